@@ -14,11 +14,19 @@ int train_acc = 1;
 int unbalanced = 0;
 int unbalanced_skip = 0;
 unsigned int fixed_bias = 0;
+unsigned int layer_bias = 0;
+#ifdef FIXEDFANN
+int fixed_q16 = 0;
+#endif
 unsigned int bp_bias = 15;
 unsigned int max_idx_train = 0, max_idx_test = 0;
 unsigned int num_layers = 0;
 unsigned int rand_seed = 0;
 unsigned int threads = 0;
+unsigned int num_folds = 0, fold = 0;
+int data_enc = FANN_DATA_FF;
+int libsvm = 0;
+unsigned int libsvm_input = 0, libsvm_output = 0;
 extern unsigned int fann_train_shuffle;
 //unsigned int train_shuffle = 0;
 #define MAX_LAYERS 12
@@ -36,6 +44,18 @@ unsigned int epochs_between_reports = 0;
 unsigned int train_algo;
 float max_error = 0.0;
 const char * save_file = NULL;
+const char * checkpoint_file = NULL;
+const char * counters_file = NULL;
+const char * profile_file = NULL;
+unsigned int profile_every = 16;
+int profile_hw = 0;
+const char * metrics_file = NULL;
+int metrics_port = 0;
+unsigned int metrics_interval = 1000;
+const char * trace_file = NULL;
+unsigned int trace_events = 1 << 20;
+int trace_samples = 0;
+const char * resume_file = NULL;
 char * from_file = NULL;
 float learn_momentum = 0.0;
 float steepness_hidden;
@@ -243,6 +263,9 @@ int train_callback(struct fann *ann, struct fann_data *train,
         snprintf(epochNfile, sizeof(epochNfile)-1, "%s-%04u", save_file, ann->train_epoch);
         fann_save(ann, epochNfile);
     }
+    if (checkpoint_file != NULL) {
+        fann_save_checkpoint(ann, train_data, checkpoint_file);
+    }
     /*if (status != NULL) {
         fprintf(status, "Train Epoch %u: SEP=%.2f ERP=%.2f ", ann->train_epoch,
                 fann_get_sep(ann), fann_get_erp(ann));
@@ -286,7 +309,10 @@ int train_callback(struct fann *ann, struct fann_data *train,
 #ifdef DOUBLEFANN
 #ifndef FANN_LIGHT
     if (print_grads && (ann->train_epoch == 1)) {
-        fann_gradient_check(ann, train_data->input[0], train_data->output[0]);
+        fann_type_ff in[ann->num_input], out[ann->num_output];
+
+        fann_gradient_check(ann, fann_expand_data_input(train_data, 0, in),
+                            fann_expand_data_output(train_data, 0, out));
     }
 #endif // FANN_LIGHT
 #endif
@@ -311,11 +337,38 @@ int train_callback(struct fann *ann, struct fann_data *train,
 }
 
 
+#if (defined SOFTFANN) && (defined FANN_COUNT_OPS)
+static void print_op_counts(void)
+{
+    struct fann_counters cnt;
+    struct fann_count sum;
+    unsigned int l, p;
+
+    fann_get_counters(&cnt);
+    memset(&sum, 0, sizeof(sum));
+    for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+        for (p = 0; p < FANN_PHASE_COUNT; p++) {
+            sum.mac += cnt.layer[l][p].mac;
+            sum.add += cnt.layer[l][p].add;
+            sum.mul += cnt.layer[l][p].mul;
+            sum.div += cnt.layer[l][p].div;
+        }
+    }
+    printf("Weight MAC OPs: %lu\n", (unsigned long int)sum.mac);
+    printf("Weight ADD OPs: %lu\n", (unsigned long int)sum.add);
+    printf("Weight MUL OPs: %lu\n", (unsigned long int)sum.mul);
+    printf("Weight DIV OPs: %lu\n", (unsigned long int)sum.div);
+}
+#endif
+
 int main(int argc, char *argv[])
 {
     struct fann *ann = arg_parse(argc, argv);
     uint32_t diff;
     static void * ref = NULL;
+#ifdef FANN_METRICS
+    FILE *metrics_out = NULL;
+#endif
 
     if (ann == NULL) {
         return 1;
@@ -323,6 +376,8 @@ int main(int argc, char *argv[])
 #ifndef FANN_LIGHT
 #ifdef SOFTFANN 
     fann_reset_counters();
+#elif (defined FANN_COUNTERS)
+    fann_clear_counters();
 #endif
     if (print_param) {
         fann_print_parameters(ann);
@@ -332,6 +387,29 @@ int main(int argc, char *argv[])
     }
 #endif // FANN_LIGHT
     //fann_print_structure(ann, __FILE__, __FUNCTION__, __LINE__);
+#ifdef FANN_PROFILE
+    if (profile_file != NULL) {
+        fann_profile_enable(profile_every);
+        if (profile_hw && (fann_profile_hw(1) == 0)) {
+            fprintf(stderr, "No hardware events can be counted, profiling times only\n");
+        }
+    }
+#endif
+#ifdef FANN_METRICS
+    if ((metrics_file != NULL) || (metrics_port > 0)) {
+        metrics_out = (metrics_file != NULL) ? fopen(metrics_file, "w") : NULL;
+        if (((metrics_file != NULL) && (metrics_out == NULL)) ||
+            fann_metrics_start(ann, (metrics_out != NULL) ? fileno(metrics_out) : -1, metrics_port,
+                               metrics_interval)) {
+            fprintf(stderr, "Unable to start the metrics\n");
+        }
+    }
+#endif
+#ifdef FANN_TRACE
+    if (trace_file != NULL) {
+        fann_trace_enable(trace_events, trace_samples);
+    }
+#endif
     ref = fann_start_count(ref, COUNT_CPU_TIME);
     if (steepness_end > steepness_start) {
         train_on_steepness(ann, train_data, max_epochs, epochs_between_reports);
@@ -354,18 +432,71 @@ int main(int argc, char *argv[])
                            epochs_between_reports, max_error);
     }
     diff = fann_stop_count_us(ref);
+    if (checkpoint_file != NULL) {
+        fann_wait_checkpoint();
+    }
     //fprintf(stderr, "tot_train_time = %f\n", tot_train_time / 1e3);
     if (rand_seed == 0) {
         printf("Time diff. = %u\n", diff);
-#ifdef SOFTFANN
-#ifndef FANN_LIGHT
-    printf("Weight MAC OPs: %lu\n", fann_mac_ops_count);
-    printf("Weight ADD OPs: %lu\n", fann_add_ops_count);
-    printf("Weight MUL OPs: %lu\n", fann_mult_ops_count);
-    printf("Weight DIV OPs: %lu\n", fann_div_ops_count);
+#if (defined SOFTFANN) && (defined FANN_COUNT_OPS)
+        print_op_counts();
+#endif
+    }
+#ifdef FANN_COUNTERS
+    if (counters_file != NULL) {
+        FILE *out = fopen(counters_file, "w");
+
+        if ((out == NULL) || fann_dump_counters(out, ann, diff * 1e-6)) {
+            fprintf(stderr, "Unable to write counters to %s\n", counters_file);
+        }
+        if (out != NULL) {
+            fclose(out);
+        }
+    }
 #endif
+#ifdef FANN_METRICS
+    fann_metrics_stop();
+    if (metrics_out != NULL) {
+        fclose(metrics_out);
+    }
 #endif
+#ifdef FANN_PROFILE
+    if (profile_file != NULL) {
+        FILE *out = fopen(profile_file, "w");
+
+        // the dump reports the sampling period, disable after it
+        if ((out == NULL) || fann_profile_dump(out, ann)) {
+            fprintf(stderr, "Unable to write profile to %s\n", profile_file);
+        }
+        if (out != NULL) {
+            fclose(out);
+        }
+        fann_profile_enable(0);
     }
+#endif
+#ifdef FANN_TRACE
+    if (trace_file != NULL) {
+        FILE *out = fopen(trace_file, "w");
+
+        fann_trace_enable(0, 0);
+        if ((out == NULL) || fann_trace_dump(out)) {
+            fprintf(stderr, "Unable to write trace to %s\n", trace_file);
+        }
+        if (out != NULL) {
+            fclose(out);
+        }
+    }
+#endif
+#ifdef FIXEDFANN
+    if (fixed_q16 && (fann_fixed_quantize(ann, train_data) == 0)) {
+        // int16 sums, with the formats observed on the train data
+        if (test_data != NULL) {
+            printf("ACCURACY on test data (int16) [%.2lf]:", fann_test_data(ann, test_data));
+            print_accuracy(ann, stdout, class_count_test);
+        }
+        fann_fixed_release(ann);
+    }
+#endif
     if (save_file != NULL) {
         printf("Saving FLOAT network.\n");
         fann_save(ann, save_file);
@@ -404,6 +535,7 @@ enum cmd_options {
     RAND_SEED,
     BP_BIAS,
     FIXED_BIAS,
+    LAYER_BIAS,
     THREADS,
     FROM_FILE,
     NUM_LAYERS,
@@ -414,6 +546,8 @@ enum cmd_options {
     FILE_TEST,
     FILE_VALIDATION,
     FILE_FOLDS,
+    LIBSVM,
+    DATA_ENC,
     ACTIV_FUNC_HIDDEN,
     ACTIV_FUNC_OUTPUT,
     //ACTIV_FUNC_CASCADE,
@@ -423,6 +557,18 @@ enum cmd_options {
     TRAIN_ALGO,
     MAX_ERROR,
     SAVE_FILE,
+    CHECKPOINT,
+    RESUME,
+    COUNTERS,
+    PROFILE,
+    PROFILE_EVERY,
+    PROFILE_HW,
+    METRICS,
+    METRICS_PORT,
+    METRICS_INTERVAL,
+    TRACE,
+    TRACE_EVENTS,
+    TRACE_SAMPLES,
     LEARN_MOMENTUM,
     STEEPNESS_CHANGE,
     STEEPNESS_HIDDEN,
@@ -436,6 +582,9 @@ enum cmd_options {
     RAND_WEIGHTS,
     BIT_FAIL_LIM,
     RPROP_DELTA_MIN,
+#ifdef FIXEDFANN
+    FIXED_Q16,
+#endif
 };
 
 static struct fann * arg_parse(int argc, char *argv[])
@@ -451,6 +600,7 @@ static struct fann * arg_parse(int argc, char *argv[])
         {"rand_seed",           required_argument, NULL, RAND_SEED},
         {"bp_bias",             required_argument, NULL, BP_BIAS},
         {"fixed_bias",          no_argument,       NULL, FIXED_BIAS},
+        {"layer_bias",          no_argument,       NULL, LAYER_BIAS},
         {"threads",             required_argument, NULL, THREADS},
         {"from_file",           required_argument, NULL, FROM_FILE},
         {"num_layers",          required_argument, NULL, NUM_LAYERS},
@@ -461,6 +611,8 @@ static struct fann * arg_parse(int argc, char *argv[])
         {"file_test",           required_argument, NULL, FILE_TEST},
         {"file_validation",     required_argument, NULL, FILE_VALIDATION},
         {"file_folds",          required_argument, NULL, FILE_FOLDS},
+        {"libsvm",              required_argument, NULL, LIBSVM},
+        {"data_enc",            required_argument, NULL, DATA_ENC},
         {"active_func_hidden",  required_argument, NULL, ACTIV_FUNC_HIDDEN},
         {"active_func_output",  required_argument, NULL, ACTIV_FUNC_OUTPUT},
         //{"active_func_cascade", required_argument, NULL, ACTIV_FUNC_CASCADE},
@@ -470,6 +622,18 @@ static struct fann * arg_parse(int argc, char *argv[])
         {"train_algo",          required_argument, NULL, TRAIN_ALGO},
         {"max_error",           required_argument, NULL, MAX_ERROR},
         {"save_file",           required_argument, NULL, SAVE_FILE},
+        {"checkpoint",          required_argument, NULL, CHECKPOINT},
+        {"resume",              required_argument, NULL, RESUME},
+        {"counters",            required_argument, NULL, COUNTERS},
+        {"profile",             required_argument, NULL, PROFILE},
+        {"profile_every",       required_argument, NULL, PROFILE_EVERY},
+        {"profile_hw",          no_argument,       NULL, PROFILE_HW},
+        {"metrics",             required_argument, NULL, METRICS},
+        {"metrics_port",        required_argument, NULL, METRICS_PORT},
+        {"metrics_interval",    required_argument, NULL, METRICS_INTERVAL},
+        {"trace",               required_argument, NULL, TRACE},
+        {"trace_events",        required_argument, NULL, TRACE_EVENTS},
+        {"trace_samples",       no_argument,       NULL, TRACE_SAMPLES},
         {"learn_momentum",      required_argument, NULL, LEARN_MOMENTUM},
         {"steepness_change",    required_argument, NULL, STEEPNESS_CHANGE},
         {"steepness_hidden",    required_argument, NULL, STEEPNESS_HIDDEN},
@@ -483,6 +647,9 @@ static struct fann * arg_parse(int argc, char *argv[])
         {"rand_weights",        required_argument, NULL, RAND_WEIGHTS},
         {"bit_fail_lim",        required_argument, NULL, BIT_FAIL_LIM},
         {"rprop_delta_min",     required_argument, NULL, RPROP_DELTA_MIN},
+#ifdef FIXEDFANN
+        {"fixed_q16",           no_argument,       NULL, FIXED_Q16},
+#endif
         {0, 0, NULL,  0 }
     };
     const unsigned int last_opt = sizeof(long_options)/sizeof(long_options)[0] - 1;
@@ -550,6 +717,9 @@ static struct fann * arg_parse(int argc, char *argv[])
         case FIXED_BIAS:
             fixed_bias = 1;
             break;
+        case LAYER_BIAS:
+            layer_bias = 1;
+            break;
         case THREADS:
             if ((sscanf(optarg, "%u", &threads) != 1) || (threads > 23)) {
                 goto parse_error;
@@ -595,7 +765,9 @@ static struct fann * arg_parse(int argc, char *argv[])
             break;
             */
         case FILE_TRAIN:
-            if (strcmp(optarg, "-") == 0) {
+            if (libsvm) {
+                train_data = fann_read_libsvm_data(optarg, libsvm_input, libsvm_output);
+            } else if (strcmp(optarg, "-") == 0) {
                 train_data = fann_read_data_from_file(NULL);
             } else {
                 train_data = fann_read_data_from_file(optarg);
@@ -613,7 +785,9 @@ static struct fann * arg_parse(int argc, char *argv[])
             }*/
             break;
         case FILE_TEST:
-            if (strcmp(optarg, "-") == 0) {
+            if (libsvm) {
+                test_data = fann_read_libsvm_data(optarg, libsvm_input, libsvm_output);
+            } else if (strcmp(optarg, "-") == 0) {
                 test_data = fann_read_data_from_file(NULL);
             } else {
                 test_data = fann_read_data_from_file(optarg);
@@ -623,13 +797,39 @@ static struct fann * arg_parse(int argc, char *argv[])
             }
             break;
         case FILE_VALIDATION:
-            validation_data = fann_read_data_from_file(optarg);
+            if (libsvm) {
+                validation_data = fann_read_libsvm_data(optarg, libsvm_input, libsvm_output);
+            } else {
+                validation_data = fann_read_data_from_file(optarg);
+            }
             if (validation_data == NULL) {
                 goto parse_error;
             }
             break;
         case FILE_FOLDS:
-            if (test_data != NULL) {
+            if ((test_data != NULL) ||
+                (sscanf(optarg, "%u:%u", &num_folds, &fold) != 2) ||
+                (fold >= num_folds)) {
+                goto parse_error;
+            }
+            break;
+        case LIBSVM:
+            /* the data files that follow are in libsvm format */
+            if ((sscanf(optarg, "%u:%u", &libsvm_input, &libsvm_output) != 2) ||
+                (libsvm_output == 0)) {
+                goto parse_error;
+            }
+            libsvm = 1;
+            break;
+        case DATA_ENC:
+            for (en = 0; en <= FANN_DATA_SPARSE; en++) {
+                if (strcmp(optarg, FANN_DATA_ENC_NAMES[en]) == 0) {
+                    data_enc = en;
+                    break;
+                }
+            }
+            if (en > FANN_DATA_SPARSE) {
+                printf("invalid data encoding %s\n", optarg);
                 goto parse_error;
             }
             break;
@@ -702,6 +902,50 @@ static struct fann * arg_parse(int argc, char *argv[])
         case SAVE_FILE:
             save_file = optarg;
             break;
+        case CHECKPOINT:
+            checkpoint_file = optarg;
+            break;
+        case RESUME:
+            resume_file = optarg;
+            break;
+        case COUNTERS:
+            counters_file = optarg;
+            break;
+        case PROFILE:
+            profile_file = optarg;
+            break;
+        case PROFILE_EVERY:
+            if ((sscanf(optarg, "%u", &profile_every) != 1) || (profile_every == 0)) {
+                goto parse_error;
+            }
+            break;
+        case PROFILE_HW:
+            profile_hw = 1;
+            break;
+        case METRICS:
+            metrics_file = optarg;
+            break;
+        case METRICS_PORT:
+            if ((sscanf(optarg, "%d", &metrics_port) != 1) || (metrics_port <= 0) || (metrics_port > 65535)) {
+                goto parse_error;
+            }
+            break;
+        case METRICS_INTERVAL:
+            if ((sscanf(optarg, "%u", &metrics_interval) != 1) || (metrics_interval == 0)) {
+                goto parse_error;
+            }
+            break;
+        case TRACE:
+            trace_file = optarg;
+            break;
+        case TRACE_EVENTS:
+            if ((sscanf(optarg, "%u", &trace_events) != 1) || (trace_events == 0)) {
+                goto parse_error;
+            }
+            break;
+        case TRACE_SAMPLES:
+            trace_samples = 1;
+            break;
         case LEARN_MOMENTUM:
             if (sscanf(optarg, "%f", &learn_momentum) != 1) {
                 goto parse_error;
@@ -795,6 +1039,11 @@ static struct fann * arg_parse(int argc, char *argv[])
                 goto parse_error;
             }
             break;
+#ifdef FIXEDFANN
+        case FIXED_Q16:
+            fixed_q16 = 1;
+            break;
+#endif
         }
         printf("option %s", long_options[option_index].name);
         if (optarg)
@@ -815,6 +1064,17 @@ static struct fann * arg_parse(int argc, char *argv[])
             return NULL;
         }
     }
+    if (num_folds > 0) {
+        /* train and test sets are views of the same rows, no copies */
+        struct fann_data * all_data = train_data;
+
+        if ((all_data == NULL) || (test_data != NULL) ||
+            fann_fold_data_view(all_data, num_folds, fold, &train_data, &test_data)) {
+            fprintf(stderr, "error splitting fold %u of %u\n", fold, num_folds);
+            return NULL;
+        }
+        fann_destroy_data(all_data);
+    }
     if ((train_data != NULL) && (num_layers > 1)) {
         for (en = 1; en < (num_layers-1); en++) {
             if (num_neurons_hidden[en] < 1) {
@@ -834,11 +1094,13 @@ static struct fann * arg_parse(int argc, char *argv[])
     }
     //fann_print_structure(ann, __FILE__, __FUNCTION__, __LINE__);
     if (ann != NULL) {
+        fann_initialize_bp_bias(ann, bp_bias);
         if (fixed_bias)
             fann_set_fixed_bp_bias(ann);
+        else if (layer_bias)
+            fann_set_layer_bp_bias(ann);
         else
             fann_set_dynamic_bp_bias(ann);
-        fann_initialize_bp_bias(ann, bp_bias);
         if (rprop_delta_min >= 0.0)
             ann->rprop_delta_min = fann_float_to_ff(rprop_delta_min);
         fann_set_mini_batch(ann, mini_batch);
@@ -884,6 +1146,18 @@ static struct fann * arg_parse(int argc, char *argv[])
         fann_free(old_l);
     }
 #endif
+    if (data_enc != FANN_DATA_FF) {
+        /* after scaling, encoded data can not be scaled */
+        /* sparse inputs only, the outputs stay dense */
+        int out_enc = (data_enc == FANN_DATA_SPARSE) ? FANN_DATA_FF : data_enc;
+
+        if (((train_data != NULL) && fann_encode_data(train_data, data_enc, out_enc)) ||
+            ((test_data != NULL) && fann_encode_data(test_data, data_enc, out_enc)) ||
+            ((validation_data != NULL) && fann_encode_data(validation_data, data_enc, out_enc))) {
+            fprintf(stderr, "error encoding data as %s\n", FANN_DATA_ENC_NAMES[data_enc]);
+            return NULL;
+        }
+    }
     if (bin_class) {
         if (train_data != NULL) {
             no_class_train = fann_count_classes(train_data, &class_count_train, 0.5, &max_idx_train, NULL);
@@ -912,6 +1186,13 @@ static struct fann * arg_parse(int argc, char *argv[])
             }
         }
     }
+    if ((ann != NULL) && (resume_file != NULL)) {
+        if (fann_load_checkpoint(ann, train_data, resume_file) != 0) {
+            fann_destroy(ann);
+            return NULL;
+        }
+        printf("resuming from epoch %u\n", ann->train_epoch);
+    }
     if (!print_stats) {
         FILE * fil = fopen("stats", "r");
         if (fil != NULL) {
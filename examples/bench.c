@@ -0,0 +1,393 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Benchmarks of the back-end it is compiled with (see "make bench"):
+
+   <name>_bench [-quick] [-min_time SECONDS] [-datasets DIR] [-dataset NAME]...
+                [-epochs N]
+
+   Micro: fann_run, a batch of fann_run, fann_backpropagate_loss,
+   fann_update_slopes_batch and each fann_update_weights_* alone, over a
+   matrix of layer widths and depths. Each is repeated until a run takes
+   min_time, the median and minimum of BENCH_REPEATS runs are reported.
+   Operations that change the state they need (the incremental update
+   reverts the input pointer of fann_run) get it back untimed before each
+   call, and are timed call by call.
+
+   Macro: epochs of the training algorithms on DIR/NAME.train, with the
+   accuracy on DIR/NAME.test, for each -dataset given or else mushroom and
+   two-spiral (decompressed by make). Large synthetic sets can be written
+   there by synth_data, in the binary format to load them faster.
+
+   The results are written to stdout as one JSON object. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "fann.h"
+
+#define BENCH_REPEATS 5
+#define BENCH_ROWS 64
+#define BENCH_OUTPUTS 4
+#define BENCH_DATASETS 16
+
+static const unsigned int widths[] = {16, 64, 256};
+static const unsigned int depths[] = {1, 2, 4};    // hidden layers
+
+static double min_time = 0.01;
+static int quick = 0;
+
+struct bench {
+    struct fann *ann;
+    struct fann_data *data;
+    unsigned int row;
+};
+
+typedef void (*bench_op)(struct bench *b);
+
+static double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+/* JSON has no NaN or infinities, a diverged loss is written as null */
+static const char *json_real(char *buf, size_t size, double x)
+{
+    if (!isfinite(x)) {
+        return "null";
+    }
+    snprintf(buf, size, "%.6f", x);
+    return buf;
+}
+
+static fann_type_ff *next_input(struct bench *b)
+{
+    b->row = (b->row + 1) % b->data->num_data;
+    return b->data->input[b->row];
+}
+
+static void op_run(struct bench *b)
+{
+    fann_run(b->ann, next_input(b));
+    b->ann->first_layer->value = NULL;
+}
+
+static void op_run_batch(struct bench *b)
+{
+    unsigned int i;
+
+    for (i = 0; i < b->data->num_data; i++) {
+        fann_run(b->ann, b->data->input[i]);
+    }
+    b->ann->first_layer->value = NULL;
+}
+
+static void prepare_loss(struct bench *b)
+{
+    fann_run(b->ann, next_input(b));
+    fann_compute_loss(b->ann, b->data->output[b->row]);
+}
+
+static void op_backpropagate_loss(struct bench *b)
+{
+    fann_backpropagate_loss(b->ann);
+}
+
+static void prepare_run(struct bench *b)
+{
+    fann_run(b->ann, next_input(b));
+}
+
+static void op_update_slopes_batch(struct bench *b)
+{
+    fann_update_slopes_batch(b->ann);
+}
+
+static void op_update_weights_incremental(struct bench *b)
+{
+    fann_update_weights_incremental(b->ann);
+}
+
+static void op_update_weights_batch(struct bench *b)
+{
+    fann_update_weights_batch(b->ann, NULL, NULL);
+}
+
+static void op_update_weights_rmsprop(struct bench *b)
+{
+    fann_update_weights_rmsprop(b->ann, NULL, NULL);
+}
+
+static void op_update_weights_irpropm(struct bench *b)
+{
+    fann_update_weights_irpropm(b->ann);
+}
+
+static const struct {
+    const char *name;
+    bench_op prepare;
+    bench_op op;
+    unsigned int rows;      // network passes per op
+} ops[] = {
+    {"run",                        NULL,         op_run,                        1},
+    {"run_batch",                  NULL,         op_run_batch,                  BENCH_ROWS},
+    {"backpropagate_loss",         prepare_loss, op_backpropagate_loss,         1},
+    {"update_slopes_batch",        prepare_run,  op_update_slopes_batch,        1},
+    {"update_weights_incremental", prepare_run,  op_update_weights_incremental, 1},
+    {"update_weights_batch",       NULL,         op_update_weights_batch,       1},
+    {"update_weights_rmsprop",     NULL,         op_update_weights_rmsprop,     1},
+    {"update_weights_irpropm",     NULL,         op_update_weights_irpropm,     1},
+};
+
+#define NUM_OPS (sizeof(ops) / sizeof(ops[0]))
+#define NUM_OF(a) (sizeof(a) / sizeof(a[0]))
+
+/* seconds taken by n ops, without their preparation */
+static double time_op(struct bench *b, unsigned int op, unsigned long n)
+{
+    double start, total = 0.0;
+    unsigned long i;
+
+    if (ops[op].prepare == NULL) {
+        start = now();
+        for (i = 0; i < n; i++) {
+            ops[op].op(b);
+        }
+        return now() - start;
+    }
+    for (i = 0; i < n; i++) {
+        ops[op].prepare(b);
+        start = now();
+        ops[op].op(b);
+        total += now() - start;
+    }
+    return total;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void bench_micro(struct bench *b, unsigned int op, const char *sep)
+{
+    double ns[BENCH_REPEATS];
+    unsigned long n = 1;
+    unsigned int r;
+
+    while ((time_op(b, op, n) < min_time) && (n < (1UL << 30))) {
+        n *= 2;
+    }
+    for (r = 0; r < BENCH_REPEATS; r++) {
+        ns[r] = 1e9 * time_op(b, op, n) / (double)n;
+    }
+    qsort(ns, BENCH_REPEATS, sizeof(double), cmp_double);
+    printf("%s\n  {\"op\": \"%s\", \"rows\": %u, \"calls\": %lu, \"ns_per_call\": %.1f, \"ns_min\": %.1f}",
+           sep, ops[op].name, ops[op].rows, n, ns[BENCH_REPEATS / 2], ns[0]);
+}
+
+static void setup(struct fann *ann)
+{
+    fann_initialize_bp_bias(ann, 15);
+    fann_set_dynamic_bp_bias(ann);
+    fann_set_activation_function_hidden(ann, FANN_SIGMOID_SYMMETRIC);
+    fann_set_activation_function_output(ann, FANN_SIGMOID);
+    fann_init_weights(ann);
+}
+
+static struct fann_data *random_data(unsigned int rows, unsigned int inputs, unsigned int outputs)
+{
+    struct fann_data *data = fann_create_data(rows, inputs, outputs);
+    unsigned int i, j;
+
+    if (data == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < rows; i++) {
+        for (j = 0; j < inputs; j++) {
+            data->input[i][j] = fann_float_to_ff(2.0f * (float)rand() / (float)RAND_MAX - 1.0f);
+        }
+        for (j = 0; j < outputs; j++) {
+            data->output[i][j] = fann_float_to_ff((float)(rand() & 1));
+        }
+    }
+    return data;
+}
+
+static int bench_shape(unsigned int width, unsigned int depth, int *first)
+{
+    unsigned int layers[2 + 8], num_layers = depth + 2, weights = 0, l, op;
+    struct bench b;
+
+    for (l = 0; l < num_layers - 1; l++) {
+        layers[l] = width;
+    }
+    layers[num_layers - 1] = BENCH_OUTPUTS;
+    for (l = 1; l < num_layers; l++) {
+        weights += layers[l] * (layers[l - 1] + 1);
+    }
+    b.row = 0;
+    b.data = random_data(BENCH_ROWS, width, BENCH_OUTPUTS);
+    b.ann = fann_create_standard_vector(0, num_layers, layers);
+    if ((b.data == NULL) || (b.ann == NULL)) {
+        return -1;
+    }
+    setup(b.ann);
+    // allocates the slopes and steps the updates work on
+    fann_set_training_algorithm(b.ann, FANN_TRAIN_RPROP);
+    fann_train_epoch(b.ann, b.data);
+    fann_set_training_algorithm(b.ann, FANN_TRAIN_RMSPROP);
+    fann_train_epoch(b.ann, b.data);
+
+    printf("%s\n {\"width\": %u, \"hidden_layers\": %u, \"weights\": %u, \"ops\": [",
+           *first ? "" : ",", width, depth, weights);
+    for (op = 0; op < NUM_OPS; op++) {
+        bench_micro(&b, op, op ? "," : "");
+    }
+    printf("]}");
+    *first = 0;
+    fann_destroy(b.ann);
+    fann_destroy_data(b.data);
+    return 0;
+}
+
+static int bench_dataset(const char *dir, const char *name, unsigned int hidden,
+                         unsigned int epochs, int *first)
+{
+    static const struct {
+        enum fann_train_enum algo;
+        unsigned int mini_batch;
+    } runs[] = {
+        {FANN_TRAIN_INCREMENTAL, 0},
+        {FANN_TRAIN_BATCH, 0},
+        {FANN_TRAIN_RPROP, 0},
+        {FANN_TRAIN_RMSPROP, 64},
+    };
+    char file[1024], loss[32], acc_buf[32];
+    struct fann_data *train_data, *test_data;
+    struct fann *ann;
+    unsigned int layers[3], r, e;
+    double start, seconds;
+    float acc;
+
+    snprintf(file, sizeof(file), "%s/%s.train", dir, name);
+    train_data = fann_read_data_from_file(file);
+    snprintf(file, sizeof(file), "%s/%s.test", dir, name);
+    test_data = fann_read_data_from_file(file);
+    if ((train_data == NULL) || (test_data == NULL)) {
+        fprintf(stderr, "%s data not found in %s, skipped\n", name, dir);
+        fann_destroy_data(train_data);
+        fann_destroy_data(test_data);
+        return 0;
+    }
+    layers[0] = fann_num_input_data(train_data);
+    layers[1] = hidden;
+    layers[2] = fann_num_output_data(train_data);
+    for (r = 0; r < NUM_OF(runs); r++) {
+        fann_enable_seed_fixed(1);
+        ann = fann_create_standard_vector(0, 3, layers);
+        if (ann == NULL) {
+            return -1;
+        }
+        setup(ann);
+        fann_set_training_algorithm(ann, runs[r].algo);
+        fann_set_mini_batch(ann, runs[r].mini_batch);
+        start = now();
+        for (e = 0; e < epochs; e++) {
+            fann_train_epoch(ann, train_data);
+        }
+        seconds = now() - start;
+        acc = fann_test_data(ann, test_data);
+        printf("%s\n  {\"dataset\": \"%s\", \"train_algo\": \"%s\", \"mini_batch\": %u, \"hidden\": %u, "
+               "\"epochs\": %u, \"seconds_per_epoch\": %.6f, \"rows_per_second\": %.1f, "
+               "\"loss\": %s, \"test_accuracy\": %s}",
+               *first ? "" : ",", name, FANN_TRAIN_NAMES[runs[r].algo], runs[r].mini_batch, hidden,
+               epochs, seconds / epochs, epochs * (double)fann_length_data(train_data) / seconds,
+               json_real(loss, sizeof(loss), fann_get_loss(ann)),
+               json_real(acc_buf, sizeof(acc_buf), acc));
+        *first = 0;
+        fann_destroy(ann);
+    }
+    fann_destroy_data(train_data);
+    fann_destroy_data(test_data);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *datasets = "../datasets";
+    const char *names[BENCH_DATASETS] = {"mushroom", "two-spiral"};
+    unsigned int epochs = 5, num_names = 0, w, d;
+    int i, first = 1;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-quick") == 0) {
+            quick = 1;
+        } else if ((strcmp(argv[i], "-min_time") == 0) && (i + 1 < argc)) {
+            min_time = atof(argv[++i]);
+        } else if ((strcmp(argv[i], "-datasets") == 0) && (i + 1 < argc)) {
+            datasets = argv[++i];
+        } else if ((strcmp(argv[i], "-dataset") == 0) && (i + 1 < argc) && (num_names < BENCH_DATASETS)) {
+            names[num_names++] = argv[++i];
+        } else if ((strcmp(argv[i], "-epochs") == 0) && (i + 1 < argc)
+                   && (sscanf(argv[++i], "%u", &epochs) == 1) && (epochs > 0)) {
+            continue;
+        } else {
+            fprintf(stderr, "usage: %s [-quick] [-min_time SECONDS] [-datasets DIR] [-dataset NAME]...\n"
+                    "       [-epochs N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (num_names == 0) {
+        num_names = 2;
+    }
+    srand(1);
+    fann_enable_seed_fixed(1);
+
+    printf("{\"back_end\": \"%s\", \"fann_type_ff_bytes\": %u, \"fann_type_bp_bytes\": %u, \"min_time\": %g,\n",
+           fann_float_type, (unsigned int)sizeof(fann_type_ff), (unsigned int)sizeof(fann_type_bp), min_time);
+    printf("\"micro\": [");
+    for (w = 0; w < NUM_OF(widths) - quick; w++) {
+        for (d = 0; d < NUM_OF(depths) - quick; d++) {
+            if (bench_shape(widths[w], depths[d], &first)) {
+                fprintf(stderr, "Unable to allocate memory.\n");
+                return 1;
+            }
+        }
+    }
+    printf("],\n\"epochs\": [");
+    first = 1;
+    for (d = 0; d < num_names; d++) {
+        if (bench_dataset(datasets, names[d], 32, quick ? 1 : epochs, &first)) {
+            fprintf(stderr, "Unable to allocate memory.\n");
+            return 1;
+        }
+    }
+    printf("]}\n");
+    return 0;
+}
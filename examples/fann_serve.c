@@ -0,0 +1,997 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Serves a network on a Unix domain socket or on loopback TCP, running
+   concurrent requests in batches:
+
+   fann_serve [-socket PATH | -port N] [-max_batch N] [-max_wait_us N]
+              [-workers N] [-max_in_flight N] [-stats S] net_file
+
+   or loads a running server with closed loop clients:
+
+   fann_serve -clients N [-requests N] [-depth N] [-socket PATH | -port N]
+              net_file
+
+   A request is uint32 id, uint32 n and n float inputs; its response is
+   uint32 id, uint32 status, uint32 n and n float outputs, all in the byte
+   order of the host (the server only listens locally). Status is 0, or
+   SERVE_BAD_SIZE with no outputs when n is not the number of inputs of
+   the network, and then the connection is closed. A connection may send
+   requests without waiting for the responses, which come back in the
+   order their batches complete, up to max_in_flight (256) requests whose
+   responses were not sent: the server stops reading it at that point and
+   closes it if it then reads none of them for SERVE_STALL_S seconds.
+   Responses are sent without blocking, what the socket does not take
+   waits in a buffer of the connection that the poll loop sends, so a
+   client that does not read never holds up the workers or other clients.
+
+   Each worker has its own copy of the network and takes up to max_batch
+   queued requests, waiting at most max_wait_us after the oldest one
+   arrived for more, and runs them with fann_run_batch. Every S seconds
+   (and on SIGINT or SIGTERM) the server writes a JSON line with the
+   requests per second, mean batch and the latency percentiles from
+   arrival to response. The clients write the same from their side, with
+   depth requests in flight each.
+
+   On SIGHUP the server loads net_file again in the background and swaps
+   it in (see fann_model.h): the batches running finish with the old
+   network, the next ones run the new one, and the workers never wait for
+   the load. net_file may be an image saved by fann_save_shared(), whose
+   weights all the servers on a host share. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "fann.h"
+
+#define SERVE_BAD_SIZE 1
+#define SERVE_MAX_CONNS 1024
+#define SERVE_QUEUE 65536
+#define SERVE_READ 65536
+// a connection at max_in_flight whose responses are not read is closed after
+#define SERVE_STALL_S 5
+// 4 per power of 2, up to 2^40 ns
+#define SERVE_BUCKETS 160
+
+struct serve_hist {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t bucket[SERVE_BUCKETS];
+};
+
+struct serve_conn {
+    int fd;
+    unsigned int refs;      // the poll loop and the queued requests, under serve.lock
+    pthread_mutex_t out_lock;
+    // under out_lock: the responses not sent, room for max_in_flight of them
+    unsigned char *out;
+    size_t out_len;
+    unsigned int queued;    // requests not answered yet
+    int dead;               // closed, the responses are dropped
+    uint64_t stalled;       // since when it is not read and its responses are not sent, or 0
+    // poll loop only
+    int closing;            // nothing more is read, closed once answered
+    unsigned char *in;
+    size_t in_len, in_size;
+};
+
+struct serve_request {
+    struct serve_conn *conn;
+    uint32_t id;
+    uint64_t arrival;
+    fann_type_ff input[];
+};
+
+static struct {
+    struct fann_model *model;
+    const char *net_file;
+    unsigned int num_input, num_output;
+    unsigned int max_batch;
+    unsigned int max_in_flight;
+    size_t response_size;
+    uint64_t max_wait_ns;
+    int stop;
+    // pending requests, from head
+    struct serve_request *queue[SERVE_QUEUE];
+    unsigned int head, count;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    // done requests, under stats_lock
+    pthread_mutex_t stats_lock;
+    uint64_t requests, batches;
+    struct serve_hist interval, total;
+} serve;
+
+static int stop_pipe[2] = {-1, -1};
+// the workers wake the poll loop up for the connections
+static int wake_pipe[2] = {-1, -1};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned int hist_bucket(uint64_t t)
+{
+    unsigned int e, b;
+
+    if (t < 4) {
+        return (unsigned int)t;
+    }
+    e = 63 - __builtin_clzll(t);
+    b = 4 * (e - 1) + (unsigned int)((t >> (e - 2)) & 3);
+    return (b < SERVE_BUCKETS) ? b : SERVE_BUCKETS - 1;
+}
+
+static void hist_add(struct serve_hist *h, uint64_t t)
+{
+    h->count++;
+    h->sum += t;
+    if (t > h->max) {
+        h->max = t;
+    }
+    h->bucket[hist_bucket(t)]++;
+}
+
+static void hist_merge(struct serve_hist *sum, const struct serve_hist *h)
+{
+    unsigned int b;
+
+    sum->count += h->count;
+    sum->sum += h->sum;
+    if (h->max > sum->max) {
+        sum->max = h->max;
+    }
+    for (b = 0; b < SERVE_BUCKETS; b++) {
+        sum->bucket[b] += h->bucket[b];
+    }
+}
+
+/* middle of bucket, at most the max, in us */
+static double hist_quantile(const struct serve_hist *h, double q)
+{
+    uint64_t acc = 0, rank = (uint64_t)(q * (double)h->count);
+    unsigned int b, e;
+    double t;
+
+    for (b = 0; b < SERVE_BUCKETS - 1; b++) {
+        acc += h->bucket[b];
+        if (acc > rank) {
+            break;
+        }
+    }
+    if (b < 4) {
+        t = (double)b;
+    } else {
+        e = b / 4 + 1;
+        t = (double)((uint64_t)(4 + b % 4) << (e - 2)) + 0.5 * (double)((uint64_t)1 << (e - 2));
+    }
+    return 1e-3 * ((t < (double)h->max) ? t : (double)h->max);
+}
+
+static void hist_print(const char *who, const struct serve_hist *h, double seconds, double mean_batch)
+{
+    printf("{\"%s\": %.3f, \"requests\": %" PRIu64 ", \"requests_per_s\": %.1f, ", who, seconds,
+           h->count, (seconds > 0.0) ? (double)h->count / seconds : 0.0);
+    if (mean_batch > 0.0) {
+        printf("\"mean_batch\": %.2f, ", mean_batch);
+    }
+    printf("\"mean_us\": %.1f, \"p50_us\": %.1f, \"p90_us\": %.1f, \"p99_us\": %.1f, "
+           "\"p999_us\": %.1f, \"max_us\": %.1f}\n",
+           h->count ? 1e-3 * (double)h->sum / (double)h->count : 0.0,
+           hist_quantile(h, 0.5), hist_quantile(h, 0.9), hist_quantile(h, 0.99),
+           hist_quantile(h, 0.999), 1e-3 * (double)h->max);
+    fflush(stdout);
+}
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    ssize_t ret;
+
+    while (len > 0) {
+        ret = send(fd, p, len, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += ret;
+        len -= (size_t)ret;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len)
+{
+    unsigned char *p = (unsigned char *)buf;
+    ssize_t ret;
+
+    while (len > 0) {
+        ret = recv(fd, p, len, 0);
+        if (ret <= 0) {
+            if ((ret < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return -1;
+        }
+        p += ret;
+        len -= (size_t)ret;
+    }
+    return 0;
+}
+
+/* drops a reference to conn under serve.lock, the last one closes it */
+static void conn_put(struct serve_conn *conn)
+{
+    if (--conn->refs == 0) {
+        close(conn->fd);
+        pthread_mutex_destroy(&conn->out_lock);
+        free(conn->out);
+        free(conn->in);
+        free(conn);
+    }
+}
+
+/* requests read whose responses are not all sent, under out_lock */
+static unsigned int conn_pending(const struct serve_conn *conn)
+{
+    return conn->queued + (unsigned int)((conn->out_len + serve.response_size - 1) / serve.response_size);
+}
+
+static void wake_poll(void)
+{
+    if (write(wake_pipe[1], "w", 1) < 0) {
+        // full: a wake up is already pending
+    }
+}
+
+/* INTERNAL FUNCTION
+   Sends what the socket takes of the output of conn without blocking,
+   under out_lock. The connection is dead if it fails.
+ */
+static void conn_flush(struct serve_conn *conn)
+{
+    ssize_t sent;
+
+    while ((conn->out_len > 0) && !conn->dead) {
+        sent = send(conn->fd, conn->out, conn->out_len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                conn->dead = 1;
+                conn->out_len = 0;
+            }
+            return;
+        }
+        memmove(conn->out, conn->out + sent, conn->out_len - (size_t)sent);
+        conn->out_len -= (size_t)sent;
+        conn->stalled = 0;
+    }
+}
+
+/* Answers a request of conn, one that was queued if status is 0, by adding
+   the response to its output and sending what the socket takes. */
+static void respond(struct serve_conn *conn, uint32_t id, uint32_t status,
+                    const fann_type_ff *output, unsigned int num, float *buf)
+{
+    uint32_t *hdr = (uint32_t *)buf;
+    size_t len = (3 + num) * sizeof(float);
+    int wake;
+
+    hdr[0] = id;
+    hdr[1] = status;
+    hdr[2] = num;
+    if (num > 0) {
+        fann_ff_to_float_array(buf + 3, output, num);
+    }
+    pthread_mutex_lock(&conn->out_lock);
+    // at the cap the poll loop stopped reading it
+    wake = (conn_pending(conn) >= serve.max_in_flight);
+    if (status == 0) {
+        conn->queued--;
+    }
+    if (!conn->dead) {
+        memcpy(conn->out + conn->out_len, buf, len);
+        conn->out_len += len;
+        conn_flush(conn);
+    }
+    // the rest is sent on POLLOUT, a closing connection may be done
+    wake |= (conn->out_len > 0) || conn->closing || conn->dead;
+    pthread_mutex_unlock(&conn->out_lock);
+    if (wake) {
+        wake_poll();
+    }
+}
+
+static void *worker(void *arg)
+{
+    unsigned int reader = (unsigned int)(uintptr_t)arg;
+    struct serve_request **batch;
+    fann_type_ff **input, *output;
+    float *buf;
+    unsigned int n, i;
+    uint64_t done;
+    struct timespec ts;
+
+    batch = (struct serve_request **)malloc(serve.max_batch * sizeof(*batch));
+    input = (fann_type_ff **)malloc(serve.max_batch * sizeof(*input));
+    output = (fann_type_ff *)malloc(serve.max_batch * serve.num_output * sizeof(fann_type_ff));
+    buf = (float *)malloc((3 + serve.num_output) * sizeof(float));
+    if ((batch == NULL) || (input == NULL) || (output == NULL) || (buf == NULL)) {
+        fprintf(stderr, "Unable to allocate the batch of a worker\n");
+        exit(1);
+    }
+    pthread_mutex_lock(&serve.lock);
+    for (;;) {
+        while ((serve.count == 0) && !serve.stop) {
+            pthread_cond_wait(&serve.not_empty, &serve.lock);
+        }
+        if (serve.count == 0) {
+            break;
+        }
+        // more requests, until the oldest one waited long enough
+        done = serve.queue[serve.head]->arrival + serve.max_wait_ns;
+        ts.tv_sec = (time_t)(done / 1000000000);
+        ts.tv_nsec = (long)(done % 1000000000);
+        while ((serve.count > 0) && (serve.count < serve.max_batch) && !serve.stop &&
+               (now_ns() < done)) {
+            pthread_cond_timedwait(&serve.not_empty, &serve.lock, &ts);
+        }
+        // another worker may have taken them
+        if (serve.count == 0) {
+            continue;
+        }
+        n = (serve.count < serve.max_batch) ? serve.count : serve.max_batch;
+        for (i = 0; i < n; i++) {
+            batch[i] = serve.queue[serve.head];
+            input[i] = batch[i]->input;
+            serve.head = (serve.head + 1) % SERVE_QUEUE;
+        }
+        // the poll loop holds the requests it reads while the queue is full
+        if (serve.count == SERVE_QUEUE) {
+            wake_poll();
+        }
+        serve.count -= n;
+        if (serve.count > 0) {
+            pthread_cond_signal(&serve.not_empty);
+        }
+        pthread_mutex_unlock(&serve.lock);
+
+        if (fann_run_batch(fann_model_acquire(serve.model, reader), n, input, output)) {
+            exit(1);
+        }
+        fann_model_release(serve.model, reader);
+        for (i = 0; i < n; i++) {
+            respond(batch[i]->conn, batch[i]->id, 0, output + i * serve.num_output, serve.num_output, buf);
+        }
+        done = now_ns();
+        pthread_mutex_lock(&serve.stats_lock);
+        serve.batches++;
+        for (i = 0; i < n; i++) {
+            hist_add(&serve.interval, done - batch[i]->arrival);
+        }
+        pthread_mutex_unlock(&serve.stats_lock);
+
+        pthread_mutex_lock(&serve.lock);
+        for (i = 0; i < n; i++) {
+            conn_put(batch[i]->conn);
+            free(batch[i]);
+        }
+    }
+    pthread_mutex_unlock(&serve.lock);
+    free(batch);
+    free(input);
+    free(output);
+    free(buf);
+    return NULL;
+}
+
+/* INTERNAL FUNCTION
+   Queues the complete requests read on conn, -1 if it must be closed.
+   Those past max_in_flight, or that do not fit in the queue, stay in its
+   input until there is room.
+ */
+static int conn_parse(struct serve_conn *conn, uint64_t arrival)
+{
+    size_t pos = 0;
+    uint32_t hdr[2];
+    struct serve_request *req;
+    unsigned int pending;
+    float bad[3];
+
+    while (conn->in_len - pos >= sizeof(hdr)) {
+        // only the workers lower it, the output has room for one more response
+        pthread_mutex_lock(&conn->out_lock);
+        pending = conn_pending(conn);
+        pthread_mutex_unlock(&conn->out_lock);
+        if (pending >= serve.max_in_flight) {
+            break;
+        }
+        memcpy(hdr, conn->in + pos, sizeof(hdr));
+        if (hdr[1] != serve.num_input) {
+            // the rest of the stream can not be trusted
+            respond(conn, hdr[0], SERVE_BAD_SIZE, NULL, 0, bad);
+            return -1;
+        }
+        if (conn->in_len - pos < sizeof(hdr) + hdr[1] * sizeof(float)) {
+            break;
+        }
+        req = (struct serve_request *)malloc(sizeof(struct serve_request) +
+                                              serve.num_input * sizeof(fann_type_ff));
+        if (req == NULL) {
+            return -1;
+        }
+        req->conn = conn;
+        req->id = hdr[0];
+        req->arrival = arrival;
+        fann_float_to_ff_array(req->input, (const float *)(conn->in + pos + sizeof(hdr)), serve.num_input);
+
+        pthread_mutex_lock(&serve.lock);
+        if (serve.count == SERVE_QUEUE) {
+            pthread_mutex_unlock(&serve.lock);
+            free(req);
+            break;
+        }
+        pthread_mutex_lock(&conn->out_lock);
+        conn->queued++;
+        pthread_mutex_unlock(&conn->out_lock);
+        serve.queue[(serve.head + serve.count) % SERVE_QUEUE] = req;
+        serve.count++;
+        conn->refs++;
+        pthread_cond_signal(&serve.not_empty);
+        pthread_mutex_unlock(&serve.lock);
+        pos += sizeof(hdr) + serve.num_input * sizeof(float);
+    }
+    memmove(conn->in, conn->in + pos, conn->in_len - pos);
+    conn->in_len -= pos;
+    return 0;
+}
+
+static void on_signal(int sig)
+{
+    if (write(stop_pipe[1], (sig == SIGHUP) ? "r" : "s", 1) < 0) {
+        // nothing else to do in a handler
+    }
+}
+
+static int listen_on(const char *path, int port)
+{
+    int fd, one = 1;
+
+    if (path != NULL) {
+        struct sockaddr_un addr;
+
+        if (strlen(path) >= sizeof(addr.sun_path)) {
+            return -1;
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path);
+        unlink(path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((fd < 0) || bind(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+            return -1;
+        }
+    } else {
+        struct sockaddr_in addr;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if ((fd < 0) || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) ||
+            bind(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+            return -1;
+        }
+    }
+    return listen(fd, 128) ? -1 : fd;
+}
+
+static int connect_to(const char *path, int port)
+{
+    int fd, one = 1;
+
+    if (path != NULL) {
+        struct sockaddr_un addr;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((fd < 0) || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+            return -1;
+        }
+    } else {
+        struct sockaddr_in addr;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if ((fd < 0) || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+            return -1;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+static void print_stats(uint64_t *last, int final)
+{
+    struct serve_hist h;
+    uint64_t t = now_ns();
+    double mean_batch;
+
+    pthread_mutex_lock(&serve.stats_lock);
+    hist_merge(&serve.total, &serve.interval);
+    h = final ? serve.total : serve.interval;
+    serve.requests += serve.interval.count;
+    mean_batch = serve.batches ? (double)serve.requests / (double)serve.batches : 0.0;
+    memset(&serve.interval, 0, sizeof(serve.interval));
+    pthread_mutex_unlock(&serve.stats_lock);
+    hist_print(final ? "total_s" : "interval_s", &h, 1e-9 * (double)(t - last[final]), mean_batch);
+    last[0] = t;
+}
+
+/* INTERNAL FUNCTION
+   The poll events of conn, after queuing what its input holds.
+   Returns -1 if it is done: dead, or closing with everything answered,
+   1 if it is stalled, 0 otherwise.
+ */
+static int conn_events(struct serve_conn *conn, uint64_t t, short *events)
+{
+    int ret;
+
+    // what was read before the peer shut down is answered too
+    if (conn_parse(conn, t)) {
+        conn->closing = 1;
+        conn->in_len = 0;
+    }
+    *events = 0;
+    pthread_mutex_lock(&conn->out_lock);
+    if (conn->out_len > 0) {
+        *events |= POLLOUT;
+    }
+    if (!conn->closing && (conn->in_len < conn->in_size) &&
+        (conn_pending(conn) < serve.max_in_flight)) {
+        *events |= POLLIN;
+    }
+    // not read, and its responses are not either
+    if ((conn->out_len > 0) && !(*events & POLLIN)) {
+        if (conn->stalled == 0) {
+            conn->stalled = t;
+        } else if (t - conn->stalled >= (uint64_t)SERVE_STALL_S * 1000000000) {
+            conn->dead = 1;
+            conn->out_len = 0;
+        }
+    } else {
+        conn->stalled = 0;
+    }
+    if (conn->dead || (conn->closing && (conn->queued == 0) && (conn->out_len == 0) &&
+                       (conn->in_len < 2 * sizeof(uint32_t) + serve.num_input * sizeof(float)))) {
+        ret = -1;
+    } else {
+        ret = (conn->stalled != 0);
+    }
+    pthread_mutex_unlock(&conn->out_lock);
+    return ret;
+}
+
+static int run_server(const char *path, int port, unsigned int workers, unsigned int stats)
+{
+    struct pollfd pfd[SERVE_MAX_CONNS + 3];
+    struct serve_conn *conns[SERVE_MAX_CONNS];
+    pthread_t *threads;
+    unsigned int num_conns = 0, c, w;
+    unsigned int version;
+    uint64_t last[2], t;
+    int listen_fd, ret, timeout, stop = 0;
+    char sig[64];
+    ssize_t got, i;
+
+    listen_fd = listen_on(path, port);
+    if (listen_fd < 0) {
+        perror("fann_serve: listen");
+        return 1;
+    }
+    if (pipe(stop_pipe) || pipe(wake_pipe)) {
+        perror("fann_serve: pipe");
+        return 1;
+    }
+    // neither the handlers nor the workers block on them
+    for (i = 0; i < 2; i++) {
+        fcntl(stop_pipe[i], F_SETFL, O_NONBLOCK);
+        fcntl(wake_pipe[i], F_SETFL, O_NONBLOCK);
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGHUP, on_signal);
+
+    pthread_mutex_init(&serve.lock, NULL);
+    pthread_mutex_init(&serve.stats_lock, NULL);
+    {
+        // the batch deadlines are CLOCK_MONOTONIC
+        pthread_condattr_t attr;
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&serve.not_empty, &attr);
+        pthread_condattr_destroy(&attr);
+    }
+    threads = (pthread_t *)malloc(workers * sizeof(pthread_t));
+    if (threads == NULL) {
+        return 1;
+    }
+    serve.model = fann_model_create(serve.net_file, workers);
+    if (serve.model == NULL) {
+        return 1;
+    }
+    version = fann_model_version(serve.model);
+    for (w = 0; w < workers; w++) {
+        if (pthread_create(threads + w, NULL, worker, (void *)(uintptr_t)w)) {
+            fprintf(stderr, "Unable to start worker %u\n", w);
+            return 1;
+        }
+    }
+    fprintf(stderr, "fann_serve: %u inputs, %u outputs, %u workers, batches up to %u in %.0f us\n",
+            serve.num_input, serve.num_output, workers, serve.max_batch, 1e-3 * (double)serve.max_wait_ns);
+
+    last[0] = last[1] = now_ns();
+    while (!stop) {
+        pfd[0].fd = stop_pipe[0];
+        pfd[0].events = POLLIN;
+        pfd[1].fd = wake_pipe[0];
+        pfd[1].events = POLLIN;
+        pfd[2].fd = listen_fd;
+        pfd[2].events = (num_conns < SERVE_MAX_CONNS) ? POLLIN : 0;
+        timeout = stats ? 100 : -1;
+        t = now_ns();
+        // from the last one, so that removing conns keeps the indexes
+        for (c = num_conns; c-- > 0; ) {
+            struct serve_conn *conn = conns[c];
+
+            ret = conn_events(conn, t, &pfd[c + 3].events);
+            if (ret < 0) {
+                shutdown(conn->fd, SHUT_RDWR);
+                pthread_mutex_lock(&serve.lock);
+                conn_put(conn);
+                pthread_mutex_unlock(&serve.lock);
+                conns[c] = conns[--num_conns];
+                pfd[c + 3].events = pfd[num_conns + 3].events;
+                continue;
+            }
+            if (ret > 0) {
+                // to close it in time
+                timeout = 100;
+            }
+        }
+        for (c = 0; c < num_conns; c++) {
+            pfd[c + 3].fd = conns[c]->fd;
+        }
+        ret = poll(pfd, num_conns + 3, timeout);
+        if ((ret < 0) && (errno != EINTR)) {
+            perror("fann_serve: poll");
+            break;
+        }
+        if (stats && (now_ns() - last[0] >= (uint64_t)stats * 1000000000)) {
+            print_stats(last, 0);
+        }
+        if (fann_model_version(serve.model) != version) {
+            version = fann_model_version(serve.model);
+            fprintf(stderr, "fann_serve: version %u of the network\n", version);
+        }
+        if (ret <= 0) {
+            continue;
+        }
+        if (pfd[0].revents) {
+            got = read(stop_pipe[0], sig, sizeof(sig));
+            for (i = 0; i < got; i++) {
+                if (sig[i] == 'r') {
+                    fprintf(stderr, "fann_serve: reloading %s\n", serve.net_file);
+                    fann_model_reload(serve.model, serve.net_file);
+                } else {
+                    stop = 1;
+                }
+            }
+        }
+        if (pfd[1].revents) {
+            // the connections are looked at again on the next round
+            while (read(wake_pipe[0], sig, sizeof(sig)) > 0) {
+            }
+        }
+        for (c = 0; c < num_conns; c++) {
+            struct serve_conn *conn = conns[c];
+            short revents = pfd[c + 3].revents;
+
+            if (revents & (POLLOUT | POLLERR | POLLHUP)) {
+                pthread_mutex_lock(&conn->out_lock);
+                conn_flush(conn);
+                if (revents & POLLERR) {
+                    conn->dead = 1;
+                    conn->out_len = 0;
+                }
+                pthread_mutex_unlock(&conn->out_lock);
+            }
+            if (!(revents & (POLLIN | POLLHUP)) || conn->closing) {
+                continue;
+            }
+            got = recv(conn->fd, conn->in + conn->in_len, conn->in_size - conn->in_len, 0);
+            if ((got < 0) && ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                continue;
+            }
+            if (got <= 0) {
+                // the responses are still sent
+                conn->closing = 1;
+                continue;
+            }
+            conn->in_len += (size_t)got;
+        }
+        if (pfd[2].revents & POLLIN) {
+            struct serve_conn *conn;
+            int fd = accept(listen_fd, NULL, NULL), one = 1;
+
+            if (fd < 0) {
+                continue;
+            }
+            if (path == NULL) {
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            fcntl(fd, F_SETFL, O_NONBLOCK);
+            conn = (struct serve_conn *)calloc(1, sizeof(struct serve_conn));
+            if (conn == NULL) {
+                close(fd);
+                continue;
+            }
+            // a partial request and a whole read, and the responses up to the cap
+            conn->in_size = 2 * sizeof(uint32_t) + serve.num_input * sizeof(float) + SERVE_READ;
+            conn->in = (unsigned char *)malloc(conn->in_size);
+            conn->out = (unsigned char *)malloc(serve.max_in_flight * serve.response_size);
+            if ((conn->in == NULL) || (conn->out == NULL)) {
+                free(conn->in);
+                free(conn->out);
+                free(conn);
+                close(fd);
+                continue;
+            }
+            conn->fd = fd;
+            conn->refs = 1;
+            pthread_mutex_init(&conn->out_lock, NULL);
+            conns[num_conns++] = conn;
+        }
+    }
+
+    // the queued requests are still answered, as far as the sockets take them
+    pthread_mutex_lock(&serve.lock);
+    serve.stop = 1;
+    pthread_cond_broadcast(&serve.not_empty);
+    pthread_mutex_unlock(&serve.lock);
+    for (w = 0; w < workers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    for (c = 0; c < num_conns; c++) {
+        pthread_mutex_lock(&conns[c]->out_lock);
+        conn_flush(conns[c]);
+        pthread_mutex_unlock(&conns[c]->out_lock);
+        conn_put(conns[c]);
+    }
+    print_stats(last, 1);
+    fann_model_destroy(serve.model);
+    close(listen_fd);
+    if (path != NULL) {
+        unlink(path);
+    }
+    free(threads);
+    return 0;
+}
+
+struct client {
+    pthread_t thread;
+    const char *path;
+    int port;
+    unsigned int requests, depth, seed;
+    struct serve_hist hist;
+    int failed;
+};
+
+static void *client_run(void *arg)
+{
+    struct client *cl = (struct client *)arg;
+    unsigned int sent = 0, recvd = 0, i, num_free, size = (2 + serve.num_input) * sizeof(float);
+    unsigned int *free_ids;
+    uint64_t *start;
+    float *req, *resp;
+    int fd;
+
+    start = (uint64_t *)malloc(cl->depth * sizeof(uint64_t));
+    free_ids = (unsigned int *)malloc(cl->depth * sizeof(unsigned int));
+    req = (float *)malloc(size);
+    resp = (float *)malloc((3 + serve.num_output) * sizeof(float));
+    fd = connect_to(cl->path, cl->port);
+    if ((start == NULL) || (free_ids == NULL) || (req == NULL) || (resp == NULL) || (fd < 0)) {
+        cl->failed = 1;
+        goto done;
+    }
+    for (num_free = 0; num_free < cl->depth; num_free++) {
+        free_ids[num_free] = num_free;
+    }
+    ((uint32_t *)req)[1] = serve.num_input;
+    while (recvd < cl->requests) {
+        // keep depth requests in flight, ids are slots of start
+        while ((sent < cl->requests) && (num_free > 0)) {
+            ((uint32_t *)req)[0] = free_ids[--num_free];
+            for (i = 0; i < serve.num_input; i++) {
+                cl->seed = cl->seed * 1103515245 + 12345;
+                req[2 + i] = (float)(cl->seed >> 16) / 32768.0f - 1.0f;
+            }
+            start[((uint32_t *)req)[0]] = now_ns();
+            if (write_all(fd, req, size)) {
+                cl->failed = 1;
+                goto done;
+            }
+            sent++;
+        }
+        if (read_all(fd, resp, 3 * sizeof(uint32_t)) || (((uint32_t *)resp)[1] != 0) ||
+            (((uint32_t *)resp)[0] >= cl->depth) || (((uint32_t *)resp)[2] != serve.num_output) ||
+            read_all(fd, resp + 3, serve.num_output * sizeof(float))) {
+            cl->failed = 1;
+            goto done;
+        }
+        hist_add(&cl->hist, now_ns() - start[((uint32_t *)resp)[0]]);
+        free_ids[num_free++] = ((uint32_t *)resp)[0];
+        recvd++;
+    }
+done:
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(start);
+    free(free_ids);
+    free(req);
+    free(resp);
+    return NULL;
+}
+
+static int run_clients(const char *path, int port, unsigned int clients, unsigned int requests,
+                       unsigned int depth)
+{
+    struct client *cl;
+    struct serve_hist all;
+    uint64_t start;
+    unsigned int c;
+    int failed = 0;
+
+    cl = (struct client *)calloc(clients, sizeof(struct client));
+    if (cl == NULL) {
+        return 1;
+    }
+    start = now_ns();
+    for (c = 0; c < clients; c++) {
+        cl[c].path = path;
+        cl[c].port = port;
+        cl[c].requests = requests;
+        cl[c].depth = depth;
+        cl[c].seed = c + 1;
+        if (pthread_create(&cl[c].thread, NULL, client_run, cl + c)) {
+            return 1;
+        }
+    }
+    memset(&all, 0, sizeof(all));
+    for (c = 0; c < clients; c++) {
+        pthread_join(cl[c].thread, NULL);
+        hist_merge(&all, &cl[c].hist);
+        failed |= cl[c].failed;
+    }
+    hist_print("clients_s", &all, 1e-9 * (double)(now_ns() - start), 0.0);
+    free(cl);
+    if (failed) {
+        fprintf(stderr, "Some clients failed\n");
+    }
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    unsigned int max_batch = 32, max_wait_us = 200, workers = 1, max_in_flight = 256, stats = 10;
+    unsigned int clients = 0, requests = 10000, depth = 1;
+    struct fann *ann;
+    int port = 0, i;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i + 1];
+
+        if (argv[i][0] != '-') {
+            break;
+        }
+        if (strcmp(argv[i], "-socket") == 0) {
+            path = arg;
+        } else if (((strcmp(argv[i], "-port") == 0) && (sscanf(arg, "%d", &port) == 1) &&
+                    (port > 0) && (port < 65536))
+                   || ((strcmp(argv[i], "-max_batch") == 0) && (sscanf(arg, "%u", &max_batch) == 1) &&
+                       (max_batch > 0))
+                   || ((strcmp(argv[i], "-max_wait_us") == 0) && (sscanf(arg, "%u", &max_wait_us) == 1))
+                   || ((strcmp(argv[i], "-workers") == 0) && (sscanf(arg, "%u", &workers) == 1) &&
+                       (workers > 0))
+                   || ((strcmp(argv[i], "-max_in_flight") == 0) &&
+                       (sscanf(arg, "%u", &max_in_flight) == 1) && (max_in_flight > 0))
+                   || ((strcmp(argv[i], "-stats") == 0) && (sscanf(arg, "%u", &stats) == 1))
+                   || ((strcmp(argv[i], "-clients") == 0) && (sscanf(arg, "%u", &clients) == 1))
+                   || ((strcmp(argv[i], "-requests") == 0) && (sscanf(arg, "%u", &requests) == 1))
+                   || ((strcmp(argv[i], "-depth") == 0) && (sscanf(arg, "%u", &depth) == 1) &&
+                       (depth > 0))) {
+            continue;
+        } else {
+            goto usage;
+        }
+    }
+    if ((i + 1 != argc) || (argv[i][0] == '-') || ((path == NULL) == (port == 0))) {
+        goto usage;
+    }
+
+    // the sizes, the server loads it again as a model
+    ann = fann_load_network(argv[i]);
+    if (ann == NULL) {
+        return 1;
+    }
+    serve.net_file = argv[i];
+    serve.num_input = fann_get_num_input(ann);
+    serve.num_output = fann_get_num_output(ann);
+    fann_destroy(ann);
+    serve.max_batch = max_batch;
+    serve.max_wait_ns = (uint64_t)max_wait_us * 1000;
+    serve.max_in_flight = max_in_flight;
+    serve.response_size = (3 + serve.num_output) * sizeof(float);
+    if (clients > 0) {
+        return run_clients(path, port, clients, requests, depth);
+    }
+    return run_server(path, port, workers, stats);
+
+usage:
+    fprintf(stderr, "usage: %s [-socket PATH | -port N] [-max_batch N] [-max_wait_us N]\n"
+            "       [-workers N] [-max_in_flight N] [-stats S] net_file\n"
+            "       %s -clients N [-requests N] [-depth N] [-socket PATH | -port N] net_file\n",
+            argv[0], argv[0]);
+    return 1;
+}
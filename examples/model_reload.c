@@ -0,0 +1,142 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Checks that reloading a model (see fann_model.h) does not leak:
+
+   model_reload [-reloads N] [-readers N] [-hidden N] [-shared]
+
+   Two networks with N hidden neurons (256 by default) are saved as
+   configuration files, or with -shared as images (see fann_save_shared),
+   and a model with N readers (4) reloads them in turn N times (200), each
+   reader running the current version between reloads. The heap in use is
+   taken after the first two reloads and at the end; the JSON line written
+   to stdout has both and the bytes of the weights of one network, and the
+   exit status is 1 if the heap grew by half of those or more. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <malloc.h>
+
+#include "fann.h"
+#include "fann_model.h"
+
+#define NUM_INPUT 64
+#define NUM_OUTPUT 8
+
+static size_t heap_in_use(void)
+{
+    struct mallinfo2 mi = mallinfo2();
+
+    return mi.uordblks + mi.hblkhd;
+}
+
+/* a random network saved to a new temporary file, name[] gets its name */
+static int save_network(char *name, unsigned int hidden, int shared)
+{
+    struct fann *ann;
+    int fd, ret;
+
+    strcpy(name, "/tmp/model_reloadXXXXXX");
+    fd = mkstemp(name);
+    if (fd < 0) {
+        return -1;
+    }
+    close(fd);
+    ann = fann_create_standard_args(0, 3, NUM_INPUT, hidden, NUM_OUTPUT);
+    if (ann == NULL) {
+        return -1;
+    }
+    fann_randomize_weights(ann, fann_float_to_nt(-1.0f), fann_float_to_nt(1.0f));
+    ret = shared ? fann_save_shared(ann, name) : fann_save(ann, name);
+    fann_destroy(ann);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int reloads = 200, readers = 4, hidden = 256, n, r, i;
+    int shared = 0, failed = 0;
+    char files[2][32];
+    fann_type_ff input[NUM_INPUT];
+    struct fann_model *model;
+    size_t start = 0, end, weights;
+
+    for (i = 1; i < (unsigned int)argc; i++) {
+        if (strcmp(argv[i], "-shared") == 0) {
+            shared = 1;
+        } else if ((i + 1 < (unsigned int)argc) && (strcmp(argv[i], "-reloads") == 0)) {
+            reloads = (unsigned int)atoi(argv[++i]);
+        } else if ((i + 1 < (unsigned int)argc) && (strcmp(argv[i], "-readers") == 0)) {
+            readers = (unsigned int)atoi(argv[++i]);
+        } else if ((i + 1 < (unsigned int)argc) && (strcmp(argv[i], "-hidden") == 0)) {
+            hidden = (unsigned int)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-reloads N] [-readers N] [-hidden N] [-shared]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((reloads < 2) || (readers == 0) || (hidden == 0)) {
+        fprintf(stderr, "reloads must be 2 or more, readers and hidden 1 or more\n");
+        return 2;
+    }
+    if (save_network(files[0], hidden, shared) || save_network(files[1], hidden, shared)) {
+        fprintf(stderr, "Unable to save the networks\n");
+        return 1;
+    }
+    model = fann_model_create(files[0], readers);
+    if (model == NULL) {
+        failed = 1;
+        goto done;
+    }
+    for (i = 0; i < NUM_INPUT; i++) {
+        input[i] = fann_float_to_ff((float)i / (float)NUM_INPUT);
+    }
+    for (n = 0; n < reloads; n++) {
+        if (fann_model_reload(model, files[(n + 1) & 1]) || fann_model_wait(model)) {
+            failed = 1;
+            break;
+        }
+        for (r = 0; r < readers; r++) {
+            fann_run(fann_model_acquire(model, r), input);
+            fann_model_release(model, r);
+        }
+        // the first versions allocate what the heap keeps for the next ones
+        if (n == 1) {
+            start = heap_in_use();
+        }
+    }
+    end = heap_in_use();
+    fann_model_destroy(model);
+    weights = ((size_t)(NUM_INPUT + 1) * hidden + (size_t)(hidden + 1) * NUM_OUTPUT) * sizeof(fann_type_ff);
+    printf("{\"reloads\": %u, \"readers\": %u, \"shared\": %d, \"weights_bytes\": %zu"
+           ", \"heap_start\": %zu, \"heap_end\": %zu}\n",
+           reloads, readers, shared, weights, start, end);
+    if (!failed && (end >= start + weights / 2)) {
+        fprintf(stderr, "The heap grew by %zu bytes in %u reloads\n", end - start, reloads - 2);
+        failed = 1;
+    }
+
+done:
+    unlink(files[0]);
+    unlink(files[1]);
+    return failed;
+}
@@ -0,0 +1,221 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Converts networks to shared images (see fann_save_shared) and measures
+   the memory of worker processes running them:
+
+   shared_model -save net_file image_file
+
+   shared_model [-processes N] [-runs N] [-mode private|file|memfd] file
+
+   Each of the N processes gets the network, runs it on N random inputs
+   and, once all of them run it, writes a JSON line with its resident
+   (rss_kb) and proportional (pss_kb, each shared page divided among the
+   processes that map it) memory from /proc/self/smaps_rollup; the parent
+   then writes the totals. In private mode each process loads its own copy
+   of a configuration file, in file mode it attaches the image file, and
+   in memfd mode the image of a configuration file or image, which the
+   parent writes to shared memory before forking. With shared weights, the
+   total pss counts them once for the host. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "fann.h"
+
+enum shared_mode {
+    MODE_PRIVATE = 0,
+    MODE_FILE,
+    MODE_MEMFD
+};
+
+/* kB of a line of /proc/self/smaps_rollup, 0 if missing */
+static unsigned long smaps_kb(const char *name)
+{
+    char line[256];
+    unsigned long kb = 0;
+    size_t len = strlen(name);
+    FILE *f = fopen("/proc/self/smaps_rollup", "r");
+
+    if (f == NULL) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if ((strncmp(line, name, len) == 0) && (line[len] == ':')) {
+            sscanf(line + len + 1, "%lu", &kb);
+            break;
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+static int worker(unsigned int w, enum shared_mode mode, const char *file, int shared_fd,
+                  unsigned int runs, int ready_fd, int go_fd, int result_fd)
+{
+    struct fann *ann;
+    fann_type_ff *input;
+    unsigned long kb[2];
+    unsigned int r, i, seed = w + 1;
+    char c;
+
+    if (mode == MODE_PRIVATE) {
+        ann = fann_create_from_file(file);
+    } else if (mode == MODE_FILE) {
+        ann = fann_attach_shared(file);
+    } else {
+        ann = fann_attach_shared_fd(shared_fd);
+    }
+    if (ann == NULL) {
+        return 1;
+    }
+    input = (fann_type_ff *)malloc(fann_get_num_input(ann) * sizeof(fann_type_ff));
+    if (input == NULL) {
+        return 1;
+    }
+    for (r = 0; r < runs; r++) {
+        for (i = 0; i < fann_get_num_input(ann); i++) {
+            seed = seed * 1103515245 + 12345;
+            input[i] = fann_float_to_ff((float)(seed >> 8) / (float)(1 << 24));
+        }
+        fann_run(ann, input);
+    }
+    // measured when every worker maps the network
+    if ((write(ready_fd, "", 1) != 1) || (read(go_fd, &c, 1) < 0)) {
+        return 1;
+    }
+    kb[0] = smaps_kb("Rss");
+    kb[1] = smaps_kb("Pss");
+    printf("{\"worker\": %u, \"rss_kb\": %lu, \"pss_kb\": %lu}\n", w, kb[0], kb[1]);
+    fflush(stdout);
+    if (write(result_fd, kb, sizeof(kb)) != (ssize_t)sizeof(kb)) {
+        return 1;
+    }
+    free(input);
+    fann_destroy(ann);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static const char * const modes[] = {"private", "file", "memfd"};
+    enum shared_mode mode = MODE_FILE;
+    unsigned int processes = 4, runs = 100, p, m, started = 0;
+    unsigned long kb[2], total[2] = {0, 0};
+    int ready[2], go[2], result[2], shared_fd = -1, status, failed = 0, i;
+    struct fann *ann;
+    char c;
+
+    if ((argc == 4) && (strcmp(argv[1], "-save") == 0)) {
+        ann = fann_load_network(argv[2]);
+        if ((ann == NULL) || fann_save_shared(ann, argv[3])) {
+            return 1;
+        }
+        fann_destroy(ann);
+        return 0;
+    }
+    for (i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i + 1];
+
+        if (argv[i][0] != '-') {
+            break;
+        }
+        if (strcmp(argv[i], "-mode") == 0) {
+            for (m = 0; (m < 3) && strcmp(arg, modes[m]); m++);
+            if (m == 3) {
+                goto usage;
+            }
+            mode = (enum shared_mode)m;
+        } else if (((strcmp(argv[i], "-processes") == 0) && (sscanf(arg, "%u", &processes) == 1) &&
+                    (processes > 0))
+                   || ((strcmp(argv[i], "-runs") == 0) && (sscanf(arg, "%u", &runs) == 1))) {
+            continue;
+        } else {
+            goto usage;
+        }
+    }
+    if ((i + 1 != argc) || (argv[i][0] == '-')) {
+        goto usage;
+    }
+
+    if (mode == MODE_MEMFD) {
+        ann = fann_load_network(argv[i]);
+        if ((ann == NULL) || ((shared_fd = fann_create_shared_fd(ann)) < 0)) {
+            return 1;
+        }
+        fann_destroy(ann);
+    }
+    if (pipe(ready) || pipe(go) || pipe(result)) {
+        perror("shared_model: pipe");
+        return 1;
+    }
+    fflush(stdout);
+    for (p = 0; p < processes; p++) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("shared_model: fork");
+            break;
+        }
+        if (pid == 0) {
+            close(go[1]);
+            exit(worker(p, mode, argv[i], shared_fd, runs, ready[1], go[0], result[1]));
+        }
+        started++;
+    }
+    close(ready[1]);
+    close(go[0]);
+    close(result[1]);
+    if (shared_fd >= 0) {
+        close(shared_fd);
+    }
+    // the workers that failed close their end without a byte
+    for (p = 0; (p < started) && (read(ready[0], &c, 1) == 1); p++);
+    close(go[1]);
+    for (p = 0; p < started; p++) {
+        if (read(result[0], kb, sizeof(kb)) != (ssize_t)sizeof(kb)) {
+            break;
+        }
+        total[0] += kb[0];
+        total[1] += kb[1];
+    }
+    for (p = 0; p < started; p++) {
+        if ((wait(&status) < 0) || !WIFEXITED(status) || WEXITSTATUS(status)) {
+            failed = 1;
+        }
+    }
+    printf("{\"mode\": \"%s\", \"processes\": %u, \"rss_kb\": %lu, \"pss_kb\": %lu}\n",
+           modes[mode], started, total[0], total[1]);
+    if (failed || (started < processes)) {
+        fprintf(stderr, "Some workers failed\n");
+        return 1;
+    }
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s -save net_file image_file\n"
+            "       %s [-processes N] [-runs N] [-mode private|file|memfd] file\n",
+            argv[0], argv[0]);
+    return 1;
+}
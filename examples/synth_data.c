@@ -0,0 +1,109 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Writes synthetic data sets (see fann_create_synthetic_data):
+
+   synth_data [-task classification|regression] [-rows N] [-test_rows N]
+              [-inputs N] [-outputs N] [-density D] [-skew S] [-noise N]
+              [-seed N] [-format text|binary|libsvm] train_file [test_file]
+
+   The rows are written one at a time, so the files can be larger than
+   memory. Files ending in .gz, .xz or .zst are compressed (but the library
+   can not read the LIBSVM format compressed). The test rows follow the
+   training rows of the same problem. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fann.h"
+
+int main(int argc, char *argv[])
+{
+    static const char * const formats[] = {"text", "binary", "libsvm"};
+    enum fann_data_format_enum format = FANN_FORMAT_TEXT;
+    enum fann_synth_enum task = FANN_SYNTH_CLASSIFICATION;
+    unsigned int rows = 10000, test_rows = 0, inputs = 16, outputs = 2, seed = 1, f;
+    float density = 1.0f, skew = 1.0f, noise = -1.0f;
+    struct fann_synth_params params;
+    int i;
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i + 1];
+
+        if (argv[i][0] != '-') {
+            break;
+        }
+        if (strcmp(argv[i], "-task") == 0) {
+            if (strcmp(arg, "classification") == 0) {
+                task = FANN_SYNTH_CLASSIFICATION;
+            } else if (strcmp(arg, "regression") == 0) {
+                task = FANN_SYNTH_REGRESSION;
+            } else {
+                goto usage;
+            }
+        } else if (strcmp(argv[i], "-format") == 0) {
+            for (f = 0; (f < 3) && strcmp(arg, formats[f]); f++);
+            if (f == 3) {
+                goto usage;
+            }
+            format = (enum fann_data_format_enum)f;
+        } else if (((strcmp(argv[i], "-rows") == 0) && (sscanf(arg, "%u", &rows) == 1))
+                   || ((strcmp(argv[i], "-test_rows") == 0) && (sscanf(arg, "%u", &test_rows) == 1))
+                   || ((strcmp(argv[i], "-inputs") == 0) && (sscanf(arg, "%u", &inputs) == 1))
+                   || ((strcmp(argv[i], "-outputs") == 0) && (sscanf(arg, "%u", &outputs) == 1))
+                   || ((strcmp(argv[i], "-density") == 0) && (sscanf(arg, "%f", &density) == 1))
+                   || ((strcmp(argv[i], "-skew") == 0) && (sscanf(arg, "%f", &skew) == 1))
+                   || ((strcmp(argv[i], "-noise") == 0) && (sscanf(arg, "%f", &noise) == 1))
+                   || ((strcmp(argv[i], "-seed") == 0) && (sscanf(arg, "%u", &seed) == 1))) {
+            continue;
+        } else {
+            goto usage;
+        }
+    }
+    if ((i >= argc) || (argv[i][0] == '-') || (i + 2 < argc) || ((i + 1 < argc) && (test_rows == 0))) {
+        goto usage;
+    }
+
+    fann_init_synthetic_params(&params, task, rows, inputs, outputs);
+    params.density = density;
+    params.skew = skew;
+    params.seed = seed;
+    if (noise >= 0.0f) {
+        params.noise = noise;
+    }
+    if (fann_save_synthetic_data(&params, argv[i], format)) {
+        return 1;
+    }
+    if (i + 1 < argc) {
+        params.first_row = rows;
+        params.num_data = test_rows;
+        if (fann_save_synthetic_data(&params, argv[i + 1], format)) {
+            return 1;
+        }
+    }
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-task classification|regression] [-rows N] [-test_rows N]\n"
+            "       [-inputs N] [-outputs N] [-density D] [-skew S] [-noise N]\n"
+            "       [-seed N] [-format text|binary|libsvm] train_file [test_file]\n", argv[0]);
+    return 1;
+}
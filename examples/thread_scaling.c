@@ -0,0 +1,398 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Thread scaling of fann_test_data and of the training algorithms, built
+   with the threaded library (floatfann-mt.o, see lib/Makefile):
+
+   thread_scaling [-threads LIST] [-mini_batch LIST] [-algos LIST] [-epochs N]
+                  [-rows N] [-inputs N] [-hidden N] [-outputs N]
+                  [-data FILE] [-pin] [-numa NODE]
+
+   LISTs are comma separated: numbers of extra threads (default 0,1,3,7),
+   mini-batch sizes (0 is the whole data, default 0,4096) and algorithms
+   (test, incremental, batch, rprop, rmsprop; default all).
+
+   The data is read from FILE (any format of fann_read_data_from_file), or
+   else a synthetic classification problem of fann_create_synthetic_data
+   with one class per output, so it can be made as large as needed. With
+   -numa the threads only run on the CPUs of NODE and the data
+   and networks are first touched there; -pin pins the calling thread and
+   each extra thread to one of the CPUs.
+
+   For each algorithm, mini-batch and number of threads the results are
+   written to stdout as JSON: samples/s, speedup and parallel efficiency
+   relative to the first number of threads, the share of the thread time
+   spent at the barrier, in the update (which sums the slopes of all
+   threads) and creating and joining threads, and the imbalance of the
+   work (max / mean of the threads). Only the RPROP epochs and
+   fann_test_data are split among threads, the other algorithms give the
+   cost of idle threads. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+
+#include "fann.h"
+
+#ifndef FANN_THREADS
+#error "thread_scaling must be built with -DFANN_THREADS, as the library"
+#endif
+
+#define MAX_LIST 32
+#define MAX_CPUS 1024
+
+enum scaling_algo {
+    ALGO_TEST = 0,
+    ALGO_INCREMENTAL,
+    ALGO_BATCH,
+    ALGO_RPROP,
+    ALGO_RMSPROP,
+    ALGO_COUNT
+};
+
+static const char * const algo_names[ALGO_COUNT] = {
+    "test", "incremental", "batch", "rprop", "rmsprop"
+};
+
+static const enum fann_train_enum algo_train[ALGO_COUNT] = {
+    FANN_TRAIN_RPROP, FANN_TRAIN_INCREMENTAL, FANN_TRAIN_BATCH, FANN_TRAIN_RPROP, FANN_TRAIN_RMSPROP
+};
+
+static unsigned int threads[MAX_LIST] = {0, 1, 3, 7}, num_threads = 4;
+static unsigned int mini_batches[MAX_LIST] = {0, 4096}, num_mini_batches = 2;
+static unsigned int algos[MAX_LIST] = {ALGO_TEST, ALGO_INCREMENTAL, ALGO_BATCH, ALGO_RPROP, ALGO_RMSPROP};
+static unsigned int num_algos = ALGO_COUNT;
+static unsigned int epochs = 3, rows = 65536, inputs = 64, hidden = 128, outputs = 8;
+static int pin = 0, numa_node = -1;
+static const char *data_file = NULL;
+static int cpus[MAX_CPUS];
+static unsigned int num_cpus = 0;
+
+static double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+/* numbers or ranges (0-3,8) as in cpulist, -1 on errors */
+static int parse_list(const char *arg, unsigned int *list, unsigned int max)
+{
+    unsigned int n = 0, a, b;
+    const char *p = arg;
+    int len;
+
+    while (*p) {
+        if (sscanf(p, "%u%n", &a, &len) != 1) {
+            return -1;
+        }
+        p += len;
+        b = a;
+        if ((*p == '-') && (sscanf(p + 1, "%u%n", &b, &len) == 1)) {
+            p += len + 1;
+        }
+        for (; (a <= b) && (n < max); a++) {
+            list[n++] = a;
+        }
+        if (*p == ',' || *p == '\n') {
+            p++;
+        } else if (*p) {
+            return -1;
+        }
+    }
+    return (int)n;
+}
+
+static int parse_algos(const char *arg)
+{
+    char buf[256], *tok, *save;
+    unsigned int a;
+
+    snprintf(buf, sizeof(buf), "%s", arg);
+    num_algos = 0;
+    for (tok = strtok_r(buf, ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+        for (a = 0; (a < ALGO_COUNT) && strcmp(tok, algo_names[a]); a++);
+        if ((a == ALGO_COUNT) || (num_algos == MAX_LIST)) {
+            return -1;
+        }
+        algos[num_algos++] = a;
+    }
+    return num_algos ? 0 : -1;
+}
+
+/* CPUs to run on: those of the NUMA node, or those the process may use */
+static int find_cpus(void)
+{
+    unsigned int list[MAX_CPUS];
+    cpu_set_t set;
+    int n, c;
+
+    if (numa_node >= 0) {
+        char file[128], line[4096];
+        FILE *f;
+
+        snprintf(file, sizeof(file), "/sys/devices/system/node/node%d/cpulist", numa_node);
+        f = fopen(file, "r");
+        if ((f == NULL) || (fgets(line, sizeof(line), f) == NULL)) {
+            fprintf(stderr, "NUMA node %d not found\n", numa_node);
+            if (f != NULL) {
+                fclose(f);
+            }
+            return -1;
+        }
+        fclose(f);
+        n = parse_list(line, list, MAX_CPUS);
+        if (n <= 0) {
+            return -1;
+        }
+        for (c = 0; c < n; c++) {
+            cpus[c] = (int)list[c];
+        }
+        num_cpus = (unsigned int)n;
+        return 0;
+    }
+    if (sched_getaffinity(0, sizeof(set), &set)) {
+        return -1;
+    }
+    for (c = 0; (c < CPU_SETSIZE) && (num_cpus < MAX_CPUS); c++) {
+        if (CPU_ISSET(c, &set)) {
+            cpus[num_cpus++] = c;
+        }
+    }
+    return num_cpus ? 0 : -1;
+}
+
+/* the calling thread on its first CPU (-pin) or on the CPUs of the node */
+static int place_self(void)
+{
+    cpu_set_t set;
+    unsigned int c;
+
+    if (!pin && (numa_node < 0)) {
+        return 0;
+    }
+    CPU_ZERO(&set);
+    for (c = 0; c < (pin ? 1 : num_cpus); c++) {
+        CPU_SET(cpus[c], &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+static struct fann *create(unsigned int extra, enum scaling_algo algo, unsigned int mini_batch)
+{
+    unsigned int layers[3] = {inputs, hidden, outputs}, t;
+    int thread_cpus[FANN_THREADS];
+    struct fann *ann;
+
+    fann_enable_seed_fixed(1);
+    ann = fann_create_standard_vector(extra, 3, layers);
+    if (ann == NULL) {
+        return NULL;
+    }
+    fann_initialize_bp_bias(ann, 15);
+    fann_set_dynamic_bp_bias(ann);
+    fann_set_activation_function_hidden(ann, FANN_SIGMOID_SYMMETRIC);
+    fann_set_activation_function_output(ann, FANN_SIGMOID);
+    fann_init_weights(ann);
+    fann_set_training_algorithm(ann, algo_train[algo]);
+    fann_set_mini_batch(ann, mini_batch);
+    if (pin) {
+        for (t = 0; t < extra; t++) {
+            thread_cpus[t] = cpus[(t + 1) % num_cpus];
+        }
+        if (fann_set_thread_cpus(ann, thread_cpus, extra)) {
+            fprintf(stderr, "Unable to pin the threads.\n");
+        }
+    }
+    return ann;
+}
+
+static int run(struct fann_data *data, enum scaling_algo algo, unsigned int mini_batch,
+               unsigned int extra, double *base_sps, unsigned int *base_procs, int *first)
+{
+    struct fann_thread_times times[FANN_THREADS + 1];
+    struct fann *ann = create(extra, algo, mini_batch);
+    double start, seconds, sps, speedup, busy, max_work, sum_work, wait, update;
+    unsigned int e, p, procs;
+
+    if (ann == NULL) {
+        return -1;
+    }
+    // untimed epoch: slopes and steps allocated, caches warm
+    if (algo == ALGO_TEST) {
+        fann_test_data(ann, data);
+    } else {
+        fann_train_epoch(ann, data);
+    }
+    fann_clear_thread_times(ann);
+    start = now();
+    for (e = 0; e < epochs; e++) {
+        if (algo == ALGO_TEST) {
+            fann_test_data(ann, data);
+        } else {
+            fann_train_epoch(ann, data);
+        }
+    }
+    seconds = now() - start;
+    procs = fann_get_thread_times(ann, times);
+
+    sps = (double)epochs * (double)data->num_data / seconds;
+    if (*base_sps == 0.0) {
+        *base_sps = sps;
+        *base_procs = procs;
+    }
+    speedup = sps / *base_sps;
+    max_work = sum_work = wait = update = 0.0;
+    for (p = 0; p < procs; p++) {
+        double work = 1e-9 * (double)times[p].work_ns;
+
+        sum_work += work;
+        if (work > max_work) {
+            max_work = work;
+        }
+        wait += 1e-9 * (double)times[p].wait_ns;
+        update += 1e-9 * (double)times[p].update_ns;
+    }
+    busy = seconds * procs;
+
+    printf("%s\n  {\"algo\": \"%s\", \"mini_batch\": %u, \"threads\": %u, \"seconds\": %.6f, "
+           "\"samples_per_second\": %.1f, \"speedup\": %.3f, \"efficiency\": %.3f,\n"
+           "   \"barrier_fraction\": %.4f, \"update_fraction\": %.4f, \"spawn_join_fraction\": %.4f, "
+           "\"imbalance\": %.4f, \"loss\": %.6f,\n   \"per_thread\": [",
+           *first ? "" : ",", algo_names[algo], mini_batch, procs, seconds, sps, speedup,
+           speedup * *base_procs / procs, wait / busy, update / busy,
+           1e-9 * (double)(times[0].spawn_ns + times[0].join_ns) / seconds,
+           (sum_work > 0.0) ? max_work * procs / sum_work : 0.0, fann_get_loss(ann));
+    for (p = 0; p < procs; p++) {
+        printf("%s{\"batches\": %llu, \"rows\": %llu, \"work\": %.6f, \"wait\": %.6f, \"update\": %.6f}",
+               p ? ", " : "", (unsigned long long)times[p].batches, (unsigned long long)times[p].rows,
+               1e-9 * (double)times[p].work_ns, 1e-9 * (double)times[p].wait_ns,
+               1e-9 * (double)times[p].update_ns);
+    }
+    printf("]}");
+    *first = 0;
+    fann_destroy(ann);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct fann_data *data;
+    unsigned int a, m, t, base_procs;
+    double base_sps;
+    int i, n, first = 1;
+
+    for (i = 1; i < argc; i++) {
+        const char *arg = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(argv[i], "-pin") == 0) {
+            pin = 1;
+            continue;
+        }
+        if (arg == NULL) {
+            goto usage;
+        }
+        i++;
+        if (strcmp(argv[i - 1], "-threads") == 0) {
+            if ((n = parse_list(arg, threads, MAX_LIST)) <= 0) {
+                goto usage;
+            }
+            num_threads = (unsigned int)n;
+        } else if (strcmp(argv[i - 1], "-mini_batch") == 0) {
+            if ((n = parse_list(arg, mini_batches, MAX_LIST)) <= 0) {
+                goto usage;
+            }
+            num_mini_batches = (unsigned int)n;
+        } else if (strcmp(argv[i - 1], "-algos") == 0) {
+            if (parse_algos(arg)) {
+                goto usage;
+            }
+        } else if (strcmp(argv[i - 1], "-data") == 0) {
+            data_file = arg;
+        } else if (((strcmp(argv[i - 1], "-epochs") == 0) && (sscanf(arg, "%u", &epochs) == 1) && epochs)
+                   || ((strcmp(argv[i - 1], "-rows") == 0) && (sscanf(arg, "%u", &rows) == 1) && rows)
+                   || ((strcmp(argv[i - 1], "-inputs") == 0) && (sscanf(arg, "%u", &inputs) == 1) && inputs)
+                   || ((strcmp(argv[i - 1], "-hidden") == 0) && (sscanf(arg, "%u", &hidden) == 1) && hidden)
+                   || ((strcmp(argv[i - 1], "-outputs") == 0) && (sscanf(arg, "%u", &outputs) == 1) && outputs)
+                   || ((strcmp(argv[i - 1], "-numa") == 0) && (sscanf(arg, "%d", &numa_node) == 1))) {
+            continue;
+        } else {
+            goto usage;
+        }
+    }
+    for (t = 0; t < num_threads; t++) {
+        if (threads[t] > FANN_THREADS) {
+            fprintf(stderr, "at most %d extra threads\n", FANN_THREADS);
+            return 1;
+        }
+    }
+    if (find_cpus() || place_self()) {
+        fprintf(stderr, "Unable to place the threads.\n");
+        return 1;
+    }
+
+    srand(1);
+    if (data_file != NULL) {
+        data = fann_read_data_from_file(data_file);
+    } else {
+        struct fann_synth_params params;
+
+        fann_init_synthetic_params(&params, FANN_SYNTH_CLASSIFICATION, rows, inputs, outputs);
+        data = fann_create_synthetic_data(&params);
+    }
+    if (data == NULL) {
+        return 1;
+    }
+    rows = fann_length_data(data);
+    inputs = fann_num_input_data(data);
+    outputs = fann_num_output_data(data);
+    printf("{\"back_end\": \"%s\", \"rows\": %u, \"layers\": [%u, %u, %u], \"epochs\": %u, "
+           "\"pin\": %d, \"numa_node\": %d, \"cpus\": %u,\n\"results\": [",
+           fann_float_type, rows, inputs, hidden, outputs, epochs, pin, numa_node, num_cpus);
+    for (a = 0; a < num_algos; a++) {
+        for (m = 0; m < num_mini_batches; m++) {
+            // testing and incremental training have no mini-batches
+            if ((m > 0) && (algos[a] != ALGO_RPROP) && (algos[a] != ALGO_RMSPROP) && (algos[a] != ALGO_BATCH)) {
+                continue;
+            }
+            base_sps = 0.0;
+            base_procs = 1;
+            for (t = 0; t < num_threads; t++) {
+                if (run(data, (enum scaling_algo)algos[a], mini_batches[m], threads[t],
+                        &base_sps, &base_procs, &first)) {
+                    fprintf(stderr, "Unable to allocate memory.\n");
+                    return 1;
+                }
+                fflush(stdout);
+            }
+        }
+    }
+    printf("]}\n");
+    fann_destroy_data(data);
+    return 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-threads LIST] [-mini_batch LIST] [-algos LIST] [-epochs N]\n"
+            "       [-rows N] [-inputs N] [-hidden N] [-outputs N] [-data FILE] [-pin] [-numa NODE]\n", argv[0]);
+    return 1;
+}
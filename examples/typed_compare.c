@@ -0,0 +1,86 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Trains the same network with several numeric back-ends in one process
+   (libfann_typed) and compares them on the same test data:
+
+   typed_compare train_file test_file epochs hidden_neurons type [type ...]
+
+   with the types named as in fann_typed.h (float, bf16, swf16_ap, ...). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fann_typed.h"
+
+static double elapsed(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + 1e-9 * (double)(now.tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char *argv[])
+{
+    struct fann_typed_data *train_data, *test_data;
+    struct fann_typed *ann;
+    struct timespec start;
+    unsigned int epochs, hidden, layers[3];
+    float acc;
+    int i, type;
+
+    if ((argc < 6) || (sscanf(argv[3], "%u", &epochs) != 1) || (sscanf(argv[4], "%u", &hidden) != 1)) {
+        fprintf(stderr, "usage: %s train_file test_file epochs hidden_neurons type [type ...]\n", argv[0]);
+        return 1;
+    }
+    printf("%-12s %-20s %10s %10s %10s\n", "type", "back-end", "accuracy", "loss", "seconds");
+    for (i = 5; i < argc; i++) {
+        type = fann_typed_parse(argv[i]);
+        if (type < 0) {
+            fprintf(stderr, "unknown type %s\n", argv[i]);
+            continue;
+        }
+        train_data = fann_typed_read_data(type, argv[1]);
+        test_data = fann_typed_read_data(type, argv[2]);
+        if ((train_data == NULL) || (test_data == NULL)) {
+            return 1;
+        }
+        layers[0] = fann_typed_num_input_data(train_data);
+        layers[1] = hidden;
+        layers[2] = fann_typed_num_output_data(train_data);
+        // same initial weights for every type
+        fann_typed_enable_seed_fixed(1);
+        ann = fann_create_typed_vector(type, 0, 3, layers);
+        if (ann == NULL) {
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        fann_typed_train_on_data(ann, train_data, epochs, 0, 0.0f);
+        acc = fann_typed_test_data(ann, test_data);
+        printf("%-12s %-20s %10.2f %10.6f %10.3f\n", FANN_NUMERIC_TYPE_NAMES[type],
+               ann->ops->get_name(), acc, fann_typed_get_loss(ann), elapsed(&start));
+        fann_typed_destroy(ann);
+        fann_typed_destroy_data(train_data);
+        fann_typed_destroy_data(test_data);
+    }
+    return 0;
+}
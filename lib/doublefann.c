@@ -39,6 +39,16 @@
 #include "fann_mem.c"
 #include "fann_activation.c"
 #include "fann_const.c"
+#include "fann_conv.c"
+#include "fann_count.c"
+#include "fann_prof.c"
+#include "fann_synth.c"
+#include "fann_metrics.c"
+#include "fann_trace.c"
+#include "fann_model.c"
+#ifdef FANN_TYPED_OPS
+#include "fann_typed_ops.c"
+#endif
 
 const char * fann_float_type = "DOUBLE";
 
@@ -28,6 +28,8 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <inttypes.h>
+#include <sys/mman.h>
 #endif // FANN_INFERENCE_ONLY
 
 #include "fann.h"
@@ -138,8 +140,55 @@ static void fann_seed_rand(void)
     srand(foo);
 }
 
+/* rand() state owned by the library, so that checkpoints can save and
+   restore it. The size matches the default glibc state (TYPE_3), hence
+   the sequence generated for a given seed is the same as with srand() on
+   the default state.
+ */
+static int32_t fann_rand_state[FANN_RAND_STATE_WORDS];
+static char * fann_rand_libc = NULL;
+
+/* INTERNAL FUNCTION
+   Make rand() use fann_rand_state, continuing from the current sequence.
+ */
+static void fann_rand_bind(void)
+{
+    if (fann_rand_libc != NULL)
+        return;
+    /* initstate() records the position of the old state in its first
+       word, so copying it carries the sequence over to our buffer */
+    fann_rand_libc = initstate(1, (char *)fann_rand_state, sizeof(fann_rand_state));
+    setstate(fann_rand_libc);
+    memcpy(fann_rand_state, fann_rand_libc, sizeof(fann_rand_state));
+    setstate((char *)fann_rand_state);
+}
+
+/* INTERNAL FUNCTION
+   Copy the rand() state (FANN_RAND_STATE_WORDS words) to state.
+ */
+void fann_rand_get_state(int32_t * state)
+{
+    fann_rand_bind();
+    /* flushes the current position into the first word */
+    setstate((char *)fann_rand_state);
+    memcpy(state, fann_rand_state, sizeof(fann_rand_state));
+}
+
+/* INTERNAL FUNCTION
+   Restore a rand() state saved by fann_rand_get_state.
+ */
+void fann_rand_set_state(const int32_t * state)
+{
+    fann_rand_bind();
+    /* switch away first, otherwise setstate() overwrites the position */
+    setstate(fann_rand_libc);
+    memcpy(fann_rand_state, state, sizeof(fann_rand_state));
+    setstate((char *)fann_rand_state);
+}
+
 static void fann_seed(void)
 {
+    fann_rand_bind();
     if (FANN_SEED_FIXED) {
         srand(FANN_SEED_FIXED);
     } else {
@@ -219,7 +268,9 @@ FANN_EXTERNAL struct fann *FANN_API fann_create_sparse_vector(
 #ifndef FANN_INFERENCE_ONLY
         layer_it->max_init = NT_0000;
         layer_it->var_init = NT_0000;
-        fann_reset_batch_stats(layer_it);
+#ifdef FANN_PRINT_STATS
+        layer_it->stats = NULL;
+#endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
     }
 
@@ -273,17 +324,31 @@ FANN_EXTERNAL struct fann *FANN_API fann_create_sparse_vector(
 #define fann_seed()
 #endif // FANN_INFERENCE_ONLY
 
-void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
+/* index == NULL runs the dense values of prev_layer, otherwise only the nnz
+   inputs index[k] (ascending) with values value[k] */
+static inline void fann_run_layer_inputs(struct fann_layer *layer_it, struct fann_layer *prev_layer,
+                                         unsigned int nnz, const unsigned int *index,
+                                         const fann_type_ff *value)
 {
 #define DEBUG_RUN
 #undef DEBUG_RUN
 
-    unsigned int n, w, prev_neurons;
+    unsigned int n, prev_neurons;
     fann_type_ff *weights, *prev_values, steepness;
     unsigned int num_neurons;
     struct fann_neuron *neuron_it;
     fann_type_nt neuron_sum, max_sum;// = fann_int_to_bp(0);    
     int softmax = 0;
+#ifdef FANN_MAC_LANES
+    unsigned int k;
+    fann_type_ff *rows[FANN_MAC_LANES];
+    fann_type_ff lane_sum[FANN_MAC_LANES];
+#elif !(defined FANN_FF_DOT)
+    unsigned int k, w;
+#endif
+#ifdef FIXEDFANN
+    unsigned int q_stride = 0;
+#endif
 
 #ifdef DEBUG_RUN
     fprintf(stderr, "### %s @ %s : %d\n", __FUNCTION__, __FILE__, __LINE__);
@@ -297,6 +362,13 @@ void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
         // only in the last layer...
         softmax = 1;
     }
+#ifdef FIXEDFANN
+    if ((index == NULL) && (layer_it->q_weight != NULL)) {
+        // the int16 inputs, once for all neurons
+        q_stride = fann_q16_stride(prev_neurons);
+        fann_q16_values(layer_it->q_value, prev_values, prev_neurons, layer_it->q_value_frac);
+    }
+#endif
         for (n = 0; n < num_neurons; n++) {
             neuron_it = layer_it->neuron + n;
             steepness = neuron_it->steepness;
@@ -307,7 +379,47 @@ void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
 #ifdef DEBUG_RUN
             fprintf(stderr, "  neuron %4u:\n", n);
 #endif
-            for (w = 0; w < prev_neurons; w++) {
+            if (index != NULL) {
+                // zero inputs add nothing to the sum
+#ifdef FANN_FF_DOT
+                neuron_sum = fann_ff_dot_index(weights[prev_neurons], weights, index, value, nnz);
+#else
+                for (k = 0; k < nnz; k++) {
+                    neuron_sum = fann_nt_mac(fann_ff_to_nt(weights[index[k]]), fann_ff_to_nt(value[k]), neuron_sum);
+                }
+#endif
+            }
+#ifdef FANN_MAC_LANES
+            else {
+                // the sums of this neuron and the next ones, computed together
+                if ((n % FANN_MAC_LANES) == 0) {
+                    unsigned int lanes = num_neurons - n;
+
+                    if (lanes > FANN_MAC_LANES) {
+                        lanes = FANN_MAC_LANES;
+                    }
+                    for (k = 0; k < lanes; k++) {
+                        rows[k] = neuron_it[k].weight;
+                        lane_sum[k] = rows[k][prev_neurons]; // BIAS
+                    }
+                    fann_ff_mac_rows(lane_sum, rows, prev_values, lanes, prev_neurons);
+                }
+                neuron_sum = fann_ff_to_nt(lane_sum[n % FANN_MAC_LANES]);
+            }
+#elif defined FANN_FF_DOT
+            else {
+                // BIAS + the whole row, by the back-end
+#ifdef FIXEDFANN
+                if (layer_it->q_weight != NULL) {
+                    neuron_sum = fann_q16_dot(weights[prev_neurons], layer_it->q_weight + n * q_stride,
+                                              layer_it->q_value, q_stride,
+                                              layer_it->q_weight_frac + layer_it->q_value_frac);
+                } else
+#endif
+                neuron_sum = fann_ff_dot(weights[prev_neurons], weights, prev_values, prev_neurons);
+            }
+#else
+            else for (w = 0; w < prev_neurons; w++) {
 #ifdef DEBUG_RUN
                 fprintf(stderr, "    w=%u : %f += %f*%f\n", w,
                        (float)fann_ff_to_float(neuron_sum),
@@ -316,6 +428,7 @@ void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
 #endif
                 neuron_sum = fann_nt_mac(fann_ff_to_nt(weights[w]), fann_ff_to_nt(prev_values[w]), neuron_sum);
             }
+#endif // FANN_MAC_LANES
             //neuron_sum = fann_ff_mac(weights[w], ff_p100, neuron_sum);
 
             neuron_sum = fann_nt_mul(fann_ff_to_nt(steepness), neuron_sum);
@@ -360,6 +473,36 @@ void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
         }
 }
 
+void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer)
+{
+    fann_run_layer_inputs(layer_it, prev_layer, 0, NULL, NULL);
+}
+
+FANN_EXTERNAL fann_type_ff *FANN_API fann_run_sparse(struct fann * ann, unsigned int nnz,
+                                                     const unsigned int * index,
+                                                     const fann_type_ff * value)
+{
+    struct fann_layer *layer_it, *last_layer, *prev_layer;
+
+    fann_set_ff_bias();
+    /* the input layer has no dense values, training uses the sparse input */
+    prev_layer = ann->first_layer;
+    prev_layer->value = NULL;
+    ann->sparse_nnz = nnz;
+    ann->sparse_index = index;
+    ann->sparse_value = value;
+    layer_it = prev_layer + 1;
+    last_layer = ann->last_layer;
+    fann_count_forward(ann, layer_it, nnz);
+    fann_run_layer_inputs(layer_it, prev_layer, nnz, index, value);
+    for (prev_layer = layer_it++; layer_it != last_layer; layer_it++) {
+        fann_count_forward(ann, layer_it, prev_layer->num_neurons);
+        fann_run_layer(layer_it, prev_layer);
+        prev_layer = layer_it;
+    }
+    return (ann->last_layer - 1)->value; // this is the output
+}
+
 FANN_EXTERNAL fann_type_ff *FANN_API fann_run(struct fann * ann, fann_type_ff * input)
 {
     struct fann_layer *layer_it, *last_layer, *prev_layer;
@@ -368,18 +511,84 @@ FANN_EXTERNAL fann_type_ff *FANN_API fann_run(struct fann * ann, fann_type_ff *
     /* first set the input */
     layer_it = ann->first_layer;
     layer_it->value = input;
+    ann->sparse_index = NULL;
     prev_layer = layer_it;
     last_layer = ann->last_layer;
     for (layer_it++; layer_it != last_layer; layer_it++) {
+        fann_count_forward(ann, layer_it, prev_layer->num_neurons);
         fann_run_layer(layer_it, prev_layer);
         prev_layer = layer_it;
     }
     return (ann->last_layer - 1)->value; // this is the output
 }
 
+#ifndef FANN_INFERENCE_ONLY
+FANN_EXTERNAL int FANN_API fann_run_batch(struct fann *ann, unsigned int num,
+                                          fann_type_ff ** input, fann_type_ff * output)
+{
+    struct fann_layer *layer_it, *last_layer, *prev_layer;
+    fann_type_ff *buf, *prev_values, *values, *own, *prev_own = NULL;
+    unsigned int s, num_output, max_values = 0;
+
+    if (num == 0) {
+        return 0;
+    }
+    last_layer = ann->last_layer;
+    num_output = (last_layer - 1)->num_neurons;
+    for (layer_it = ann->first_layer + 1; layer_it != last_layer - 1; layer_it++) {
+        if (max_values < layer_it->num_neurons + 1) {
+            max_values = layer_it->num_neurons + 1;
+        }
+    }
+    // the values of every sample in two layers, the last one in output
+    // (for this call only, not counted as memory of the network)
+    buf = (fann_type_ff *)malloc((2 * max_values * num + 1) * sizeof(fann_type_ff));
+    if (buf == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+
+    fann_set_ff_bias();
+    ann->sparse_index = NULL;
+    prev_values = NULL;
+    values = buf;
+    prev_layer = ann->first_layer;
+    // one layer for all samples, its weights stay in cache
+    for (layer_it = prev_layer + 1; layer_it != last_layer; layer_it++) {
+        unsigned int stride = layer_it->num_neurons + 1;
+
+        own = layer_it->value;
+        if (layer_it == last_layer - 1) {
+            values = output;
+            stride = num_output;
+        }
+        for (s = 0; s < num; s++) {
+            prev_layer->value = (prev_values == NULL) ? input[s] : prev_values + s * (prev_layer->num_neurons + 1);
+            layer_it->value = values + s * stride;
+            fann_count_forward(ann, layer_it, prev_layer->num_neurons);
+            fann_run_layer(layer_it, prev_layer);
+        }
+        if (prev_own != NULL) {
+            prev_layer->value = prev_own;
+        }
+        prev_own = own;
+        prev_values = values;
+        values = (values == buf) ? buf + max_values * num : buf;
+        prev_layer = layer_it;
+    }
+    prev_layer->value = prev_own;
+    ann->first_layer->value = input[num - 1];
+    free(buf);
+    return 0;
+}
+#endif // FANN_INFERENCE_ONLY
+
 FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
 {
     struct fann_layer *layer_it;
+#ifdef FANN_THREADS
+    unsigned int i;
+#endif
     if(ann == NULL)
         return;
     ann->first_layer->value = NULL;
@@ -388,33 +597,51 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
         
         fann_free(layer_it->value);
         fann_free(layer_it->sum_w);
+#ifdef FIXEDFANN
+        fann_free(layer_it->q_weight);
+        fann_free(layer_it->q_value);
+#endif
 #ifndef FANN_INFERENCE_ONLY
         //fann_free(layer_it->train_errors);
 #endif
-        fann_free(layer_it->neuron);
-
         if (layer_it->neuron == NULL)
             continue;
 
         last_neuron = layer_it->neuron + layer_it->num_neurons;
         for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
             //fann_free(neuron_it->prev_layer);
-            fann_free(neuron_it->weight);
+            // copies and attached images leave them to the original or the mapping
+            if (!ann->weights_shared)
+                fann_free(neuron_it->weight);
 #ifndef FANN_INFERENCE_ONLY
             fann_free(neuron_it->weight_slopes);
             fann_free(neuron_it->prev_steps);
             fann_free(neuron_it->prev_slopes);
+#ifdef FANN_QUIRE_DOT
+            fann_free(neuron_it->slope_sums);
+#endif
 #endif
         }
-
+        fann_free(layer_it->neuron);
+    }
+#ifdef FANN_THREADS
+    // the copies of the training threads
+    for (i = 0; i + 1 < ann->num_procs; i++) {
+        fann_destroy(ann->ann[i]);
     }
+#endif
 #ifdef CALCULATE_ERROR
     fann_free(ann->num_max_ok);
 #endif // CALCULATE_ERROR
 #ifndef FANN_INFERENCE_ONLY
     fann_free(ann->unbal_er_adjust);
+    fann_free(ann->data_row);
 #endif
     fann_free(ann->first_layer);
+#ifndef FANN_INFERENCE_ONLY
+    if (ann->shared_map != NULL)
+        munmap(ann->shared_map, ann->shared_len);
+#endif // FANN_INFERENCE_ONLY
     
 #ifdef FANN_DATA_SCALE
     fann_free( ann->scale_mean_in );
@@ -429,11 +656,7 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
     
 #ifndef FANN_INFERENCE_ONLY
 #ifdef FANN_PRINT_STATS
-    fann_free(ann->stats_weigs);
-    fann_free(ann->stats_errors);
-    fann_free(ann->stats_deltas);
-    fann_free(ann->stats_steps);
-    fann_free(ann->stats_slopes);
+    fann_free(ann->stats);
 #endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
 
@@ -441,6 +664,18 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann)
 }
 
 #ifndef FANN_INFERENCE_ONLY
+/* INTERNAL FUNCTION
+   For what changes the weights: an attached image maps them read-only.
+ */
+int fann_check_weights_writable(struct fann *ann)
+{
+    if (ann->weights_shared == FANN_WEIGHTS_MAPPED) {
+        fann_error(FANN_E_WEIGHTS_READ_ONLY);
+        return -1;
+    }
+    return 0;
+}
+
 FANN_EXTERNAL void FANN_API fann_randomize_weights(struct fann *ann,
                                                    fann_type_nt min_weight,
                                                    fann_type_nt max_weight)
@@ -449,6 +684,12 @@ FANN_EXTERNAL void FANN_API fann_randomize_weights(struct fann *ann,
     struct fann_layer * layer_it, * prev_layer;
     fann_type_ff *weights, *last_weight;
 
+    if (fann_check_weights_writable(ann))
+        return;
+#ifdef FIXEDFANN
+    // the int16 copies would no longer match the weights
+    fann_fixed_release(ann);
+#endif
     prev_layer = ann->first_layer;
     for (layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++) {
         layer_it->max_init = max_weight;
@@ -469,12 +710,16 @@ FANN_EXTERNAL void FANN_API fann_randomize_weights(struct fann *ann,
 }
 #endif // FANN_INFERENCE_ONLY
 
-/* deep copy of the fann structure sharing the neurons and read-only buffers */
+/* deep copy of the fann structure sharing the weights: the steepness and
+   the scale and unbalanced error arrays are copied, the copy owns them.
+   The weights stay with orig, which must be destroyed after the copy is
+   no longer run. */
 FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
 {
     struct fann* copy;
     unsigned int num_layers = (unsigned int)(orig->last_layer - orig->first_layer);
     struct fann_layer *orig_layer_it, *copy_layer_it;
+    unsigned int n;
 
     copy = fann_allocate_structure(num_layers);
     if (copy == NULL) {
@@ -485,6 +730,8 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
     copy->num_procs = 0;
     copy->ann[0] = orig;
 #endif
+    // a copy of an attached image can not write the weights either
+    copy->weights_shared = (orig->weights_shared == FANN_WEIGHTS_MAPPED) ? FANN_WEIGHTS_MAPPED : FANN_WEIGHTS_COPY;
 
     copy->num_input = orig->num_input;
     copy->num_output = orig->num_output;
@@ -500,7 +747,6 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
     copy->bit_fail_limit = orig->bit_fail_limit;
 #endif // CALCULATE_ERROR
 #ifndef FANN_INFERENCE_ONLY
-    copy->unbal_er_adjust = orig->unbal_er_adjust;
     copy->learning_rate = orig->learning_rate;
     copy->learning_momentum = orig->learning_momentum;
     copy->training_algorithm = orig->training_algorithm;
@@ -532,11 +778,7 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
  
 #ifndef FANN_INFERENCE_ONLY
 #ifdef FANN_PRINT_STATS
-    copy->stats_weigs = NULL;
-    copy->stats_errors = NULL;
-    copy->stats_deltas = NULL;
-    copy->stats_slopes = NULL;
-    copy->stats_steps = NULL;
+    copy->stats = NULL;
 #endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
 
@@ -551,24 +793,40 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
 #ifndef FANN_INFERENCE_ONLY
         copy_layer_it->max_init = NT_0000;
         copy_layer_it->var_init = NT_0000;
+#ifdef FANN_PRINT_STATS
+        copy_layer_it->stats = NULL;
+#endif // FANN_PRINT_STATS
 #endif
-        //fann_reset_batch_stats(copy_layer_it);
     }
 
 #ifdef FANN_DATA_SCALE
-    /* copy scale parameters, when used */
+    /* copy scale parameters, when used (fann_destroy frees them) */
     if (orig->scale_mean_in != NULL)
     {
-        copy->scale_mean_in = orig->scale_mean_in;
-        copy->scale_deviation_in = orig->scale_deviation_in;
-        copy->scale_new_min_in = orig->scale_new_min_in;
-        copy->scale_factor_in = orig->scale_factor_in;
-        copy->scale_mean_out = orig->scale_mean_out;
-        copy->scale_deviation_out = orig->scale_deviation_out;
-        copy->scale_new_min_out = orig->scale_new_min_out;
-        copy->scale_factor_out = orig->scale_factor_out;
+        if (fann_allocate_scale(copy)) {
+            return NULL;
+        }
+        memcpy(copy->scale_mean_in, orig->scale_mean_in, copy->num_input * sizeof(fann_type_nt));
+        memcpy(copy->scale_deviation_in, orig->scale_deviation_in, copy->num_input * sizeof(fann_type_nt));
+        memcpy(copy->scale_new_min_in, orig->scale_new_min_in, copy->num_input * sizeof(fann_type_nt));
+        memcpy(copy->scale_factor_in, orig->scale_factor_in, copy->num_input * sizeof(fann_type_nt));
+        memcpy(copy->scale_mean_out, orig->scale_mean_out, copy->num_output * sizeof(fann_type_nt));
+        memcpy(copy->scale_deviation_out, orig->scale_deviation_out, copy->num_output * sizeof(fann_type_nt));
+        memcpy(copy->scale_new_min_out, orig->scale_new_min_out, copy->num_output * sizeof(fann_type_nt));
+        memcpy(copy->scale_factor_out, orig->scale_factor_out, copy->num_output * sizeof(fann_type_nt));
     }
 #endif // FANN_DATA_SCALE
+#ifndef FANN_INFERENCE_ONLY
+    if (orig->unbal_er_adjust != NULL) {
+        fann_malloc(copy->unbal_er_adjust, copy->num_output);
+        if (copy->unbal_er_adjust == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            fann_destroy(copy);
+            return NULL;
+        }
+        memcpy(copy->unbal_er_adjust, orig->unbal_er_adjust, copy->num_output * sizeof(fann_type_ff));
+    }
+#endif // FANN_INFERENCE_ONLY
 
 #ifdef CALCULATE_ERROR
     fann_malloc(copy->num_max_ok, copy->num_output);
@@ -583,409 +841,214 @@ FANN_EXTERNAL struct fann* FANN_API fann_copy(struct fann* orig)
         fann_destroy(copy);
         return NULL;
     }
+    for (orig_layer_it = orig->first_layer + 1, copy_layer_it = copy->first_layer + 1;
+            orig_layer_it != orig->last_layer; orig_layer_it++, copy_layer_it++)
+    {
+        for (n = 0; n < orig_layer_it->num_neurons; n++) {
+            copy_layer_it->neuron[n].steepness = orig_layer_it->neuron[n].steepness;
+        }
+    }
     return copy;
 }
 
 #ifndef FANN_INFERENCE_ONLY
 #ifdef FANN_PRINT_STATS
-static int cmp_float(const void *p1, const void *p2)
+static void fann_stat_reset(struct fann_stat *st)
 {
-    float *f1, *f2;
-
-    f1 = (float *)p1;
-    f2 = (float *)p2;
-    
-    if (*f1 < *f2)
-        return -1;
-    if (*f1 > *f2)
-        return 1;
-    return 0;
+    memset(st, 0, sizeof(struct fann_stat));
+    st->min_abs = HUGE_VALF;
 }
 
-#include <stdlib.h>
-static void fann_stats_quart(float * vec,
-                             const unsigned int c,
-                             unsigned int * q1,
-                             unsigned int * q2,
-                             unsigned int * q3)
+void fann_stat_add(struct fann_stat *st, float x)
 {
-    qsort(vec, c, sizeof(*vec), cmp_float);
-    if (q1 == NULL) {
+    union {
+        float f;
+        uint32_t u;
+    } ab;
+
+    ab.f = x;
+    ab.u &= 0x7FFFFFFF;
+    if (ab.u == 0) {
+        st->zero++;
         return;
     }
-    if (c > 5) {
-        *q1 = c / 4;
-        *q2 = c / 2;
-        *q3 = (3 * c) / 4;
-    } else if (c > 2) {
-        *q1 = 0;
-        *q2 = 1;
-        *q3 = 2;
-    } else {
-        *q1 = 0;
-        *q2 = 0;
-        *q3 = 1;
+    st->count++;
+    st->sum += x;
+    st->sum_sq += (double)x * (double)x;
+    if (ab.f < st->min_abs) {
+        st->min_abs = ab.f;
+    }
+    if (ab.f > st->max_abs) {
+        st->max_abs = ab.f;
     }
+    st->bucket[ab.u >> 21]++;
 }
 
-static int fann_batch_stats_disabled = 1;
-#endif // FANN_PRINT_STATS
-
-void fann_reset_batch_stats(struct fann_layer *layer_it)
+#ifdef FANN_THREADS
+/* adds the stats of a thread to dst and resets them */
+static void fann_stat_merge(struct fann_stat *dst, struct fann_stat *src)
 {
-#ifdef FANN_PRINT_STATS
-    // output errors:
-    layer_it->zero_error = layer_it->count_error = 0;
-    layer_it->avg_abs_error = layer_it->max_abs_error = 0.0;
-    layer_it->min_abs_error = 0.0;
-    // weight deltas:
-    layer_it->zero_delta = layer_it->count_delta = 0;
-    layer_it->avg_abs_delta = layer_it->max_abs_delta = 0.0;
-    layer_it->min_abs_delta = 0.0;
-    // adaptive step:
-    layer_it->zero_step = layer_it->count_step = 0;
-    layer_it->avg_abs_step = layer_it->max_abs_step = 0.0;
-    layer_it->min_abs_step = 0.0;
-    // adaptive slope:
-    layer_it->zero_slope = layer_it->count_slope = 0;
-    layer_it->avg_abs_slope = layer_it->max_abs_slope = 0.0;
-    layer_it->min_abs_slope = 0.0;
-#else
-    layer_it = layer_it;
-#endif // FANN_PRINT_STATS
+    unsigned int b;
+
+    dst->zero += src->zero;
+    dst->count += src->count;
+    dst->sum += src->sum;
+    dst->sum_sq += src->sum_sq;
+    if (src->min_abs < dst->min_abs) {
+        dst->min_abs = src->min_abs;
+    }
+    if (src->max_abs > dst->max_abs) {
+        dst->max_abs = src->max_abs;
+    }
+    for (b = 0; b < FANN_STAT_BUCKETS; b++) {
+        dst->bucket[b] += src->bucket[b];
+    }
+    fann_stat_reset(src);
 }
+#endif // FANN_THREADS
 
-void FANN_API fann_enable_batch_stats(void)
+/* |x| below which a fraction q of the non zero values are, the middle of
+   its bucket */
+static float fann_stat_quantile(const struct fann_stat *st, double q)
 {
-#ifdef FANN_PRINT_STATS
-    fann_batch_stats_disabled = 0;
-#endif // FANN_PRINT_STATS
+    union {
+        float f;
+        uint32_t u;
+    } lo, hi;
+    uint64_t acc = 0, rank = (uint64_t)(q * (double)st->count);
+    unsigned int b;
+
+    for (b = 0; b < FANN_STAT_BUCKETS - 1; b++) {
+        acc += st->bucket[b];
+        if (acc > rank) {
+            break;
+        }
+    }
+    lo.u = b << 21;
+    hi.u = (b + 1) << 21;
+    lo.f = 0.5f * (lo.f + hi.f);
+    if (lo.f < st->min_abs) {
+        return st->min_abs;
+    }
+    return (lo.f > st->max_abs) ? st->max_abs : lo.f;
 }
 
-void FANN_API fann_batch_stats(struct fann *ann)
+static void fann_stat_print(int layer, const char *name, const struct fann_stat *st)
 {
-#ifdef FANN_PRINT_STATS
-    unsigned int n, num_w, num_n, w;
-    struct fann_layer *layer_it, *prev_layer;
-    struct fann_neuron *neuron_it;
-    double ab;
+    double avg = 0.0, sd = 0.0;
 
-    if ((fann_batch_stats_disabled) || (ann->stats_weigs == NULL)) {
+    if (st->count == 0) {
+        printf("layer=%02d: %7s: z=%" PRIu64 " nz=0\n", layer, name, st->zero);
         return;
     }
-    prev_layer = ann->first_layer;
-    for (layer_it = prev_layer + 1; layer_it < ann->last_layer; layer_it++) {
-        prev_layer = layer_it;
-        num_w = prev_layer->num_connections;
-        num_n = layer_it->num_neurons;
-        for (n = 0; n < num_n; n++) {
-            neuron_it = layer_it->neuron + n;
-            fann_set_bp_bias(neuron_it->bp_fp16_bias);
-                //if (layer_it->train_errors != NULL) {
-                    ab = fabs(fann_bp_to_float(neuron_it->train_error));
-                if (ab == 0.0) {
-                    layer_it->zero_error++;
-                } else {
-                    if (ab > layer_it->max_abs_error)
-                        layer_it->max_abs_error = ab;
-                    if ((ab < layer_it->min_abs_error) || (layer_it->min_abs_error == 0.0))
-                        layer_it->min_abs_error = ab;
-                    layer_it->count_error++;
-                    layer_it->avg_abs_error += ab;
-                }
-            //}
-            for (w = 0; w < num_w ; w++) {
-                if (neuron_it->prev_steps != NULL) {
-                    ab = fabs(fann_bp_to_float(neuron_it->prev_steps[w]));
-                    if (ab == 0.0) {
-                        layer_it->zero_step++;
-                    } else {
-                        if (ab > layer_it->max_abs_step)
-                            layer_it->max_abs_step = ab;
-                        if ((ab < layer_it->min_abs_step) || (layer_it->min_abs_step == 0.0))
-                            layer_it->min_abs_step = ab;
-                        layer_it->count_step++;
-                        layer_it->avg_abs_step += ab;
-                    }
-                }
-                if (neuron_it->prev_slopes != NULL) {
-                    ab = fabs(fann_bp_to_float(neuron_it->prev_slopes[w]));
-                    if (ab == 0.0) {
-                        layer_it->zero_slope++;
-                    } else {
-                        if (ab > layer_it->max_abs_slope)
-                            layer_it->max_abs_slope = ab;
-                        if ((ab < layer_it->min_abs_slope) || (layer_it->min_abs_slope == 0.0))
-                            layer_it->min_abs_slope = ab;
-                        layer_it->count_slope++;
-                        layer_it->avg_abs_slope += ab;
-                    }
-                }
-                if (neuron_it->weight_slopes != NULL) {
-                    ab = fabs(fann_bp_to_float(neuron_it->weight_slopes[w]));
-                    if (ab == 0.0) {
-                        layer_it->zero_delta++;
-                    } else {
-                        if (ab > layer_it->max_abs_delta)
-                            layer_it->max_abs_delta = ab;
-                        if ((ab < layer_it->min_abs_delta) || (layer_it->min_abs_delta == 0.0))
-                            layer_it->min_abs_delta = ab;
-                        layer_it->count_delta++;
-                        layer_it->avg_abs_delta += ab;
-                    }
-                }
-            } 
+    avg = st->sum / (double)st->count;
+    if (st->count > 1) {
+        sd = sqrt(fmax(0.0, (st->sum_sq - st->sum * avg) / (double)(st->count - 1)));
+    }
+    printf("layer=%02d: %7s: z=%" PRIu64 " nz=%" PRIu64 " av=%+e sd=%e abs: min=%e q1=%e q2=%e q3=%e p99=%e max=%e\n",
+           layer, name, st->zero, st->count, avg, sd, st->min_abs,
+           fann_stat_quantile(st, 0.25), fann_stat_quantile(st, 0.5), fann_stat_quantile(st, 0.75),
+           fann_stat_quantile(st, 0.99), st->max_abs);
+}
+
+static const char * const fann_stat_names[FANN_STAT_KINDS] = {
+    "Weights",
+    "Errors",
+    "Deltas",
+    "Steps",
+    "Slopes",
+};
+#endif // FANN_PRINT_STATS
+
+void fann_reset_batch_stats(struct fann_layer *layer_it)
+{
+#ifdef FANN_PRINT_STATS
+    unsigned int k;
+
+    if (layer_it->stats != NULL) {
+        for (k = 0; k < FANN_STAT_KINDS; k++) {
+            fann_stat_reset(layer_it->stats + k);
         }
-    } 
+    }
 #else
-    ann = ann;
+    layer_it = layer_it;
 #endif // FANN_PRINT_STATS
 }
 
+/* Prints, for each layer, the weights and the errors, deltas, steps and
+   slopes seen by the update kernels since the previous call. The first
+   call only allocates the statistics, a block per training thread (added
+   to by the update of the neurons it takes) summed here. */
 FANN_EXTERNAL void FANN_API fann_print_stats(struct fann *ann)
 {
 #ifdef FANN_PRINT_STATS
     int layer;
     struct fann_layer *layer_it, *prev_layer;
     struct fann_neuron *neuron_it;
-    unsigned int weig_c, n, num_w, num_n, w;
-    unsigned int weig_q1, weig_q2, weig_q3;
-    unsigned int err_q1, err_q2, err_q3;
-    float min_abs_weigs, min_abs_error, min_abs_delta, ab;
-    float min_abs_slope, min_abs_step;
-    unsigned int zero_weigs, zero_error, zero_delta;
-    unsigned int zero_slope, zero_step, incw;
-    //unsigned int frozen_l = 0, frozen_n = 0;
-    float * weigs, * errors, * deltas, * slopes, * steps;
-    float max_bias_w, max_bias_d, max_bias_sl, max_bias_st;
-    double avg_weigs, avg_error, avg_delta;
-    double avg_slope, avg_step, sd_weigs;
-
-    if (ann->stats_weigs == NULL) {
-        unsigned int max_weigs = 0;
-        unsigned int max_neurs = 0;
-
-        prev_layer = ann->first_layer;
-        for (layer_it = ann->first_layer + 1; layer_it < ann->last_layer; layer_it++) {
-            if (max_neurs < layer_it->num_neurons) {
-                max_neurs = layer_it->num_neurons;
-            }
-            w = layer_it->num_neurons * prev_layer->num_connections;
-            if (max_weigs < w) {
-                max_weigs = w;
-            }
-            prev_layer = layer_it;
+    struct fann_stat *weigs;
+    unsigned int n, num_w, num_n, w, k;
+    unsigned int num_layers = (unsigned int)(ann->last_layer - ann->first_layer);
+#ifdef FANN_THREADS
+    unsigned int p;
+#endif
+
+    if (ann->stats == NULL) {
+        unsigned int num_blocks = 1;
+
+#ifdef FANN_THREADS
+        if (ann->num_procs > 1) {
+            num_blocks = ann->num_procs;
         }
-        fann_calloc(ann->stats_weigs, max_weigs);
-        fann_calloc(ann->stats_errors, max_neurs);
-        fann_calloc(ann->stats_deltas, max_weigs);
-        //if (prev_layer->first_neuron->prev_steps != NULL)
-            fann_calloc(ann->stats_steps, max_weigs);
-        //if (prev_layer->first_neuron->prev_slopes != NULL)
-            fann_calloc(ann->stats_slopes, max_weigs);
-        if ((ann->stats_weigs == NULL) || (ann->stats_errors == NULL) ||
-            (ann->stats_deltas == NULL) || (ann->stats_steps == NULL) ||
-            (ann->stats_slopes == NULL)) {
-            fann_free(ann->stats_weigs);
-            fann_free(ann->stats_errors);
-            fann_free(ann->stats_deltas);
-            fann_free(ann->stats_steps);
-            fann_free(ann->stats_slopes);
+#endif
+        fann_calloc(ann->stats, num_blocks * num_layers * FANN_STAT_KINDS);
+        if (ann->stats == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
             return;
         }
+        for (layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++) {
+            layer_it->stats = ann->stats + (layer_it - ann->first_layer) * FANN_STAT_KINDS;
+            fann_reset_batch_stats(layer_it);
+        }
+#ifdef FANN_THREADS
+        for (p = 0; p + 1 < ann->num_procs; p++) {
+            struct fann *ann_p = ann->ann[p];
+
+            for (layer_it = ann_p->first_layer + 1; layer_it != ann_p->last_layer; layer_it++) {
+                layer_it->stats = ann->stats + ((p + 1) * num_layers + (layer_it - ann_p->first_layer)) * FANN_STAT_KINDS;
+                fann_reset_batch_stats(layer_it);
+            }
+        }
+#endif
     }
-    weigs = ann->stats_weigs;
-    errors = ann->stats_errors;
-    deltas = ann->stats_deltas;
-    slopes = ann->stats_slopes;
-    steps = ann->stats_steps;
 
     prev_layer = ann->first_layer;
     for (layer_it = ann->first_layer + 1; layer_it != ann->last_layer; layer_it++) {
         layer = (int)(layer_it - ann->first_layer);
-        incw = weig_c = 0;
-        sd_weigs = 0.0;
-        fann_set_ff_bias();
-        avg_weigs = fann_ff_to_float(layer_it->neuron[0].weight[0]);
-        zero_weigs = zero_error = zero_delta = zero_slope = zero_step = 0;
-        min_abs_slope = min_abs_step = min_abs_error = min_abs_weigs = min_abs_delta = HUGE_VALF;
-        avg_slope = avg_step = max_bias_st = max_bias_sl = 0.0;
-        max_bias_d = max_bias_w = avg_error = avg_delta = 0.0;
+#ifdef FANN_THREADS
+        for (p = 0; p + 1 < ann->num_procs; p++) {
+            struct fann_stat *stats_p = ann->ann[p]->first_layer[layer].stats;
+
+            for (k = FANN_STAT_ERROR; k < FANN_STAT_KINDS; k++) {
+                fann_stat_merge(layer_it->stats + k, stats_p + k);
+            }
+        }
+#endif
+        weigs = layer_it->stats + FANN_STAT_WEIGHT;
         num_w = prev_layer->num_connections;
         num_n = layer_it->num_neurons;
+        fann_set_ff_bias();
         for (n = 0; n < num_n; n++) {
             neuron_it = layer_it->neuron + n;
-            fann_set_bp_bias(neuron_it->bp_fp16_bias);
-            if (ann->training_algorithm == FANN_TRAIN_INCREMENTAL) {
-                //if (layer_it->train_errors != NULL) {
-                    //errors[n] = fann_bp_to_float(layer_it->train_errors[n]);
-                    errors[n] = fann_bp_to_float(neuron_it->train_error);
-                    avg_error += (double)errors[n];
-                    ab = fabsf(errors[n]);
-                    if (ab == 0.0) {
-                        zero_error++;
-                    } else if (ab < min_abs_error) {
-                        min_abs_error = ab;
-                    }
-                /*} else {
-                    errors[n] = 0.0;
-                }*/
-            }
             for (w = 0; w < num_w ; w++) {
-                fann_set_ff_bias();
-                weigs[weig_c] = fann_ff_to_float(neuron_it->weight[w]);
-                ++incw;
-                if (incw > 1) {
-                    double tmp = avg_weigs + ((weigs[weig_c] - avg_weigs) / (double)incw);
-                    sd_weigs += (weigs[weig_c] - avg_weigs) * (weigs[weig_c] - tmp);
-                    avg_weigs = tmp;
-                }
-                ab = fabsf(weigs[weig_c]);
-                if (ab == 0.0) {
-                    zero_weigs++;
-                } else if (ab < min_abs_weigs) {
-                    min_abs_weigs = ab;
-                }
-                fann_set_bp_bias(neuron_it->bp_fp16_bias);
-                if (neuron_it->prev_steps != NULL) {
-                    steps[weig_c] = fann_bp_to_float(neuron_it->prev_steps[w]);
-                    avg_step += (double)steps[weig_c];
-                    ab = fabs(steps[weig_c]);
-                    if (ab == 0.0) {
-                        zero_step++;
-                    } else if (ab < min_abs_step) {
-                        min_abs_step = ab;
-                    }
-                }
-                if (neuron_it->prev_slopes != NULL) {
-                    slopes[weig_c] = fann_bp_to_float(neuron_it->prev_slopes[w]);
-                    avg_slope += (double)slopes[weig_c];
-                    ab = fabs(slopes[weig_c]);
-                    if (ab == 0.0) {
-                        zero_slope++;
-                    } else if (ab < min_abs_slope) {
-                        min_abs_slope = ab;
-                    }
-                }
-                if (neuron_it->weight_slopes != NULL) {
-                    deltas[weig_c] = fann_bp_to_float(neuron_it->weight_slopes[w]);
-                    avg_delta += (double)deltas[weig_c];
-                    ab = fabs(deltas[weig_c]);
-                    if (ab == 0.0) {
-                        /*if ((layer > 1) && (w < (num_w - 1))) {
-                            printf("zero delta: prev[%u] _sum=%+le _val=%+le | this[%u] _sum=%+le _val=%+le\n",
-                                   w, fann_ff_to_float(prev_layer->sum_w[w]),
-                                   fann_ff_to_float(prev_layer->value[w]),
-                                   n, fann_ff_to_float(layer_it->sum_w[n]),
-                                   fann_ff_to_float(layer_it->value[n]));
-                        }*/
-                        zero_delta++;
-                    } else if (ab < min_abs_delta) {
-                        min_abs_delta = ab;
-                    }
-                } else {
-                    //printf("forward stats only\n");
-                    deltas[weig_c] = 0.0;
-                }
-                weig_c++;
+                fann_stat_add(weigs, fann_ff_to_float(neuron_it->weight[w]));
             }
-            w = weig_c - 1;
-            if (fabsf(weigs[w]) > max_bias_w)
-                max_bias_w = fabsf(weigs[w]);
-            if (fabsf(deltas[w]) > max_bias_d)
-                max_bias_d = fabsf(deltas[w]);
-            if ((steps != NULL) && (fabsf(steps[w]) > max_bias_st))
-                max_bias_st = fabsf(steps[w]);
-            if ((slopes != NULL) && (fabsf(slopes[w]) > max_bias_sl))
-                max_bias_sl = fabsf(slopes[w]);
-        }
-        if (ann->training_algorithm == FANN_TRAIN_INCREMENTAL) {
-            avg_error /= (float)num_n;
-            fann_stats_quart(errors, num_n, &err_q1, &err_q2, &err_q3);
-        } else {
-            err_q1 = err_q2 = err_q3 = 0;
-        }
-        //avg_weigs /= (float)weig_c;
-        sd_weigs = sqrt(sd_weigs/(double)(incw-1));
-        fann_stats_quart(weigs, weig_c, &weig_q1, &weig_q2, &weig_q3);
-        avg_delta /= (float)weig_c;
-        fann_stats_quart(deltas, weig_c, NULL, NULL, NULL);
-        if (slopes != NULL) {
-            avg_slope /= (float)weig_c;
-            fann_stats_quart(slopes, weig_c, NULL, NULL, NULL);
         }
-        if (steps != NULL) {
-            avg_step /= (float)weig_c;
-            fann_stats_quart(steps, weig_c, NULL, NULL, NULL);
-        }
-
-        printf("layer=%02d: Weights: bias=%+e min=%e av=%+e %+e %+e %+e %+e %+e z=%u sd=%e\n",
-                layer, max_bias_w, min_abs_weigs, avg_weigs,
-                weigs[0], weigs[weig_q1], weigs[weig_q2],
-                weigs[weig_q3], weigs[weig_c-1], zero_weigs, sd_weigs);
-        if (ann->training_algorithm == FANN_TRAIN_INCREMENTAL) {
-            if (min_abs_error != HUGE_VALF) {
-                printf("layer=%02d:  Errors:                    min=%e av=%+e %+e %+e %+e %+e %+e %u\n",
-                        layer, min_abs_error,
-                        avg_error, errors[0], errors[err_q1], errors[err_q2],
-                        errors[err_q3], errors[num_n-1], zero_error);
-            } else {
-                printf("layer=%02d:  Errors: bias=0.0 min=0.0 av=0.0 0.0 0.0 0.0 0.0 0.0 %u\n", layer, zero_error);
+        for (k = 0; k < FANN_STAT_KINDS; k++) {
+            if ((k == FANN_STAT_WEIGHT) || (layer_it->stats[k].zero != 0) || (layer_it->stats[k].count != 0)) {
+                fann_stat_print(layer, fann_stat_names[k], layer_it->stats + k);
             }
         }
-        if (min_abs_delta != HUGE_VALF) {
-            printf("layer=%02d:  Deltas: bias=%+e min=%e av=%+e %+e %+e %+e %+e %+e %u\n",
-                    layer, max_bias_d, min_abs_delta,
-                    avg_delta, deltas[0], deltas[weig_q1], deltas[weig_q2],
-                    deltas[weig_q3], deltas[weig_c-1], zero_delta);
-        } else if (deltas != NULL) {
-            printf("layer=%02d:  Deltas: bias=0.0 min=0.0 av=0.0 0.0 0.0 0.0 0.0 0.0 %u\n", layer, zero_delta);
-        }
-        if (min_abs_step != HUGE_VALF) {
-            printf("layer=%02d:   Steps: bias=%+e min=%e av=%+e %+e %+e %+e %+e %+e %u\n",
-                    layer, max_bias_st, min_abs_step,
-                    avg_step, steps[0], steps[weig_q1], steps[weig_q2],
-                    steps[weig_q3], steps[weig_c-1], zero_step);
-        } else if (steps != NULL) {
-            printf("layer=%02d:   Steps: bias=0.0 min=0.0 av=0.0 0.0 0.0 0.0 0.0 0.0 %u\n", layer, zero_step);
-        }
-        if (min_abs_slope != HUGE_VALF) {
-            printf("layer=%02d:  Slopes: bias=%+e min=%e av=%+e %+e %+e %+e %+e %+e %u\n",
-                    layer, max_bias_sl, min_abs_slope,
-                    avg_slope, slopes[0], slopes[weig_q1], slopes[weig_q2],
-                    slopes[weig_q3], slopes[weig_c-1], zero_slope);
-        } else if (slopes != NULL) {
-            printf("layer=%02d:  Slopes: bias=0.0 min=0.0 av=0.0 0.0 0.0 0.0 0.0 0.0 %u\n", layer, zero_slope);
-        }
-        //printf("layer=%02d: MIN/MAX abs sum: %+e %+e\n", layer, fann_ff_to_float(layer_it->min_abs_sum),
-        //        fann_ff_to_float(layer_it->max_abs_sum));
-        if ((layer_it->zero_error != 0) || (layer_it->count_error != 0)) {
-            printf("layer=%02d:  ERROR(z nz): %u %u ", layer, layer_it->zero_error, layer_it->count_error);
-            if (layer_it->count_error == 0)
-                printf("0.0 ");
-            else
-                printf("%+e ", layer_it->avg_abs_error / (double)layer_it->count_error);
-            printf("%+e %+e\n", layer_it->min_abs_error, layer_it->max_abs_error);
-            printf("layer=%02d:  DELTA(z nz): %u %u ", layer, layer_it->zero_delta, layer_it->count_delta);
-            if (layer_it->count_delta == 0)
-                printf("0.0 ");
-            else
-                printf("%+e ", layer_it->avg_abs_delta / (double)layer_it->count_delta);
-            printf("%+e %+e\n", layer_it->min_abs_delta, layer_it->max_abs_delta);
-            printf("layer=%02d:  SLOPE(z nz): %u %u ", layer, layer_it->zero_slope, layer_it->count_slope);
-            if (layer_it->count_slope == 0)
-                printf("0.0 ");
-            else
-                printf("%+e ", layer_it->avg_abs_slope / (double)layer_it->count_slope);
-            printf("%+e %+e\n", layer_it->min_abs_slope, layer_it->max_abs_slope);
-            printf("layer=%02d:   STEP(z nz): %u %u ", layer, layer_it->zero_step, layer_it->count_step);
-            if (layer_it->count_step == 0)
-                printf("0.0 ");
-            else
-                printf("%+e ", layer_it->avg_abs_step / (double)layer_it->count_step);
-            printf("%+e %+e\n", layer_it->min_abs_step, layer_it->max_abs_step);
-            fann_reset_batch_stats(layer_it);
-        }
+        fann_reset_batch_stats(layer_it);
         prev_layer = layer_it;
     }
 #else
@@ -1000,6 +1063,11 @@ FANN_EXTERNAL void FANN_API fann_init_weights(struct fann *ann)//, struct fann_d
     struct fann_neuron *neuron_it;
     fann_type_nt min;
 
+    if (fann_check_weights_writable(ann))
+        return;
+#ifdef FIXEDFANN
+    fann_fixed_release(ann);
+#endif
     prev_layer = ann->first_layer;
     last_layer = ann->last_layer;// - 1; // only the hidden ones
     for (layer_it = ann->first_layer + 1; layer_it != last_layer; ) {
@@ -1152,6 +1220,8 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
     pthread_cond_init(&(ann->cond), NULL);
     ann->wait_procs = 0;
     ann->num_procs = 0;
+    ann->cpu = -1;
+    memset(&(ann->times), 0, sizeof(struct fann_thread_times));
 #endif
     ann->num_input = 0;
     ann->num_output = 0;
@@ -1182,15 +1252,26 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
     FP_BIAS = FP_BIAS_DEFAULT;
 #endif
 
+    ann->sparse_index = NULL;
+    ann->sparse_value = NULL;
+    ann->sparse_nnz = 0;
+    ann->weights_shared = 0;
+
 #ifndef FANN_INFERENCE_ONLY
     ann->data_input = NULL;
     ann->data_output = NULL;
     ann->data_batch = 0;
+    ann->data_input_codec = NULL;
+    ann->data_output_codec = NULL;
+    ann->data_row = NULL;
     ann->unbal_er_adjust = NULL;
+    ann->shared_map = NULL;
+    ann->shared_len = 0;
     ann->learning_rate = fann_float_to_ff(0.7f);
     ann->learning_momentum = fann_int_to_ff(0);
     ann->training_algorithm = FANN_TRAIN_RPROP;
     ann->mini_batch = 0;
+    ann->mini_batch_ratio = 1e3;
     //ann->train_loss_function = FANN_LOSSFUNC_MSE;
     //ann->train_error_function = FANN_ERRORFUNC_INV_TANH;
     //ann->train_error_function = FANN_ERRORFUNC_LINEAR;
@@ -1218,6 +1299,7 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
     ann->sarprop_step_error_shift = fann_float_to_ff(1.385f);
     ann->sarprop_temperature = fann_float_to_ff(0.015f);*/
     ann->train_epoch = 0;
+    ann->resume_epoch = 0;
 #endif // FANN_INFERENCE_ONLY
  
     //fann_init_error_data((struct fann_error *) ann);
@@ -1225,11 +1307,7 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
     /* allocated only if fann_print_stats is called */
 #ifndef FANN_INFERENCE_ONLY
 #ifdef FANN_PRINT_STATS
-    ann->stats_weigs = NULL;
-    ann->stats_errors = NULL;
-    ann->stats_deltas = NULL;
-    ann->stats_slopes = NULL;
-    ann->stats_steps = NULL;
+    ann->stats = NULL;
 #endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
 
@@ -1244,7 +1322,7 @@ struct fann *fann_allocate_structure(unsigned int num_layers)
     }
     ann->last_layer = ann->first_layer + num_layers;
 #if (defined SWF16_AP) || (defined HWF16)
-    ann->change_bias = 1;
+    ann->change_bias = FANN_BP_BIAS_NEURON;
 #endif // (defined SWF16_AP) || (defined HWF16)
     return ann;
 }
@@ -1282,7 +1360,8 @@ int fann_allocate_scale(struct fann *ann)
 #endif // FANN_DATA_SCALE
 
 /* INTERNAL FUNCTION
-   Allocates room for the neurons.
+   Allocates room for the neurons, with the weights of orig (shared) if
+   given. If orig is ann, the weights are left NULL for the caller.
  */
 int fann_allocate_neurons(struct fann *ann, struct fann *orig)
 {
@@ -1296,12 +1375,20 @@ int fann_allocate_neurons(struct fann *ann, struct fann *orig)
     layer_it->neuron = NULL;
     layer_it->sum_w = NULL;
     layer_it->value = NULL;
+#ifdef FIXEDFANN
+    layer_it->q_weight = NULL;
+    layer_it->q_value = NULL;
+#endif
 #ifndef FANN_INFERENCE_ONLY
     //layer_it->train_errors = NULL;
 #endif
     //printf("%p %p\n", layer_it, layer_it->value);
     prev_layer = layer_it;
     for (++layer_it, l = 1; layer_it != ann->last_layer; l++, layer_it++) {
+#ifdef FIXEDFANN
+        layer_it->q_weight = NULL;
+        layer_it->q_value = NULL;
+#endif
         fann_calloc(layer_it->value, layer_it->num_connections); // FIXME num_neurons
         if (layer_it->value == NULL) {
             fann_error(FANN_E_CANT_ALLOCATE_MEM);
@@ -1349,6 +1436,9 @@ int fann_allocate_neurons(struct fann *ann, struct fann *orig)
             neuron->weight_slopes = NULL;
             neuron->prev_steps = NULL;
             neuron->prev_slopes = NULL;
+#ifdef FANN_QUIRE_DOT
+            neuron->slope_sums = NULL;
+#endif
 #endif
         }
 #ifndef FANN_INFERENCE_ONLY
@@ -1498,5 +1588,46 @@ error:
     return delta;
 }
 
+#ifdef FANN_THREADS
+FANN_EXTERNAL int FANN_API fann_set_thread_cpus(struct fann *ann, const int *cpus, unsigned int num_cpus)
+{
+    unsigned int p;
+
+#ifndef CPU_SET
+    if (num_cpus > 0) {
+        return -1;
+    }
+#endif
+    if (num_cpus + 1 > ann->num_procs) {
+        return -1;
+    }
+    for (p = 0; p + 1 < ann->num_procs; p++) {
+        ann->ann[p]->cpu = (p < num_cpus) ? cpus[p] : -1;
+    }
+    return 0;
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_get_thread_times(struct fann *ann, struct fann_thread_times *times)
+{
+    unsigned int p;
+
+    times[0] = ann->times;
+    for (p = 0; p + 1 < ann->num_procs; p++) {
+        times[p + 1] = ann->ann[p]->times;
+    }
+    return ann->num_procs;
+}
+
+FANN_EXTERNAL void FANN_API fann_clear_thread_times(struct fann *ann)
+{
+    unsigned int p;
+
+    memset(&(ann->times), 0, sizeof(struct fann_thread_times));
+    for (p = 0; p + 1 < ann->num_procs; p++) {
+        memset(&(ann->ann[p]->times), 0, sizeof(struct fann_thread_times));
+    }
+}
+#endif // FANN_THREADS
+
 #endif // FANN_INFERENCE_ONLY
 
@@ -119,6 +119,12 @@ extern const char * fann_float_type;
 #include "fann_mem.h"
 #include "fann_activation.h"
 #include "fann_const.h"
+#include "fann_conv.h"
+#include "fann_count.h"
+#include "fann_prof.h"
+#include "fann_metrics.h"
+#include "fann_trace.h"
+#include "fann_model.h"
 
 #ifndef FANN_INFERENCE_ONLY
 /* Function: fann_create_standard
@@ -198,6 +204,10 @@ FANN_EXTERNAL void FANN_API fann_destroy(struct fann *ann);
 
 /* Function: fann_copy
    Creates a copy of a fann structure. 
+
+   The copy shares the weights of ann, which must outlive it and frees them (<fann_destroy>
+   of the copy leaves them); the steepness and the scaling parameters are copied, so both
+   run the same.
    
    Data in the user data <fann_set_user_data> is not copied, but the user data pointer is copied.
 
@@ -217,6 +227,38 @@ FANN_EXTERNAL struct fann * FANN_API fann_copy(struct fann *ann);
 */ 
 FANN_EXTERNAL fann_type_ff * FANN_API fann_run(struct fann *ann, fann_type_ff * input);
 
+/* Function: fann_run_sparse
+    Same as <fann_run>, for a sparse input: only the *nnz* inputs index[0..nnz-1] are
+    nonzero, with values value[0..nnz-1]. The indexes must be ascending and lower than
+    the number of inputs. The first layer only accumulates the weights of these inputs,
+    so its cost scales with *nnz* and not with the number of inputs.
+
+    index and value must remain valid until the training step of this input is done.
+
+    See also:
+        <fann_run>, <fann_encode_data>
+*/
+FANN_EXTERNAL fann_type_ff * FANN_API fann_run_sparse(struct fann *ann, unsigned int nnz,
+                                                      const unsigned int * index,
+                                                      const fann_type_ff * value);
+
+#ifndef FANN_INFERENCE_ONLY
+/* Function: fann_run_batch
+    Same as <fann_run> for *num* inputs, writing the outputs of input[i] to
+    output[i * num_output ... (i + 1) * num_output - 1]. Each layer is run for all the
+    inputs before the next one, so its weights are loaded from memory once per batch
+    and not once per input. The results are the same as those of <fann_run>.
+
+    Returns:
+    0, or -1 if the values of the batch can not be allocated.
+
+    See also:
+        <fann_run>
+*/
+FANN_EXTERNAL int FANN_API fann_run_batch(struct fann *ann, unsigned int num,
+                                          fann_type_ff ** input, fann_type_ff * output);
+#endif // FANN_INFERENCE_ONLY
+
 /* Function: fann_randomize_weights
     Give each connection a random weight between *min_weight* and *max_weight*
    
@@ -448,14 +490,34 @@ FANN_EXTERNAL void FANN_API fann_enable_seed_fixed(const unsigned int non_zero);
 */
 FANN_EXTERNAL void FANN_API fann_enable_seed_rand(void);
 
+/* values of ann->change_bias (AP formats) */
+#define FANN_BP_BIAS_FIXED  0
+#define FANN_BP_BIAS_NEURON 1
+#define FANN_BP_BIAS_LAYER  2
+
 #if (defined SWF16_AP) || (defined HWF16)
 FANN_EXTERNAL void FANN_API fann_initialize_bp_bias(struct fann *ann, int bias);
 FANN_EXTERNAL void FANN_API fann_set_fixed_bp_bias(struct fann *ann);
 FANN_EXTERNAL void FANN_API fann_set_dynamic_bp_bias(struct fann *ann);
+
+/* Function: fann_set_layer_bp_bias
+
+   Block floating point: the bp exponent bias is shared by all the neurons of
+   a layer, starting from the smallest bias of its neurons. Like
+   <fann_set_dynamic_bp_bias>, it goes down after a mini-batch with
+   overflows and up after an epoch without them, counting the overflows of
+   the whole layer.
+
+   Backpropagation then converts each train error once per neuron instead
+   of once per weight, and the batch slopes convert the inputs of a layer
+   once for all its neurons.
+ */
+FANN_EXTERNAL void FANN_API fann_set_layer_bp_bias(struct fann *ann);
 #else
 #define fann_initialize_bp_bias(ann, b)
 #define fann_set_fixed_bp_bias(ann)
 #define fann_set_dynamic_bp_bias(ann)
+#define fann_set_layer_bp_bias(ann)
 #endif
 
 #define fann_set_mini_batch(s, a) {s->mini_batch = a;}
@@ -463,6 +525,38 @@ FANN_EXTERNAL void FANN_API fann_set_dynamic_bp_bias(struct fann *ann);
 //#define fann_set_train_error_function(s, a) {s->train_error_function = a;}
 #define fann_set_callback(s, a) {s->callback = a;}
 
+#ifdef FANN_THREADS
+/* Function: fann_set_thread_cpus
+
+   Pins the extra threads of *ann* when they are created (for each batch of
+   training or <fann_test_data>): thread i to CPU cpus[i], -1 leaves it
+   free. The calling thread is the first one and is not pinned here.
+
+   Returns:
+   0, or -1 if *num_cpus* is larger than the number of extra threads or
+   the library was built without CPU affinity (_GNU_SOURCE).
+ */
+FANN_EXTERNAL int FANN_API fann_set_thread_cpus(struct fann *ann, const int *cpus, unsigned int num_cpus);
+
+/* Function: fann_get_thread_times
+
+   Copies to *times* where the time of each thread of *ann* went since it
+   was created or <fann_clear_thread_times>: times[0] is the calling
+   thread, times[i] the extra thread i-1. The time of the update after the
+   barrier includes the sum of the slopes of all threads (the reduction).
+
+   Returns:
+   The number of threads, and of entries written.
+ */
+FANN_EXTERNAL unsigned int FANN_API fann_get_thread_times(struct fann *ann, struct fann_thread_times *times);
+
+/* Function: fann_clear_thread_times
+
+   Zeroes the times of all threads of *ann*.
+ */
+FANN_EXTERNAL void FANN_API fann_clear_thread_times(struct fann *ann);
+#endif // FANN_THREADS
+
 #include <stdint.h>
 enum count_time_type {
     COUNT_CPU_TIME,
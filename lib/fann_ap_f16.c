@@ -976,3 +976,247 @@ uint_fast8_t softfloat_countLeadingZeros16( uint16_t a )
 }
 */
 
+
+#ifdef FANN_F16_FAST
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+
+// 2^s in each 32-bit lane, 0 <= s <= 31 (2^31 converts to 0x80000000)
+static inline __m128i f16_pow2_x4( __m128i s )
+{
+    return _mm_cvttps_epi32( _mm_castsi128_ps(
+                _mm_slli_epi32( _mm_add_epi32( s, _mm_set1_epi32( 127 ) ), 23 ) ) );
+}
+
+// floor(log2(v)) of 0 < v < 2^24, -127 for v == 0
+static inline __m128i f16_ilogb_x4( __m128i v )
+{
+    return _mm_sub_epi32( _mm_srli_epi32( _mm_castps_si128( _mm_cvtepi32_ps( v ) ), 23 ),
+                          _mm_set1_epi32( 127 ) );
+}
+
+// index of the most significant bit of unsigned v, -1 for v == 0 (31 - clz32)
+static inline __m128i f16_msb32_x4( __m128i v )
+{
+    __m128i hi = _mm_add_epi32( f16_ilogb_x4( _mm_srli_epi32( v, 16 ) ), _mm_set1_epi32( 16 ) );
+    __m128i lo = f16_ilogb_x4( _mm_and_si128( v, _mm_set1_epi32( 0xFFFF ) ) );
+    return _mm_max_epi32( _mm_max_epi32( hi, lo ), _mm_set1_epi32( -1 ) );
+}
+
+// unsigned v >> d, 0 <= d <= 31, as the high half of v * 2^(32 - d)
+static inline __m128i f16_srlv_x4( __m128i v, __m128i d )
+{
+    __m128i m = f16_pow2_x4( _mm_sub_epi32( _mm_set1_epi32( 32 ), d ) );
+    __m128i even = _mm_srli_epi64( _mm_mul_epu32( v, m ), 32 );
+    __m128i odd = _mm_mul_epu32( _mm_srli_epi64( v, 32 ), _mm_srli_epi64( m, 32 ) );
+    return _mm_blendv_epi8( _mm_blend_epi16( even, odd, 0xCC ), v,
+                            _mm_cmpeq_epi32( d, _mm_setzero_si128() ) );
+}
+
+/* f16_mulAdd() of 4 lanes (16-bit values in 32-bit lanes), the same steps
+ * done for every lane and the results selected by masks. The counters are
+ * accumulated (as negative counts) only for the lanes set in valid. */
+static inline __m128i f16_mulAdd_x4( __m128i a, __m128i b, __m128i c, __m128i bias, __m128i valid,
+                                     __m128i *cancel, __m128i *under, __m128i *over )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m1F = _mm_set1_epi32( 0x1F );
+    const __m128i m3FF = _mm_set1_epi32( 0x3FF );
+    const __m128i m400 = _mm_set1_epi32( 0x400 );
+    const __m128i m7FFF = _mm_set1_epi32( 0x7FFF );
+    const __m128i m8000 = _mm_set1_epi32( 0x8000 );
+    __m128i expA, expB, expC, sigA, sigB, sigC, signProd, signC, expProd, sigProd;
+    __m128i zeroAB, zeroC, expDiff, shiftDist, dist, domC, sigZ, sigS, expZ, signZ;
+    __m128i same, prodGt, cancelProd, cancelC, exact0, roundBits, smallest, largest, ret;
+
+    expA = _mm_and_si128( _mm_srli_epi32( a, 10 ), m1F );
+    expB = _mm_and_si128( _mm_srli_epi32( b, 10 ), m1F );
+    expC = _mm_and_si128( _mm_srli_epi32( c, 10 ), m1F );
+    sigA = _mm_or_si128( _mm_and_si128( a, m3FF ), m400 );
+    sigB = _mm_or_si128( _mm_and_si128( b, m3FF ), m400 );
+    sigC = _mm_slli_epi32( _mm_or_si128( _mm_and_si128( c, m3FF ), m400 ), 10 );
+    signProd = _mm_and_si128( _mm_xor_si128( a, b ), m8000 );
+    signC = _mm_and_si128( c, m8000 );
+    zeroAB = _mm_or_si128( _mm_cmpeq_epi32( _mm_and_si128( a, m7FFF ), zero ),
+                           _mm_cmpeq_epi32( _mm_and_si128( b, m7FFF ), zero ) );
+    zeroC = _mm_cmpeq_epi32( _mm_and_si128( c, m7FFF ), zero );
+    expProd = _mm_sub_epi32( _mm_add_epi32( expA, expB ), bias );
+    sigProd = _mm_mullo_epi32( sigA, sigB );
+    expDiff = _mm_sub_epi32( expProd, expC );
+
+    // both normalized by the larger one, the other one shifted right (truncated),
+    // no normalization for equal exponents
+    shiftDist = _mm_sub_epi32( _mm_set1_epi32( 30 ), f16_ilogb_x4( _mm_max_epi32( sigProd, sigC ) ) );
+    shiftDist = _mm_andnot_si128( _mm_cmpeq_epi32( expDiff, zero ), shiftDist );
+    domC = _mm_cmplt_epi32( expDiff, zero );
+    dist = _mm_min_epi32( _mm_abs_epi32( expDiff ), _mm_set1_epi32( 16 ) );
+    sigZ = _mm_mullo_epi32( sigProd, f16_pow2_x4( shiftDist ) );
+    sigS = _mm_mullo_epi32( sigC, f16_pow2_x4( shiftDist ) );
+    sigZ = _mm_blendv_epi8( sigZ, f16_srlv_x4( sigZ, dist ), domC );
+    sigS = _mm_blendv_epi8( f16_srlv_x4( sigS, dist ), sigS, domC );
+    expZ = _mm_sub_epi32( _mm_blendv_epi8( expProd, expC, domC ), shiftDist );
+    same = _mm_cmpeq_epi32( signProd, signC );
+    prodGt = _mm_cmpgt_epi32( sigZ, sigS );
+    signZ = _mm_blendv_epi8( signC, signProd, _mm_or_si128( same, prodGt ) );
+    exact0 = _mm_andnot_si128( _mm_or_si128( same, zeroC ),
+                               _mm_and_si128( _mm_cmpeq_epi32( expDiff, zero ),
+                                              _mm_cmpeq_epi32( sigZ, sigS ) ) );
+    sigZ = _mm_blendv_epi8( _mm_blendv_epi8( _mm_sub_epi32( sigS, sigZ ), _mm_sub_epi32( sigZ, sigS ), prodGt ),
+                            _mm_add_epi32( sigZ, sigS ), same );
+
+    // one of them too small: no addition
+    cancelProd = _mm_cmplt_epi32( expDiff, _mm_set1_epi32( -16 ) );
+    cancelC = _mm_cmpgt_epi32( expDiff, _mm_set1_epi32( 16 ) );
+    sigZ = _mm_blendv_epi8( sigZ, sigC, cancelProd );
+    expZ = _mm_blendv_epi8( expZ, expC, cancelProd );
+    signZ = _mm_blendv_epi8( signZ, signC, cancelProd );
+    cancelC = _mm_or_si128( cancelC, zeroC );
+    sigZ = _mm_blendv_epi8( sigZ, sigProd, cancelC );
+    expZ = _mm_blendv_epi8( expZ, expProd, cancelC );
+    signZ = _mm_blendv_epi8( signZ, signProd, cancelC );
+    *cancel = _mm_add_epi32( *cancel, _mm_and_si128( _mm_andnot_si128( _mm_or_si128( zeroAB, zeroC ), valid ),
+                                                      _mm_or_si128( cancelProd, cancelC ) ) );
+
+    // roundPack: 15 bits (sticky) for softfloat_roundPackToF16()
+    shiftDist = _mm_max_epi32( _mm_sub_epi32( f16_msb32_x4( sigZ ), _mm_set1_epi32( 14 ) ), zero );
+    roundBits = sigZ;
+    sigZ = f16_srlv_x4( sigZ, shiftDist );
+    roundBits = _mm_cmpeq_epi32( _mm_mullo_epi32( sigZ, f16_pow2_x4( shiftDist ) ), roundBits );
+    sigZ = _mm_or_si128( sigZ, _mm_andnot_si128( roundBits, _mm_set1_epi32( 1 ) ) );
+    expZ = _mm_add_epi32( expZ, _mm_sub_epi32( shiftDist, _mm_set1_epi32( 10 - 4 ) ) );
+
+    // softfloat_roundPackToF16()
+    shiftDist = _mm_sub_epi32( _mm_set1_epi32( 14 ), f16_msb32_x4( sigZ ) );
+    smallest = _mm_cmpgt_epi32( shiftDist, _mm_max_epi32( expZ, zero ) );
+    sigZ = _mm_mullo_epi32( sigZ, f16_pow2_x4( shiftDist ) );
+    expZ = _mm_sub_epi32( expZ, shiftDist );
+    sigZ = _mm_srli_epi32( _mm_add_epi32( sigZ, _mm_set1_epi32( 0x8 ) ), 4 );
+    roundBits = _mm_srli_epi32( sigZ, 11 ); // carry
+    expZ = _mm_add_epi32( expZ, roundBits );
+    sigZ = _mm_blendv_epi8( sigZ, _mm_srli_epi32( sigZ, 1 ), _mm_sub_epi32( zero, roundBits ) );
+    largest = _mm_andnot_si128( smallest, _mm_cmpgt_epi32( expZ, m1F ) );
+    smallest = _mm_or_si128( smallest, _mm_andnot_si128( largest,
+                    _mm_or_si128( _mm_cmplt_epi32( expZ, zero ),
+                                  _mm_cmpeq_epi32( _mm_and_si128( sigZ, m400 ), zero ) ) ) );
+    ret = _mm_or_si128( _mm_or_si128( signZ, _mm_slli_epi32( expZ, 10 ) ), _mm_and_si128( sigZ, m3FF ) );
+    ret = _mm_blendv_epi8( ret, _mm_or_si128( signZ, m7FFF ), largest );
+    ret = _mm_blendv_epi8( ret, signZ, smallest );
+    valid = _mm_andnot_si128( _mm_or_si128( zeroAB, exact0 ), valid );
+    *over = _mm_add_epi32( *over, _mm_and_si128( largest, valid ) );
+    *under = _mm_add_epi32( *under, _mm_and_si128( smallest, valid ) );
+
+    ret = _mm_andnot_si128( exact0, ret );
+    return _mm_blendv_epi8( ret, c, zeroAB );
+}
+
+static inline unsigned int f16_count_x4( __m128i count )
+{
+    count = _mm_add_epi32( count, _mm_shuffle_epi32( count, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    count = _mm_add_epi32( count, _mm_shuffle_epi32( count, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    return (unsigned int)(-_mm_cvtsi128_si32( count ));
+}
+
+static inline void f16_add_counters_x4( __m128i cancel, __m128i under, __m128i over )
+{
+#ifdef FANN_AP_INCLUDE_ZERO
+    fann_ap_cancel += f16_count_x4( cancel );
+#else
+    (void) cancel;
+#endif
+    fann_ap_underflow += f16_count_x4( under );
+    fann_ap_overflow += f16_count_x4( over );
+}
+#endif // __SSE4_1__
+
+void f16_mulAdd_array( float16_t *y, float16_t a, const float16_t *x, unsigned int n )
+{
+    unsigned int i = 0, g;
+
+    if ( ! (a.u & 0x7FFF) ) return; // f16_mulAdd() returns y[i]
+#ifdef __SSE4_1__
+    if (n >= F16_LANES) {
+        const __m128i bias = _mm_set1_epi32( FP_BIAS );
+        const __m128i all = _mm_set1_epi32( -1 );
+        const __m128i va = _mm_set1_epi32( a.u );
+        __m128i cancel = _mm_setzero_si128();
+        __m128i under = _mm_setzero_si128();
+        __m128i over = _mm_setzero_si128();
+
+        for (; i + F16_LANES <= n; i += F16_LANES) {
+            // independent groups of 4 lanes
+            for (g = 0; g < F16_LANES; g += 8) {
+                __m128i vx = _mm_loadu_si128( (const __m128i *)(x + i + g) );
+                __m128i vy = _mm_loadu_si128( (const __m128i *)(y + i + g) );
+                __m128i lo = f16_mulAdd_x4( va, _mm_cvtepu16_epi32( vx ), _mm_cvtepu16_epi32( vy ),
+                                            bias, all, &cancel, &under, &over );
+                __m128i hi = f16_mulAdd_x4( va, _mm_cvtepu16_epi32( _mm_srli_si128( vx, 8 ) ),
+                                            _mm_cvtepu16_epi32( _mm_srli_si128( vy, 8 ) ),
+                                            bias, all, &cancel, &under, &over );
+                _mm_storeu_si128( (__m128i *)(y + i + g), _mm_packus_epi32( lo, hi ) );
+            }
+        }
+        f16_add_counters_x4( cancel, under, over );
+    }
+#endif
+    for (; i < n; i++) {
+        y[i] = f16_mulAdd( a, x[i], y[i] );
+    }
+}
+
+void f16_mulAdd_rows( float16_t *sum, float16_t * const *rows, const float16_t *x,
+                      unsigned int num_rows, unsigned int n )
+{
+    unsigned int i, r, g;
+
+#ifdef __SSE4_1__
+    if (num_rows > 2) {
+        // num_rows lanes in groups of 4, independent of each other
+        const unsigned int groups = (num_rows + 3) / 4;
+        const __m128i bias = _mm_set1_epi32( FP_BIAS );
+        const float16_t *row[F16_LANES];
+        float16_t acc[F16_LANES];
+        __m128i cancel = _mm_setzero_si128();
+        __m128i under = _mm_setzero_si128();
+        __m128i over = _mm_setzero_si128();
+        __m128i vsum[F16_LANES / 4], valid[F16_LANES / 4];
+
+        // missing rows repeat the first one, their lanes are not counted
+        for (r = 0; r < 4 * groups; r++) {
+            row[r] = rows[(r < num_rows) ? r : 0];
+            acc[r] = sum[(r < num_rows) ? r : 0];
+        }
+        for (g = 0; g < groups; g++) {
+            valid[g] = _mm_cmpgt_epi32( _mm_set1_epi32( num_rows ),
+                                        _mm_add_epi32( _mm_set1_epi32( 4 * g ), _mm_setr_epi32( 0, 1, 2, 3 ) ) );
+            vsum[g] = _mm_setr_epi32( acc[4 * g].u, acc[4 * g + 1].u, acc[4 * g + 2].u, acc[4 * g + 3].u );
+        }
+        for (i = 0; i < n; i++) {
+            __m128i vx;
+
+            if ( ! (x[i].u & 0x7FFF) ) continue; // f16_mulAdd() returns the sums
+            vx = _mm_set1_epi32( x[i].u );
+            for (g = 0; g < groups; g++) {
+                const float16_t * const *rg = row + 4 * g;
+
+                vsum[g] = f16_mulAdd_x4( _mm_setr_epi32( rg[0][i].u, rg[1][i].u, rg[2][i].u, rg[3][i].u ),
+                                         vx, vsum[g], bias, valid[g], &cancel, &under, &over );
+            }
+        }
+        for (r = 0; r < num_rows; r++) {
+            union { __m128i v; uint32_t u[4]; } lane;
+
+            lane.v = vsum[r / 4];
+            sum[r].u = (uint16_t) lane.u[r % 4];
+        }
+        f16_add_counters_x4( cancel, under, over );
+        return;
+    }
+#endif
+    for (i = 0; i < n; i++) {
+        for (r = 0; r < num_rows; r++) {
+            sum[r] = f16_mulAdd( rows[r][i], x[i], sum[r] );
+        }
+    }
+}
+#endif // FANN_F16_FAST
@@ -523,4 +523,22 @@ float16_t f32_to_f16( float32_t a );
 #define FP_BIAS_DEFAULT 15
 extern volatile int_fast8_t FP_BIAS;
 
+/*----------------------------------------------------------------------------
+| Multiply-add over arrays, bit-exact with f16_mulAdd() (counters included).
+| With FANN_F16_FAST and SSE4.1 the operations are emulated F16_LANES at a
+| time in 32-bit integer SIMD, otherwise f16_mulAdd() (the reference) is
+| called for each element.
+*----------------------------------------------------------------------------*/
+#undef FANN_F16_FAST // SoftFloat reference only
+#define FANN_F16_FAST
+
+#ifdef FANN_F16_FAST
+#define F16_LANES 16
+// y[i] = a * x[i] + y[i]
+void f16_mulAdd_array( float16_t *y, float16_t a, const float16_t *x, unsigned int n );
+// sum[r] += rows[r][i] * x[i], for i = 0..n-1 in order, r < num_rows <= F16_LANES
+void f16_mulAdd_rows( float16_t *sum, float16_t * const *rows, const float16_t *x,
+                      unsigned int num_rows, unsigned int n );
+#endif // FANN_F16_FAST
+
 
@@ -74,6 +74,9 @@ void fann_const_init(void)
 #if (defined SWF16_AP) || (defined HWF16)
     FP_BIAS = FP_BIAS_DEFAULT;
 #endif
+#ifdef SWF8
+    f8_init(); // arithmetic tables
+#endif
 
     ff_p200 = fann_int_to_ff(CI_TWO);
     ff_p100 = fann_int_to_ff(CI_ONE);
@@ -0,0 +1,506 @@
+/*
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  This library was based on the Fast Artificial Neural Network Library.
+  See README.md for details.
+
+*/
+
+// Array conversions: SIMD where the format allows, the scalar macros for the tails
+
+#include "fann_conv.h"
+
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+#ifdef POSIT16
+#include <pthread.h>
+#endif
+
+#if (defined SOFTFANN) && (defined SWF16_IEEE)
+#define FANN_CONV_IEEE_F16
+#elif (defined SOFTFANN) && ((defined SWF16_AP) || (defined HWF16))
+#define FANN_CONV_AP_F16
+#elif (defined FLOATFANN) && ((defined _GCC_ARM_F16_FF) || (defined _GCC_ARM_F16_BP)) && \
+      !((defined __arm__) || (defined __aarch64__))
+#define FANN_CONV_IEEE_F16 // x86 _Float16
+#endif
+
+#if (!defined FANN_INFERENCE_ONLY) || (defined FANN_CONV_IEEE_F16)
+#define FANN_CONV_HALF
+#endif
+#if (!defined FANN_INFERENCE_ONLY) || ((defined FLOATFANN) && (defined _BFLOAT16))
+#define FANN_CONV_BF16
+#endif
+
+#ifdef FANN_CONV_HALF
+/*
+ * INTERNAL FUNCTION
+ * IEEE 754 binary16 to float, exact for all inputs.
+ */
+static inline float fann_half_to_float(uint16_t h)
+{
+    union { uint32_t u; float f; } o, magic = { 113u << 23 };
+    uint32_t exp;
+
+    o.u = (uint32_t)(h & 0x7fff) << 13;
+    exp = o.u & 0x0f800000u;
+    o.u += (uint32_t)(127 - 15) << 23;
+    if (exp == 0x0f800000u) {
+        o.u += (uint32_t)(128 - 16) << 23; // Inf or NaN
+    } else if (exp == 0) {
+        o.u += 1u << 23; // zero or subnormal
+        o.f -= magic.f;
+    }
+    o.u |= (uint32_t)(h & 0x8000) << 16;
+    return o.f;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * float to IEEE 754 binary16, round to nearest even.
+ */
+static inline uint16_t fann_float_to_half(float v)
+{
+    union { uint32_t u; float f; } f, denorm = { (uint32_t)((127 - 15) + (23 - 10) + 1) << 23 };
+    uint32_t sign, o;
+
+    f.f = v;
+    sign = f.u & 0x80000000u;
+    f.u ^= sign;
+    if (f.u >= 0x47800000u) {
+        o = (f.u > 0x7f800000u) ? 0x7e00 : 0x7c00; // NaN or overflow to Inf
+    } else if (f.u < (113u << 23)) {
+        f.f += denorm.f; // subnormal, rounded by the float addition
+        o = f.u - denorm.u;
+    } else {
+        uint32_t mant_odd = (f.u >> 13) & 1;
+
+        f.u += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        f.u += mant_odd;
+        o = f.u >> 13;
+    }
+    return (uint16_t)(o | (sign >> 16));
+}
+
+#ifdef __SSE2__
+/* 4 halves (low 16 bits of each lane) to float, same results as fann_half_to_float */
+static inline __m128 fann_half_to_float_sse2(__m128i h)
+{
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((127 + 112) << 23));
+    __m128i expmant = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+    // the multiplication rebiases the exponent and normalizes subnormals
+    __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), magic);
+    __m128i infnan = _mm_and_si128(_mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7bff)),
+                                   _mm_set1_epi32(255 << 23));
+
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infnan)));
+}
+
+/* 4 floats to halves, sign extended to 32 bits for _mm_packs_epi32 */
+static inline __m128i fann_float_to_half_sse2(__m128 v)
+{
+    const __m128i subnorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    __m128i sign = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0x80000000));
+    __m128i f = _mm_xor_si128(_mm_castps_si128(v), sign);
+    __m128i is_nan = _mm_cmpgt_epi32(f, _mm_set1_epi32(0x7f800000));
+    __m128i is_regular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), f);
+    __m128i is_sub = _mm_cmpgt_epi32(_mm_set1_epi32(113 << 23), f);
+    __m128i inf_nan = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x0200)),
+                                   _mm_set1_epi32(0x7c00));
+    __m128i sub, norm, ret;
+
+    // subnormal: rounded by the float addition
+    sub = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(subnorm_magic)));
+    sub = _mm_sub_epi32(sub, subnorm_magic);
+    // normal: round to nearest even (the odd mask is -1)
+    norm = _mm_add_epi32(f, _mm_set1_epi32(((15 - 127) << 23) + 0xfff));
+    norm = _mm_sub_epi32(norm, _mm_srai_epi32(_mm_slli_epi32(f, 31 - 13), 31));
+    norm = _mm_srli_epi32(norm, 13);
+
+    ret = _mm_or_si128(_mm_and_si128(is_sub, sub), _mm_andnot_si128(is_sub, norm));
+    ret = _mm_or_si128(_mm_and_si128(is_regular, ret), _mm_andnot_si128(is_regular, inf_nan));
+    return _mm_or_si128(ret, _mm_srai_epi32(sign, 16));
+}
+#endif // __SSE2__
+
+static void fann_half_to_float_vec(float *dst, const uint16_t *src, unsigned int n)
+{
+    unsigned int i = 0;
+
+#ifdef __F16C__
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+#elif (defined __SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+
+        _mm_storeu_ps(dst + i, fann_half_to_float_sse2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(dst + i + 4, fann_half_to_float_sse2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = fann_half_to_float(src[i]);
+    }
+}
+
+static void fann_float_to_half_vec(uint16_t *dst, const float *src, unsigned int n)
+{
+    unsigned int i = 0;
+
+#ifdef __F16C__
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(src + i);
+
+        // F16C quiets NaNs keeping their payload, the scalar returns 0x7e00
+        if (_mm256_movemask_ps(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)))
+            break;
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+#elif (defined __SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(fann_float_to_half_sse2(_mm_loadu_ps(src + i)),
+                                fann_float_to_half_sse2(_mm_loadu_ps(src + i + 4))));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = fann_float_to_half(src[i]);
+    }
+}
+#endif // FANN_CONV_HALF
+
+#ifdef FANN_CONV_BF16
+static void fann_bf16_to_float_vec(float *dst, const uint16_t *src, unsigned int n)
+{
+    union { uint32_t u; float f; } o;
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(_mm_setzero_si128(), h));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(_mm_setzero_si128(), h));
+    }
+#endif
+    for (; i < n; i++) {
+        o.u = (uint32_t)src[i] << 16;
+        dst[i] = o.f;
+    }
+}
+#endif // FANN_CONV_BF16
+
+#ifndef FANN_INFERENCE_ONLY
+#ifdef __SSE2__
+/* 4 floats to bfloat16 (round to nearest even, NaNs quieted), sign extended */
+static inline __m128i fann_float_to_bf16_sse2(__m128 v)
+{
+    __m128i f = _mm_castps_si128(v);
+    __m128i is_nan = _mm_cmpgt_epi32(_mm_and_si128(f, _mm_set1_epi32(0x7fffffff)),
+                                     _mm_set1_epi32(0x7f800000));
+    __m128i odd = _mm_and_si128(_mm_srli_epi32(f, 16), _mm_set1_epi32(1));
+    __m128i rne = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32(0x7fff)), odd), 16);
+    __m128i nan = _mm_or_si128(_mm_srli_epi32(f, 16), _mm_set1_epi32(0x40));
+    __m128i ret = _mm_or_si128(_mm_and_si128(is_nan, nan), _mm_andnot_si128(is_nan, rne));
+
+    return _mm_srai_epi32(_mm_slli_epi32(ret, 16), 16);
+}
+#endif // __SSE2__
+
+static void fann_float_to_bf16_vec(uint16_t *dst, const float *src, unsigned int n)
+{
+    union { uint32_t u; float f; } f;
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(fann_float_to_bf16_sse2(_mm_loadu_ps(src + i)),
+                                fann_float_to_bf16_sse2(_mm_loadu_ps(src + i + 4))));
+    }
+#endif
+    for (; i < n; i++) {
+        f.f = src[i];
+        if ((f.u & 0x7fffffffu) > 0x7f800000u) {
+            dst[i] = (uint16_t)((f.u >> 16) | 0x40); // quiet NaN
+        } else {
+            f.u += 0x7fff + ((f.u >> 16) & 1);
+            dst[i] = (uint16_t)(f.u >> 16);
+        }
+    }
+}
+#endif // FANN_INFERENCE_ONLY
+
+#if (defined FANN_CONV_AP_F16) && (defined __SSE2__)
+/*
+ * INTERNAL FUNCTION
+ * 4 floats to AP binary16 with exponent bias 127 - ebias, as f32_to_f16 in
+ * fann_ap_f16.c: ties away from zero, no subnormals, saturation to the
+ * largest value. Zeros are kept, as with FANN_AP_INCLUDE_ZERO.
+ */
+static inline __m128i fann_float_to_ap_sse2(__m128 v, __m128i ebias,
+                                            unsigned int *overflow, unsigned int *underflow)
+{
+    __m128i sign = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0x80000000));
+    __m128i f = _mm_xor_si128(_mm_castps_si128(v), sign);
+    // a carry of the rounding goes to the exponent, as the renormalization does
+    __m128i r = _mm_add_epi32(f, _mm_set1_epi32(0x1000));
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(r, 23), ebias);
+    __m128i zero = _mm_cmpeq_epi32(f, _mm_setzero_si128());
+    __m128i over = _mm_cmpgt_epi32(e, _mm_set1_epi32(31));
+    __m128i under = _mm_andnot_si128(zero, _mm_cmplt_epi32(e, _mm_setzero_si128()));
+    __m128i ret;
+
+    ret = _mm_or_si128(_mm_slli_epi32(e, 10), _mm_and_si128(_mm_srli_epi32(r, 13), _mm_set1_epi32(0x3ff)));
+    ret = _mm_andnot_si128(_mm_or_si128(zero, under), ret);
+    ret = _mm_or_si128(_mm_andnot_si128(over, ret), _mm_and_si128(over, _mm_set1_epi32(0x7fff)));
+    *overflow += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(over)));
+    *underflow += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(under)));
+    return _mm_or_si128(ret, _mm_srai_epi32(sign, 16));
+}
+
+/* 4 AP binary16 (low 16 bits of each lane) to float */
+static inline __m128 fann_ap_to_float_sse2(__m128i h, __m128i ebias)
+{
+    __m128i x = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    __m128i zero = _mm_cmpeq_epi32(x, _mm_setzero_si128());
+    __m128i ret = _mm_add_epi32(_mm_slli_epi32(x, 13), _mm_slli_epi32(ebias, 23));
+
+    ret = _mm_andnot_si128(zero, ret);
+    return _mm_castsi128_ps(_mm_or_si128(ret, _mm_slli_epi32(_mm_xor_si128(h, x), 16)));
+}
+#endif // FANN_CONV_AP_F16 && __SSE2__
+
+void fann_float_to_ff_array(fann_type_ff *dst, const float *src, unsigned int n)
+{
+    unsigned int i = 0;
+
+#if (defined FANN_CONV_IEEE_F16)
+    fann_float_to_half_vec((uint16_t *)dst, src, n);
+    i = n;
+#elif (defined FANN_CONV_AP_F16) && (defined __SSE2__)
+    __m128i ebias = _mm_set1_epi32(127 - FP_BIAS);
+    unsigned int overflow = 0, underflow = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(fann_float_to_ap_sse2(_mm_loadu_ps(src + i), ebias, &overflow, &underflow),
+                                fann_float_to_ap_sse2(_mm_loadu_ps(src + i + 4), ebias, &overflow, &underflow)));
+    }
+    fann_ap_overflow += overflow;
+    fann_ap_underflow += underflow;
+#elif (defined FLOATFANN) && (defined _BFLOAT16) && (defined __SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(fann_float_to_bfloat16_sse2(_mm_loadu_ps(src + i)),
+                                fann_float_to_bfloat16_sse2(_mm_loadu_ps(src + i + 4))));
+    }
+#endif
+    // native types are vectorized by the compiler, posits go one by one
+    for (; i < n; i++) {
+        dst[i] = fann_float_to_ff(src[i]);
+    }
+}
+
+#ifdef POSIT16
+/* every posit16 as float, filled once on first use (by any thread) */
+static float fann_posit16_lut[1 << 16];
+static pthread_once_t fann_posit16_lut_once = PTHREAD_ONCE_INIT;
+
+static void fann_posit16_lut_init(void)
+{
+    posit16_t p;
+    unsigned int i;
+
+    for (i = 0; i < (1 << 16); i++) {
+        p.v = (uint16_t)i;
+        fann_posit16_lut[i] = (float)convertP16ToDouble(p);
+    }
+}
+#endif // POSIT16
+
+void fann_ff_to_float_array(float *dst, const fann_type_ff *src, unsigned int n)
+{
+    unsigned int i = 0;
+
+#if (defined FANN_CONV_IEEE_F16)
+    fann_half_to_float_vec(dst, (const uint16_t *)src, n);
+    i = n;
+#elif (defined FANN_CONV_AP_F16) && (defined __SSE2__)
+    __m128i ebias = _mm_set1_epi32(127 - FP_BIAS);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+
+        _mm_storeu_ps(dst + i, fann_ap_to_float_sse2(_mm_unpacklo_epi16(h, _mm_setzero_si128()), ebias));
+        _mm_storeu_ps(dst + i + 4, fann_ap_to_float_sse2(_mm_unpackhi_epi16(h, _mm_setzero_si128()), ebias));
+    }
+#elif (defined FLOATFANN) && (defined _BFLOAT16)
+    fann_bf16_to_float_vec(dst, (const uint16_t *)src, n);
+    i = n;
+#elif (defined POSIT16)
+    pthread_once(&fann_posit16_lut_once, fann_posit16_lut_init);
+    for (; i < n; i++) {
+        dst[i] = fann_posit16_lut[(uint16_t)src[i].v];
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = fann_ff_to_float(src[i]);
+    }
+}
+
+#ifndef FANN_INFERENCE_ONLY
+void fann_ff_to_bp_array(fann_type_bp *dst, const fann_type_ff *src, unsigned int n,
+                         int_fast8_t bias)
+{
+    unsigned int i = 0;
+
+#ifdef FANN_CONV_AP_F16
+    int_fast8_t save_bias = FP_BIAS;
+
+    if (bias == FP_BIAS_DEFAULT) {
+        fann_memcpy(dst, src, n);
+        return;
+    }
+#ifdef __SSE2__
+    {
+        // rebias the exponents, as fann_ff_to_bp: zeros are kept, underflows
+        // go to +0 and overflows saturate
+        __m128i delta = _mm_set1_epi16(bias - FP_BIAS_DEFAULT);
+        unsigned int overflow = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i u = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i nz = _mm_xor_si128(_mm_cmpeq_epi16(_mm_and_si128(u, _mm_set1_epi16(0x7fff)),
+                                                       _mm_setzero_si128()), _mm_set1_epi16(-1));
+            __m128i e = _mm_add_epi16(_mm_and_si128(_mm_srli_epi16(u, 10), _mm_set1_epi16(0x1f)), delta);
+            __m128i under = _mm_cmplt_epi16(e, _mm_setzero_si128());
+            __m128i over = _mm_and_si128(nz, _mm_cmpgt_epi16(e, _mm_set1_epi16(31)));
+            __m128i ret;
+
+            ret = _mm_or_si128(_mm_and_si128(u, _mm_set1_epi16((short)0x83ff)), _mm_slli_epi16(e, 10));
+            ret = _mm_andnot_si128(under, ret);
+            ret = _mm_or_si128(_mm_andnot_si128(over, ret),
+                               _mm_and_si128(over, _mm_or_si128(u, _mm_set1_epi16(0x7fff))));
+            ret = _mm_or_si128(_mm_and_si128(nz, ret), _mm_andnot_si128(nz, u));
+            _mm_storeu_si128((__m128i *)(dst + i), ret);
+            overflow += __builtin_popcount(_mm_movemask_epi8(over)) / 2;
+        }
+        fann_ap_overflow += overflow;
+    }
+#endif // __SSE2__
+    FP_BIAS = bias;
+    for (; i < n; i++) {
+        dst[i] = fann_ff_to_bp(src[i]);
+    }
+    FP_BIAS = save_bias;
+#else
+    (void)bias;
+    for (; i < n; i++) {
+        dst[i] = fann_ff_to_bp(src[i]);
+    }
+#endif // FANN_CONV_AP_F16
+}
+
+void fann_half_to_ff_array(fann_type_ff *dst, const uint16_t *src, unsigned int n)
+{
+    float tmp[FANN_CONV_CHUNK];
+    unsigned int i, k;
+
+    for (i = 0; i < n; i += k) {
+        k = ((n - i) < FANN_CONV_CHUNK) ? (n - i) : FANN_CONV_CHUNK;
+        fann_half_to_float_vec(tmp, src + i, k);
+        fann_float_to_ff_array(dst + i, tmp, k);
+    }
+}
+
+void fann_ff_to_half_array(uint16_t *dst, const fann_type_ff *src, unsigned int n)
+{
+    float tmp[FANN_CONV_CHUNK];
+    unsigned int i, k;
+
+    for (i = 0; i < n; i += k) {
+        k = ((n - i) < FANN_CONV_CHUNK) ? (n - i) : FANN_CONV_CHUNK;
+        fann_ff_to_float_array(tmp, src + i, k);
+        fann_float_to_half_vec(dst + i, tmp, k);
+    }
+}
+
+void fann_bf16_to_ff_array(fann_type_ff *dst, const uint16_t *src, unsigned int n)
+{
+    float tmp[FANN_CONV_CHUNK];
+    unsigned int i, k;
+
+    for (i = 0; i < n; i += k) {
+        k = ((n - i) < FANN_CONV_CHUNK) ? (n - i) : FANN_CONV_CHUNK;
+        fann_bf16_to_float_vec(tmp, src + i, k);
+        fann_float_to_ff_array(dst + i, tmp, k);
+    }
+}
+
+void fann_ff_to_bf16_array(uint16_t *dst, const fann_type_ff *src, unsigned int n)
+{
+    float tmp[FANN_CONV_CHUNK];
+    unsigned int i, k;
+
+    for (i = 0; i < n; i += k) {
+        k = ((n - i) < FANN_CONV_CHUNK) ? (n - i) : FANN_CONV_CHUNK;
+        fann_ff_to_float_array(tmp, src + i, k);
+        fann_float_to_bf16_vec(dst + i, tmp, k);
+    }
+}
+#endif // FANN_INFERENCE_ONLY
+
+#ifdef FANN_DATA_SCALE
+void fann_ff_to_nt_array(fann_type_nt *dst, const fann_type_ff *src, unsigned int n)
+{
+#ifdef SOFTFANN
+    // scaling runs on fann_type_ff itself
+    fann_memcpy(dst, src, n);
+#elif (defined FLOATFANN) || (defined FIXEDFANN)
+    fann_ff_to_float_array(dst, src, n);
+#else
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = fann_ff_to_nt(src[i]);
+    }
+#endif
+}
+
+void fann_nt_to_ff_array(fann_type_ff *dst, const fann_type_nt *src, unsigned int n)
+{
+#ifdef SOFTFANN
+    fann_memcpy(dst, src, n);
+#elif (defined FLOATFANN) || (defined FIXEDFANN)
+    fann_float_to_ff_array(dst, src, n);
+#else
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = fann_nt_to_ff(src[i]);
+    }
+#endif
+}
+#endif // FANN_DATA_SCALE
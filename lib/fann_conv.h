@@ -0,0 +1,52 @@
+/*
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+
+#ifndef _fann_conv_h
+#define _fann_conv_h
+
+/* Array conversions, bit-exact with the scalar fann_float_to_ff(),
+ * fann_ff_to_float() and fann_ff_to_bp() of the back-end (NaN payloads
+ * aside). The AP formats use the current FP_BIAS as the scalar ones do,
+ * overflows and underflows are counted the same way. */
+
+/* values converted at a time by the staging buffers */
+#define FANN_CONV_CHUNK 64
+
+void fann_float_to_ff_array(fann_type_ff *dst, const float *src, unsigned int n);
+void fann_ff_to_float_array(float *dst, const fann_type_ff *src, unsigned int n);
+
+#ifndef FANN_INFERENCE_ONLY
+/* ff to bp with an explicit bp exponent bias (AP formats only, ignored elsewhere) */
+void fann_ff_to_bp_array(fann_type_bp *dst, const fann_type_ff *src, unsigned int n,
+                         int_fast8_t bias);
+
+/* IEEE binary16 and bfloat16 storage (FANN_DATA_F16, FANN_DATA_BF16) */
+void fann_half_to_ff_array(fann_type_ff *dst, const uint16_t *src, unsigned int n);
+void fann_ff_to_half_array(uint16_t *dst, const fann_type_ff *src, unsigned int n);
+void fann_bf16_to_ff_array(fann_type_ff *dst, const uint16_t *src, unsigned int n);
+void fann_ff_to_bf16_array(uint16_t *dst, const fann_type_ff *src, unsigned int n);
+#endif // FANN_INFERENCE_ONLY
+
+#ifdef FANN_DATA_SCALE
+void fann_ff_to_nt_array(fann_type_nt *dst, const fann_type_ff *src, unsigned int n);
+void fann_nt_to_ff_array(fann_type_ff *dst, const fann_type_nt *src, unsigned int n);
+#endif // FANN_DATA_SCALE
+
+#endif // _fann_conv_h
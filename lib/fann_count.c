@@ -0,0 +1,247 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#include "fann.h"
+
+const char * const FANN_PHASE_NAMES[FANN_PHASE_COUNT] = {
+    "forward",
+    "loss",
+    "backward",
+    "update",
+};
+
+#ifdef FANN_COUNTERS
+
+#include <pthread.h>
+#include <inttypes.h>
+
+/* one per thread, cache line aligned so that no two threads write the
+   same line */
+struct fann_count_block {
+    struct fann_counters cnt;
+    struct fann_count_block *next;
+};
+
+__thread struct fann_count *fann_count_cur = NULL;
+static __thread struct fann_count_block *fann_count_own = NULL;
+
+static struct fann_count_block *fann_count_blocks = NULL;
+static pthread_mutex_t fann_count_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* INTERNAL FUNCTION
+   The counters of layer and phase in the block of this thread, NULL if
+   the block can not be allocated.
+ */
+static struct fann_count *fann_count_enter(struct fann *ann, struct fann_layer *layer,
+                                           enum fann_count_phase phase)
+{
+    unsigned int l = (unsigned int)(layer - ann->first_layer);
+    struct fann_count_block *block = fann_count_own;
+
+    if (block == NULL) {
+        void *mem;
+
+        // kept after the thread exits, its counts still add to the totals
+        if (posix_memalign(&mem, 64, sizeof(struct fann_count_block))) {
+            return NULL;
+        }
+        block = (struct fann_count_block *)mem;
+        memset(block, 0, sizeof(struct fann_count_block));
+        pthread_mutex_lock(&fann_count_lock);
+        block->next = fann_count_blocks;
+        fann_count_blocks = block;
+        pthread_mutex_unlock(&fann_count_lock);
+        fann_count_own = block;
+    }
+    if (l >= FANN_COUNT_LAYERS) {
+        l = FANN_COUNT_LAYERS - 1;
+    }
+    fann_prof_layer(l, phase);
+    fann_count_cur = &block->cnt.layer[l][phase];
+    fann_count_cur->passes++;
+    return fann_count_cur;
+}
+
+void fann_count_forward(struct fann *ann, struct fann_layer *layer, unsigned int num_inputs)
+{
+    struct fann_count *c = fann_count_enter(ann, layer, FANN_PHASE_FORWARD);
+    uint64_t n = layer->num_neurons;
+
+    if (c != NULL) {
+        // MACs, steepness and activation; sums and values written
+        c->flops += n * (2 * (uint64_t)num_inputs + 2);
+        c->weight_bytes += n * (num_inputs + 1) * sizeof(fann_type_ff);
+        c->value_bytes += (num_inputs + 2 * n) * sizeof(fann_type_ff);
+    }
+}
+
+void fann_count_loss(struct fann *ann)
+{
+    struct fann_count *c = fann_count_enter(ann, ann->last_layer - 1, FANN_PHASE_LOSS);
+    uint64_t n = ann->num_output;
+
+    if (c != NULL) {
+        // difference, square and sum; the errors written
+        c->flops += 3 * n;
+        c->value_bytes += n * (2 * sizeof(fann_type_ff) + sizeof(fann_type_bp));
+    }
+}
+
+void fann_count_backward(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer)
+{
+    struct fann_count *c = fann_count_enter(ann, layer, FANN_PHASE_BACKWARD);
+    uint64_t n = layer->num_neurons, p = prev_layer->num_neurons;
+
+    if (c != NULL) {
+        // MACs into the previous errors, then their derivatives
+        c->flops += 2 * n * p + p;
+        c->weight_bytes += n * p * sizeof(fann_type_ff);
+        c->value_bytes += n * sizeof(fann_type_bp) + p * (sizeof(fann_type_bp) + sizeof(fann_type_ff));
+    }
+}
+
+void fann_count_slopes(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer)
+{
+    struct fann_count *c = fann_count_enter(ann, layer, FANN_PHASE_BACKWARD);
+    uint64_t n = layer->num_neurons, p = prev_layer->num_neurons;
+
+    if (c != NULL) {
+        // slopes read and written
+        c->flops += 2 * n * (p + 1);
+        c->weight_bytes += 2 * n * (p + 1) * sizeof(fann_type_bp);
+        c->value_bytes += p * sizeof(fann_type_ff) + n * sizeof(fann_type_bp);
+    }
+}
+
+void fann_count_update(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer,
+                       unsigned int flops_per_weight, unsigned int bp_arrays)
+{
+    struct fann_count *c = fann_count_enter(ann, layer, FANN_PHASE_UPDATE);
+    uint64_t w = (uint64_t)layer->num_neurons * (prev_layer->num_neurons + 1);
+
+    if (c != NULL) {
+        c->flops += w * flops_per_weight;
+        c->weight_bytes += 2 * w * (sizeof(fann_type_ff) + bp_arrays * sizeof(fann_type_bp));
+    }
+}
+
+static void fann_count_sum(struct fann_count *sum, const struct fann_count *c)
+{
+    sum->passes += c->passes;
+    sum->flops += c->flops;
+    sum->weight_bytes += c->weight_bytes;
+    sum->value_bytes += c->value_bytes;
+    sum->mac += c->mac;
+    sum->add += c->add;
+    sum->mul += c->mul;
+    sum->div += c->div;
+}
+
+FANN_EXTERNAL void FANN_API fann_get_counters(struct fann_counters *total)
+{
+    struct fann_count_block *block;
+    unsigned int l, p;
+
+    memset(total, 0, sizeof(struct fann_counters));
+    pthread_mutex_lock(&fann_count_lock);
+    for (block = fann_count_blocks; block != NULL; block = block->next) {
+        for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+            for (p = 0; p < FANN_PHASE_COUNT; p++) {
+                fann_count_sum(&total->layer[l][p], &block->cnt.layer[l][p]);
+            }
+        }
+    }
+    pthread_mutex_unlock(&fann_count_lock);
+}
+
+FANN_EXTERNAL void FANN_API fann_clear_counters(void)
+{
+    struct fann_count_block *block;
+
+    pthread_mutex_lock(&fann_count_lock);
+    for (block = fann_count_blocks; block != NULL; block = block->next) {
+        memset(&block->cnt, 0, sizeof(struct fann_counters));
+    }
+    pthread_mutex_unlock(&fann_count_lock);
+}
+
+static void fann_dump_count(FILE *out, const struct fann_count *c)
+{
+    fprintf(out, "{\"passes\": %" PRIu64 ", \"flops\": %" PRIu64
+            ", \"weight_bytes\": %" PRIu64 ", \"value_bytes\": %" PRIu64
+            ", \"mac\": %" PRIu64 ", \"add\": %" PRIu64 ", \"mul\": %" PRIu64 ", \"div\": %" PRIu64 "}",
+            c->passes, c->flops, c->weight_bytes, c->value_bytes, c->mac, c->add, c->mul, c->div);
+}
+
+static void fann_dump_phases(FILE *out, const struct fann_count *phase)
+{
+    unsigned int p;
+
+    for (p = 0; p < FANN_PHASE_COUNT; p++) {
+        fprintf(out, "%s\"%s\": ", p ? ", " : "", FANN_PHASE_NAMES[p]);
+        fann_dump_count(out, phase + p);
+    }
+}
+
+FANN_EXTERNAL int FANN_API fann_dump_counters(FILE *out, struct fann *ann, double seconds)
+{
+    struct fann_counters cnt;
+    struct fann_count total[FANN_PHASE_COUNT], all;
+    unsigned int l, p, num_layers = (unsigned int)(ann->last_layer - ann->first_layer);
+    int first = 1;
+
+    fann_get_counters(&cnt);
+    memset(total, 0, sizeof(total));
+    memset(&all, 0, sizeof(all));
+    fprintf(out, "{\"back_end\": \"%s\", \"fann_type_ff_bytes\": %u, \"fann_type_bp_bytes\": %u,\n",
+            fann_float_type, (unsigned int)sizeof(fann_type_ff), (unsigned int)sizeof(fann_type_bp));
+    fprintf(out, " \"layers\": [");
+    for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+        for (p = 0; (p < FANN_PHASE_COUNT) && (cnt.layer[l][p].passes == 0); p++);
+        if (p == FANN_PHASE_COUNT) {
+            continue;
+        }
+        fprintf(out, "%s\n  {\"layer\": %u, \"neurons\": %u, ", first ? "" : ",", l,
+                (l < num_layers) ? ann->first_layer[l].num_neurons : 0);
+        fann_dump_phases(out, cnt.layer[l]);
+        fprintf(out, "}");
+        for (p = 0; p < FANN_PHASE_COUNT; p++) {
+            fann_count_sum(total + p, &cnt.layer[l][p]);
+            fann_count_sum(&all, &cnt.layer[l][p]);
+        }
+        first = 0;
+    }
+    fprintf(out, "],\n \"total\": {");
+    fann_dump_phases(out, total);
+    fprintf(out, ", \"all\": ");
+    fann_dump_count(out, &all);
+    fprintf(out, "}");
+    if (seconds > 0.0) {
+        double bytes = (double)(all.weight_bytes + all.value_bytes);
+
+        fprintf(out, ",\n \"seconds\": %.6f, \"gflops\": %.6f, \"gbytes_per_second\": %.6f, \"flops_per_byte\": %.6f",
+                seconds, all.flops / seconds * 1e-9, bytes / seconds * 1e-9,
+                (bytes > 0.0) ? all.flops / bytes : 0.0);
+    }
+    fprintf(out, "}\n");
+    return ferror(out) ? -1 : 0;
+}
+
+#endif // FANN_COUNTERS
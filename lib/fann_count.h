@@ -0,0 +1,132 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_count_h
+#define _fann_count_h
+
+/* Work counters, per layer and per phase of training.
+ *
+ * Each layer pass adds its nominal dense work: flops (a MAC is 2) and the
+ * bytes of weights (including slopes and steps) and of values (inputs,
+ * sums, outputs and errors) it touches, each array counted once per pass.
+ * Built with -DFANN_COUNT_OPS (the softfann-*-ops.o objects, as counting
+ * slows them), the soft back-ends also count the scalar operations they
+ * execute (COUNT_*_OP in softfann.c), under the layer and phase last
+ * entered.
+ *
+ * Every thread has its own block of counters, allocated on its first
+ * layer pass and never shared, so counting needs no atomics. The blocks
+ * are summed on demand by fann_get_counters().
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#if !(defined FANN_EMBEDDED) && !(defined FANN_INFERENCE_ONLY)
+#define FANN_COUNTERS
+//#define FANN_COUNT_OPS // scalar operations of the soft back-ends
+#else
+#undef FANN_COUNT_OPS
+#endif
+
+enum fann_count_phase {
+    FANN_PHASE_FORWARD = 0,
+    FANN_PHASE_LOSS,
+    FANN_PHASE_BACKWARD,    // errors of the previous layer and weight slopes
+    FANN_PHASE_UPDATE,      // weights, steps and slopes after each (mini) batch
+    FANN_PHASE_COUNT
+};
+
+extern const char * const FANN_PHASE_NAMES[FANN_PHASE_COUNT];
+
+// deeper layers are added to the last one
+#define FANN_COUNT_LAYERS 16
+
+struct fann_count {
+    uint64_t passes;
+    uint64_t flops;
+    uint64_t weight_bytes;
+    uint64_t value_bytes;
+    // scalar operations of the soft back-ends
+    uint64_t mac;
+    uint64_t add;
+    uint64_t mul;
+    uint64_t div;
+};
+
+struct fann_counters {
+    struct fann_count layer[FANN_COUNT_LAYERS][FANN_PHASE_COUNT];
+};
+
+#ifdef FANN_COUNTERS
+
+/* the counters of the current thread being added to (NULL before its first pass) */
+extern __thread struct fann_count *fann_count_cur;
+
+#define fann_count_ops(op, n) {if (fann_count_cur != NULL) fann_count_cur->op += (n);}
+
+/* INTERNAL FUNCTIONS
+   Start counting a pass of layer (whose inputs come from prev_layer).
+ */
+void fann_count_forward(struct fann *ann, struct fann_layer *layer, unsigned int num_inputs);
+void fann_count_loss(struct fann *ann);
+void fann_count_backward(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer);
+void fann_count_slopes(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer);
+/* flops per weight and number of fann_type_bp arrays (slopes, steps, ...)
+   read and written with the weights by the update rule */
+void fann_count_update(struct fann *ann, struct fann_layer *layer, struct fann_layer *prev_layer,
+                       unsigned int flops_per_weight, unsigned int bp_arrays);
+
+/* Function: fann_get_counters
+
+   Sum of the counters of all threads, since the last <fann_clear_counters>.
+ */
+FANN_EXTERNAL void FANN_API fann_get_counters(struct fann_counters *total);
+
+/* Function: fann_clear_counters
+
+   Zeroes the counters of all threads. Not to be called while other
+   threads run or train networks.
+ */
+FANN_EXTERNAL void FANN_API fann_clear_counters(void);
+
+/* Function: fann_dump_counters
+
+   Writes the counters as JSON to *out*: for each layer of *ann* with work
+   and for the whole network, the counters of each phase. With *seconds*
+   > 0, the totals include GFLOP/s, GB/s and flops per byte.
+
+   Returns:
+   0 on success, -1 on write errors.
+ */
+FANN_EXTERNAL int FANN_API fann_dump_counters(FILE *out, struct fann *ann, double seconds);
+
+#else // !FANN_COUNTERS
+
+#define fann_count_ops(op, n)
+#define fann_count_forward(ann, layer, num_inputs)
+#define fann_count_loss(ann)
+#define fann_count_backward(ann, layer, prev_layer)
+#define fann_count_slopes(ann, layer, prev_layer)
+#define fann_count_update(ann, layer, prev_layer, flops_per_weight, bp_arrays)
+
+#endif // FANN_COUNTERS
+
+#endif // _fann_count_h
@@ -302,6 +302,7 @@ struct fann;
 
 #ifndef FANN_INFERENCE_ONLY
 struct fann_data;
+struct fann_data_codec;
 #endif // FANN_INFERENCE_ONLY
 
 /* Type: fann_callback_type
@@ -345,12 +346,27 @@ FANN_EXTERNAL typedef int (FANN_API * fann_callback_type) (struct fann *ann, str
  * No data within these structures should be altered directly by the user.
  */
 
+// threads are enabled by building with -DFANN_THREADS=<max extra threads>
+#ifndef FANN_THREADS
 #define FANN_THREADS 23
 #undef  FANN_THREADS
+#endif
 
 #include <stdint.h>
 #ifdef FANN_THREADS
 #include <pthread.h>
+
+/* Where the time of a thread goes while training and testing (ns), see
+   fann_get_thread_times */
+struct fann_thread_times {
+    uint64_t batches;   // (mini) batches, or test runs, of the thread
+    uint64_t rows;
+    uint64_t work_ns;   // forward, loss, backward and slopes of its rows
+    uint64_t wait_ns;   // at the barrier before the weight update
+    uint64_t update_ns; // slopes of all threads summed and weights updated, shared by neuron
+    uint64_t spawn_ns;  // calling thread: creating the others
+    uint64_t join_ns;   // calling thread: waiting for the others to end
+};
 #endif
 
 struct fann_neuron
@@ -388,6 +404,13 @@ struct fann_neuron
      * Not allocated if not used.
      */
     fann_type_bp * prev_slopes;
+
+#ifdef FANN_QUIRE_DOT
+    /* Exact sums of the weight slopes in the current batch, rounded
+     * into weight_slopes by fann_round_weight_slopes().
+     */
+    fann_quire * slope_sums;
+#endif
     
 #if (defined SWF16_AP) || (defined HWF16)
     /* The Back. Prop. FP bias */
@@ -402,6 +425,38 @@ struct fann_neuron
 };
 //#endif
 
+#ifndef FANN_INFERENCE_ONLY
+#ifdef FANN_PRINT_STATS
+/* Streaming statistics of one kind of value of a layer, see fann_print_stats() */
+enum fann_stat_kind {
+    FANN_STAT_WEIGHT = 0,   // snapshot when printed
+    FANN_STAT_ERROR,        // the following added by the update kernels
+    FANN_STAT_DELTA,        // weight slopes of each batch
+    FANN_STAT_STEP,
+    FANN_STAT_SLOPE,
+    FANN_STAT_KINDS
+};
+
+/* |x| as float, by exponent and the 2 high mantissa bits: quantiles
+   within 12.5% without keeping (or sorting) the values */
+#define FANN_STAT_BUCKETS 1024
+
+struct fann_stat {
+    uint64_t zero;
+    uint64_t count; // not zero
+    double sum;
+    double sum_sq;
+    float min_abs;
+    float max_abs;
+    uint64_t bucket[FANN_STAT_BUCKETS];
+};
+#endif // FANN_PRINT_STATS
+#endif // FANN_INFERENCE_ONLY
+
+/* owners of the weights of a network other than itself, see weights_shared */
+#define FANN_WEIGHTS_COPY   1
+#define FANN_WEIGHTS_MAPPED 2
+
 /* A single layer in the neural network. */
 struct fann_layer
 {
@@ -422,7 +477,18 @@ struct fann_layer
     /* The values of the activation functions applied to the sum */
     /* FIXME: NO NEED TO USE LAST POSITION (BIAS) */
     fann_type_ff * value; // [num_connections]
-       
+
+#ifdef FIXEDFANN
+    /* int16 copies of the weights (without the BIAS, rows padded to
+     * fann_q16_stride()) and of the inputs of the layer, with their own
+     * fraction bits. NULL unless set by fann_fixed_quantize().
+     */
+    int16_t * q_weight; // [num_neurons * fann_q16_stride(prev. num_neurons)]
+    int16_t * q_value; // [fann_q16_stride(prev. num_neurons)]
+    int_fast8_t q_weight_frac;
+    int_fast8_t q_value_frac;
+#endif
+
 #ifndef FANN_INFERENCE_ONLY
     /* The maximum absolute dot product of weights and inputs *
     fann_type_ff min_abs_sum;
@@ -432,30 +498,10 @@ struct fann_layer
     fann_type_nt max_init;
     fann_type_nt var_init;
 
-    // basic statistics updated only if fann_print_stats is called,
-    // which also resets all the values. Zeros are not included in the
-    // average calculation.
+    // statistics allocated by the first fann_print_stats, which also
+    // resets them. Zeros are not included in the averages.
 #ifdef FANN_PRINT_STATS
-    double avg_abs_error; 
-    double min_abs_error; 
-    double max_abs_error; 
-    unsigned int count_error;
-    unsigned int zero_error;
-    double avg_abs_delta;
-    double min_abs_delta;
-    double max_abs_delta;
-    unsigned int count_delta;
-    unsigned int zero_delta;
-    double avg_abs_slope;
-    double min_abs_slope;
-    double max_abs_slope;
-    unsigned int count_slope;
-    unsigned int zero_slope;
-    double avg_abs_step;
-    double min_abs_step;
-    double max_abs_step;
-    unsigned int count_step;
-    unsigned int zero_step;
+    struct fann_stat *stats; // FANN_STAT_KINDS, NULL if not allocated
 #endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
 };
@@ -470,11 +516,19 @@ struct fann
     pthread_mutex_t mutex;
     unsigned int wait_procs;
     unsigned int num_procs;
+    /* CPU the thread is pinned to, -1 if not pinned */
+    int cpu;
+    struct fann_thread_times times;
 #endif // FANN_THREADS
 #ifndef FANN_INFERENCE_ONLY
     fann_type_ff ** data_input;
     fann_type_ff ** data_output;
     unsigned int data_batch;
+    /* encoding of data_input and data_output, and the row (num_input +
+       num_output values) where encoded rows are expanded */
+    const struct fann_data_codec * data_input_codec;
+    const struct fann_data_codec * data_output_codec;
+    fann_type_ff * data_row;
 
     /* the learning rate of the network */
     fann_type_ff learning_rate; // SAVED
@@ -501,6 +555,11 @@ struct fann
     /* Number of output neurons (not including bias) */
     unsigned int num_output;
 
+    /* sparse input of the last <fann_run_sparse>, NULL after <fann_run> */
+    const unsigned int *sparse_index;
+    const fann_type_ff *sparse_value;
+    unsigned int sparse_nnz;
+
 #ifndef FANN_INFERENCE_ONLY
     /* Unbalance error value adjust */
     fann_type_ff * unbal_er_adjust;
@@ -511,6 +570,10 @@ struct fann
 
     /* if changed to non-zero, update weights more frequently in batch modes */
     unsigned int mini_batch; // SAVED
+
+    /* loss deviation/average ratio of the last mini-batch epoch, used to
+     * fall back to full batches (RPROP) */
+    double mini_batch_ratio;
 #endif // FANN_INFERENCE_ONLY
 
 #ifdef CALCULATE_LOSS
@@ -603,6 +666,9 @@ struct fann
 
     /* Current training epoch */
     unsigned int train_epoch;
+
+    /* Epoch restored by fann_load_checkpoint, where fann_train_on_data resumes */
+    unsigned int resume_epoch;
 #endif // FANN_INFERENCE_ONLY
 
 #ifdef FANN_DATA_SCALE
@@ -641,17 +707,23 @@ struct fann
 
 #ifndef FANN_INFERENCE_ONLY
 #ifdef FANN_PRINT_STATS
-    /* vectors allocated only if fann_print_stats() is called */
-    float *stats_weigs;
-    float *stats_errors;
-    float *stats_deltas; /* batch_deltas or incre_deltas */
-    float *stats_steps;
-    float *stats_slopes;
+    /* stats of all layers, allocated only if fann_print_stats() is called */
+    struct fann_stat *stats;
 #endif // FANN_PRINT_STATS
 #endif // FANN_INFERENCE_ONLY
 #if (defined SWF16_AP) || (defined HWF16)
-    int change_bias;
+    int change_bias; // FANN_BP_BIAS_*
 #endif // (defined SWF16_AP) || (defined HWF16)
+    /* 0 if the weights are freed by fann_destroy, else FANN_WEIGHTS_*:
+     * those of another network (a <fann_copy> of it) or read-only in a
+     * mapping (an attached image or a copy of one) */
+    int weights_shared;
+#ifndef FANN_INFERENCE_ONLY
+    /* read-only image holding the weights, see fann_attach_shared(),
+     * NULL if they are private */
+    void *shared_map;
+    size_t shared_len;
+#endif // FANN_INFERENCE_ONLY
 };
 
 #endif // __fann_data_h__
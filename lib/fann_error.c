@@ -129,6 +129,33 @@ void fann_error(const enum fann_errno_enum errno_f, ...)
     case FANN_E_WRONG_PARAMETERS_FOR_CREATE: 
         fprintf(stderr, "The parameters for create_standard are wrong, either too few parameters provided or a negative/very high value provided.\n");
         break;
+    case FANN_E_CANT_WRITE_CONFIG:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Error writing configuration file \"%s\".\n", s);
+        break;
+    case FANN_E_CHECKPOINT_MISMATCH:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Checkpoint \"%s\" does not match the network or back-end.\n", s);
+        break;
+    case FANN_E_DATA_ENCODED:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Training data is encoded as %s, operation needs FANN_DATA_FF.\n", s);
+        break;
+    case FANN_E_DATA_FORMAT:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Data file \"%s\": the format can not hold this data set.\n", s);
+        break;
+    case FANN_E_METRICS:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Unable to start the metrics: %s.\n", s);
+        break;
+    case FANN_E_MODEL:
+        s = va_arg(ap, char *);
+        fprintf(stderr, "Model: %s.\n", s);
+        break;
+    case FANN_E_WEIGHTS_READ_ONLY:
+        fprintf(stderr, "The weights are in a read-only shared image, the network can not be trained.\n");
+        break;
     }
     va_end(ap);
 }
@@ -57,6 +57,13 @@
     FANN_E_INPUT_NO_MATCH - The number of input neurons in the ann and data don't match
     FANN_E_OUTPUT_NO_MATCH - The number of output neurons in the ann and data don't match
     FANN_E_WRONG_PARAMETERS_FOR_CREATE - The parameters for create_standard are wrong, either too few parameters provided or a negative/very high value provided
+    FANN_E_CANT_WRITE_CONFIG - Error writing, syncing or renaming a configuration or checkpoint file
+    FANN_E_CHECKPOINT_MISMATCH - The checkpoint was saved by another back-end or for another network topology
+    FANN_E_DATA_ENCODED - The operation is not supported on encoded training data
+    FANN_E_DATA_FORMAT - The file format (or the build) does not support the data set
+    FANN_E_METRICS - The metrics thread or its socket can not be started
+    FANN_E_MODEL - A model can not start its loader or install a network
+    FANN_E_WEIGHTS_READ_ONLY - The weights are in an attached image (or a copy of one) and can not be changed
 */
 enum fann_errno_enum
 {
@@ -81,7 +88,14 @@ enum fann_errno_enum
     FANN_E_SCALE_NOT_PRESENT,
     FANN_E_INPUT_NO_MATCH,
     FANN_E_OUTPUT_NO_MATCH,
-    FANN_E_WRONG_PARAMETERS_FOR_CREATE
+    FANN_E_WRONG_PARAMETERS_FOR_CREATE,
+    FANN_E_CANT_WRITE_CONFIG,
+    FANN_E_CHECKPOINT_MISMATCH,
+    FANN_E_DATA_ENCODED,
+    FANN_E_DATA_FORMAT,
+    FANN_E_METRICS,
+    FANN_E_MODEL,
+    FANN_E_WEIGHTS_READ_ONLY
 };
 
 #endif // FANN_INFERENCE_ONLY
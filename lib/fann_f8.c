@@ -0,0 +1,156 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+// 8-bit formats: lookup tables built from an exact decoder and encoder
+
+#include "fann_f8.h"
+
+bool f8_ready = false;
+float f8_to_f32_lut[1 << 8];
+uint8_t f32_to_f8_lut[1 << 16];
+uint8_t f8_add_lut[1 << 16];
+uint8_t f8_mul_lut[1 << 16];
+uint8_t f8_div_lut[1 << 16];
+
+static double f8_decode(uint8_t u)
+{
+#ifdef POSIT8
+    unsigned int bits, run, nbits;
+    int k;
+
+    if (u == 0) {
+        return 0.0;
+    }
+    if (u == F8_NAR_UI) {
+        return NAN;
+    }
+    if (u & 0x80) {
+        return -f8_decode((uint8_t)-u);
+    }
+    // regime: run of equal bits after the sign, then its terminating bit
+    bits = (unsigned int)u << 1; // 7 bits in 7..1
+    for (run = 1; (run < 7) && (((bits >> (7 - run)) & 1) == ((bits >> 7) & 1)); run++);
+    k = ((bits >> 7) & 1) ? (int)run - 1 : -(int)run;
+    nbits = (run < 6) ? 6 - run : 0; // fraction bits after the terminator
+    return ldexp(1.0 + (double)(u & ((1u << nbits) - 1)) / (double)(1u << nbits), k);
+#else
+#ifdef SWF8_E4M3
+    const unsigned int mbits = 3, emax = 15;
+    const int bias = 7;
+#else // SWF8_E5M2
+    const unsigned int mbits = 2, emax = 31;
+    const int bias = 15;
+#endif
+    unsigned int e = (u & 0x7F) >> mbits;
+    unsigned int m = u & ((1u << mbits) - 1);
+    double s = (u & 0x80) ? -1.0 : 1.0;
+
+    if (e == emax) {
+#ifdef SWF8_E4M3
+        if (m == ((1u << mbits) - 1)) {
+            return NAN;
+        }
+#else
+        return (m == 0) ? s * INFINITY : NAN;
+#endif
+    }
+    if (e == 0) {
+        return s * ldexp((double)m, 1 - bias - (int)mbits);
+    }
+    return s * ldexp((double)((1u << mbits) | m), (int)e - bias - (int)mbits);
+#endif
+}
+
+/* d to the nearest code, ties to the even code. The positive codes are in
+   ascending order of value in all three formats. */
+static uint8_t f8_encode(double d)
+{
+    double a = fabs(d), lo, hi;
+    unsigned int c;
+
+    if (isnan(d)) {
+#ifdef POSIT8
+        return F8_NAR_UI;
+#else
+        return 0x7F | (signbit(d) ? 0x80 : 0);
+#endif
+    }
+#ifdef POSIT8
+    if (isinf(d)) {
+        return F8_NAR_UI;
+    }
+    if (a == 0.0) {
+        return 0;
+    }
+#elif defined SWF8_E5M2
+    if (isinf(d)) {
+        return 0x7C | (signbit(d) ? 0x80 : 0);
+    }
+#endif
+    if (a >= f8_to_f32_lut[F8_MAX_UI]) {
+        c = F8_MAX_UI; // saturation (and E4M3 infinities)
+    } else {
+        for (c = 0; (c < F8_MAX_UI) && (f8_to_f32_lut[c + 1] <= a); c++);
+        lo = f8_to_f32_lut[c];
+        hi = f8_to_f32_lut[c + 1];
+        if ((a - lo > hi - a) || ((a - lo == hi - a) && (c & 1))) {
+            c++;
+        }
+#ifdef POSIT8
+        if (c == 0) {
+            c = 1; // never to zero
+        }
+#endif
+    }
+#ifdef POSIT8
+    return (uint8_t)(signbit(d) ? -c : c);
+#else
+    return (uint8_t)(c | (signbit(d) ? 0x80 : 0));
+#endif
+}
+
+void f8_init(void)
+{
+    union { float f; uint32_t u; } v;
+    unsigned int i, j;
+
+    if (f8_ready) {
+        return;
+    }
+    for (i = 0; i < (1 << 8); i++) {
+        f8_to_f32_lut[i] = (float)f8_decode((uint8_t)i);
+    }
+    for (i = 0; i < (1 << 16); i++) {
+        v.u = (uint32_t)i << 16;
+        f32_to_f8_lut[i] = f8_encode(v.f);
+    }
+    // sums, products and quotients of two 8-bit values are exact in double
+    // (quotients are never close enough to a tie to round wrong)
+    for (i = 0; i < (1 << 8); i++) {
+        for (j = 0; j < (1 << 8); j++) {
+            double a = f8_to_f32_lut[i], b = f8_to_f32_lut[j];
+
+            f8_add_lut[(i << 8) | j] = f8_encode(a + b);
+            f8_mul_lut[(i << 8) | j] = f8_encode(a * b);
+            f8_div_lut[(i << 8) | j] = f8_encode(a / b);
+        }
+    }
+    f8_ready = true;
+}
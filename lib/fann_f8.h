@@ -0,0 +1,178 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_f8_h
+#define _fann_f8_h
+
+/* 8-bit formats, one of them at compilation time:
+ *
+ * SWF8_E4M3: OCP FP8 E4M3 (bias 7, subnormals, no infinities,
+ *            NaN = S.1111.111, largest 448)
+ * SWF8_E5M2: OCP FP8 E5M2 (bias 15, subnormals, IEEE infinities and NaNs,
+ *            largest 57344)
+ * POSIT8:    posit<8,0> (NaR = 0x80, largest 64, smallest 1/64)
+ *
+ * All results are rounded to nearest, ties to even. Overflows saturate to
+ * the largest finite value (the OCP "saturate" mode), posits never round
+ * a nonzero value to zero.
+ *
+ * With 256 values per operand, add, mul and div are 64K-entry tables and
+ * fused multiply-add is computed exactly in double and rounded once. The
+ * tables are built by f8_init(), called by fann_const_init() and by the
+ * first conversion from float.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+typedef struct { uint8_t u; } float8_t;
+
+#ifdef SWF8_E4M3
+#define F8_SIGN_MAGNITUDE
+#define F8_MAX_UI 0x7E
+#elif defined SWF8_E5M2
+#define F8_SIGN_MAGNITUDE
+#define F8_MAX_UI 0x7B
+#elif defined POSIT8
+#define F8_MAX_UI 0x7F
+#define F8_NAR_UI 0x80
+#else
+#error "Choose SWF8_E4M3, SWF8_E5M2 or POSIT8"
+#endif
+
+void f8_init(void);
+
+extern bool f8_ready;
+extern float f8_to_f32_lut[1 << 8];
+extern uint8_t f32_to_f8_lut[1 << 16];
+extern uint8_t f8_add_lut[1 << 16];
+extern uint8_t f8_mul_lut[1 << 16];
+extern uint8_t f8_div_lut[1 << 16];
+
+#define f8_index(a, b) (((unsigned int)(a).u << 8) | (b).u)
+
+static inline float f8_to_f32(float8_t a)
+{
+    if (!f8_ready) {
+        f8_init();
+    }
+    return f8_to_f32_lut[a.u];
+}
+
+/* the upper 16 bits of the float, bit 16 doubling as sticky bit: no
+   8-bit format keeps more than 5 fraction bits, so the rounding never
+   depends on bits 15 to 0 otherwise */
+static inline float8_t f32_to_f8(float f)
+{
+    union { float f; uint32_t u; } v;
+    float8_t ret;
+
+    if (!f8_ready) {
+        f8_init();
+    }
+    v.f = f;
+    ret.u = f32_to_f8_lut[(v.u >> 16) | ((v.u & 0xFFFF) != 0)];
+    return ret;
+}
+
+/* rounds d to float toward zero, with the last bit set if inexact
+   (round to odd), so that f32_to_f8() still rounds d correctly */
+static inline float8_t f64_to_f8(double d)
+{
+    union { float f; uint32_t u; } v;
+
+    v.f = (float)d;
+    if ((double)v.f != d) {
+        if (fabs((double)v.f) > fabs(d)) {
+            v.u--;
+        }
+        v.u |= 1;
+    }
+    return f32_to_f8(v.f);
+}
+
+static inline float8_t i32_to_f8(int32_t i)
+{
+    return f64_to_f8((double)i);
+}
+
+static inline float8_t f8_neg(float8_t a)
+{
+#ifdef F8_SIGN_MAGNITUDE
+    a.u ^= 0x80;
+#else
+    a.u = (uint8_t)-a.u; // 0 and NaR are their own negatives
+#endif
+    return a;
+}
+
+static inline float8_t f8_add(float8_t a, float8_t b)
+{
+    float8_t ret;
+
+    ret.u = f8_add_lut[f8_index(a, b)];
+    return ret;
+}
+
+static inline float8_t f8_sub(float8_t a, float8_t b)
+{
+    return f8_add(a, f8_neg(b));
+}
+
+static inline float8_t f8_mul(float8_t a, float8_t b)
+{
+    float8_t ret;
+
+    ret.u = f8_mul_lut[f8_index(a, b)];
+    return ret;
+}
+
+static inline float8_t f8_div(float8_t a, float8_t b)
+{
+    float8_t ret;
+
+    ret.u = f8_div_lut[f8_index(a, b)];
+    return ret;
+}
+
+/* a * b + c, exact in double for all three formats */
+static inline float8_t f8_mulAdd(float8_t a, float8_t b, float8_t c)
+{
+    return f64_to_f8((double)f8_to_f32_lut[a.u] * f8_to_f32_lut[b.u] + f8_to_f32_lut[c.u]);
+}
+
+// comparisons as float: NaNs and NaR compare false
+static inline bool f8_eq(float8_t a, float8_t b)
+{
+    return f8_to_f32_lut[a.u] == f8_to_f32_lut[b.u];
+}
+
+static inline bool f8_le(float8_t a, float8_t b)
+{
+    return f8_to_f32_lut[a.u] <= f8_to_f32_lut[b.u];
+}
+
+static inline bool f8_lt(float8_t a, float8_t b)
+{
+    return f8_to_f32_lut[a.u] < f8_to_f32_lut[b.u];
+}
+
+#endif // _fann_f8_h
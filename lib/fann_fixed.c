@@ -0,0 +1,115 @@
+/*
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  This library was based on the Fast Artificial Neural Network Library.
+  See README.md for details.
+
+*/
+
+// int16 neuron sums with per-layer fraction bits (fixedfann.c only)
+
+FANN_EXTERNAL void FANN_API fann_fixed_release(struct fann *ann)
+{
+    struct fann_layer *layer_it;
+
+    for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+        fann_free(layer_it->q_weight);
+        fann_free(layer_it->q_value);
+    }
+}
+
+#ifndef FANN_INFERENCE_ONLY
+/* the most fraction bits (up to FIX_FRAC) that keep max_abs in int16 */
+static int_fast8_t fann_q16_frac(cpu_type max_abs)
+{
+    int_fast8_t frac = FIX_FRAC;
+
+    while ((frac > 0) && ((max_abs >> (FIX_FRAC - frac)) > INT16_MAX)) {
+        frac--;
+    }
+    return frac;
+}
+
+FANN_EXTERNAL int FANN_API fann_fixed_quantize(struct fann *ann, struct fann_data *data)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    unsigned int num_layers, prev_neurons, stride, i, l, n, w;
+    cpu_type *max_in, max_w;
+
+    if ((fann_check_input_output_sizes(ann, data) == -1) || fann_prepare_data(ann, data)) {
+        return -1;
+    }
+    fann_fixed_release(ann);
+    num_layers = (unsigned int)(ann->last_layer - ann->first_layer);
+    fann_calloc(max_in, num_layers);
+    if (max_in == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+
+    // largest input of each layer, with the int32 sums
+    for (i = 0; i < data->num_data; i++) {
+        fann_run_data_row(ann, data->input[i]);
+        for (prev_layer = ann->first_layer, l = 1; l < num_layers; prev_layer++, l++) {
+            if (prev_layer->value == NULL) {
+                continue; // sparse input
+            }
+            for (n = 0; n < prev_layer->num_neurons; n++) {
+                if (fann_abs(prev_layer->value[n]) > max_in[l]) {
+                    max_in[l] = fann_abs(prev_layer->value[n]);
+                }
+            }
+        }
+    }
+    if (ann->data_input_codec->enc == FANN_DATA_SPARSE) {
+        max_in[1] = 0; // sparse layers keep the int32 sums
+    }
+
+    for (prev_layer = ann->first_layer, l = 1; l < num_layers; prev_layer++, l++) {
+        layer_it = prev_layer + 1;
+        if (max_in[l] == 0) {
+            continue;
+        }
+        prev_neurons = prev_layer->num_neurons;
+        stride = fann_q16_stride(prev_neurons);
+        fann_calloc(layer_it->q_weight, layer_it->num_neurons * stride);
+        fann_calloc(layer_it->q_value, stride);
+        if ((layer_it->q_weight == NULL) || (layer_it->q_value == NULL)) {
+            fann_free(max_in);
+            fann_fixed_release(ann);
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            return -1;
+        }
+        max_w = 0;
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            for (w = 0; w < prev_neurons; w++) {
+                if (fann_abs(layer_it->neuron[n].weight[w]) > max_w) {
+                    max_w = fann_abs(layer_it->neuron[n].weight[w]);
+                }
+            }
+        }
+        layer_it->q_weight_frac = fann_q16_frac(max_w);
+        layer_it->q_value_frac = fann_q16_frac(max_in[l]);
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            fann_q16_values(layer_it->q_weight + n * stride, layer_it->neuron[n].weight,
+                            prev_neurons, layer_it->q_weight_frac);
+        }
+    }
+    fann_free(max_in);
+    return 0;
+}
+#endif // FANN_INFERENCE_ONLY
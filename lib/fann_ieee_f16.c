@@ -1561,3 +1561,135 @@ uint_fast8_t softfloat_countLeadingZeros16( uint16_t a )
 }
 
 
+
+#ifdef FANN_F16_FAST
+#include <math.h>
+
+// half to double, exact; NaN for infinities and NaNs (SoftFloat handles them)
+static inline double f16_fast_toDouble( uint_fast16_t uiA )
+{
+    union { double d; uint64_t u; } v;
+
+    if ( (uiA & 0x7C00) == 0x7C00 ) return NAN;
+    if ( uiA & 0x7C00 ) {
+        v.u = ((uint64_t) (uiA & 0x7FFF)<<42) + ((uint64_t) (1023 - 15)<<52);
+    } else {
+        v.d = (double) (uiA & 0x03FF) * 0x1p-24; // subnormal, no float subnormals
+    }
+    v.u |= (uint64_t) (uiA & 0x8000)<<48;
+    return v.d;
+}
+
+// zero or normal results only, the rest is done by SoftFloat
+#define f16_fast_inRange( z ) (((fabs( z ) >= 0x1p-14) && (fabs( z ) < 65504.0)) || ((z) == 0.0))
+
+// round to nearest even, z in range
+static inline float16_t f16_fast_roundPack( double z )
+{
+    union { double d; uint64_t u; } v;
+    uint_fast64_t mag;
+    float16_t ret;
+
+    v.d = z;
+    mag = v.u & UINT64_C( 0x7FFFFFFFFFFFFFFF );
+    softfloat_exceptionFlags |= (uint_fast8_t) ((mag & ((UINT64_C( 1 )<<42) - 1)) != 0); // inexact
+    // 42 bits dropped: half minus one, plus the kept lsb for the ties
+    mag += ((UINT64_C( 1 )<<41) - 1) + ((mag>>42) & 1);
+    ret.u = (uint16_t) (v.u>>48) & 0x8000;
+    if ( mag>>42 ) {
+        ret.u |= (uint16_t) ((mag>>42) - ((uint_fast64_t) (1023 - 15)<<10));
+    }
+    return ret;
+}
+
+float16_t f16_add_fast( float16_t a, float16_t b )
+{
+    double z;
+
+    if ( softfloat_roundingMode != softfloat_round_near_even ) return f16_add( a, b );
+    z = f16_fast_toDouble( a.u ) + f16_fast_toDouble( b.u ); // exact
+    if ( ! f16_fast_inRange( z ) ) return f16_add( a, b );
+    return f16_fast_roundPack( z );
+}
+
+float16_t f16_sub_fast( float16_t a, float16_t b )
+{
+    double z;
+
+    if ( softfloat_roundingMode != softfloat_round_near_even ) return f16_sub( a, b );
+    z = f16_fast_toDouble( a.u ) - f16_fast_toDouble( b.u ); // exact
+    if ( ! f16_fast_inRange( z ) ) return f16_sub( a, b );
+    return f16_fast_roundPack( z );
+}
+
+float16_t f16_mul_fast( float16_t a, float16_t b )
+{
+    double z;
+
+    if ( softfloat_roundingMode != softfloat_round_near_even ) return f16_mul( a, b );
+    z = f16_fast_toDouble( a.u ) * f16_fast_toDouble( b.u ); // exact
+    if ( ! f16_fast_inRange( z ) ) return f16_mul( a, b );
+    return f16_fast_roundPack( z );
+}
+
+float16_t f16_div_fast( float16_t a, float16_t b )
+{
+    double z;
+
+    if ( softfloat_roundingMode != softfloat_round_near_even ) return f16_div( a, b );
+    // 53 >= 2 * 11 + 2 bits: rounding twice is the same as rounding once
+    z = f16_fast_toDouble( a.u ) / f16_fast_toDouble( b.u );
+    if ( ! f16_fast_inRange( z ) ) return f16_div( a, b );
+    return f16_fast_roundPack( z );
+}
+
+float16_t f16_mulAdd_fast( float16_t a, float16_t b, float16_t c )
+{
+    double prod, addend, z, err, bb;
+    union { double d; uint64_t u; } v;
+    uint64_t inexact;
+
+    if ( softfloat_roundingMode != softfloat_round_near_even ) return f16_mulAdd( a, b, c );
+    // zero product of finite operands and a finite, non zero c: c itself
+    if ( ((! (a.u & 0x7FFF) && ((b.u & 0x7C00) != 0x7C00)) || (! (b.u & 0x7FFF) && ((a.u & 0x7C00) != 0x7C00)))
+         && (c.u & 0x7FFF) && ((c.u & 0x7C00) != 0x7C00) ) {
+        return c;
+    }
+    prod = f16_fast_toDouble( a.u ) * f16_fast_toDouble( b.u ); // exact
+    addend = f16_fast_toDouble( c.u );
+    z = prod + addend;
+    // the rounding error of the sum (TwoSum), then z rounded to odd instead
+    bb = z - prod;
+    err = (prod - (z - bb)) + (addend - bb);
+    // inexact: truncated (one step down when z was rounded away from zero)
+    // with the last bit set
+    inexact = (err != 0.0);
+    v.d = z;
+    v.u = (v.u - (inexact & ((err < 0.0) != (z < 0.0)))) | inexact;
+    z = v.d;
+    if ( ! f16_fast_inRange( z ) ) return f16_mulAdd( a, b, c );
+    return f16_fast_roundPack( z );
+}
+
+void f16_mulAdd_array( float16_t *y, float16_t a, const float16_t *x, unsigned int n )
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        y[i] = f16_mulAdd_fast( a, x[i], y[i] );
+    }
+}
+
+void f16_mulAdd_rows( float16_t *sum, float16_t * const *rows, const float16_t *x,
+                      unsigned int num_rows, unsigned int n )
+{
+    unsigned int i, r;
+
+    // independent rows interleaved
+    for (i = 0; i < n; i++) {
+        for (r = 0; r < num_rows; r++) {
+            sum[r] = f16_mulAdd_fast( rows[r][i], x[i], sum[r] );
+        }
+    }
+}
+#endif // FANN_F16_FAST
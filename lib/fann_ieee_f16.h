@@ -492,6 +492,33 @@ float16_t f32_to_f16( float32_t a );
 #define FP_BIAS 15
 #define FP_BIAS_DEFAULT 15
 
+/*----------------------------------------------------------------------------
+| Hardware assisted operations, bit-exact with the SoftFloat ones above
+| (exception flags included) in round-to-nearest-even. Operands are widened
+| to double, where products and sums of two halves are exact, and rounded
+| once to half; the sum of mulAdd is kept in round-to-odd (53 bits) so that
+| the final rounding is not a double rounding. Non-finite operands, results
+| below the normal range or above the largest finite value and other
+| rounding modes fall back to SoftFloat, which stays the reference.
+*----------------------------------------------------------------------------*/
+#undef FANN_F16_FAST // SoftFloat reference only
+#define FANN_F16_FAST
+
+#ifdef FANN_F16_FAST
+float16_t f16_add_fast( float16_t, float16_t );
+float16_t f16_sub_fast( float16_t, float16_t );
+float16_t f16_mul_fast( float16_t, float16_t );
+float16_t f16_mulAdd_fast( float16_t, float16_t, float16_t );
+float16_t f16_div_fast( float16_t, float16_t );
+
+#define F16_LANES 16
+// y[i] = a * x[i] + y[i]
+void f16_mulAdd_array( float16_t *y, float16_t a, const float16_t *x, unsigned int n );
+// sum[r] += rows[r][i] * x[i], for i = 0..n-1 in order, r < num_rows <= F16_LANES
+void f16_mulAdd_rows( float16_t *sum, float16_t * const *rows, const float16_t *x,
+                      unsigned int num_rows, unsigned int n );
+#endif // FANN_F16_FAST
+
 //#define F16_MAX 6.550400000000e+04
 //#define F16_MIN 6.10351562500000e-05 // normal
 //#define F16_MIN 5.9604644775390625000000e-08 
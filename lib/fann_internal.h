@@ -53,33 +53,52 @@ int fann_save_data_internal_fd(struct fann_data *data, FILE * file);//, const ch
 #define fann_error(...)
 #else
 void fann_error(const enum fann_errno_enum errno_f, ...);
-void FANN_API fann_enable_batch_stats(void);
 void fann_reset_batch_stats(struct fann_layer *layer_it);
-void FANN_API fann_batch_stats(struct fann *ann);
+#ifdef FANN_PRINT_STATS
+void fann_stat_add(struct fann_stat *st, float x);
+/* adds x of the bp type to the stats of a layer, when allocated */
+#define fann_stat_bp(stats, kind, x) {if ((stats) != NULL) fann_stat_add((stats) + (kind), fann_bp_to_float(x));}
+#else
+#define fann_stat_bp(stats, kind, x)
+#endif // FANN_PRINT_STATS
 void fann_print_structure(struct fann *ann, const char *file, const char* function, const int line);
 #endif // FANN_INFERENCE_ONLY
 
 #ifndef FANN_INFERENCE_ONLY
 struct fann *fann_create_from_fd(FILE * conf, const char *configuration_file);
 struct fann_data *fann_read_data_from_fd(FILE * file, const char *filename);
+FILE *fann_open_data_file(const char *filename, const char *mode, int *piped);
+int fann_close_data_file(FILE *file, int piped);
 int fann_check_input_output_sizes(struct fann *ann, struct fann_data *data);
+/* -1 (reported) if the weights are read-only, in an attached image */
+int fann_check_weights_writable(struct fann *ann);
 #endif // FANN_INFERENCE_ONLY
 
 void fann_run_layer(struct fann_layer *layer_it, struct fann_layer *prev_layer);
 
 #ifndef FANN_INFERENCE_ONLY
 int fann_compute_loss(struct fann *ann, fann_type_ff * desired_output);
+#ifdef CALCULATE_ERROR
+fann_type_ff *fann_test_output(struct fann *ann, fann_type_ff * output_begin,
+                               fann_type_ff * desired_output);
+#endif // CALCULATE_ERROR
 void fann_update_output_weights(struct fann *ann);
 void fann_backpropagate_loss(struct fann *ann);
 void fann_update_weights_incremental(struct fann *ann);
 void fann_update_slopes_batch(struct fann *ann);
+#ifdef FANN_QUIRE_DOT
+void fann_round_weight_slopes(struct fann *ann);
+#else
+#define fann_round_weight_slopes(ann)
+#endif
 void fann_update_weights_rmsprop(struct fann *ann,// unsigned int num_data,
         struct fann_layer *layer_begin, struct fann_layer *layer_end);
 //void fann_update_weights_quickprop(struct fann *ann, unsigned int num_data,
 //        struct fann_layer *layer_begin, struct fann_layer *layer_end);
 void fann_update_weights_batch(struct fann *ann,// unsigned int num_data,
         struct fann_layer *layer_begin, struct fann_layer *layer_end);
-void fann_update_weights_irpropm(struct fann *ann);
+/* self: the network of the calling thread, whose stats are added to */
+void fann_update_weights_irpropm(struct fann *ann, struct fann *self);
 //void fann_update_weights_sarprop(struct fann *ann, unsigned int epoch, unsigned int first_weight,
 //                                unsigned int past_end);
 
@@ -88,6 +107,11 @@ void fann_clear_batch_deltas(struct fann *ann,
                             struct fann_layer *layer_begin, struct fann_layer *layer_end);
 
 int fann_desired_error_reached(struct fann *ann, float desired_error);
+
+#define FANN_RAND_STATE_WORDS 32
+void fann_rand_get_state(int32_t * state);
+void fann_rand_set_state(const int32_t * state);
+int fann_reorder_data(struct fann_data *data, const unsigned int *order);
 #endif // FANN_INFERENCE_ONLY
 
 #ifdef FANN_DATA_SCALE
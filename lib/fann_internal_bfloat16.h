@@ -17,13 +17,13 @@ typedef union { float f; uint32_t u; } fcpu;
 #else // round to nearest:
 #define cpu_bp(x) ({fann_type_bp ret; uint32_t e, m, s; \
                     e = (x).u & 0x7F800000; s = (x).u & 0x80000000; \
-                    if (e == 0) { ret.u = s; } else if (e == 0x7F800000) { ret.u = s | 0x7FFFFFFF; } else { \
+                    if (e == 0) { ret.u = s; } else if (((x).u & 0x7FFFFFFF) > 0x7F800000) { ret.u = (s | 0x7FFFFFFF) >> 16; } else { \
                     m = ((x).u & 0x007FFFFF) | 0x00800000; \
                     m += 0x00007FFF; if (m & 0x01000000) {m >>= 1; e += 0x00800000;} m &= 0x007FFFFF; \
                     ret.u = ((s | e | m) >> 16);} ret;})
 #define cpu_ff(x) ({fann_type_ff ret; uint32_t e, m, s; \
                     e = (x).u & 0x7F800000; s = (x).u & 0x80000000; \
-                    if (e == 0) { ret.u = s; } else if (e == 0x7F800000) { ret.u = s | 0x7FFFFFFF; } else { \
+                    if (e == 0) { ret.u = s; } else if (((x).u & 0x7FFFFFFF) > 0x7F800000) { ret.u = (s | 0x7FFFFFFF) >> 16; } else { \
                     m = ((x).u & 0x007FFFFF) | 0x00800000; \
                     m += 0x00007FFF; if (m & 0x01000000) {m >>= 1; e += 0x00800000;} m &= 0x007FFFFF; \
                     ret.u = ((s | e | m) >> 16);} ret;})
@@ -105,4 +105,134 @@ typedef union { float f; uint32_t u; } fcpu;
 #define fann_nt_div(x, y)           ((x) / (y))
 #define fann_nt_mac(x, y, c)        ((x) * (y) + (c))
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+// 8 bf16 to 2x4 floats: the bf16 bits are the upper half of the float
+#define fann_bf16_lo_sse2(h) _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), (h)))
+#define fann_bf16_hi_sse2(h) _mm_castsi128_ps(_mm_unpackhi_epi16(_mm_setzero_si128(), (h)))
+
+/* 4 floats as cpu_ff() / cpu_bp(): zeros for subnormals, 0x7F80 / 0xFF80 for +/-Inf (and
+   overflows), 0x7FFF / 0xFFFF for NaN, sign extended */
+static inline __m128i fann_float_to_bfloat16_sse2(__m128 v)
+{
+    __m128i f = _mm_castps_si128(v);
+    __m128i e = _mm_and_si128(f, _mm_set1_epi32(0x7f800000));
+    __m128i sign = _mm_and_si128(f, _mm_set1_epi32(0x80000000));
+    __m128i is_sub = _mm_cmpeq_epi32(e, _mm_setzero_si128());
+    __m128i is_nan = _mm_cmpgt_epi32(_mm_xor_si128(f, sign), _mm_set1_epi32(0x7f800000));
+    __m128i ret;
+
+    // Inf rounds to itself, the largest floats round up to Inf
+    ret = _mm_add_epi32(_mm_xor_si128(f, sign), _mm_set1_epi32(0x7fff));
+    ret = _mm_andnot_si128(is_sub, _mm_or_si128(ret, sign));
+    // the rounding can carry a NaN into the sign bit: replace, don't or
+    ret = _mm_or_si128(_mm_andnot_si128(is_nan, ret),
+                       _mm_and_si128(is_nan, _mm_or_si128(sign, _mm_set1_epi32(0x7fffffff))));
+    return _mm_srai_epi32(ret, 16);
+}
+#endif // __SSE2__
+
+// bf16 kernels: dot products and error sums in fp32 vectors, one rounding per neuron
+//#define FANN_BF16_KERNELS // instead of the per operation macros above only
+
+#if (defined FANN_BF16_KERNELS) && (defined __SSE2__)
+#ifdef __AVX512BF16__
+#include <immintrin.h>
+#endif
 
+#define FANN_FF_DOT        // fann_ff_dot(), fann_ff_dot_index() (see fann_run_layer)
+#define FANN_BP_FLOAT_ACC  // fann_bp_axpy_float() (see fann_backpropagate_loss)
+#define FANN_BP_MAC_ARRAY  // fann_bp_mac_ff_array() (see fann_update_slopes_batch)
+
+/* c + sum(a[i] * in[i]) in fp32: the products are exact, the sum is not
+   rounded to bf16 until fann_nt_to_ff() */
+static inline float fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *in,
+                                unsigned int n)
+{
+    float sum;
+    unsigned int i = 0;
+#ifdef __AVX512BF16__
+    __m512 acc = _mm512_setzero_ps();
+
+    // vdpbf16ps: pairs of products added to 16 fp32 lanes
+    for (; i + 32 <= n; i += 32) {
+        acc = _mm512_dpbf16_ps(acc, (__m512bh)_mm512_loadu_si512((const void *)(a + i)),
+                                    (__m512bh)_mm512_loadu_si512((const void *)(in + i)));
+    }
+    sum = _mm512_reduce_add_ps(acc);
+#else
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    __m128 s;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vx = _mm_loadu_si128((const __m128i *)(in + i));
+
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(fann_bf16_lo_sse2(va), fann_bf16_lo_sse2(vx)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(fann_bf16_hi_sse2(va), fann_bf16_hi_sse2(vx)));
+    }
+    s = _mm_add_ps(sum0, sum1);
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    sum = _mm_cvtss_f32(s);
+#endif // __AVX512BF16__
+    sum += fann_ff_to_float(c);
+    for (; i < n; i++) {
+        sum += fann_ff_to_float(a[i]) * fann_ff_to_float(in[i]);
+    }
+    return sum;
+}
+
+static inline float fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                                      const fann_type_ff *in, unsigned int n)
+{
+    float sum = fann_ff_to_float(c);
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        sum += fann_ff_to_float(a[index[i]]) * fann_ff_to_float(in[i]);
+    }
+    return sum;
+}
+
+#ifndef FANN_INFERENCE_ONLY
+// acc[i] += a * in[i] in fp32, rounded by the caller
+static inline void fann_bp_axpy_float(float *acc, fann_type_bp a, const fann_type_ff *in, unsigned int n)
+{
+    __m128 va = _mm_set1_ps(fann_bp_to_float(a));
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i vx = _mm_loadu_si128((const __m128i *)(in + i));
+
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(va, fann_bf16_lo_sse2(vx))));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(va, fann_bf16_hi_sse2(vx))));
+    }
+    for (; i < n; i++) {
+        acc[i] += fann_bp_to_float(a) * fann_ff_to_float(in[i]);
+    }
+}
+
+// out[i] = fann_bp_mac(a, fann_ff_to_bp(in[i]), out[i]), same results
+static inline void fann_bp_mac_ff_array(fann_type_bp *out, fann_type_bp a, const fann_type_ff *in, unsigned int n)
+{
+    __m128 va = _mm_set1_ps(fann_bp_to_float(a));
+    unsigned int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i vx = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i vy = _mm_loadu_si128((const __m128i *)(out + i));
+        __m128 lo = _mm_add_ps(_mm_mul_ps(va, fann_bf16_lo_sse2(vx)), fann_bf16_lo_sse2(vy));
+        __m128 hi = _mm_add_ps(_mm_mul_ps(va, fann_bf16_hi_sse2(vx)), fann_bf16_hi_sse2(vy));
+
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(fann_float_to_bfloat16_sse2(lo),
+                                                             fann_float_to_bfloat16_sse2(hi)));
+    }
+    for (; i < n; i++) {
+        out[i] = fann_bp_mac(a, fann_ff_to_bp(in[i]), out[i]);
+    }
+}
+#endif // FANN_INFERENCE_ONLY
+#endif // FANN_BF16_KERNELS && __SSE2__
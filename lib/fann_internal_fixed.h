@@ -133,3 +133,138 @@ behaviour for your compiler/processor. Even when supported by hardware,
 #define fann_nt_mac(x, y, c)        ((x) * (y) + (c))
 
 
+// saturated to the int32 range
+#define cpu_sat(x) ((cpu_type)(((x) > INT32_MAX) ? INT32_MAX : (((x) < INT32_MIN) ? INT32_MIN : (x))))
+
+/* Neuron sums (fann_run_layer) in integers, instead of fann_type_nt:
+ *
+ * fann_ff_dot():  Q.FIX_FRAC weights and values, products summed in 64 bits
+ *                 (2 per pmuldq), shifted once and saturated.
+ * fann_q16_dot(): int16 weights and values with the fraction bits of each
+ *                 layer (fann_fixed_quantize()), 8 products per pmaddwd
+ *                 (16 with AVX2), also summed in 64 bits.
+ */
+#define FANN_FF_DOT
+
+#if (defined __SSE4_1__) || (defined __AVX2__)
+#include <immintrin.h>
+#endif
+
+// int16 rows and inputs padded with zeros to whole vectors
+#define FANN_Q16_PAD 16
+#define fann_q16_stride(n) (((n) + FANN_Q16_PAD - 1) & ~(FANN_Q16_PAD - 1))
+
+/* s with frac fraction bits to Q.FIX_FRAC, rounded to nearest and
+   saturated */
+static inline cpu_type fann_fixed_rescale(int64_t s, int frac)
+{
+    if (frac > FIX_FRAC) {
+        s = (s + ((int64_t)1 << (frac - FIX_FRAC - 1))) >> (frac - FIX_FRAC);
+    } else if (frac < FIX_FRAC) {
+        if ((s > (INT32_MAX >> (FIX_FRAC - frac))) || (s < (INT32_MIN >> (FIX_FRAC - frac)))) {
+            return (s > 0) ? INT32_MAX : INT32_MIN;
+        }
+        s *= (int64_t)1 << (FIX_FRAC - frac);
+    }
+    return cpu_sat(s);
+}
+
+// c + s, saturated
+static inline cpu_type fann_fixed_add_sat(cpu_type c, cpu_type s)
+{
+    int64_t r = (int64_t)c + s;
+
+    return cpu_sat(r);
+}
+
+static inline fann_type_nt fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *in,
+                                       unsigned int n)
+{
+    int64_t sum = 0;
+    unsigned int i = 0;
+#ifdef __SSE4_1__
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vx = _mm_loadu_si128((const __m128i *)(in + i));
+
+        // elements 0 and 2, then 1 and 3
+        acc0 = _mm_add_epi64(acc0, _mm_mul_epi32(va, vx));
+        acc1 = _mm_add_epi64(acc1, _mm_mul_epi32(_mm_srli_epi64(va, 32), _mm_srli_epi64(vx, 32)));
+    }
+    acc0 = _mm_add_epi64(acc0, acc1);
+    sum = _mm_cvtsi128_si64(acc0) + _mm_extract_epi64(acc0, 1);
+#endif
+    for (; i < n; i++) {
+        sum += (int64_t)a[i] * in[i];
+    }
+    return cpu_to_float(fann_fixed_add_sat(c, fann_fixed_rescale(sum, 2 * FIX_FRAC)));
+}
+
+static inline fann_type_nt fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                                             const fann_type_ff *in, unsigned int n)
+{
+    int64_t sum = 0;
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        sum += (int64_t)a[index[i]] * in[i];
+    }
+    return cpu_to_float(fann_fixed_add_sat(c, fann_fixed_rescale(sum, 2 * FIX_FRAC)));
+}
+
+// Q.FIX_FRAC values to int16 with frac fraction bits, rounded and saturated
+static inline void fann_q16_values(int16_t *q, const cpu_type *v, unsigned int n, int frac)
+{
+    const int shift = FIX_FRAC - frac;
+    unsigned int i;
+    int64_t t;
+
+    for (i = 0; i < n; i++) {
+        t = (shift > 0) ? (((int64_t)v[i] + ((int64_t)1 << (shift - 1))) >> shift) : ((int64_t)v[i] << -shift);
+        q[i] = (int16_t)((t > INT16_MAX) ? INT16_MAX : ((t < -INT16_MAX) ? -INT16_MAX : t));
+    }
+}
+
+/* c + a[] * in[], n a multiple of FANN_Q16_PAD. The int16 values are
+   limited to +-INT16_MAX, so each pair sum of pmaddwd fits in int32. */
+static inline fann_type_nt fann_q16_dot(fann_type_ff c, const int16_t *a, const int16_t *in,
+                                        unsigned int n, int frac)
+{
+    int64_t sum = 0;
+    unsigned int i = 0;
+#ifdef __AVX2__
+    __m256i acc = _mm256_setzero_si256();
+    __m128i s;
+
+    for (; i < n; i += 16) {
+        __m256i p = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                      _mm256_loadu_si256((const __m256i *)(in + i)));
+
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(p)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(p, 1)));
+    }
+    s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+#elif defined __SSE4_1__
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+
+    for (; i < n; i += 8) {
+        __m128i p = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)),
+                                   _mm_loadu_si128((const __m128i *)(in + i)));
+
+        acc0 = _mm_add_epi64(acc0, _mm_cvtepi32_epi64(p));
+        acc1 = _mm_add_epi64(acc1, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(p, p)));
+    }
+    acc0 = _mm_add_epi64(acc0, acc1);
+    sum = _mm_cvtsi128_si64(acc0) + _mm_extract_epi64(acc0, 1);
+#else
+    for (; i < n; i++) {
+        sum += (int32_t)a[i] * in[i];
+    }
+#endif
+    return cpu_to_float(fann_fixed_add_sat(c, fann_fixed_rescale(sum, frac)));
+}
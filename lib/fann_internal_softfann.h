@@ -7,6 +7,9 @@ unsigned int fann_bp_fpu_limits(double *min_neg, double *max_neg, double *min_po
 #elif defined SWF16
 #define fann_ff_bin_set(ff, val) ((ff).u = (uint16_t)(val))
 #define fann_bp_bin_set(ff, val) ((bp).u = (uint16_t)(val))
+#elif defined SWF8
+#define fann_ff_bin_set(ff, val) ((ff).u = (uint8_t)(val))
+#define fann_bp_bin_set(ff, val) ((bp).u = (uint8_t)(val))
 #endif
 //int fann_ff_to_int(fann_type_ff f);
 float fann_ff_to_float(fann_type_ff f);
@@ -43,6 +46,22 @@ int fann_ff_is_zero(fann_type_ff x);
 #define fann_ff_is_non_zero(x) (((x).f)!=0.0)
 #endif // ! EMUL_FLOAT
 
+#ifdef FANN_MAC_LANES
+/* same results (and counters) as fann_ff_mac() over each row in order,
+   num_rows <= FANN_MAC_LANES rows at a time */
+void fann_ff_mac_rows(fann_type_ff *sum, fann_type_ff * const *rows, const fann_type_ff *x,
+                      unsigned int num_rows, unsigned int n);
+#endif // FANN_MAC_LANES
+
+#ifdef FANN_FF_DOT
+/* c + sum(a[i] * x[i]) (dense) or c + sum(a[index[i]] * x[i]) (sparse),
+   accumulated in a wider format (exactly for posits) and rounded once */
+fann_type_ff fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *x,
+                         unsigned int n);
+fann_type_ff fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                               const fann_type_ff *x, unsigned int n);
+#endif // FANN_FF_DOT
+
 #ifndef FANN_INFERENCE_ONLY
 
 fann_type_bp fann_ff_to_bp(fann_type_ff n);
@@ -53,7 +72,7 @@ fann_type_bp fann_int_to_bp(int i);
 
 #if (defined SWF16_AP) || (defined HWF16)
 fann_type_bp fann_bp_to_bp(fann_type_bp n, int_fast8_t bp_bias);
-#elif (defined SWF16_IEEE) || (defined SWF32_IEEE) || (defined POSIT16)
+#elif (defined SWF16_IEEE) || (defined SWF32_IEEE) || (defined POSIT16) || (defined SWF8)
 #define fann_bp_to_bp(n, b) (n)
 #else
 #error "SOFTFANN definition"
@@ -89,6 +108,21 @@ int fann_bp_is_zero(fann_type_bp x);
 #define fann_bp_is_zero(x) (((x).f)==0.0)
 #define fann_bp_is_non_zero(x) (((x).f)!=0.0)
 #endif // EMUL_FLOAT
+#ifdef FANN_BP_MAC_ARRAY
+// y[i] = fann_bp_mac(a, fann_ff_to_bp(x[i]), y[i])
+void fann_bp_mac_ff_array(fann_type_bp *y, fann_type_bp a, const fann_type_ff *x, unsigned int n);
+// y[i] = fann_bp_mac(a, x[i], y[i])
+void fann_bp_mac_array(fann_type_bp *y, fann_type_bp a, const fann_type_bp *x, unsigned int n);
+#endif // FANN_BP_MAC_ARRAY
+#ifdef FANN_QUIRE_DOT
+/* exact sums of bp products, rounded only by fann_quire_to_bp() */
+#define fann_quire_clr(q) q16_clr(q)
+fann_quire fann_bp_to_quire(fann_type_bp c);
+fann_quire fann_quire_mac(fann_quire q, fann_type_bp x, fann_type_bp y);
+fann_type_bp fann_quire_to_bp(fann_quire q);
+// q[i] += a * fann_ff_to_bp(x[i])
+void fann_quire_mac_ff_array(fann_quire *q, fann_type_bp a, const fann_type_ff *x, unsigned int n);
+#endif // FANN_QUIRE_DOT
 #endif // FANN_INFERENCE_ONLY
 
 /* native type for temporary calculations: */
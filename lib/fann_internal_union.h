@@ -66,4 +66,51 @@
 #define fann_nt_div(x, y)           ((x) / (y))
 #define fann_nt_mac(x, y, c)        ((x) * (y) + (c))
 
+#if ((defined _GCC_ARM_F16_FF) || (defined _GCC_ARM_F16_BP)) && (defined __F16C__)
+#include <immintrin.h>
 
+// x86 binary16: neuron sums in fp32 vectors, as fann_type_nt (see fann_run_layer)
+#define FANN_FF_DOT
+
+static inline float fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *x,
+                                unsigned int n)
+{
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    __m128 s;
+    float sum;
+    unsigned int i = 0;
+
+#define fann_f16c_load(p) _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(p)))
+    for (; i + 16 <= n; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(fann_f16c_load(a + i), fann_f16c_load(x + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(fann_f16c_load(a + i + 8), fann_f16c_load(x + i + 8)));
+    }
+    if (i + 8 <= n) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(fann_f16c_load(a + i), fann_f16c_load(x + i)));
+        i += 8;
+    }
+#undef fann_f16c_load
+    sum0 = _mm256_add_ps(sum0, sum1);
+    s = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    sum = (float)c.f + _mm_cvtss_f32(s);
+    for (; i < n; i++) {
+        sum += (float)a[i].f * (float)x[i].f;
+    }
+    return sum;
+}
+
+static inline float fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                                      const fann_type_ff *x, unsigned int n)
+{
+    float sum = (float)c.f;
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        sum += (float)a[index[i]].f * (float)x[i].f;
+    }
+    return sum;
+}
+#endif // binary16 && __F16C__
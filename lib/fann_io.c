@@ -27,6 +27,14 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/memfd.h>
 
 #include "fann.h"
 #include "fann_data.h"
@@ -223,6 +231,556 @@ int fann_save_internal_fd(struct fann *ann, FILE * conf)//, const char *configur
     //return calculated_decimal_point;
     return 0;
 }
+
+/* Checkpoints
+   Binary snapshot of the network and of everything needed to continue the
+   training bit-exactly: weights, optimizer arrays, fp16 bias state, rand()
+   state, epoch and the order of the shuffled training data. The layout is
+   native (same machine and back-end only), followed by a FNV-1a hash.
+ */
+
+#define FANN_CKPT_MAGIC   "FANNCKP1"
+#define FANN_CKPT_SLOPES  1
+#define FANN_CKPT_STEPS   2
+#define FANN_CKPT_PSLOPES 4
+
+extern unsigned int fann_train_shuffle;
+
+/* the single checkpoint being written in background */
+static struct {
+    pthread_t thread;
+    int busy;
+    int retval;
+    enum fann_errno_enum error; // of the writer, reported by the caller's thread
+    unsigned char *buf;
+    size_t len;
+    char *file;
+} fann_ckpt;
+
+static uint64_t fann_ckpt_hash(const unsigned char *buf, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    while (len--) {
+        h ^= *buf++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+#define CKPT_PUT(ptr, len) { \
+    if (dst != NULL) \
+        memcpy(dst + pos, ptr, len); \
+    pos += len; }
+#define CKPT_PUT_U32(val) { uint32_t put_u32 = (val); CKPT_PUT(&put_u32, sizeof(put_u32)); }
+
+/* INTERNAL FUNCTION
+   Serialize the training state into dst, or only compute its size if dst is NULL.
+ */
+static size_t fann_ckpt_serialize(struct fann *ann, struct fann_data *data, unsigned char *dst)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    struct fann_neuron *neuron_it;
+    int32_t rand_state[FANN_RAND_STATE_WORDS];
+    size_t pos = 0;
+    unsigned int n, num_con;
+    uint32_t u32;
+    int32_t bias;
+
+    CKPT_PUT(FANN_CKPT_MAGIC, 8);
+    CKPT_PUT_U32(sizeof(fann_type_ff));
+    CKPT_PUT_U32(sizeof(fann_type_bp));
+    CKPT_PUT_U32(strlen(fann_float_type));
+    CKPT_PUT(fann_float_type, strlen(fann_float_type));
+    CKPT_PUT_U32(ann->last_layer - ann->first_layer);
+    for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+        CKPT_PUT_U32(layer_it->num_neurons);
+        CKPT_PUT_U32(layer_it->activation);
+    }
+    CKPT_PUT_U32(ann->train_epoch);
+    CKPT_PUT_U32(fann_train_shuffle);
+    CKPT_PUT_U32(ann->training_algorithm);
+    CKPT_PUT_U32(ann->mini_batch);
+    CKPT_PUT(&ann->mini_batch_ratio, sizeof(ann->mini_batch_ratio));
+    CKPT_PUT(&ann->learning_rate, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->learning_momentum, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rmsprop_avg, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rmsprop_1mavg, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rprop_increase_factor, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rprop_decrease_factor, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rprop_delta_min, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rprop_delta_max, sizeof(fann_type_ff));
+    CKPT_PUT(&ann->rprop_delta_zero, sizeof(fann_type_ff));
+#if (defined SWF16_AP) || (defined HWF16)
+    CKPT_PUT_U32(ann->change_bias);
+#else
+    CKPT_PUT_U32(0);
+#endif
+    if (dst != NULL)
+        fann_rand_get_state(rand_state);
+    CKPT_PUT(rand_state, sizeof(rand_state));
+
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        num_con = prev_layer->num_connections;
+        CKPT_PUT(&layer_it->max_init, sizeof(fann_type_nt));
+        CKPT_PUT(&layer_it->var_init, sizeof(fann_type_nt));
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            neuron_it = layer_it->neuron + n;
+#if (defined SWF16_AP) || (defined HWF16)
+            bias = neuron_it->bp_fp16_bias;
+            CKPT_PUT(&bias, sizeof(bias));
+            CKPT_PUT_U32(neuron_it->bp_batch_overflows);
+            CKPT_PUT_U32(neuron_it->bp_epoch_overflows);
+#else
+            bias = 0;
+            CKPT_PUT(&bias, sizeof(bias));
+            CKPT_PUT_U32(0);
+            CKPT_PUT_U32(0);
+#endif
+            u32 = 0;
+            if (neuron_it->weight_slopes != NULL)
+                u32 |= FANN_CKPT_SLOPES;
+            if (neuron_it->prev_steps != NULL)
+                u32 |= FANN_CKPT_STEPS;
+            if (neuron_it->prev_slopes != NULL)
+                u32 |= FANN_CKPT_PSLOPES;
+            CKPT_PUT_U32(u32);
+            CKPT_PUT(&neuron_it->steepness, sizeof(fann_type_ff));
+            CKPT_PUT(&neuron_it->train_error, sizeof(fann_type_bp));
+            CKPT_PUT(neuron_it->weight, num_con * sizeof(fann_type_ff));
+            if (u32 & FANN_CKPT_SLOPES)
+                CKPT_PUT(neuron_it->weight_slopes, num_con * sizeof(fann_type_bp));
+            if (u32 & FANN_CKPT_STEPS)
+                CKPT_PUT(neuron_it->prev_steps, num_con * sizeof(fann_type_bp));
+            if (u32 & FANN_CKPT_PSLOPES)
+                CKPT_PUT(neuron_it->prev_slopes, num_con * sizeof(fann_type_bp));
+        }
+        prev_layer = layer_it;
+    }
+
+#ifdef FANN_DATA_SCALE
+    if (ann->scale_mean_in != NULL) {
+        CKPT_PUT_U32(1);
+        CKPT_PUT(ann->scale_mean_in, ann->num_input * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_deviation_in, ann->num_input * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_new_min_in, ann->num_input * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_factor_in, ann->num_input * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_mean_out, ann->num_output * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_deviation_out, ann->num_output * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_new_min_out, ann->num_output * sizeof(fann_type_nt));
+        CKPT_PUT(ann->scale_factor_out, ann->num_output * sizeof(fann_type_nt));
+    } else
+#endif // FANN_DATA_SCALE
+    {
+        CKPT_PUT_U32(0);
+    }
+
+    /* row order of the (shuffled) training data */
+    if ((data != NULL) && (data->order != NULL)) {
+        CKPT_PUT_U32(data->num_data);
+        CKPT_PUT(data->order, data->num_data * sizeof(unsigned int));
+    } else {
+        CKPT_PUT_U32(0);
+    }
+
+    if (dst != NULL) {
+        uint64_t h = fann_ckpt_hash(dst, pos);
+        memcpy(dst + pos, &h, sizeof(h));
+    }
+    pos += sizeof(uint64_t);
+    return pos;
+}
+
+#undef CKPT_PUT_U32
+#undef CKPT_PUT
+
+/* Write the snapshot to a temporary file, sync it and rename it over the
+   checkpoint, so that the file on disk is always a complete checkpoint.
+   Errors are left in fann_ckpt.error: fann_error() is not thread safe.
+ */
+static void * fann_ckpt_writer(void * ref)
+{
+    char *tmp, *dir, *slash;
+    size_t done = 0;
+    ssize_t ret;
+    int fd;
+
+    (void)ref;
+    fann_ckpt.retval = -1;
+    fann_malloc(tmp, strlen(fann_ckpt.file) + 5);
+    if (tmp == NULL) {
+        fann_ckpt.error = FANN_E_CANT_ALLOCATE_MEM;
+        return NULL;
+    }
+    fann_trace_begin(FANN_TRACE_WRITE);
+    sprintf(tmp, "%s.tmp", fann_ckpt.file);
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fann_ckpt.error = FANN_E_CANT_OPEN_CONFIG_W;
+        fann_free(tmp);
+        fann_trace_end();
+        return NULL;
+    }
+    while (done < fann_ckpt.len) {
+        ret = write(fd, fann_ckpt.buf + done, fann_ckpt.len - done);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        done += ret;
+    }
+    if ((done != fann_ckpt.len) || fsync(fd)) {
+        close(fd);
+        fd = -1;
+    }
+    if ((fd < 0) || close(fd) || rename(tmp, fann_ckpt.file)) {
+        fann_ckpt.error = FANN_E_CANT_WRITE_CONFIG;
+        unlink(tmp);
+        fann_free(tmp);
+        fann_trace_end();
+        return NULL;
+    }
+    /* make the rename itself durable */
+    strcpy(tmp, fann_ckpt.file);
+    slash = strrchr(tmp, '/');
+    if (slash == NULL) {
+        dir = ".";
+    } else {
+        slash[1] = '\0';
+        dir = tmp;
+    }
+    fd = open(dir, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    fann_free(tmp);
+    fann_trace_end();
+    fann_ckpt.retval = 0;
+    return NULL;
+}
+
+/* INTERNAL FUNCTION
+   Reports the error of the last write, on the calling thread.
+ */
+static void fann_ckpt_report(void)
+{
+    switch (fann_ckpt.error) {
+    case FANN_E_NO_ERROR:
+        break;
+    case FANN_E_CANT_OPEN_CONFIG_W:
+        fann_error(FANN_E_CANT_OPEN_CONFIG_W, fann_ckpt.file);
+        break;
+    case FANN_E_CANT_WRITE_CONFIG:
+        fann_error(FANN_E_CANT_WRITE_CONFIG, fann_ckpt.file);
+        break;
+    default:
+        fann_error(fann_ckpt.error);
+        break;
+    }
+}
+
+/* Wait for the checkpoint being written (if any).
+ */
+FANN_EXTERNAL int FANN_API fann_wait_checkpoint(void)
+{
+    if (!fann_ckpt.busy)
+        return 0;
+    fann_trace_begin(FANN_TRACE_JOIN);
+    pthread_join(fann_ckpt.thread, NULL);
+    fann_trace_end();
+    fann_ckpt.busy = 0;
+    fann_ckpt_report();
+    fann_free(fann_ckpt.buf);
+    fann_free(fann_ckpt.file);
+    return fann_ckpt.retval;
+}
+
+/* Save a checkpoint. The state is copied to memory before returning and
+   written by a background thread.
+ */
+FANN_EXTERNAL int FANN_API fann_save_checkpoint(struct fann *ann, struct fann_data *data,
+                                                const char *checkpoint_file)
+{
+    unsigned char *buf;
+    size_t len;
+
+    /* only one checkpoint in flight, older ones are complete on disk */
+    fann_wait_checkpoint();
+
+    fann_trace_begin(FANN_TRACE_CHECKPOINT);
+    len = fann_ckpt_serialize(ann, data, NULL);
+    fann_malloc(buf, len);
+    fann_malloc(fann_ckpt.file, strlen(checkpoint_file) + 1);
+    if ((buf == NULL) || (fann_ckpt.file == NULL)) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_free(buf);
+        fann_free(fann_ckpt.file);
+        fann_trace_end();
+        return -1;
+    }
+    fann_ckpt_serialize(ann, data, buf);
+    strcpy(fann_ckpt.file, checkpoint_file);
+    fann_ckpt.buf = buf;
+    fann_ckpt.len = len;
+    fann_ckpt.error = FANN_E_NO_ERROR;
+    if (pthread_create(&fann_ckpt.thread, NULL, fann_ckpt_writer, NULL)) {
+        /* no thread available, write it synchronously */
+        fann_ckpt_writer(NULL);
+        fann_ckpt_report();
+        fann_free(fann_ckpt.buf);
+        fann_free(fann_ckpt.file);
+        fann_trace_end();
+        return fann_ckpt.retval;
+    }
+    fann_ckpt.busy = 1;
+    fann_trace_end();
+    return 0;
+}
+
+#define CKPT_READ(ptr, len) { \
+    if (pos + (len) > end) \
+        goto ckpt_short; \
+    memcpy(ptr, buf + pos, len); \
+    pos += len; }
+#define CKPT_READ_U32(var) CKPT_READ(&(var), sizeof(uint32_t))
+/* into the network, only once the file has been checked */
+#define CKPT_GET(ptr, len) { \
+    if (pos + (len) > end) \
+        goto ckpt_short; \
+    if (apply) \
+        memcpy(ptr, buf + pos, len); \
+    pos += len; }
+#define CKPT_GET_U32(var) CKPT_GET(&(var), sizeof(uint32_t))
+#define CKPT_CHECK_U32(val) { \
+    CKPT_READ_U32(u32); \
+    if (u32 != (uint32_t)(val)) \
+        goto ckpt_mismatch; }
+
+/* INTERNAL FUNCTION
+   Allocate a missing optimizer array before restoring it.
+ */
+static int fann_ckpt_array(fann_type_bp ** array, unsigned int num_con)
+{
+    if (*array == NULL) {
+        fann_calloc(*array, num_con);
+        if (*array == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Restore a checkpoint into a network with the same topology and back-end.
+ */
+FANN_EXTERNAL int FANN_API fann_load_checkpoint(struct fann *ann, struct fann_data *data,
+                                                const char *checkpoint_file)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    struct fann_neuron *neuron_it;
+    int32_t rand_state[FANN_RAND_STATE_WORDS];
+    unsigned char *buf = NULL;
+    unsigned int *order = NULL;
+    size_t pos, end, layers_pos;
+    unsigned int n, num_con, epoch, shuffle;
+    uint32_t u32, flags;
+    int32_t bias;
+    uint64_t h;
+    long size;
+    FILE *file;
+    int apply;
+
+    if (fann_check_weights_writable(ann))
+        return -1;
+    file = fopen(checkpoint_file, "rb");
+    if (file == NULL) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_R, checkpoint_file);
+        return -1;
+    }
+    if ((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < (long)(8 + sizeof(h)))) {
+        fclose(file);
+        fann_error(FANN_E_CANT_READ_CONFIG, "size", checkpoint_file);
+        return -1;
+    }
+    rewind(file);
+    fann_malloc(buf, size);
+    if (buf == NULL) {
+        fclose(file);
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+    if (fread(buf, 1, size, file) != (size_t)size) {
+        fclose(file);
+        fann_free(buf);
+        fann_error(FANN_E_CANT_READ_CONFIG, "data", checkpoint_file);
+        return -1;
+    }
+    fclose(file);
+    end = size - sizeof(h);
+    memcpy(&h, buf + end, sizeof(h));
+    if ((memcmp(buf, FANN_CKPT_MAGIC, 8) != 0) || (h != fann_ckpt_hash(buf, end))) {
+        fann_free(buf);
+        fann_error(FANN_E_WRONG_CONFIG_VERSION, checkpoint_file);
+        return -1;
+    }
+    pos = 8;
+
+    /* the back-end and topology are checked before the network is touched */
+    CKPT_CHECK_U32(sizeof(fann_type_ff));
+    CKPT_CHECK_U32(sizeof(fann_type_bp));
+    CKPT_CHECK_U32(strlen(fann_float_type));
+    if ((pos + strlen(fann_float_type) > end) ||
+        (memcmp(buf + pos, fann_float_type, strlen(fann_float_type)) != 0))
+        goto ckpt_mismatch;
+    pos += strlen(fann_float_type);
+    CKPT_CHECK_U32(ann->last_layer - ann->first_layer);
+    layers_pos = pos;
+    for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+        CKPT_CHECK_U32(layer_it->num_neurons);
+        CKPT_READ_U32(u32); // activation, restored below
+    }
+
+    /* the whole file is read and checked once (apply == 0) before the
+       network is changed; only memory can then run out */
+    for (apply = 0; apply < 2; apply++) {
+        pos = layers_pos;
+        for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+            pos += sizeof(uint32_t);
+            CKPT_READ_U32(u32);
+            if (apply)
+                layer_it->activation = (enum fann_activationfunc_enum)u32;
+        }
+        CKPT_READ_U32(epoch);
+        CKPT_READ_U32(shuffle);
+        CKPT_READ_U32(u32);
+        if (apply)
+            ann->training_algorithm = (enum fann_train_enum)u32;
+        CKPT_GET_U32(ann->mini_batch);
+        CKPT_GET(&ann->mini_batch_ratio, sizeof(ann->mini_batch_ratio));
+        CKPT_GET(&ann->learning_rate, sizeof(fann_type_ff));
+        CKPT_GET(&ann->learning_momentum, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rmsprop_avg, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rmsprop_1mavg, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rprop_increase_factor, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rprop_decrease_factor, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rprop_delta_min, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rprop_delta_max, sizeof(fann_type_ff));
+        CKPT_GET(&ann->rprop_delta_zero, sizeof(fann_type_ff));
+        CKPT_READ_U32(u32);
+#if (defined SWF16_AP) || (defined HWF16)
+        if (apply)
+            ann->change_bias = u32;
+#endif
+        CKPT_READ(rand_state, sizeof(rand_state));
+
+        prev_layer = ann->first_layer;
+        for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+            num_con = prev_layer->num_connections;
+            CKPT_GET(&layer_it->max_init, sizeof(fann_type_nt));
+            CKPT_GET(&layer_it->var_init, sizeof(fann_type_nt));
+            for (n = 0; n < layer_it->num_neurons; n++) {
+                neuron_it = layer_it->neuron + n;
+                CKPT_READ(&bias, sizeof(bias));
+#if (defined SWF16_AP) || (defined HWF16)
+                if (apply)
+                    neuron_it->bp_fp16_bias = bias;
+                CKPT_GET_U32(neuron_it->bp_batch_overflows);
+                CKPT_GET_U32(neuron_it->bp_epoch_overflows);
+#else
+                CKPT_READ_U32(u32);
+                CKPT_READ_U32(u32);
+#endif
+                CKPT_READ_U32(flags);
+                CKPT_GET(&neuron_it->steepness, sizeof(fann_type_ff));
+                CKPT_GET(&neuron_it->train_error, sizeof(fann_type_bp));
+                CKPT_GET(neuron_it->weight, num_con * sizeof(fann_type_ff));
+                if (flags & FANN_CKPT_SLOPES) {
+                    if (apply && fann_ckpt_array(&neuron_it->weight_slopes, num_con))
+                        goto ckpt_error;
+                    CKPT_GET(neuron_it->weight_slopes, num_con * sizeof(fann_type_bp));
+                }
+                if (flags & FANN_CKPT_STEPS) {
+                    if (apply && fann_ckpt_array(&neuron_it->prev_steps, num_con))
+                        goto ckpt_error;
+                    CKPT_GET(neuron_it->prev_steps, num_con * sizeof(fann_type_bp));
+                }
+                if (flags & FANN_CKPT_PSLOPES) {
+                    if (apply && fann_ckpt_array(&neuron_it->prev_slopes, num_con))
+                        goto ckpt_error;
+                    CKPT_GET(neuron_it->prev_slopes, num_con * sizeof(fann_type_bp));
+                }
+            }
+            prev_layer = layer_it;
+        }
+
+        CKPT_READ_U32(u32);
+#ifdef FANN_DATA_SCALE
+        if (u32) {
+            if (apply && (ann->scale_mean_in == NULL) && fann_allocate_scale(ann))
+                goto ckpt_error;
+            CKPT_GET(ann->scale_mean_in, ann->num_input * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_deviation_in, ann->num_input * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_new_min_in, ann->num_input * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_factor_in, ann->num_input * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_mean_out, ann->num_output * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_deviation_out, ann->num_output * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_new_min_out, ann->num_output * sizeof(fann_type_nt));
+            CKPT_GET(ann->scale_factor_out, ann->num_output * sizeof(fann_type_nt));
+        }
+#else
+        if (u32)
+            goto ckpt_mismatch;
+#endif // FANN_DATA_SCALE
+
+        CKPT_READ_U32(u32);
+        if ((u32 != 0) && (data != NULL) && !apply) {
+            if (u32 != data->num_data)
+                goto ckpt_mismatch;
+            fann_malloc(order, u32);
+            if (order == NULL) {
+                fann_error(FANN_E_CANT_ALLOCATE_MEM);
+                goto ckpt_error;
+            }
+            CKPT_READ(order, u32 * sizeof(unsigned int));
+            for (n = 0; n < u32; n++) {
+                if (order[n] >= u32)
+                    goto ckpt_mismatch;
+            }
+        }
+    }
+
+    if ((order != NULL) && fann_reorder_data(data, order))
+        goto ckpt_error;
+#ifdef FIXEDFANN
+    fann_fixed_release(ann);
+#endif
+    fann_free(order);
+    fann_rand_set_state(rand_state);
+    fann_train_shuffle = shuffle;
+    ann->train_epoch = epoch;
+    ann->resume_epoch = epoch;
+    fann_free(buf);
+    return 0;
+
+ckpt_short:
+    fann_error(FANN_E_CANT_READ_CONFIG, "checkpoint", checkpoint_file);
+    goto ckpt_error;
+ckpt_mismatch:
+    fann_error(FANN_E_CHECKPOINT_MISMATCH, checkpoint_file);
+ckpt_error:
+    fann_free(order);
+    fann_free(buf);
+    return -1;
+}
+
+#undef CKPT_CHECK_U32
+#undef CKPT_GET_U32
+#undef CKPT_GET
+#undef CKPT_READ_U32
+#undef CKPT_READ
 #endif // FANN_INFERENCE_ONLY
 
 #define fann_scanf(type, name, val) \
@@ -385,12 +943,31 @@ struct fann *fann_create_from_fd(FILE * conf, const char *configuration_file)
         layer_it->num_neurons = layer_size;
         layer_it->num_connections = layer_it->num_neurons + 1;
         layer_it->activation = tmpu;
+#ifndef FANN_INFERENCE_ONLY
+        layer_it->max_init = NT_0000;
+        layer_it->var_init = NT_0000;
+#ifdef FANN_PRINT_STATS
+        layer_it->stats = NULL;
+#endif // FANN_PRINT_STATS
+#endif // FANN_INFERENCE_ONLY
     }
     fann_skip("\n");
 
     // ignore the BIAS
     ann->num_input = ann->first_layer->num_neurons;
     ann->num_output = ((ann->last_layer - 1)->num_neurons);
+#ifdef CALCULATE_ERROR
+    fann_malloc(ann->num_max_ok, ann->num_output);
+    if (ann->num_max_ok == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_destroy(ann);
+        return NULL;
+    }
+#endif // CALCULATE_ERROR
+#ifdef FANN_THREADS
+    // the file has no threads, only the calling one
+    ann->num_procs = 1;
+#endif
 
 #ifdef FANN_DATA_SCALE
 #define SCALE_LOAD( what, where )                                            \
@@ -444,7 +1021,8 @@ struct fann *fann_create_from_fd(FILE * conf, const char *configuration_file)
         }
         for (i = 0; i < num_n; i++) {
             neuron_it = layer_it->neuron + i;
-            if (fscanf(conf, IOSCANF "\n", &tmpf) != 1) {
+            // the rest of the line is training state
+            if (fscanf(conf, IOSCANF "%*[^\n]\n", &tmpf) != 1) {
                 fann_error(FANN_E_CANT_READ_NEURON, configuration_file);
                 fann_destroy(ann);
                 return NULL;
@@ -460,22 +1038,470 @@ struct fann *fann_create_from_fd(FILE * conf, const char *configuration_file)
     prev_layer = ann->first_layer;
     for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
         unsigned int w, tmpl, num_con;
+        IOTYPE *weights;
         /* the neurons */
         num_con = prev_layer->num_connections;
+        fann_malloc(weights, num_con);
+        if (weights == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            fann_destroy(ann);
+            return NULL;
+        }
         for (i = 0; i < layer_it->num_neurons; i++) {
             neuron_it = layer_it->neuron + i;
             for (w = 0; w < num_con; w++) {
-                if ((fscanf(conf, "%u, %u, " IOSCANF "\n", &tmpl, &tmpu, &tmpf) != 3) || (tmpu != w) || (tmpl != i)) {
+                if ((fscanf(conf, "%u, %u, " IOSCANF "%*[^\n]\n", &tmpl, &tmpu, &weights[w]) != 3) ||
+                    (tmpu != w) || (tmpl != i)) {
                     fann_error(FANN_E_CANT_READ_CONNECTIONS, configuration_file);
+                    fann_free(weights);
                     fann_destroy(ann);
                     return NULL;
                 }
-                neuron_it->weight[w] = fann_float_to_ff(tmpf);
             }
+            fann_float_to_ff_array(neuron_it->weight, weights, num_con);
+        }
+        fann_free(weights);
+        prev_layer = layer_it;
+    }
+    return ann;
+}
+
+/* Shared models
+   Image of a network for inference, mapped read-only by any number of
+   processes: a header with the layers, steepness and scale parameters,
+   followed at FANN_SHARED_ALIGN by the weights, one row per neuron padded
+   to a cache line. The layout is native (same machine and back-end only);
+   the header ends with its FNV-1a hash.
+ */
+
+#define FANN_SHARED_MAGIC "FANNSHM1"
+#define FANN_SHARED_ALIGN 4096
+#define FANN_SHARED_ROW(num_con) \
+    ((((num_con) * sizeof(fann_type_ff)) + 63) & ~(size_t)63)
+
+/* <fcntl.h> defines the seals only with _GNU_SOURCE */
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+#define SHARED_PUT(ptr, len) { \
+    if (dst != NULL) \
+        memcpy(dst + pos, ptr, len); \
+    pos += len; }
+#define SHARED_PUT_U32(val) { uint32_t put_u32 = (val); SHARED_PUT(&put_u32, sizeof(put_u32)); }
+
+/* INTERNAL FUNCTION
+   Serialize the header of the image of ann into dst, or only compute its
+   size if dst is NULL. The weights follow at weights_pos.
+ */
+static size_t fann_shared_header(struct fann *ann, unsigned char *dst)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    uint64_t weights_pos, weights_len = 0;
+    size_t pos = 0;
+    unsigned int n;
+    float bit_fail_limit = 0.0f;
+
+    SHARED_PUT(FANN_SHARED_MAGIC, 8);
+    SHARED_PUT_U32(sizeof(fann_type_ff));
+    SHARED_PUT_U32(strlen(fann_float_type));
+    SHARED_PUT(fann_float_type, strlen(fann_float_type));
+    SHARED_PUT_U32(ann->last_layer - ann->first_layer);
+    for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+        SHARED_PUT_U32(layer_it->num_neurons);
+        SHARED_PUT_U32(layer_it->activation);
+    }
+#ifdef CALCULATE_ERROR
+    bit_fail_limit = ann->bit_fail_limit;
+#endif // CALCULATE_ERROR
+    SHARED_PUT(&bit_fail_limit, sizeof(bit_fail_limit));
+#ifdef FANN_DATA_SCALE
+    if (ann->scale_mean_in != NULL) {
+        SHARED_PUT_U32(1);
+        SHARED_PUT(ann->scale_mean_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_deviation_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_new_min_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_factor_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_mean_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_deviation_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_new_min_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_PUT(ann->scale_factor_out, ann->num_output * sizeof(fann_type_nt));
+    } else
+#endif // FANN_DATA_SCALE
+    {
+        SHARED_PUT_U32(0);
+    }
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            SHARED_PUT(&(layer_it->neuron[n].steepness), sizeof(fann_type_ff));
         }
+        weights_len += layer_it->num_neurons * FANN_SHARED_ROW(prev_layer->num_connections);
         prev_layer = layer_it;
     }
+    weights_pos = pos + 3 * sizeof(uint64_t);
+    weights_pos = (weights_pos + FANN_SHARED_ALIGN - 1) & ~(uint64_t)(FANN_SHARED_ALIGN - 1);
+    SHARED_PUT(&weights_pos, sizeof(weights_pos));
+    SHARED_PUT(&weights_len, sizeof(weights_len));
+    if (dst != NULL) {
+        uint64_t h = fann_ckpt_hash(dst, pos);
+        memcpy(dst + pos, &h, sizeof(h));
+    }
+    pos += sizeof(uint64_t);
+    return pos;
+}
+
+#undef SHARED_PUT_U32
+#undef SHARED_PUT
+
+/* INTERNAL FUNCTION
+   write() all of buf, 0 on success.
+ */
+static int fann_write_all(int fd, const void *buf, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    ssize_t ret;
+
+    while (len > 0) {
+        ret = write(fd, p, len);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += ret;
+        len -= ret;
+    }
+    return 0;
+}
+
+/* INTERNAL FUNCTION
+   Write the image of ann to fd, from its current position.
+ */
+static int fann_save_shared_fd(struct fann *ann, int fd)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    unsigned char *buf;
+    size_t len, row, size;
+    unsigned int n;
+    uint64_t weights_pos;
+
+    len = fann_shared_header(ann, NULL);
+    prev_layer = ann->first_layer;
+    row = 0;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        if (FANN_SHARED_ROW(prev_layer->num_connections) > row)
+            row = FANN_SHARED_ROW(prev_layer->num_connections);
+        prev_layer = layer_it;
+    }
+    /* the header and its padding, then one row at a time */
+    size = (len > row) ? len : row;
+    size = (size + FANN_SHARED_ALIGN - 1) & ~(size_t)(FANN_SHARED_ALIGN - 1);
+    buf = (unsigned char *)calloc(size, 1);
+    if (buf == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+    fann_shared_header(ann, buf);
+    memcpy(&weights_pos, buf + len - 3 * sizeof(uint64_t), sizeof(weights_pos));
+    if (fann_write_all(fd, buf, weights_pos))
+        goto shared_error;
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        row = FANN_SHARED_ROW(prev_layer->num_connections);
+        memset(buf, 0, row);
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            memcpy(buf, layer_it->neuron[n].weight, prev_layer->num_connections * sizeof(fann_type_ff));
+            if (fann_write_all(fd, buf, row))
+                goto shared_error;
+        }
+        prev_layer = layer_it;
+    }
+    free(buf);
+    return 0;
+
+shared_error:
+    free(buf);
+    return -1;
+}
+
+/* Save the image to a temporary file, sync it and rename it over the file,
+   so that processes attaching it never see a partial image, and those
+   that mapped the old one keep it.
+ */
+FANN_EXTERNAL int FANN_API fann_save_shared(struct fann *ann, const char *file)
+{
+    char *tmp;
+    int fd;
+
+    tmp = (char *)malloc(strlen(file) + 5);
+    if (tmp == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+    sprintf(tmp, "%s.tmp", file);
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_W, tmp);
+        free(tmp);
+        return -1;
+    }
+    if (fann_save_shared_fd(ann, fd) || fsync(fd)) {
+        close(fd);
+        fd = -1;
+    }
+    if ((fd < 0) || close(fd) || rename(tmp, file)) {
+        fann_error(FANN_E_CANT_WRITE_CONFIG, file);
+        unlink(tmp);
+        free(tmp);
+        return -1;
+    }
+    free(tmp);
+    return 0;
+}
+
+/* Write the image to a sealed memfd, or to an unlinked shm object where
+   memfds are not available.
+ */
+FANN_EXTERNAL int FANN_API fann_create_shared_fd(struct fann *ann)
+{
+    int fd = -1;
+
+#ifdef SYS_memfd_create
+    fd = (int)syscall(SYS_memfd_create, "fann", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#endif
+    if (fd < 0) {
+        char name[64];
+
+        sprintf(name, "/fann-%u-%p", (unsigned int)getpid(), (void *)ann);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            shm_unlink(name);
+        }
+    }
+    if (fd < 0) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_W, "shared memory");
+        return -1;
+    }
+    if (fann_save_shared_fd(ann, fd)) {
+        fann_error(FANN_E_CANT_WRITE_CONFIG, "shared memory");
+        close(fd);
+        return -1;
+    }
+    /* no process can change it after this one (shm objects stay writable) */
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    return fd;
+}
+
+#define SHARED_GET(ptr, len) { \
+    if (pos + (len) > end) \
+        goto shared_short; \
+    memcpy(ptr, map + pos, len); \
+    pos += len; }
+#define SHARED_GET_U32(var) SHARED_GET(&(var), sizeof(uint32_t))
+#define SHARED_CHECK_U32(val) { \
+    SHARED_GET_U32(u32); \
+    if (u32 != (uint32_t)(val)) \
+        goto shared_mismatch; }
+
+/* INTERNAL FUNCTION
+   A network running on the image mapped at map, NULL on errors. The image
+   must be unmapped by the caller if it fails, else by fann_destroy().
+ */
+static struct fann *fann_shared_shell(const unsigned char *map, size_t size, const char *name)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    struct fann *ann = NULL;
+    uint64_t weights_pos, weights_len, saved_len, h;
+    size_t pos, end = size, offset;
+    unsigned int num_layers, n;
+    uint32_t u32;
+    float bit_fail_limit;
+
+    fann_const_init();
+    if ((size < 8) || (memcmp(map, FANN_SHARED_MAGIC, 8) != 0)) {
+        fann_error(FANN_E_WRONG_CONFIG_VERSION, name);
+        return NULL;
+    }
+    pos = 8;
+    SHARED_CHECK_U32(sizeof(fann_type_ff));
+    SHARED_CHECK_U32(strlen(fann_float_type));
+    if ((pos + strlen(fann_float_type) > end) ||
+        (memcmp(map + pos, fann_float_type, strlen(fann_float_type)) != 0))
+        goto shared_mismatch;
+    pos += strlen(fann_float_type);
+    SHARED_GET_U32(num_layers);
+    if ((num_layers < 2) || (num_layers > (end - pos) / (2 * sizeof(uint32_t))))
+        goto shared_short;
+    ann = fann_allocate_structure(num_layers);
+    if (ann == NULL)
+        return NULL;
+    fann_reset_loss(ann);
+    for (layer_it = ann->first_layer; layer_it != ann->last_layer; layer_it++) {
+        SHARED_GET_U32(layer_it->num_neurons);
+        SHARED_GET_U32(u32);
+        layer_it->activation = (enum fann_activationfunc_enum)u32;
+        layer_it->num_connections = layer_it->num_neurons + 1;
+        layer_it->max_init = NT_0000;
+        layer_it->var_init = NT_0000;
+#ifdef FANN_PRINT_STATS
+        layer_it->stats = NULL;
+#endif // FANN_PRINT_STATS
+    }
+    ann->num_input = ann->first_layer->num_neurons;
+    ann->num_output = (ann->last_layer - 1)->num_neurons;
+    SHARED_GET(&bit_fail_limit, sizeof(bit_fail_limit));
+#ifdef CALCULATE_ERROR
+    ann->bit_fail_limit = bit_fail_limit;
+    fann_malloc(ann->num_max_ok, ann->num_output);
+    if (ann->num_max_ok == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        goto shared_error;
+    }
+#endif // CALCULATE_ERROR
+#ifdef FANN_THREADS
+    ann->num_procs = 1;
+#endif
+    SHARED_GET_U32(u32);
+#ifdef FANN_DATA_SCALE
+    if (u32) {
+        if (fann_allocate_scale(ann))
+            goto shared_error;
+        SHARED_GET(ann->scale_mean_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_deviation_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_new_min_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_factor_in, ann->num_input * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_mean_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_deviation_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_new_min_out, ann->num_output * sizeof(fann_type_nt));
+        SHARED_GET(ann->scale_factor_out, ann->num_output * sizeof(fann_type_nt));
+    }
+#else
+    if (u32)
+        goto shared_mismatch;
+#endif // FANN_DATA_SCALE
+
+    /* private neurons, values and sums; the weights are set below */
+    if (fann_allocate_neurons(ann, ann))
+        goto shared_error;
+    ann->weights_shared = FANN_WEIGHTS_MAPPED;
+    weights_len = 0;
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            SHARED_GET(&(layer_it->neuron[n].steepness), sizeof(fann_type_ff));
+        }
+        layer_it->value[layer_it->num_neurons] = ff_p100;
+        weights_len += layer_it->num_neurons * FANN_SHARED_ROW(prev_layer->num_connections);
+        prev_layer = layer_it;
+    }
+    SHARED_GET(&weights_pos, sizeof(weights_pos));
+    SHARED_GET(&saved_len, sizeof(saved_len));
+    if (saved_len != weights_len)
+        goto shared_mismatch;
+    if (pos + sizeof(h) > end)
+        goto shared_short;
+    memcpy(&h, map + pos, sizeof(h));
+    if (h != fann_ckpt_hash(map, pos)) {
+        fann_error(FANN_E_WRONG_CONFIG_VERSION, name);
+        goto shared_error;
+    }
+    if ((weights_pos % 64) || (weights_pos > size) || (weights_len > size - weights_pos))
+        goto shared_short;
+
+    offset = weights_pos;
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++) {
+        for (n = 0; n < layer_it->num_neurons; n++) {
+            layer_it->neuron[n].weight = (fann_type_ff *)(map + offset);
+            offset += FANN_SHARED_ROW(prev_layer->num_connections);
+        }
+        prev_layer = layer_it;
+    }
+    ann->shared_map = (void *)map;
+    ann->shared_len = size;
     return ann;
+
+shared_short:
+    fann_error(FANN_E_CANT_READ_CONFIG, "shared model", name);
+    goto shared_error;
+shared_mismatch:
+    fann_error(FANN_E_CHECKPOINT_MISMATCH, name);
+shared_error:
+    fann_destroy(ann);
+    return NULL;
+}
+
+#undef SHARED_CHECK_U32
+#undef SHARED_GET_U32
+#undef SHARED_GET
+
+/* INTERNAL FUNCTION
+   Map fd read-only and attach a network to it.
+ */
+static struct fann *fann_attach_shared_map(int fd, const char *name)
+{
+    struct fann *ann;
+    struct stat st;
+    void *map;
+
+    if (fstat(fd, &st) || (st.st_size <= 0)) {
+        fann_error(FANN_E_CANT_READ_CONFIG, "size", name);
+        return NULL;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_R, name);
+        return NULL;
+    }
+    ann = fann_shared_shell((const unsigned char *)map, (size_t)st.st_size, name);
+    if (ann == NULL) {
+        munmap(map, (size_t)st.st_size);
+    }
+    return ann;
+}
+
+FANN_EXTERNAL struct fann *FANN_API fann_attach_shared(const char *file)
+{
+    struct fann *ann;
+    int fd;
+
+    fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_R, file);
+        return NULL;
+    }
+    /* the mapping keeps the image, even if the file is replaced */
+    ann = fann_attach_shared_map(fd, file);
+    close(fd);
+    return ann;
+}
+
+FANN_EXTERNAL struct fann *FANN_API fann_attach_shared_fd(int fd)
+{
+    return fann_attach_shared_map(fd, "shared memory");
+}
+
+/* Attach the image, or load the configuration file.
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_load_network(const char *file)
+{
+    char magic[8];
+    FILE *f;
+    int shared;
+
+    f = fopen(file, "rb");
+    if (f == NULL) {
+        fann_error(FANN_E_CANT_OPEN_CONFIG_R, file);
+        return NULL;
+    }
+    shared = (fread(magic, 1, 8, f) == 8) && (memcmp(magic, FANN_SHARED_MAGIC, 8) == 0);
+    fclose(f);
+    return shared ? fann_attach_shared(file) : fann_create_from_file(file);
 }
 
 #endif // FANN_INFERENCE_ONLY
@@ -69,6 +69,123 @@ FANN_EXTERNAL struct fann *FANN_API fann_create_from_file(const char *configurat
  */
 FANN_EXTERNAL int FANN_API fann_save(struct fann *ann, const char *configuration_file);
 
+/* Group: Checkpoints */
+
+/* Function: fann_save_checkpoint
+   Save the training state of the network to a binary checkpoint file.
+
+   Besides the weights, the checkpoint holds the optimizer arrays (weight slopes, previous
+   steps and slopes), the fp16 bias state of each neuron, the rand() state, the current epoch
+   and, if data is not NULL, the row order of the shuffled training data. This is everything
+   <fann_load_checkpoint> needs to continue the training bit-exactly.
+
+   The state is copied to memory before the function returns, and the file is written by a
+   background thread to checkpoint_file.tmp, synced and renamed, so checkpoint_file is always
+   a complete checkpoint. Only one checkpoint is written at a time: a new call waits for the
+   previous one.
+
+   The format is native, it can only be read by the same back-end on the same architecture.
+
+   Return:
+   The function returns 0 on success and -1 on failure. Errors writing the file are reported
+   by <fann_wait_checkpoint>.
+
+   See also:
+    <fann_load_checkpoint>, <fann_wait_checkpoint>, <fann_save>
+ */
+FANN_EXTERNAL int FANN_API fann_save_checkpoint(struct fann *ann, struct fann_data *data,
+                                                const char *checkpoint_file);
+
+/* Function: fann_wait_checkpoint
+   Wait until the checkpoint being written by <fann_save_checkpoint> (if any) is on disk.
+
+   Return:
+   The function returns 0 on success and -1 if the last checkpoint could not be written.
+ */
+FANN_EXTERNAL int FANN_API fann_wait_checkpoint(void);
+
+/* Function: fann_load_checkpoint
+   Restore a checkpoint saved by <fann_save_checkpoint> into a network with the same
+   topology, created by the same back-end.
+
+   If data is not NULL, it must be the training data in its original (file) order, which is
+   rearranged to the order it had when the checkpoint was saved. <fann_train_on_data> then
+   continues from the saved epoch.
+
+   Return:
+   The function returns 0 on success and -1 on failure.
+
+   See also:
+    <fann_save_checkpoint>
+ */
+FANN_EXTERNAL int FANN_API fann_load_checkpoint(struct fann *ann, struct fann_data *data,
+                                                const char *checkpoint_file);
+
+/* Group: Shared models */
+
+/* Function: fann_save_shared
+   Save the network as an image that processes map read-only with <fann_attach_shared>, so
+   that they all share one copy of its weights.
+
+   The image holds what <fann_run> needs: layers, activation functions, steepness, scale
+   parameters and the weights, which start on a page boundary with each neuron on its own
+   cache line. Like <fann_save_checkpoint>, it is written to file.tmp, synced and renamed, so
+   processes attaching the file see a complete image and processes that attached the old one
+   keep it. The format is native, it can only be attached by the same back-end on the same
+   architecture.
+
+   Return:
+   The function returns 0 on success and -1 on failure.
+
+   See also:
+    <fann_attach_shared>, <fann_create_shared_fd>, <fann_save>
+ */
+FANN_EXTERNAL int FANN_API fann_save_shared(struct fann *ann, const char *file);
+
+/* Function: fann_create_shared_fd
+   Write the image of <fann_save_shared> to anonymous shared memory (a sealed memfd, or an
+   unlinked POSIX shm object) and return its descriptor, for worker processes to attach with
+   <fann_attach_shared_fd> after inheriting it across fork() or receiving it over a Unix
+   socket. The memory is freed when the last descriptor is closed and the last network
+   attached to it is destroyed.
+
+   Return:
+   The descriptor (close-on-exec), or -1 on failure.
+ */
+FANN_EXTERNAL int FANN_API fann_create_shared_fd(struct fann *ann);
+
+/* Function: fann_attach_shared
+   Create a network running on the image of file, mapped read-only.
+
+   Only the network structure, neurons, and the values and sums of each layer are allocated
+   by the process; the weights stay in the page cache, shared by every process that attaches
+   the same file. The network can be run and copied (<fann_copy>, the copies run on the same
+   mapped weights), but not trained: <fann_train_epoch>, <fann_train_on_data>,
+   <fann_randomize_weights>, <fann_init_weights> and <fann_load_checkpoint> report
+   FANN_E_WEIGHTS_READ_ONLY for it and its copies and leave them unchanged. Neither
+   <fann_destroy> of the network nor of a copy frees the mapped weights; the network
+   unmaps the image, after the copies are destroyed.
+
+   Return:
+   The network, or NULL on failure (e.g. an image of another back-end).
+
+   See also:
+    <fann_save_shared>, <fann_load_network>
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_attach_shared(const char *file);
+
+/* Function: fann_attach_shared_fd
+   Like <fann_attach_shared>, with the image of a descriptor, e.g. from
+   <fann_create_shared_fd>. The descriptor can be closed afterwards.
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_attach_shared_fd(int fd);
+
+/* Function: fann_load_network
+   Attach file if it is an image of <fann_save_shared>, otherwise load it with
+   <fann_create_from_file>.
+ */
+FANN_EXTERNAL struct fann *FANN_API fann_load_network(const char *file);
+
 #endif
 #endif
 
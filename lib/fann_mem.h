@@ -31,6 +31,7 @@
 #undef STATIC_MEMORY_ALLOCS
 #endif
 
+// bytes allocated so far, not decreased by fann_free (which does not know the size)
 extern unsigned int fann_mem_current;
 
 #ifdef STATIC_MEMORY_ALLOCS
@@ -66,8 +67,8 @@ unsigned int fann_mem_debug(void);
 //#define fann_realloc(ptr, len) { ptr = (typeof(ptr)) realloc(ptr, (len) * sizeof(*(ptr))); }
 
 #define fann_memcpy(dest, src, len) { memcpy(dest, src, (len) * sizeof(*(dest))); }
-#define fann_calloc(ptr, len) { ptr = (typeof(ptr)) calloc((len), sizeof(*(ptr))); fann_mem_current += len * sizeof(*(ptr)); }
-#define fann_malloc(ptr, len) { ptr = (typeof(ptr)) malloc((len) * sizeof(*(ptr))); fann_mem_current += len; }
+#define fann_calloc(ptr, len) { ptr = (typeof(ptr)) calloc((len), sizeof(*(ptr))); fann_mem_current += (len) * sizeof(*(ptr)); }
+#define fann_malloc(ptr, len) { ptr = (typeof(ptr)) malloc((len) * sizeof(*(ptr))); fann_mem_current += (len) * sizeof(*(ptr)); }
 #define fann_free(ptr) { if (ptr != NULL) { free(ptr); ptr = NULL; }}
 
 #endif // DEBUG_MEMORY_ALLOCS
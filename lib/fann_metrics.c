@@ -0,0 +1,474 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#include "fann.h"
+
+#ifdef FANN_METRICS
+
+#include <pthread.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define FANN_METRICS_TEXT 16384
+
+/* written by the training threads with relaxed atomics */
+struct fann_metrics_counters {
+    uint64_t samples_trained;
+    uint64_t samples_tested;
+    uint64_t epochs;
+    uint64_t updates;
+    uint64_t overflows[FANN_COUNT_LAYERS];
+    uint32_t epoch;
+    uint32_t bit_fail;
+    uint32_t loss;      // bits of the float
+};
+
+/* a snapshot, with what the rates need */
+struct fann_metrics_snap {
+    struct fann_metrics_counters c;
+    uint64_t ns;
+    uint64_t resident_bytes;
+#ifdef FANN_PROFILE
+    double phase_seconds[FANN_PHASE_COUNT];
+#endif
+#ifdef FANN_THREADS
+    unsigned int num_procs;
+    struct fann_thread_times times[FANN_THREADS + 1];
+#endif
+};
+
+struct fann_metrics_text {
+    char buf[FANN_METRICS_TEXT];
+    unsigned int len;
+};
+
+__thread unsigned int fann_metrics_pending = 0;
+
+static struct fann_metrics_counters fann_metrics_total;
+
+static struct {
+    pthread_t thread;
+    int running;
+    struct fann *ann;
+    int fd;
+    int listen_fd;
+    int stop_pipe[2];
+    unsigned int interval_ms;
+    struct fann_metrics_snap prev;
+    struct fann_metrics_text json, prom;
+} fann_metrics_state = {.running = 0};
+
+#define fann_metrics_add(field, n) __atomic_fetch_add(&(field), (n), __ATOMIC_RELAXED)
+#define fann_metrics_load(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define fann_metrics_store(field, v) __atomic_store_n(&(field), (v), __ATOMIC_RELAXED)
+
+void fann_metrics_publish(int update)
+{
+    if (fann_metrics_pending) {
+        fann_metrics_add(fann_metrics_total.samples_trained, fann_metrics_pending);
+        fann_metrics_pending = 0;
+    }
+    if (update) {
+        fann_metrics_add(fann_metrics_total.updates, 1);
+    }
+}
+
+void fann_metrics_epoch(struct fann *ann, float error)
+{
+    union {
+        float f;
+        uint32_t u;
+    } loss;
+
+    fann_metrics_publish(0);
+    fann_metrics_add(fann_metrics_total.epochs, 1);
+    fann_metrics_store(fann_metrics_total.epoch, ann->train_epoch);
+    loss.f = error;
+    fann_metrics_store(fann_metrics_total.loss, loss.u);
+#ifdef CALCULATE_ERROR
+    fann_metrics_store(fann_metrics_total.bit_fail, ann->num_bit_fail[0] + ann->num_bit_fail[1]);
+#endif
+}
+
+void fann_metrics_overflows(unsigned int l, unsigned int overflows)
+{
+    if (overflows) {
+        fann_metrics_add(fann_metrics_total.overflows[(l < FANN_COUNT_LAYERS) ? l : FANN_COUNT_LAYERS - 1],
+                         overflows);
+    }
+}
+
+void fann_metrics_tested(unsigned int num)
+{
+    fann_metrics_add(fann_metrics_total.samples_tested, num);
+}
+
+static uint64_t fann_metrics_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* INTERNAL FUNCTION
+   Resident set size of the process, 0 if /proc is not there.
+ */
+static uint64_t fann_metrics_resident(void)
+{
+    unsigned long size, resident;
+    FILE *file = fopen("/proc/self/statm", "r");
+
+    if (file == NULL) {
+        return 0;
+    }
+    if (fscanf(file, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(file);
+    return (uint64_t)resident * (uint64_t)sysconf(_SC_PAGESIZE);
+}
+
+static void fann_metrics_snapshot(struct fann_metrics_snap *snap)
+{
+    unsigned int l;
+
+    snap->ns = fann_metrics_ns();
+    snap->resident_bytes = fann_metrics_resident();
+    snap->c.samples_trained = fann_metrics_load(fann_metrics_total.samples_trained);
+    snap->c.samples_tested = fann_metrics_load(fann_metrics_total.samples_tested);
+    snap->c.epochs = fann_metrics_load(fann_metrics_total.epochs);
+    snap->c.updates = fann_metrics_load(fann_metrics_total.updates);
+    for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+        snap->c.overflows[l] = fann_metrics_load(fann_metrics_total.overflows[l]);
+    }
+    snap->c.epoch = fann_metrics_load(fann_metrics_total.epoch);
+    snap->c.bit_fail = fann_metrics_load(fann_metrics_total.bit_fail);
+    snap->c.loss = fann_metrics_load(fann_metrics_total.loss);
+#ifdef FANN_PROFILE
+    fann_prof_seconds(snap->phase_seconds);
+#endif
+#ifdef FANN_THREADS
+    // read while the threads run, a torn value only skews one interval
+    snap->num_procs = (fann_metrics_state.ann != NULL) ?
+        fann_get_thread_times(fann_metrics_state.ann, snap->times) : 0;
+#endif
+}
+
+static void fann_metrics_printf(struct fann_metrics_text *text, const char *format, ...)
+{
+    va_list ap;
+    int n;
+
+    if (text->len >= FANN_METRICS_TEXT) {
+        return;
+    }
+    va_start(ap, format);
+    n = vsnprintf(text->buf + text->len, FANN_METRICS_TEXT - text->len, format, ap);
+    va_end(ap);
+    text->len = (n < 0) ? FANN_METRICS_TEXT : text->len + (unsigned int)n;
+}
+
+static double fann_metrics_rate(uint64_t now, uint64_t prev, double seconds)
+{
+    return (seconds > 0.0) ? (double)(now - prev) / seconds : 0.0;
+}
+
+#ifdef FANN_THREADS
+/* share of the time since prev that thread p worked, -1 if it did not run */
+static double fann_metrics_utilization(const struct fann_metrics_snap *snap,
+                                       const struct fann_metrics_snap *prev, unsigned int p)
+{
+    uint64_t work = snap->times[p].work_ns, wait = snap->times[p].wait_ns;
+
+    if (p < prev->num_procs) {
+        work -= prev->times[p].work_ns;
+        wait -= prev->times[p].wait_ns;
+    }
+    return (work + wait > 0) ? (double)work / (double)(work + wait) : -1.0;
+}
+#endif
+
+/* INTERNAL FUNCTION
+   Both texts of snap, with the rates since prev.
+ */
+static void fann_metrics_format(const struct fann_metrics_snap *snap, const struct fann_metrics_snap *prev)
+{
+    struct fann_metrics_text *json = &fann_metrics_state.json, *prom = &fann_metrics_state.prom;
+    double seconds = (double)(snap->ns - prev->ns) * 1e-9;
+    double trained = fann_metrics_rate(snap->c.samples_trained, prev->c.samples_trained, seconds);
+    double tested = fann_metrics_rate(snap->c.samples_tested, prev->c.samples_tested, seconds);
+    double epochs = fann_metrics_rate(snap->c.epochs, prev->c.epochs, seconds);
+    union {
+        uint32_t u;
+        float f;
+    } loss;
+    struct timespec now;
+    unsigned int l, last;
+    int first;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    loss.u = snap->c.loss;
+    for (last = FANN_COUNT_LAYERS; (last > 0) && (snap->c.overflows[last - 1] == 0); last--);
+    json->len = prom->len = 0;
+    fann_metrics_printf(json, "{\"time\": %.3f, \"back_end\": \"%s\", \"samples_trained\": %" PRIu64
+                        ", \"samples_per_second\": %.1f, \"samples_tested\": %" PRIu64
+                        ", \"tested_per_second\": %.1f, \"epochs\": %" PRIu64 ", \"epochs_per_second\": %.3f"
+                        ", \"updates\": %" PRIu64 ", \"epoch\": %u, \"loss\": %.9g, \"bit_fail\": %u"
+                        ", \"resident_bytes\": %" PRIu64 ", \"overflows\": [",
+                        (double)now.tv_sec + 1e-9 * (double)now.tv_nsec, fann_float_type, snap->c.samples_trained, trained,
+                        snap->c.samples_tested, tested, snap->c.epochs, epochs, snap->c.updates,
+                        snap->c.epoch, loss.f, snap->c.bit_fail, snap->resident_bytes);
+    fann_metrics_printf(prom, "# TYPE fann_samples_trained_total counter\nfann_samples_trained_total %" PRIu64 "\n"
+                        "# TYPE fann_samples_per_second gauge\nfann_samples_per_second %.1f\n"
+                        "# TYPE fann_samples_tested_total counter\nfann_samples_tested_total %" PRIu64 "\n"
+                        "# TYPE fann_tested_per_second gauge\nfann_tested_per_second %.1f\n"
+                        "# TYPE fann_epochs_total counter\nfann_epochs_total %" PRIu64 "\n"
+                        "# TYPE fann_epochs_per_second gauge\nfann_epochs_per_second %.3f\n"
+                        "# TYPE fann_updates_total counter\nfann_updates_total %" PRIu64 "\n"
+                        "# TYPE fann_epoch gauge\nfann_epoch %u\n"
+                        "# TYPE fann_loss gauge\nfann_loss %.9g\n"
+                        "# TYPE fann_bit_fail gauge\nfann_bit_fail %u\n"
+                        "# TYPE fann_resident_memory_bytes gauge\nfann_resident_memory_bytes %" PRIu64 "\n"
+                        "# TYPE fann_overflows_total counter\n",
+                        snap->c.samples_trained, trained, snap->c.samples_tested, tested,
+                        snap->c.epochs, epochs, snap->c.updates, snap->c.epoch, loss.f,
+                        snap->c.bit_fail, snap->resident_bytes);
+    for (l = 0; l < last; l++) {
+        fann_metrics_printf(json, "%s%" PRIu64, l ? ", " : "", snap->c.overflows[l]);
+        fann_metrics_printf(prom, "fann_overflows_total{layer=\"%u\"} %" PRIu64 "\n", l, snap->c.overflows[l]);
+    }
+    fann_metrics_printf(json, "]");
+#ifdef FANN_PROFILE
+    fann_metrics_printf(json, ", \"phase_seconds\": {");
+    fann_metrics_printf(prom, "# TYPE fann_phase_seconds_total counter\n");
+    for (l = 0; l < FANN_PHASE_COUNT; l++) {
+        fann_metrics_printf(json, "%s\"%s\": %.6f", l ? ", " : "", FANN_PHASE_NAMES[l], snap->phase_seconds[l]);
+        fann_metrics_printf(prom, "fann_phase_seconds_total{phase=\"%s\"} %.6f\n",
+                            FANN_PHASE_NAMES[l], snap->phase_seconds[l]);
+    }
+    fann_metrics_printf(json, "}");
+#endif
+#ifdef FANN_THREADS
+    fann_metrics_printf(json, ", \"thread_utilization\": [");
+    fann_metrics_printf(prom, "# TYPE fann_thread_utilization gauge\n");
+    for (l = 0, first = 1; l < snap->num_procs; l++) {
+        double u = fann_metrics_utilization(snap, prev, l);
+
+        if (u < 0.0) {
+            fann_metrics_printf(json, "%snull", first ? "" : ", ");
+        } else {
+            fann_metrics_printf(json, "%s%.4f", first ? "" : ", ", u);
+            fann_metrics_printf(prom, "fann_thread_utilization{thread=\"%u\"} %.4f\n", l, u);
+        }
+        first = 0;
+    }
+    fann_metrics_printf(json, "]");
+#else
+    (void)first;
+#endif
+    fann_metrics_printf(json, "}\n");
+}
+
+/* INTERNAL FUNCTION
+   Writes all of text to fd. Sockets are sent with MSG_NOSIGNAL: a client
+   closing early must not SIGPIPE the trainer.
+ */
+static void fann_metrics_write(int fd, const struct fann_metrics_text *text, int sock)
+{
+    unsigned int done = 0;
+    ssize_t n;
+
+    while (done < text->len) {
+        if (sock) {
+            n = send(fd, text->buf + done, text->len - done, MSG_NOSIGNAL);
+        } else {
+            n = write(fd, text->buf + done, text->len - done);
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        done += (unsigned int)n;
+    }
+}
+
+/* INTERNAL FUNCTION
+   Answers one connection with the Prometheus text, whatever it asked.
+ */
+static void fann_metrics_serve(int listen_fd)
+{
+    struct fann_metrics_text head;
+    struct pollfd pfd;
+    char request[1024];
+    int fd = accept(listen_fd, NULL, NULL);
+
+    if (fd < 0) {
+        return;
+    }
+    // the request is read but not parsed, a slow client can not stall training
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 100) > 0) {
+        if (read(fd, request, sizeof(request)) < 0) {
+            request[0] = '\0';
+        }
+    }
+    head.len = 0;
+    fann_metrics_printf(&head, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                        "Content-Length: %u\r\nConnection: close\r\n\r\n", fann_metrics_state.prom.len);
+    fann_metrics_write(fd, &head, 1);
+    fann_metrics_write(fd, &fann_metrics_state.prom, 1);
+    close(fd);
+}
+
+static void *fann_metrics_thread(void *arg)
+{
+    struct fann_metrics_snap snap;
+    struct pollfd pfd[2];
+    uint64_t next = fann_metrics_ns();
+    int timeout, n;
+
+    (void)arg;
+    pfd[0].fd = fann_metrics_state.stop_pipe[0];
+    pfd[0].events = POLLIN;
+    pfd[1].fd = fann_metrics_state.listen_fd;
+    pfd[1].events = POLLIN;
+    for (;;) {
+        uint64_t now = fann_metrics_ns();
+
+        if (now >= next) {
+            fann_metrics_snapshot(&snap);
+            fann_metrics_format(&snap, &fann_metrics_state.prev);
+            fann_metrics_state.prev = snap;
+            if (fann_metrics_state.fd >= 0) {
+                fann_metrics_write(fann_metrics_state.fd, &fann_metrics_state.json, 0);
+            }
+            next = now + (uint64_t)fann_metrics_state.interval_ms * 1000000;
+            continue;
+        }
+        timeout = (int)((next - now + 999999) / 1000000);
+        n = poll(pfd, (fann_metrics_state.listen_fd >= 0) ? 2 : 1, timeout);
+        if ((n > 0) && (pfd[0].revents & POLLIN)) {
+            break;
+        }
+        if ((n > 0) && (pfd[1].revents & POLLIN)) {
+            fann_metrics_serve(fann_metrics_state.listen_fd);
+        }
+    }
+    return NULL;
+}
+
+static int fann_metrics_listen(int port)
+{
+    struct sockaddr_in addr;
+    int fd, one = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(fd, 8)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+FANN_EXTERNAL int FANN_API fann_metrics_start(struct fann *ann, int fd, int port,
+                                              unsigned int interval_ms)
+{
+    if (fann_metrics_state.running) {
+        fann_error(FANN_E_METRICS, "already running");
+        return -1;
+    }
+    fann_metrics_state.ann = ann;
+    fann_metrics_state.fd = fd;
+    fann_metrics_state.interval_ms = interval_ms ? interval_ms : 1000;
+    fann_metrics_state.listen_fd = -1;
+    if ((port > 0) && ((fann_metrics_state.listen_fd = fann_metrics_listen(port)) < 0)) {
+        fann_error(FANN_E_METRICS, strerror(errno));
+        return -1;
+    }
+    if (pipe(fann_metrics_state.stop_pipe)) {
+        fann_error(FANN_E_METRICS, strerror(errno));
+        if (fann_metrics_state.listen_fd >= 0) {
+            close(fann_metrics_state.listen_fd);
+        }
+        return -1;
+    }
+    // rates of the first line from now
+    fann_metrics_snapshot(&fann_metrics_state.prev);
+    if (pthread_create(&fann_metrics_state.thread, NULL, fann_metrics_thread, NULL)) {
+        fann_error(FANN_E_METRICS, "can not create the thread");
+        close(fann_metrics_state.stop_pipe[0]);
+        close(fann_metrics_state.stop_pipe[1]);
+        if (fann_metrics_state.listen_fd >= 0) {
+            close(fann_metrics_state.listen_fd);
+        }
+        return -1;
+    }
+    fann_metrics_state.running = 1;
+    return 0;
+}
+
+FANN_EXTERNAL void FANN_API fann_metrics_stop(void)
+{
+    struct fann_metrics_snap snap;
+
+    if (!fann_metrics_state.running) {
+        return;
+    }
+    if (write(fann_metrics_state.stop_pipe[1], "", 1) == 1) {
+        pthread_join(fann_metrics_state.thread, NULL);
+    } else {
+        pthread_cancel(fann_metrics_state.thread);
+        pthread_join(fann_metrics_state.thread, NULL);
+    }
+    fann_metrics_publish(0);
+    if (fann_metrics_state.fd >= 0) {
+        fann_metrics_snapshot(&snap);
+        fann_metrics_format(&snap, &fann_metrics_state.prev);
+        fann_metrics_write(fann_metrics_state.fd, &fann_metrics_state.json, 0);
+    }
+    close(fann_metrics_state.stop_pipe[0]);
+    close(fann_metrics_state.stop_pipe[1]);
+    if (fann_metrics_state.listen_fd >= 0) {
+        close(fann_metrics_state.listen_fd);
+    }
+    fann_metrics_state.ann = NULL;
+    fann_metrics_state.running = 0;
+}
+
+#endif // FANN_METRICS
@@ -0,0 +1,98 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_metrics_h
+#define _fann_metrics_h
+
+/* Live metrics of training and testing, for dashboards.
+ *
+ * Training and testing add to process wide counters: samples trained and
+ * tested, epochs, weight updates after each (mini) batch and the bp
+ * overflows of each layer, and set the loss and bit fails of the last
+ * epoch. Each thread counts its samples locally and publishes them with
+ * one relaxed atomic add per update or every FANN_METRICS_PUBLISH samples.
+ *
+ * fann_metrics_start() starts a thread that takes a snapshot every
+ * interval, adds the rates since the previous one, the resident memory
+ * of the process (from /proc/self/statm), the phase times measured by the profiler (see
+ * fann_prof.h) and the utilization of the threads of a network, and then
+ * writes it as one JSON line to a file descriptor and/or serves it as
+ * Prometheus text on 127.0.0.1.
+ */
+
+#include "fann_count.h"
+
+#ifdef FANN_COUNTERS
+#define FANN_METRICS
+#endif
+
+#ifdef FANN_METRICS
+
+#define FANN_METRICS_PUBLISH 256
+
+/* samples counted by this thread and not yet published */
+extern __thread unsigned int fann_metrics_pending;
+
+/* Function: fann_metrics_start
+
+   Starts the metrics thread. Every *interval_ms* it writes a JSON line to
+   *fd* (if >= 0) and updates the text served to HTTP GET requests on
+   127.0.0.1:*port* (if > 0). With *ann*, the snapshots include the
+   utilization of its threads (work / (work + wait) since the last one);
+   *ann* must then live until <fann_metrics_stop>.
+
+   Returns:
+   0 on success, -1 if the socket or the thread can not be created or the
+   metrics already run.
+ */
+FANN_EXTERNAL int FANN_API fann_metrics_start(struct fann *ann, int fd, int port,
+                                              unsigned int interval_ms);
+
+/* Function: fann_metrics_stop
+
+   Writes a last JSON line, stops the thread and closes the socket (not
+   *fd*).
+ */
+FANN_EXTERNAL void FANN_API fann_metrics_stop(void);
+
+/* INTERNAL FUNCTIONS
+   Publishes the samples of this thread (and a weight update with
+   update), ends an epoch of ann with its loss, counts overflows of layer
+   l and a test of num samples.
+ */
+void fann_metrics_publish(int update);
+void fann_metrics_epoch(struct fann *ann, float error);
+void fann_metrics_overflows(unsigned int l, unsigned int overflows);
+void fann_metrics_tested(unsigned int num);
+
+#define fann_metrics_sample() \
+    {if (++fann_metrics_pending >= FANN_METRICS_PUBLISH) fann_metrics_publish(0);}
+
+#else // !FANN_METRICS
+
+#define fann_metrics_sample()
+#define fann_metrics_publish(update)
+#define fann_metrics_epoch(ann, error)
+#define fann_metrics_overflows(l, overflows)
+#define fann_metrics_tested(num)
+
+#endif // FANN_METRICS
+
+#endif // _fann_metrics_h
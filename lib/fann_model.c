@@ -0,0 +1,335 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#include "fann.h"
+
+#ifndef FANN_INFERENCE_ONLY
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+/* grace period poll of the loader, in ns */
+#define FANN_MODEL_POLL 20000
+
+struct fann_model_version {
+    unsigned int num;
+    struct fann **ann;      // one per reader
+};
+
+/* odd while the reader holds a network, on a cache line of its own */
+struct fann_model_reader {
+    unsigned long seq;
+    char pad[64 - sizeof(unsigned long)];
+};
+
+struct fann_model {
+    struct fann_model_version *current;
+    unsigned int seq;       // versions installed
+    unsigned int num_readers;
+    unsigned int num_input;
+    unsigned int num_output;
+    struct fann_model_reader *readers;
+    unsigned long *snap;    // loader only
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int stop;
+    int busy;               // a reload is queued or running
+    int status;
+    char *file;             // queued reload
+    struct fann *ann;
+};
+
+/* the copies first, ann[0] frees the weights they share */
+static void fann_model_free_version(struct fann_model_version *v)
+{
+    unsigned int r;
+
+    for (r = v->num; r-- > 0; ) {
+        if (v->ann[r] != NULL) {
+            fann_destroy(v->ann[r]);
+        }
+    }
+    free(v->ann);
+    free(v);
+}
+
+/* INTERNAL FUNCTION
+   A version of ann, which it then owns, with a copy for each reader but
+   the first. NULL on errors, ann destroyed.
+ */
+static struct fann_model_version *fann_model_new_version(struct fann *ann, unsigned int num)
+{
+    struct fann_model_version *v;
+    unsigned int r;
+
+    v = (struct fann_model_version *)calloc(1, sizeof(struct fann_model_version));
+    if (v != NULL) {
+        v->ann = (struct fann **)calloc(num, sizeof(struct fann *));
+    }
+    if ((v == NULL) || (v->ann == NULL)) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        free(v);
+        fann_destroy(ann);
+        return NULL;
+    }
+    v->num = num;
+    v->ann[0] = ann;
+    for (r = 1; r < num; r++) {
+        v->ann[r] = fann_copy(ann);
+        if (v->ann[r] == NULL) {
+            fann_model_free_version(v);
+            return NULL;
+        }
+    }
+    return v;
+}
+
+/* INTERNAL FUNCTION
+   Waits until every reader that may hold a network of the version swapped
+   out has released it: those that held one (odd) when it was swapped.
+ */
+static void fann_model_grace(struct fann_model *model)
+{
+    struct timespec poll = {0, FANN_MODEL_POLL};
+    unsigned int r;
+
+    for (r = 0; r < model->num_readers; r++) {
+        model->snap[r] = __atomic_load_n(&(model->readers[r].seq), __ATOMIC_SEQ_CST);
+    }
+    for (r = 0; r < model->num_readers; r++) {
+        if (model->snap[r] & 1) {
+            while (__atomic_load_n(&(model->readers[r].seq), __ATOMIC_ACQUIRE) == model->snap[r]) {
+                nanosleep(&poll, NULL);
+            }
+        }
+    }
+}
+
+/* INTERNAL FUNCTION
+   Installs ann as the next version, 0 on success.
+ */
+static int fann_model_swap(struct fann_model *model, struct fann *ann)
+{
+    struct fann_model_version *v, *old;
+
+    if ((ann->num_input != model->num_input) || (ann->num_output != model->num_output)) {
+        fann_error(FANN_E_MODEL, "the new network has other inputs or outputs");
+        fann_destroy(ann);
+        return -1;
+    }
+    v = fann_model_new_version(ann, model->num_readers);
+    if (v == NULL) {
+        return -1;
+    }
+    old = __atomic_exchange_n(&(model->current), v, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&(model->seq), model->seq + 1, __ATOMIC_RELAXED);
+    fann_model_grace(model);
+    fann_model_free_version(old);
+    return 0;
+}
+
+static void *fann_model_loader(void *arg)
+{
+    struct fann_model *model = (struct fann_model *)arg;
+    struct fann *ann;
+    char *file;
+    int status;
+
+    pthread_mutex_lock(&(model->lock));
+    for (;;) {
+        while (!model->stop && (model->file == NULL) && (model->ann == NULL)) {
+            pthread_cond_wait(&(model->cond), &(model->lock));
+        }
+        if (model->stop) {
+            break;
+        }
+        file = model->file;
+        ann = model->ann;
+        model->file = NULL;
+        model->ann = NULL;
+        pthread_mutex_unlock(&(model->lock));
+
+        if (file != NULL) {
+            ann = fann_load_network(file);
+            free(file);
+        }
+        status = (ann != NULL) ? fann_model_swap(model, ann) : -1;
+
+        pthread_mutex_lock(&(model->lock));
+        model->status = status;
+        if ((model->file == NULL) && (model->ann == NULL)) {
+            model->busy = 0;
+            pthread_cond_broadcast(&(model->cond));
+        }
+    }
+    pthread_mutex_unlock(&(model->lock));
+    return NULL;
+}
+
+FANN_EXTERNAL struct fann_model * FANN_API fann_model_create(const char *file,
+                                                             unsigned int readers)
+{
+    struct fann_model *model;
+    struct fann *ann;
+    void *mem;
+
+    if (readers == 0) {
+        readers = 1;
+    }
+    ann = fann_load_network(file);
+    if (ann == NULL) {
+        return NULL;
+    }
+    model = (struct fann_model *)calloc(1, sizeof(struct fann_model));
+    if ((model == NULL) || posix_memalign(&mem, 64, readers * sizeof(struct fann_model_reader))) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        free(model);
+        fann_destroy(ann);
+        return NULL;
+    }
+    model->readers = (struct fann_model_reader *)mem;
+    memset(model->readers, 0, readers * sizeof(struct fann_model_reader));
+    model->snap = (unsigned long *)calloc(readers, sizeof(unsigned long));
+    model->num_readers = readers;
+    model->num_input = ann->num_input;
+    model->num_output = ann->num_output;
+    model->current = (model->snap != NULL) ? fann_model_new_version(ann, readers) : NULL;
+    if (model->current == NULL) {
+        if (model->snap == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            fann_destroy(ann);
+        }
+        free(model->snap);
+        free(model->readers);
+        free(model);
+        return NULL;
+    }
+    model->seq = 1;
+    pthread_mutex_init(&(model->lock), NULL);
+    pthread_cond_init(&(model->cond), NULL);
+    if (pthread_create(&(model->thread), NULL, fann_model_loader, model)) {
+        fann_error(FANN_E_MODEL, "can not create the loader thread");
+        pthread_mutex_destroy(&(model->lock));
+        pthread_cond_destroy(&(model->cond));
+        fann_model_free_version(model->current);
+        free(model->snap);
+        free(model->readers);
+        free(model);
+        return NULL;
+    }
+    return model;
+}
+
+FANN_EXTERNAL void FANN_API fann_model_destroy(struct fann_model *model)
+{
+    if (model == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&(model->lock));
+    model->stop = 1;
+    pthread_cond_broadcast(&(model->cond));
+    pthread_mutex_unlock(&(model->lock));
+    pthread_join(model->thread, NULL);
+    free(model->file);
+    if (model->ann != NULL) {
+        fann_destroy(model->ann);
+    }
+    pthread_mutex_destroy(&(model->lock));
+    pthread_cond_destroy(&(model->cond));
+    fann_model_free_version(model->current);
+    free(model->snap);
+    free(model->readers);
+    free(model);
+}
+
+FANN_EXTERNAL struct fann * FANN_API fann_model_acquire(struct fann_model *model,
+                                                        unsigned int reader)
+{
+    struct fann_model_reader *r = model->readers + reader;
+
+    // odd before current is read: a swap after this store waits for the
+    // release, a swap before it is seen by the load
+    __atomic_store_n(&(r->seq), r->seq + 1, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&(model->current), __ATOMIC_SEQ_CST)->ann[reader];
+}
+
+FANN_EXTERNAL void FANN_API fann_model_release(struct fann_model *model, unsigned int reader)
+{
+    struct fann_model_reader *r = model->readers + reader;
+
+    __atomic_store_n(&(r->seq), r->seq + 1, __ATOMIC_RELEASE);
+}
+
+FANN_EXTERNAL int FANN_API fann_model_reload(struct fann_model *model, const char *file)
+{
+    char *copy = strdup(file);
+
+    if (copy == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+    pthread_mutex_lock(&(model->lock));
+    free(model->file);
+    if (model->ann != NULL) {
+        fann_destroy(model->ann);
+        model->ann = NULL;
+    }
+    model->file = copy;
+    model->busy = 1;
+    pthread_cond_broadcast(&(model->cond));
+    pthread_mutex_unlock(&(model->lock));
+    return 0;
+}
+
+FANN_EXTERNAL void FANN_API fann_model_install(struct fann_model *model, struct fann *ann)
+{
+    pthread_mutex_lock(&(model->lock));
+    free(model->file);
+    model->file = NULL;
+    if (model->ann != NULL) {
+        fann_destroy(model->ann);
+    }
+    model->ann = ann;
+    model->busy = 1;
+    pthread_cond_broadcast(&(model->cond));
+    pthread_mutex_unlock(&(model->lock));
+}
+
+FANN_EXTERNAL int FANN_API fann_model_wait(struct fann_model *model)
+{
+    int status;
+
+    pthread_mutex_lock(&(model->lock));
+    while (model->busy) {
+        pthread_cond_wait(&(model->cond), &(model->lock));
+    }
+    status = model->status;
+    pthread_mutex_unlock(&(model->lock));
+    return status;
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_model_version(struct fann_model *model)
+{
+    return __atomic_load_n(&(model->seq), __ATOMIC_RELAXED);
+}
+
+#endif // FANN_INFERENCE_ONLY
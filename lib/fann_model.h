@@ -0,0 +1,125 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_model_h
+#define _fann_model_h
+
+/* Hot swappable network, for threads that serve inferences while the
+ * network is retrained or replaced.
+ *
+ * A model holds its current version: the network, copied once for each
+ * reader since fann_run writes the values of the neurons. A reader takes
+ * the network of the current version with fann_model_acquire() and gives
+ * it back with fann_model_release(); each costs an atomic store and (the
+ * first) a load, never a lock or a wait.
+ *
+ * fann_model_reload() and fann_model_install() hand a network to a loader
+ * thread, which loads and copies it off the path of the readers, swaps the
+ * current version with one atomic exchange and then waits for a grace
+ * period: every reader that was between acquire and release at the swap
+ * must release (or acquire again) before the old version is destroyed.
+ * Readers that acquire after the swap already run the new version, so an
+ * inference never sees a network that is being loaded or freed.
+ *
+ * Images saved by fann_save_shared() are attached instead of loaded: the
+ * loader maps them, and every version and reader copy runs on weights
+ * shared with the other processes that attach the same file.
+ */
+
+#ifndef FANN_INFERENCE_ONLY
+
+struct fann_model;
+
+/* Function: fann_model_create
+
+   Loads the network of *file* (see <fann_load_network>) as the first
+   version of a model with *readers* readers, numbered from 0, and starts
+   its loader thread. Each reader number must be used by one thread at a
+   time.
+
+   Returns:
+   The model, or NULL on errors.
+ */
+FANN_EXTERNAL struct fann_model * FANN_API fann_model_create(const char *file,
+                                                             unsigned int readers);
+
+/* Function: fann_model_destroy
+
+   Stops the loader thread, dropping a reload that has not started, and
+   destroys the model. No reader may hold a network.
+ */
+FANN_EXTERNAL void FANN_API fann_model_destroy(struct fann_model *model);
+
+/* Function: fann_model_acquire
+
+   Takes the network of the current version for *reader*, to run until
+   <fann_model_release>. Acquires do not nest.
+ */
+FANN_EXTERNAL struct fann * FANN_API fann_model_acquire(struct fann_model *model,
+                                                        unsigned int reader);
+
+/* Function: fann_model_release
+
+   Gives back the network taken by *reader*, which may then be destroyed
+   by a reload.
+ */
+FANN_EXTERNAL void FANN_API fann_model_release(struct fann_model *model, unsigned int reader);
+
+/* Function: fann_model_reload
+
+   Queues the network of *file* as the next version and returns; a reload
+   queued and not yet started is replaced. The network must have the
+   inputs and outputs of the model, otherwise the current version stays.
+   See <fann_model_wait>.
+
+   Returns:
+   0, or -1 if the name can not be copied.
+ */
+FANN_EXTERNAL int FANN_API fann_model_reload(struct fann_model *model, const char *file);
+
+/* Function: fann_model_install
+
+   Like <fann_model_reload>, with a network built by the caller (e.g. just
+   trained), which the model then owns: it is destroyed with its version,
+   or if it can not be installed.
+ */
+FANN_EXTERNAL void FANN_API fann_model_install(struct fann_model *model, struct fann *ann);
+
+/* Function: fann_model_wait
+
+   Waits until the queued reloads are done, including the grace period of
+   the old version.
+
+   Returns:
+   0 if the last one was installed, -1 if it failed (the error was
+   reported by <fann_error>).
+ */
+FANN_EXTERNAL int FANN_API fann_model_wait(struct fann_model *model);
+
+/* Function: fann_model_version
+
+   Returns the number of versions installed, 1 for the network loaded by
+   <fann_model_create>.
+ */
+FANN_EXTERNAL unsigned int FANN_API fann_model_version(struct fann_model *model);
+
+#endif // FANN_INFERENCE_ONLY
+
+#endif // _fann_model_h
@@ -0,0 +1,679 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#include "fann.h"
+
+#ifdef FANN_PROFILE
+
+#include <pthread.h>
+#include <inttypes.h>
+#include <time.h>
+#if (defined __x86_64__) || (defined __i386__)
+#include <x86intrin.h>
+#define FANN_PROF_TSC
+#endif
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define FANN_PROF_HW
+#endif
+
+// 4 per power of 2, up to 2^40 ticks
+#define FANN_PROF_BUCKETS 160
+
+#define FANN_PROF_EVENTS 6
+
+static const char * const fann_prof_event_names[FANN_PROF_EVENTS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+};
+
+struct fann_prof_hist {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint32_t bucket[FANN_PROF_BUCKETS];
+    // hardware events, summed over the hw_count passes that counted them
+    uint64_t hw_count;
+    uint64_t hw[FANN_PROF_EVENTS];
+};
+
+struct fann_prof_block {
+    struct fann_prof_hist phase[FANN_PHASE_COUNT];
+    struct fann_prof_hist layer[FANN_COUNT_LAYERS][FANN_PHASE_COUNT];
+    // time the event group of the thread was enabled and counting (ns)
+    uint64_t hw_enabled;
+    uint64_t hw_running;
+    struct fann_prof_block *next;
+};
+
+/* what this thread is timing */
+struct fann_prof_state {
+    struct fann_prof_block *block;
+    unsigned int countdown;
+    int active;             // this sample (or batch update) is timed
+    int phase;              // open phase, -1 if none
+    int layer;              // open layer pass, -1 if none
+    int layer_phase;
+    unsigned int touched;   // phases with time in acc
+    uint64_t t_phase;
+    uint64_t t_layer;
+    uint64_t acc[FANN_PHASE_COUNT];
+    // hardware events of this thread (perf_event_open), read at the same
+    // points as the clock when hw_live
+    int hw_live;
+    int hw_tried;
+    unsigned int hw_n;
+    unsigned int hw_mask;
+    unsigned int hw_touched;
+    int hw_fd[FANN_PROF_EVENTS];
+    uint64_t hw_enabled;
+    uint64_t hw_running;
+    uint64_t hw_phase[FANN_PROF_EVENTS];
+    uint64_t hw_layer[FANN_PROF_EVENTS];
+    uint64_t hw_acc[FANN_PHASE_COUNT][FANN_PROF_EVENTS];
+};
+
+static __thread struct fann_prof_state fann_prof_tls = {NULL, 0, 0, -1, -1, 0, 0, 0, 0, {0, }};
+
+static unsigned int fann_prof_every = 0;
+static struct fann_prof_block *fann_prof_blocks = NULL;
+static unsigned int fann_prof_num_blocks = 0;
+static pthread_mutex_t fann_prof_lock = PTHREAD_MUTEX_INITIALIZER;
+// clocks when enabled, to convert ticks to ns
+static uint64_t fann_prof_tick0 = 0, fann_prof_ns0 = 0;
+// hardware events requested, those that fit in one group (narrowed by the
+// first thread that opens them) and the error when none can be opened
+static int fann_prof_hw_on = 0;
+static unsigned int fann_prof_hw_mask = (1u << FANN_PROF_EVENTS) - 1;
+static int fann_prof_hw_errno = 0;
+
+static uint64_t fann_prof_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t fann_prof_now(void)
+{
+#ifdef FANN_PROF_TSC
+    return __rdtsc();
+#else
+    return fann_prof_ns();
+#endif
+}
+
+static unsigned int fann_prof_bucket(uint64_t t)
+{
+    unsigned int e, b;
+
+    if (t < 4) {
+        return (unsigned int)t;
+    }
+    e = 63 - __builtin_clzll(t);
+    b = 4 * (e - 1) + (unsigned int)((t >> (e - 2)) & 3);
+    return (b < FANN_PROF_BUCKETS) ? b : FANN_PROF_BUCKETS - 1;
+}
+
+/* middle of the ticks of bucket b */
+static double fann_prof_bucket_mid(unsigned int b)
+{
+    unsigned int e;
+
+    if (b < 4) {
+        return (double)b;
+    }
+    e = b / 4 + 1;
+    return (double)((uint64_t)(4 + b % 4) << (e - 2)) + 0.5 * (double)((uint64_t)1 << (e - 2));
+}
+
+static void fann_prof_add(struct fann_prof_hist *h, uint64_t t, const uint64_t *hw)
+{
+    unsigned int e;
+
+    h->count++;
+    h->sum += t;
+    if (t > h->max) {
+        h->max = t;
+    }
+    h->bucket[fann_prof_bucket(t)]++;
+    if (hw != NULL) {
+        h->hw_count++;
+        for (e = 0; e < FANN_PROF_EVENTS; e++) {
+            h->hw[e] += hw[e];
+        }
+    }
+}
+
+#ifdef FANN_PROF_HW
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} fann_prof_event_attrs[FANN_PROF_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+};
+
+static pthread_key_t fann_prof_hw_key;
+static pthread_once_t fann_prof_hw_once = PTHREAD_ONCE_INIT;
+
+static void fann_prof_hw_close(void *arg)
+{
+    struct fann_prof_state *s = (struct fann_prof_state *)arg;
+
+    while (s->hw_n > 0) {
+        close(s->hw_fd[--s->hw_n]);
+    }
+    s->hw_mask = 0;
+    s->hw_tried = 0;
+}
+
+static void fann_prof_hw_init(void)
+{
+    // closes the events of a thread when it exits
+    pthread_key_create(&fann_prof_hw_key, fann_prof_hw_close);
+}
+
+/* INTERNAL FUNCTION
+   Counters of the group of this thread in v, 0 for events not counted.
+ */
+static void fann_prof_hw_read(struct fann_prof_state *s, uint64_t *v)
+{
+    uint64_t buf[3 + FANN_PROF_EVENTS];
+    unsigned int e, i;
+
+    if (read(s->hw_fd[0], buf, sizeof(buf)) < (ssize_t)((3 + s->hw_n) * sizeof(uint64_t))) {
+        memset(v, 0, FANN_PROF_EVENTS * sizeof(uint64_t));
+        return;
+    }
+    s->hw_enabled = buf[1];
+    s->hw_running = buf[2];
+    for (e = 0, i = 3; e < FANN_PROF_EVENTS; e++) {
+        v[e] = (s->hw_mask & (1u << e)) ? buf[i++] : 0;
+    }
+}
+
+/* INTERNAL FUNCTION
+   Opens the events of mask as one group counting this thread in user
+   space. The group is only counted when all its events fit in the PMU
+   at once, so events are dropped from the end until it is scheduled.
+ */
+static void fann_prof_hw_open(struct fann_prof_state *s)
+{
+    struct perf_event_attr attr;
+    uint64_t v[FANN_PROF_EVENTS];
+    unsigned int e, mask;
+    int fd;
+
+    pthread_once(&fann_prof_hw_once, fann_prof_hw_init);
+    s->hw_tried = 1;
+    pthread_mutex_lock(&fann_prof_lock);
+    mask = fann_prof_hw_mask;
+    pthread_mutex_unlock(&fann_prof_lock);
+    while (mask) {
+        for (e = 0; e < FANN_PROF_EVENTS; e++) {
+            if (!(mask & (1u << e))) {
+                continue;
+            }
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = fann_prof_event_attrs[e].type;
+            attr.config = fann_prof_event_attrs[e].config;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.disabled = (s->hw_n == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, (s->hw_n > 0) ? s->hw_fd[0] : -1, 0);
+            if (fd < 0) {
+                // not supported by this CPU or not allowed
+                fann_prof_hw_errno = errno;
+                mask &= ~(1u << e);
+                continue;
+            }
+            s->hw_fd[s->hw_n++] = fd;
+            s->hw_mask |= 1u << e;
+        }
+        if (s->hw_n == 0) {
+            break;
+        }
+        ioctl(s->hw_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        fann_prof_hw_read(s, v);
+        fann_prof_hw_read(s, v);
+        if (s->hw_running > 0) {
+            break;
+        }
+        fann_prof_hw_close(s);
+        s->hw_tried = 1;
+        mask &= ~(1u << (31 - __builtin_clz(mask)));
+    }
+    if (s->hw_n > 0) {
+        pthread_setspecific(fann_prof_hw_key, s);
+        pthread_mutex_lock(&fann_prof_lock);
+        fann_prof_hw_mask = s->hw_mask;
+        pthread_mutex_unlock(&fann_prof_lock);
+    }
+}
+
+#else // !FANN_PROF_HW
+
+static void fann_prof_hw_read(struct fann_prof_state *s, uint64_t *v)
+{
+    (void)s;
+    memset(v, 0, FANN_PROF_EVENTS * sizeof(uint64_t));
+}
+
+#endif // FANN_PROF_HW
+
+/* the events counted since since, in d */
+static const uint64_t *fann_prof_hw_sub(uint64_t *d, const uint64_t *v, const uint64_t *since)
+{
+    unsigned int e;
+
+    for (e = 0; e < FANN_PROF_EVENTS; e++) {
+        d[e] = v[e] - since[e];
+    }
+    return d;
+}
+
+/* INTERNAL FUNCTION
+   The histograms of this thread, NULL if they can not be allocated.
+ */
+static struct fann_prof_block *fann_prof_own(void)
+{
+    struct fann_prof_block *block = fann_prof_tls.block;
+
+    if (block == NULL) {
+        void *mem;
+
+        // kept after the thread exits, as the counters
+        if (posix_memalign(&mem, 64, sizeof(struct fann_prof_block))) {
+            return NULL;
+        }
+        block = (struct fann_prof_block *)mem;
+        memset(block, 0, sizeof(struct fann_prof_block));
+        pthread_mutex_lock(&fann_prof_lock);
+        block->next = fann_prof_blocks;
+        fann_prof_blocks = block;
+        fann_prof_num_blocks++;
+        pthread_mutex_unlock(&fann_prof_lock);
+        fann_prof_tls.block = block;
+    }
+    return block;
+}
+
+void fann_prof_flush(void)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+    struct fann_prof_block *block;
+    unsigned int p;
+
+    if (s->touched && ((block = fann_prof_own()) != NULL)) {
+        for (p = 0; p < FANN_PHASE_COUNT; p++) {
+            if (s->touched & (1u << p)) {
+                fann_prof_add(&block->phase[p], s->acc[p],
+                              (s->hw_touched & (1u << p)) ? s->hw_acc[p] : NULL);
+                s->acc[p] = 0;
+                memset(s->hw_acc[p], 0, sizeof(s->hw_acc[p]));
+            }
+        }
+        if (s->hw_touched) {
+            block->hw_enabled = s->hw_enabled;
+            block->hw_running = s->hw_running;
+        }
+    }
+    s->touched = 0;
+    s->hw_touched = 0;
+    s->active = 0;
+}
+
+void fann_prof_sample(void)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+
+    if (s->touched) {
+        fann_prof_flush();
+    }
+    if (fann_prof_every == 0) {
+        s->active = 0;
+        return;
+    }
+    if (s->countdown == 0) {
+        s->countdown = fann_prof_every;
+    }
+    s->active = (--s->countdown == 0);
+}
+
+void fann_prof_start(enum fann_count_phase phase)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+
+    if (s->active) {
+        s->phase = phase;
+        s->layer = -1;
+#ifdef FANN_PROF_HW
+        if (fann_prof_hw_on && !s->hw_tried) {
+            fann_prof_hw_open(s);
+        }
+#endif
+        // the events are read outside the times of the phases
+        s->hw_live = fann_prof_hw_on && (s->hw_n > 0);
+        if (s->hw_live) {
+            fann_prof_hw_read(s, s->hw_phase);
+        }
+        s->t_phase = fann_prof_now();
+    }
+}
+
+void fann_prof_layer(unsigned int l, enum fann_count_phase phase)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+    struct fann_prof_block *block;
+    uint64_t t, v[FANN_PROF_EVENTS], d[FANN_PROF_EVENTS];
+
+    if (s->phase < 0) {
+        return;
+    }
+    t = fann_prof_now();
+    if (s->hw_live) {
+        fann_prof_hw_read(s, v);
+    }
+    if ((s->layer >= 0) && ((block = fann_prof_own()) != NULL)) {
+        fann_prof_add(&block->layer[s->layer][s->layer_phase], t - s->t_layer,
+                      s->hw_live ? fann_prof_hw_sub(d, v, s->hw_layer) : NULL);
+    }
+    s->layer = l;
+    s->layer_phase = phase;
+    if (s->hw_live) {
+        memcpy(s->hw_layer, v, sizeof(v));
+    }
+    // the read above is timed in the pass, not counted in its events
+    s->t_layer = t;
+}
+
+void fann_prof_stop(void)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+    struct fann_prof_block *block;
+    uint64_t t, v[FANN_PROF_EVENTS], d[FANN_PROF_EVENTS];
+    unsigned int e;
+
+    if (s->phase < 0) {
+        return;
+    }
+    t = fann_prof_now();
+    if (s->hw_live) {
+        fann_prof_hw_read(s, v);
+    }
+    if ((s->layer >= 0) && ((block = fann_prof_own()) != NULL)) {
+        fann_prof_add(&block->layer[s->layer][s->layer_phase], t - s->t_layer,
+                      s->hw_live ? fann_prof_hw_sub(d, v, s->hw_layer) : NULL);
+    }
+    s->acc[s->phase] += t - s->t_phase;
+    s->touched |= 1u << s->phase;
+    if (s->hw_live) {
+        for (e = 0; e < FANN_PROF_EVENTS; e++) {
+            s->hw_acc[s->phase][e] += v[e] - s->hw_phase[e];
+        }
+        s->hw_touched |= 1u << s->phase;
+    }
+    s->phase = -1;
+    s->layer = -1;
+}
+
+void fann_prof_batch_start(void)
+{
+    if (fann_prof_every == 0) {
+        return;
+    }
+    if (fann_prof_tls.touched) {
+        fann_prof_flush();
+    }
+    // once per batch, cheap enough to always time
+    fann_prof_tls.active = 1;
+    fann_prof_start(FANN_PHASE_UPDATE);
+}
+
+void fann_prof_batch_stop(void)
+{
+    fann_prof_stop();
+    fann_prof_flush();
+}
+
+FANN_EXTERNAL void FANN_API fann_profile_enable(unsigned int every)
+{
+    if (every && (fann_prof_every == 0)) {
+        fann_prof_ns0 = fann_prof_ns();
+        fann_prof_tick0 = fann_prof_now();
+    }
+    fann_prof_every = every;
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_profile_hw(int enable)
+{
+    struct fann_prof_state *s = &fann_prof_tls;
+
+    fann_prof_hw_on = enable;
+#ifdef FANN_PROF_HW
+    if (enable && !s->hw_tried) {
+        fann_prof_hw_open(s);
+    } else if (!enable && s->hw_tried) {
+        fann_prof_hw_close(s);
+    }
+#endif
+    return enable ? s->hw_n : 0;
+}
+
+FANN_EXTERNAL void FANN_API fann_profile_clear(void)
+{
+    struct fann_prof_block *block;
+
+    pthread_mutex_lock(&fann_prof_lock);
+    for (block = fann_prof_blocks; block != NULL; block = block->next) {
+        memset(block, 0, offsetof(struct fann_prof_block, next));
+    }
+    pthread_mutex_unlock(&fann_prof_lock);
+}
+
+static void fann_prof_merge(struct fann_prof_hist *sum, const struct fann_prof_hist *h)
+{
+    unsigned int b;
+
+    sum->count += h->count;
+    sum->sum += h->sum;
+    if (h->max > sum->max) {
+        sum->max = h->max;
+    }
+    for (b = 0; b < FANN_PROF_BUCKETS; b++) {
+        sum->bucket[b] += h->bucket[b];
+    }
+    sum->hw_count += h->hw_count;
+    for (b = 0; b < FANN_PROF_EVENTS; b++) {
+        sum->hw[b] += h->hw[b];
+    }
+}
+
+static double fann_prof_quantile(const struct fann_prof_hist *h, double q)
+{
+    uint64_t acc = 0, rank = (uint64_t)(q * (double)h->count);
+    unsigned int b;
+    double t;
+
+    for (b = 0; b < FANN_PROF_BUCKETS - 1; b++) {
+        acc += h->bucket[b];
+        if (acc > rank) {
+            break;
+        }
+    }
+    t = fann_prof_bucket_mid(b);
+    return (t < (double)h->max) ? t : (double)h->max;
+}
+
+static void fann_prof_dump_hist(FILE *out, const struct fann_prof_hist *h, double ns_per_tick)
+{
+    fprintf(out, "{\"count\": %" PRIu64 ", \"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f",
+            h->count, h->count ? ns_per_tick * (double)h->sum / (double)h->count : 0.0,
+            ns_per_tick * fann_prof_quantile(h, 0.5), ns_per_tick * fann_prof_quantile(h, 0.99),
+            ns_per_tick * (double)h->max);
+    if (h->hw_count > 0) {
+        unsigned int e;
+
+        // means per pass, with the ratios that tell compute from memory bound
+        for (e = 0; e < FANN_PROF_EVENTS; e++) {
+            if (fann_prof_hw_mask & (1u << e)) {
+                fprintf(out, ", \"%s\": %.1f", fann_prof_event_names[e], (double)h->hw[e] / (double)h->hw_count);
+            }
+        }
+        if (h->hw[0] && h->hw[1]) {
+            fprintf(out, ", \"ipc\": %.3f", (double)h->hw[1] / (double)h->hw[0]);
+        }
+        for (e = 2; (e < FANN_PROF_EVENTS) && h->hw[1]; e++) {
+            if (fann_prof_hw_mask & (1u << e)) {
+                fprintf(out, ", \"%s_per_kinst\": %.3f", fann_prof_event_names[e],
+                        1000.0 * (double)h->hw[e] / (double)h->hw[1]);
+            }
+        }
+    }
+    fprintf(out, "}");
+}
+
+static void fann_prof_dump_phases(FILE *out, const struct fann_prof_hist *phase, double ns_per_tick)
+{
+    unsigned int p;
+
+    for (p = 0; p < FANN_PHASE_COUNT; p++) {
+        fprintf(out, "%s\"%s\": ", p ? ", " : "", FANN_PHASE_NAMES[p]);
+        fann_prof_dump_hist(out, phase + p, ns_per_tick);
+    }
+}
+
+static double fann_prof_ns_per_tick(void)
+{
+#ifdef FANN_PROF_TSC
+    uint64_t dt = fann_prof_now() - fann_prof_tick0;
+
+    if (dt > 0) {
+        return (double)(fann_prof_ns() - fann_prof_ns0) / (double)dt;
+    }
+#endif
+    return 1.0;
+}
+
+void fann_prof_seconds(double *seconds)
+{
+    struct fann_prof_block *block;
+    double s_per_tick = fann_prof_ns_per_tick() * 1e-9;
+    unsigned int p;
+
+    for (p = 0; p < FANN_PHASE_COUNT; p++) {
+        seconds[p] = 0.0;
+    }
+    pthread_mutex_lock(&fann_prof_lock);
+    for (block = fann_prof_blocks; block != NULL; block = block->next) {
+        for (p = 0; p < FANN_PHASE_COUNT; p++) {
+            seconds[p] += s_per_tick * (double)block->phase[p].sum;
+        }
+    }
+    pthread_mutex_unlock(&fann_prof_lock);
+}
+
+FANN_EXTERNAL int FANN_API fann_profile_dump(FILE *out, struct fann *ann)
+{
+    struct fann_prof_block *block, *all;
+    unsigned int l, p, t, num_layers = (unsigned int)(ann->last_layer - ann->first_layer);
+    double ns_per_tick = fann_prof_ns_per_tick();
+    int first = 1;
+
+    fann_prof_flush();
+    all = (struct fann_prof_block *)calloc(1, sizeof(struct fann_prof_block));
+    if (all == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        return -1;
+    }
+    fprintf(out, "{\"clock\": \"%s\", \"ns_per_tick\": %.6f, \"every\": %u,\n \"threads\": [",
+#ifdef FANN_PROF_TSC
+            "tsc",
+#else
+            "monotonic",
+#endif
+            ns_per_tick, fann_prof_every);
+    pthread_mutex_lock(&fann_prof_lock);
+    // newest first in the list, threads numbered by creation
+    for (block = fann_prof_blocks, t = fann_prof_num_blocks; block != NULL; block = block->next) {
+        fprintf(out, "%s\n  {\"thread\": %u, ", (block == fann_prof_blocks) ? "" : ",", --t);
+        fann_prof_dump_phases(out, block->phase, ns_per_tick);
+        fprintf(out, "}");
+        all->hw_enabled += block->hw_enabled;
+        all->hw_running += block->hw_running;
+        for (p = 0; p < FANN_PHASE_COUNT; p++) {
+            fann_prof_merge(all->phase + p, block->phase + p);
+            for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+                fann_prof_merge(&all->layer[l][p], &block->layer[l][p]);
+            }
+        }
+    }
+    pthread_mutex_unlock(&fann_prof_lock);
+    fprintf(out, "],\n \"layers\": [");
+    for (l = 0; l < FANN_COUNT_LAYERS; l++) {
+        for (p = 0; (p < FANN_PHASE_COUNT) && (all->layer[l][p].count == 0); p++);
+        if (p == FANN_PHASE_COUNT) {
+            continue;
+        }
+        fprintf(out, "%s\n  {\"layer\": %u, \"neurons\": %u, ", first ? "" : ",", l,
+                (l < num_layers) ? ann->first_layer[l].num_neurons : 0);
+        fann_prof_dump_phases(out, all->layer[l], ns_per_tick);
+        fprintf(out, "}");
+        first = 0;
+    }
+    fprintf(out, "],\n \"total\": {");
+    fann_prof_dump_phases(out, all->phase, ns_per_tick);
+    fprintf(out, "}");
+    if (all->hw_enabled > 0) {
+        // below 1 if the kernel multiplexed the events (the counts are not scaled)
+        fprintf(out, ",\n \"hw\": {\"events\": [");
+        for (p = 0, first = 1; p < FANN_PROF_EVENTS; p++) {
+            if (fann_prof_hw_mask & (1u << p)) {
+                fprintf(out, "%s\"%s\"", first ? "" : ", ", fann_prof_event_names[p]);
+                first = 0;
+            }
+        }
+        fprintf(out, "], \"running_share\": %.4f}", (double)all->hw_running / (double)all->hw_enabled);
+    } else if (fann_prof_hw_on || fann_prof_hw_errno) {
+        fprintf(out, ",\n \"hw\": {\"events\": [], \"error\": \"%s\"}",
+                fann_prof_hw_errno ? strerror(fann_prof_hw_errno) : "no events counted");
+    }
+    fprintf(out, "}\n");
+    free(all);
+    return ferror(out) ? -1 : 0;
+}
+
+#endif // FANN_PROFILE
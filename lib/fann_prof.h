@@ -0,0 +1,124 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_prof_h
+#define _fann_prof_h
+
+/* Phase profiler, enabled at runtime by fann_profile_enable().
+ *
+ * Every Nth training sample of each thread is timed: the whole forward,
+ * loss, backward (with the weight slopes) and per sample update, and each
+ * layer pass inside them (from the fann_count_* hooks, see fann_count.h).
+ * Weight updates after each (mini) batch are always timed. The times go
+ * to per-thread log-linear histograms (4 buckets per power of 2), from
+ * which p50 and p99 are estimated within 12.5%.
+ *
+ * Times are read with rdtsc on x86 and CLOCK_MONOTONIC elsewhere; TSC
+ * ticks are converted to ns with the rate measured since the profiler was
+ * enabled.
+ *
+ * With fann_profile_hw(), the same timed phases and layer passes also count
+ * hardware events of their thread (perf_event_open on Linux, user space
+ * only): cycles, instructions, L1D, LLC and dTLB read misses and branch
+ * misses. Each thread reads its event group with one system call at every
+ * point it reads the clock, which adds about a microsecond to the timed
+ * passes but not to their events.
+ */
+
+#include "fann_count.h"
+
+#ifdef FANN_COUNTERS
+#define FANN_PROFILE
+#endif
+
+#ifdef FANN_PROFILE
+
+/* Function: fann_profile_enable
+
+   Times one of every *every* training samples of each thread, 0 stops
+   profiling. The histograms are kept, see <fann_profile_clear>.
+ */
+FANN_EXTERNAL void FANN_API fann_profile_enable(unsigned int every);
+
+/* Function: fann_profile_hw
+
+   Counts hardware events in the timed phases and layer passes (see above),
+   or stops counting them. The events each thread opens are closed when it
+   exits. Events the CPU does not have, that the kernel does not allow
+   (see /proc/sys/kernel/perf_event_paranoid) or that do not fit in the
+   PMU together are left out, and the times are recorded anyway.
+
+   Returns:
+   The number of events counted in the calling thread, 0 if none.
+ */
+FANN_EXTERNAL unsigned int FANN_API fann_profile_hw(int enable);
+
+/* Function: fann_profile_clear
+
+   Empties the histograms of all threads. Not to be called while other
+   threads train networks.
+ */
+FANN_EXTERNAL void FANN_API fann_profile_clear(void);
+
+/* Function: fann_profile_dump
+
+   Writes the histograms as JSON to *out*: count, mean, p50, p99 and max
+   (ns) of each phase per thread and for all threads, and of each layer
+   pass of *ann* per phase. With hardware events, each also has the mean
+   of every event per pass, instructions per cycle and the misses per 1000
+   instructions, and "hw" lists the events counted (or the error when none
+   could be).
+
+   Returns:
+   0 on success, -1 on write errors.
+ */
+FANN_EXTERNAL int FANN_API fann_profile_dump(FILE *out, struct fann *ann);
+
+/* INTERNAL FUNCTION
+   Time measured in each phase by all threads, in seconds.
+ */
+void fann_prof_seconds(double *seconds);
+
+/* INTERNAL FUNCTIONS
+   A sample begins (times it or not), phases begin and end within it,
+   weight updates of a batch begin and end, the epoch ends.
+ */
+void fann_prof_sample(void);
+void fann_prof_start(enum fann_count_phase phase);
+void fann_prof_stop(void);
+void fann_prof_batch_start(void);
+void fann_prof_batch_stop(void);
+void fann_prof_flush(void);
+/* a pass of layer l begins (called by the fann_count_* hooks) */
+void fann_prof_layer(unsigned int l, enum fann_count_phase phase);
+
+#else // !FANN_PROFILE
+
+#define fann_prof_sample()
+#define fann_prof_start(phase)
+#define fann_prof_stop()
+#define fann_prof_batch_start()
+#define fann_prof_batch_stop()
+#define fann_prof_flush()
+#define fann_prof_layer(l, phase)
+
+#endif // FANN_PROFILE
+
+#endif // _fann_prof_h
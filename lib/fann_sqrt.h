@@ -68,7 +68,7 @@
 
 #elif defined SOFTFANN
 
-#ifdef POSIT16
+#if (defined POSIT16) || (defined SWF8)
 
 #if 0
 #define FANN_SQRT_EMULATION
@@ -79,7 +79,7 @@
 #define fann_rsqrt_name "1/sqrtf(.f)"
 #endif
 
-#else // ! POSIT16
+#else // ! POSIT16 && ! SWF8
 #if 1
 #define FANN_SQRT_EMULATION
 #else
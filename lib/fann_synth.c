@@ -0,0 +1,297 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Synthetic data sets (see fann_create_synthetic_data in fann_train.h) */
+
+#include "fann.h"
+
+#ifndef FANN_INFERENCE_ONLY
+
+#include <stdint.h>
+#include <math.h>
+
+/* the problem of a fann_synth_params: cumulative class frequencies and
+   centroids (classification) or weights and biases (regression) */
+struct fann_synth {
+    const struct fann_synth_params *params;
+    unsigned int num_classes;
+    float *prior;   // num_classes
+    float *model;   // num_classes * num_input, or num_output * (num_input + 1)
+};
+
+/* splitmix64, independent of the generator of the weights */
+static uint64_t fann_synth_next(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* uniform in [0, 1) */
+static float fann_synth_uniform(uint64_t *state)
+{
+    return (float)(fann_synth_next(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+static float fann_synth_normal(uint64_t *state)
+{
+    float u = 1.0f - fann_synth_uniform(state), v = fann_synth_uniform(state);
+
+    return sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * v);
+}
+
+static void fann_synth_destroy(struct fann_synth *synth)
+{
+    fann_free(synth->prior);
+    fann_free(synth->model);
+}
+
+static int fann_synth_init(struct fann_synth *synth, const struct fann_synth_params *params)
+{
+    const unsigned int num_input = params->num_input;
+    uint64_t state = (uint64_t)params->seed * 0xD1B54A32D192ED03ULL + params->task;
+    unsigned int c, i, n;
+    float sum, p, scale;
+
+    synth->params = params;
+    synth->prior = synth->model = NULL;
+    if ((params->num_input == 0) || (params->num_output == 0) ||
+        !(params->density > 0.0f) || (params->density > 1.0f) || !(params->skew >= 1.0f)) {
+        fann_error(FANN_E_WRONG_PARAMETERS_FOR_CREATE);
+        return -1;
+    }
+    synth->num_classes = (params->num_output > 1) ? params->num_output : 2;
+    if (params->task == FANN_SYNTH_CLASSIFICATION) {
+        n = synth->num_classes * num_input;
+    } else {
+        n = params->num_output * (num_input + 1);
+    }
+    fann_malloc(synth->prior, synth->num_classes);
+    fann_malloc(synth->model, n);
+    if ((synth->prior == NULL) || (synth->model == NULL)) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_synth_destroy(synth);
+        return -1;
+    }
+    for (c = 0, sum = 0.0f, p = 1.0f; c < synth->num_classes; c++, p /= params->skew) {
+        sum += p;
+        synth->prior[c] = sum;
+    }
+    for (c = 0; c < synth->num_classes; c++) {
+        synth->prior[c] /= sum;
+    }
+    // regression sums density * num_input terms, kept about unit variance
+    scale = (params->task == FANN_SYNTH_CLASSIFICATION) ? 1.0f :
+        1.0f / sqrtf(params->density * num_input / 3.0f);
+    for (i = 0; i < n; i++) {
+        synth->model[i] = scale * fann_synth_normal(&state);
+    }
+    return 0;
+}
+
+/* INTERNAL FUNCTION
+   Row number row of the problem, with the class (or 0) returned.
+ */
+static unsigned int fann_synth_row(const struct fann_synth *synth, unsigned int row,
+                                   float *input, float *output)
+{
+    const struct fann_synth_params *params = synth->params;
+    const unsigned int num_input = params->num_input;
+    uint64_t state = ((uint64_t)params->seed << 32) ^ ((uint64_t)row * 0x9E3779B97F4A7C15ULL);
+    unsigned int c = 0, i, o;
+    const float *w;
+    float u, sum;
+
+    fann_synth_next(&state);
+    if (params->task == FANN_SYNTH_CLASSIFICATION) {
+        u = fann_synth_uniform(&state);
+        while ((c + 1 < synth->num_classes) && (u >= synth->prior[c])) {
+            c++;
+        }
+        w = synth->model + c * num_input;
+        for (i = 0; i < num_input; i++) {
+            input[i] = ((params->density < 1.0f) && (fann_synth_uniform(&state) >= params->density)) ?
+                0.0f : w[i] + params->noise * fann_synth_normal(&state);
+        }
+        for (o = 0; o < params->num_output; o++) {
+            output[o] = (params->num_output > 1) ? (float)(o == c) : (float)c;
+        }
+        return c;
+    }
+    for (i = 0; i < num_input; i++) {
+        input[i] = ((params->density < 1.0f) && (fann_synth_uniform(&state) >= params->density)) ?
+            0.0f : 2.0f * fann_synth_uniform(&state) - 1.0f;
+    }
+    for (o = 0; o < params->num_output; o++) {
+        w = synth->model + o * (num_input + 1);
+        for (i = 0, sum = w[num_input]; i < num_input; i++) {
+            sum += w[i] * input[i];
+        }
+        output[o] = 0.5f * (1.0f + tanhf(sum)) + params->noise * fann_synth_normal(&state);
+    }
+    return 0;
+}
+
+FANN_EXTERNAL void FANN_API fann_init_synthetic_params(struct fann_synth_params *params,
+                                                       enum fann_synth_enum task,
+                                                       unsigned int num_data,
+                                                       unsigned int num_input,
+                                                       unsigned int num_output)
+{
+    params->task = task;
+    params->num_data = num_data;
+    params->first_row = 0;
+    params->num_input = num_input;
+    params->num_output = num_output;
+    params->density = 1.0f;
+    params->skew = 1.0f;
+    params->noise = (task == FANN_SYNTH_CLASSIFICATION) ? 1.0f : 0.05f;
+    params->seed = 1;
+}
+
+FANN_EXTERNAL struct fann_data *FANN_API fann_create_synthetic_data(const struct fann_synth_params *params)
+{
+    struct fann_synth synth;
+    struct fann_data *data;
+    unsigned int i;
+    float *row;
+
+    if (fann_synth_init(&synth, params)) {
+        return NULL;
+    }
+    data = fann_create_data(params->num_data, params->num_input, params->num_output);
+    fann_malloc(row, params->num_input + params->num_output);
+    if ((data == NULL) || (row == NULL)) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_destroy_data(data);
+        fann_free(row);
+        fann_synth_destroy(&synth);
+        return NULL;
+    }
+    fann_set_ff_bias();
+    for (i = 0; i < params->num_data; i++) {
+        fann_synth_row(&synth, params->first_row + i, row, row + params->num_input);
+        fann_float_to_ff_array(data->input[i], row, params->num_input);
+        fann_float_to_ff_array(data->output[i], row + params->num_input, params->num_output);
+    }
+    fann_free(row);
+    fann_synth_destroy(&synth);
+    return data;
+}
+
+static int fann_synth_write_row(FILE *file, const struct fann_synth_params *params,
+                                enum fann_data_format_enum format, unsigned int c,
+                                const float *input, const float *output)
+{
+    unsigned int i;
+
+    switch (format) {
+    case FANN_FORMAT_BINARY:
+        if ((fwrite(input, sizeof(float), params->num_input, file) != params->num_input) ||
+            (fwrite(output, sizeof(float), params->num_output, file) != params->num_output)) {
+            return -1;
+        }
+        return 0;
+    case FANN_FORMAT_LIBSVM:
+        if (params->task == FANN_SYNTH_REGRESSION) {
+            fprintf(file, "%.7g", output[0]);
+        } else {
+            fprintf(file, "%u", (params->num_output > 1) ? c + 1 : c);
+        }
+        for (i = 0; i < params->num_input; i++) {
+            if (input[i] != 0.0f) {
+                fprintf(file, " %u:%.7g", i + 1, input[i]);
+            }
+        }
+        break;
+    default:
+        for (i = 0; i < params->num_input; i++) {
+            fprintf(file, (input[i] != 0.0f) ? "%.7g " : "0 ", input[i]);
+        }
+        fprintf(file, "\n");
+        for (i = 0; i < params->num_output; i++) {
+            fprintf(file, "%.7g ", output[i]);
+        }
+        break;
+    }
+    return (fputc('\n', file) == EOF) ? -1 : 0;
+}
+
+FANN_EXTERNAL int FANN_API fann_save_synthetic_data(const struct fann_synth_params *params,
+                                                    const char *filename,
+                                                    enum fann_data_format_enum format)
+{
+    struct fann_synth synth;
+    uint32_t head[3];
+    unsigned int i, c;
+    float *row;
+    FILE *file;
+    int piped, retval = 0;
+
+    if ((format == FANN_FORMAT_LIBSVM) && (params->task == FANN_SYNTH_REGRESSION) &&
+        (params->num_output > 1)) {
+        fann_error(FANN_E_DATA_FORMAT, filename);
+        return -1;
+    }
+    if (fann_synth_init(&synth, params)) {
+        return -1;
+    }
+    fann_malloc(row, params->num_input + params->num_output);
+    if (row == NULL) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_synth_destroy(&synth);
+        return -1;
+    }
+    file = fann_open_data_file(filename, (format == FANN_FORMAT_BINARY) ? "wb" : "w", &piped);
+    if (file == NULL) {
+        fann_error(FANN_E_CANT_OPEN_TD_W, filename);
+        fann_free(row);
+        fann_synth_destroy(&synth);
+        return -1;
+    }
+    if (format == FANN_FORMAT_BINARY) {
+        head[0] = params->num_data;
+        head[1] = params->num_input;
+        head[2] = params->num_output;
+        if ((fwrite(FANN_DATA_MAGIC, 1, sizeof(FANN_DATA_MAGIC) - 1, file) != sizeof(FANN_DATA_MAGIC) - 1) ||
+            (fwrite(head, sizeof(uint32_t), 3, file) != 3)) {
+            retval = -1;
+        }
+    } else if (format == FANN_FORMAT_TEXT) {
+        fprintf(file, "%u %u %u\n", params->num_data, params->num_input, params->num_output);
+    }
+    for (i = 0; (i < params->num_data) && (retval == 0); i++) {
+        c = fann_synth_row(&synth, params->first_row + i, row, row + params->num_input);
+        retval = fann_synth_write_row(file, params, format, c, row, row + params->num_input);
+    }
+    if (fann_close_data_file(file, piped)) {
+        retval = -1;
+    }
+    if (retval) {
+        fann_error(FANN_E_CANT_OPEN_TD_W, filename);
+    }
+    fann_free(row);
+    fann_synth_destroy(&synth);
+    return retval;
+}
+
+#endif // FANN_INFERENCE_ONLY
@@ -0,0 +1,248 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#include "fann.h"
+
+#ifdef FANN_TRACE
+
+#include <pthread.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FANN_TRACE_DEPTH 8
+
+static const char * const fann_trace_names[FANN_TRACE_COUNT] = {
+    "epoch", "batch", "forward", "loss", "backward", "slopes", "update",
+    "barrier", "reduce", "spawn", "join", "test", "checkpoint", "write"
+};
+
+struct fann_trace_record {
+    uint64_t ts;
+    uint64_t dur;
+    uint64_t event;
+};
+
+/* events of one thread at a time, written only by it */
+struct fann_trace_ring {
+    uint64_t head;          // events written, published with release
+    unsigned int size;
+    unsigned int tid;
+    int in_use;
+    struct fann_trace_record *rec;
+    struct fann_trace_ring *next;
+};
+
+/* events this thread has begun */
+struct fann_trace_state {
+    struct fann_trace_ring *ring;
+    unsigned int depth;
+    uint64_t begin[FANN_TRACE_DEPTH];
+    enum fann_trace_event event[FANN_TRACE_DEPTH];
+};
+
+static __thread struct fann_trace_state fann_trace_tls = {NULL, 0, {0, }, {FANN_TRACE_EPOCH, }};
+
+int fann_trace_level = 0;
+
+static unsigned int fann_trace_size = 0;
+static unsigned int fann_trace_num_rings = 0;
+static struct fann_trace_ring *fann_trace_rings = NULL;
+static pthread_mutex_t fann_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t fann_trace_key;
+static pthread_once_t fann_trace_once = PTHREAD_ONCE_INIT;
+static uint64_t fann_trace_ns0 = 0;
+
+static uint64_t fann_trace_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* the ring of an exiting thread goes back to the pool */
+static void fann_trace_release(void *arg)
+{
+    struct fann_trace_ring *ring = (struct fann_trace_ring *)arg;
+
+    pthread_mutex_lock(&fann_trace_lock);
+    ring->in_use = 0;
+    pthread_mutex_unlock(&fann_trace_lock);
+}
+
+static void fann_trace_init(void)
+{
+    pthread_key_create(&fann_trace_key, fann_trace_release);
+}
+
+FANN_EXTERNAL void FANN_API fann_trace_enable(unsigned int events, int samples)
+{
+    pthread_once(&fann_trace_once, fann_trace_init);
+    pthread_mutex_lock(&fann_trace_lock);
+    if (fann_trace_ns0 == 0) {
+        fann_trace_ns0 = fann_trace_ns();
+    }
+    fann_trace_size = events;
+    pthread_mutex_unlock(&fann_trace_lock);
+    fann_trace_level = (events == 0) ? 0 : (samples ? 2 : 1);
+}
+
+/* INTERNAL FUNCTION
+   Takes a ring for this thread: the free one with the lowest tid, so that
+   the threads of every batch take the same tracks, or a new one. None if
+   it can not be allocated.
+ */
+static void fann_trace_own(void)
+{
+    struct fann_trace_ring *ring, *best = NULL;
+
+    pthread_mutex_lock(&fann_trace_lock);
+    for (ring = fann_trace_rings; ring != NULL; ring = ring->next) {
+        if (!ring->in_use && ((best == NULL) || (ring->tid < best->tid))) {
+            best = ring;
+        }
+    }
+    if ((best == NULL) && (fann_trace_size > 0)) {
+        best = (struct fann_trace_ring *)calloc(1, sizeof(struct fann_trace_ring));
+        if (best != NULL) {
+            best->rec = (struct fann_trace_record *)malloc(fann_trace_size * sizeof(struct fann_trace_record));
+            if (best->rec == NULL) {
+                free(best);
+                best = NULL;
+            } else {
+                best->size = fann_trace_size;
+                best->tid = fann_trace_num_rings++;
+                best->next = fann_trace_rings;
+                fann_trace_rings = best;
+            }
+        }
+    }
+    if (best != NULL) {
+        best->in_use = 1;
+    }
+    pthread_mutex_unlock(&fann_trace_lock);
+    if (best != NULL) {
+        pthread_setspecific(fann_trace_key, best);
+    }
+    fann_trace_tls.ring = best;
+}
+
+void fann_trace_begin_event(enum fann_trace_event event)
+{
+    struct fann_trace_state *s = &fann_trace_tls;
+
+    // taken at the first begin, so that threads that overlap in time
+    // never share a track
+    if (s->ring == NULL) {
+        fann_trace_own();
+    }
+    // deeper events are not recorded, but still ended
+    if (s->depth < FANN_TRACE_DEPTH) {
+        s->event[s->depth] = event;
+        s->begin[s->depth] = fann_trace_ns();
+    }
+    s->depth++;
+}
+
+void fann_trace_end_event(void)
+{
+    struct fann_trace_state *s = &fann_trace_tls;
+    struct fann_trace_ring *ring = s->ring;
+    struct fann_trace_record *rec;
+    uint64_t now, head;
+
+    // begun before the tracer was enabled
+    if (s->depth == 0) {
+        return;
+    }
+    s->depth--;
+    if (s->depth >= FANN_TRACE_DEPTH) {
+        return;
+    }
+    now = fann_trace_ns();
+    if (ring == NULL) {
+        return;
+    }
+    head = ring->head;
+    rec = ring->rec + (head % ring->size);
+    rec->ts = s->begin[s->depth];
+    rec->dur = now - s->begin[s->depth];
+    rec->event = s->event[s->depth];
+    __atomic_store_n(&(ring->head), head + 1, __ATOMIC_RELEASE);
+}
+
+FANN_EXTERNAL void FANN_API fann_trace_clear(void)
+{
+    struct fann_trace_ring *ring, **prev;
+
+    pthread_mutex_lock(&fann_trace_lock);
+    // free rings are released, so that new ones take the current size
+    for (prev = &fann_trace_rings; (ring = *prev) != NULL; ) {
+        if (ring->in_use) {
+            __atomic_store_n(&(ring->head), 0, __ATOMIC_RELEASE);
+            prev = &(ring->next);
+        } else {
+            *prev = ring->next;
+            free(ring->rec);
+            free(ring);
+        }
+    }
+    fann_trace_num_rings = 0;
+    for (ring = fann_trace_rings; ring != NULL; ring = ring->next) {
+        if (ring->tid >= fann_trace_num_rings) {
+            fann_trace_num_rings = ring->tid + 1;
+        }
+    }
+    pthread_mutex_unlock(&fann_trace_lock);
+}
+
+FANN_EXTERNAL int FANN_API fann_trace_dump(FILE *out)
+{
+    struct fann_trace_ring *ring;
+    struct fann_trace_record *rec;
+    uint64_t head, first, i, dropped = 0;
+    unsigned int pid = (unsigned int)getpid();
+    int comma = 0;
+
+    fprintf(out, "{\"traceEvents\": [");
+    pthread_mutex_lock(&fann_trace_lock);
+    for (ring = fann_trace_rings; ring != NULL; ring = ring->next) {
+        head = __atomic_load_n(&(ring->head), __ATOMIC_ACQUIRE);
+        first = (head > ring->size) ? head - ring->size : 0;
+        dropped += first;
+        fprintf(out, "%s\n {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %u, \"tid\": %u, "
+                "\"args\": {\"name\": \"thread %u\"}}", comma ? "," : "", pid, ring->tid, ring->tid);
+        comma = 1;
+        for (i = first; i < head; i++) {
+            rec = ring->rec + (i % ring->size);
+            fprintf(out, ",\n {\"name\": \"%s\", \"cat\": \"fann\", \"ph\": \"X\", \"pid\": %u, "
+                    "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                    fann_trace_names[rec->event], pid, ring->tid,
+                    (double)(rec->ts - fann_trace_ns0) * 1e-3, (double)rec->dur * 1e-3);
+        }
+    }
+    pthread_mutex_unlock(&fann_trace_lock);
+    fprintf(out, "],\n \"displayTimeUnit\": \"ns\",\n \"otherData\": {\"dropped\": %" PRIu64 "}}\n",
+            dropped);
+    return ferror(out) ? -1 : 0;
+}
+
+#endif // FANN_TRACE
@@ -0,0 +1,118 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef _fann_trace_h
+#define _fann_trace_h
+
+/* Timeline tracer, enabled at runtime by fann_trace_enable().
+ *
+ * Records when each thread trains an epoch or a (mini) batch, waits for
+ * the other threads of the batch, updates the weights, reduces the
+ * results of the threads, starts and joins them, tests data and saves a
+ * checkpoint, and optionally the forward, loss, backward and slopes of
+ * every sample. fann_trace_dump() writes them in the Chrome trace event
+ * format (JSON), which chrome://tracing and ui.perfetto.dev load.
+ *
+ * Each thread writes complete events (begin and duration) to its own ring
+ * and publishes them with a release store; when the ring is full the
+ * oldest events are overwritten. Threads exit after every batch, so their
+ * rings go back to a pool for the next ones; each ring is one track of the
+ * timeline. When disabled, every hook costs a load and a branch.
+ */
+
+#include "fann_count.h"
+
+#ifdef FANN_COUNTERS
+#define FANN_TRACE
+#endif
+
+#ifdef FANN_TRACE
+
+enum fann_trace_event {
+    FANN_TRACE_EPOCH = 0,
+    FANN_TRACE_BATCH,
+    FANN_TRACE_FORWARD,
+    FANN_TRACE_LOSS,
+    FANN_TRACE_BACKWARD,
+    FANN_TRACE_SLOPES,
+    FANN_TRACE_UPDATE,
+    FANN_TRACE_BARRIER,
+    FANN_TRACE_REDUCE,
+    FANN_TRACE_SPAWN,
+    FANN_TRACE_JOIN,
+    FANN_TRACE_TEST,
+    FANN_TRACE_CHECKPOINT,
+    FANN_TRACE_WRITE,
+    FANN_TRACE_COUNT
+};
+
+/* 0 off, 1 on, 2 also the phases of each sample */
+extern int fann_trace_level;
+
+/* Function: fann_trace_enable
+
+   Records up to *events* events per thread (the latest ones), 0 stops
+   recording. With *samples*, also the phases of every training sample,
+   which fill the rings quickly. Events already recorded are kept, see
+   <fann_trace_clear>.
+ */
+FANN_EXTERNAL void FANN_API fann_trace_enable(unsigned int events, int samples);
+
+/* Function: fann_trace_clear
+
+   Drops the events of all threads. Not to be called while other threads
+   train networks.
+ */
+FANN_EXTERNAL void FANN_API fann_trace_clear(void);
+
+/* Function: fann_trace_dump
+
+   Writes the events of all threads to *out* as a Chrome trace (JSON), with
+   times in microseconds since the tracer was first enabled. Events of
+   threads still training may be overwritten while they are read, so dump
+   after training.
+
+   Returns:
+   0 on success, -1 on write errors.
+ */
+FANN_EXTERNAL int FANN_API fann_trace_dump(FILE *out);
+
+/* INTERNAL FUNCTIONS
+   An event of this thread begins, or the last one begun ends. Events nest
+   up to FANN_TRACE_DEPTH deep.
+ */
+void fann_trace_begin_event(enum fann_trace_event event);
+void fann_trace_end_event(void);
+
+#define fann_trace_begin(event) {if (fann_trace_level) fann_trace_begin_event(event);}
+#define fann_trace_end() {if (fann_trace_level) fann_trace_end_event();}
+#define fann_trace_sample_begin(event) {if (fann_trace_level > 1) fann_trace_begin_event(event);}
+#define fann_trace_sample_end() {if (fann_trace_level > 1) fann_trace_end_event();}
+
+#else // !FANN_TRACE
+
+#define fann_trace_begin(event)
+#define fann_trace_end()
+#define fann_trace_sample_begin(event)
+#define fann_trace_sample_end()
+
+#endif // FANN_TRACE
+
+#endif // _fann_trace_h
@@ -84,7 +84,15 @@ static inline void fann_update_er_loss(struct fann *ann, uint_fast8_t low, float
 FANN_EXTERNAL fann_type_ff *FANN_API fann_test(struct fann *ann, fann_type_ff * input,
                                             fann_type_ff * desired_output)
 {
-    fann_type_ff *output_begin = fann_run(ann, input);
+    return fann_test_output(ann, fann_run(ann, input), desired_output);
+}
+
+/* INTERNAL FUNCTION
+   Update the error and loss with the output of the last run.
+ */
+fann_type_ff *fann_test_output(struct fann *ann, fann_type_ff * output_begin,
+                               fann_type_ff * desired_output)
+{
     unsigned int u, maxdesidx = 0, maxoutidx = 0;
     fann_type_ff *output_it;
     fann_type_ff maxdes, maxout;
@@ -332,6 +340,13 @@ void fann_clear_train_arrays(struct fann *ann)
                     neuron_it->weight_slopes[i] = bp_0000;//fann_int_to_bp(0, neuron_it->bp_fp16_bias);
                 }
             }
+#ifdef FANN_QUIRE_DOT
+            if (neuron_it->slope_sums != NULL) {
+                for (i = 0; i < num_connections; i++) {
+                    fann_quire_clr(neuron_it->slope_sums[i]);
+                }
+            }
+#endif
             if (neuron_it->prev_steps != NULL) {
                 fann_initialize_prev_steps(ann, layer_begin, neuron_it, num_connections);
             }
@@ -379,6 +394,7 @@ int fann_compute_loss(struct fann *ann, fann_type_ff * desired_output)
     if (fann_initialize_errors(ann))
         return 0;
 
+    fann_count_loss(ann);
     max_desired_idx = 0;
     max_desired_val = desired_output[0];
     for (err = 1; err < ann->num_output; err++) {
@@ -478,6 +494,50 @@ int fann_compute_loss(struct fann *ann, fann_type_ff * desired_output)
     return 1;
 }
 
+#if (defined SWF16_AP) && (defined FANN_BP_MAC_ARRAY)
+/* INTERNAL FUNCTION
+   The sums of fann_backpropagate_loss() with FANN_BP_BIAS_LAYER: the
+   previous errors in chunks, one array MAC per neuron of this layer, in
+   the same order. Returns the number of neurons without error.
+*/
+static unsigned int fann_backpropagate_layer(struct fann_layer *layer, struct fann_layer *prev_layer)
+{
+    struct fann_neuron *neuron_it, *last_neuron = layer->neuron + layer->num_neurons;
+    struct fann_neuron *prev_neuron = prev_layer->neuron;
+    fann_type_bp acc[FANN_CONV_CHUNK];
+    unsigned int n, k, len, skipped = 0;
+
+    for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+        if (fann_bp_is_zero(neuron_it->train_error)) {
+            skipped++;
+        }
+    }
+    fann_set_bp_bias(prev_neuron->bp_fp16_bias);
+    for (n = 0; (skipped < layer->num_neurons) && (n < prev_layer->num_neurons); n += FANN_CONV_CHUNK) {
+        len = prev_layer->num_neurons - n;
+        if (len > FANN_CONV_CHUNK) {
+            len = FANN_CONV_CHUNK;
+        }
+        for (k = 0; k < len; k++) {
+            acc[k] = prev_neuron[n + k].train_error;
+        }
+        for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+            if (fann_bp_is_non_zero(neuron_it->train_error)) {
+                fann_bp_mac_ff_array(acc, fann_bp_to_bp(neuron_it->train_error, neuron_it->bp_fp16_bias),
+                                     neuron_it->weight + n, len);
+            }
+        }
+        for (k = 0; k < len; k++) {
+            prev_neuron[n + k].train_error = acc[k];
+        }
+    }
+    // overflows are summed per layer
+    prev_neuron->bp_batch_overflows += fann_ap_overflow;
+    prev_neuron->bp_epoch_overflows += fann_ap_overflow;
+    return skipped;
+}
+#endif
+
 /* INTERNAL FUNCTION
    Propagate the error backwards from the output layer.
 
@@ -490,7 +550,9 @@ void fann_backpropagate_loss(struct fann *ann)
     struct fann_layer *layer_it, *prev_layer;
     struct fann_neuron *neuron_it, *last_neuron;
     //fann_type_bp *prev_train_errors, *this_train_errors;
+#if !((defined FANN_QUIRE_DOT) || (defined FANN_BP_FLOAT_ACC))
     fann_type_ff *weights;
+#endif
     const struct fann_layer *second_layer = ann->first_layer + 1;
     struct fann_layer *last_layer = ann->last_layer;
 
@@ -507,9 +569,57 @@ void fann_backpropagate_loss(struct fann *ann)
         // DO NOT backpropagate BIAS...
         last_neuron = layer_it->neuron + layer_it->num_neurons;
         prev_layer = layer_it - 1;
+        fann_count_backward(ann, layer_it, prev_layer);
         /* for each connection in this layer, propagate the error backwards */
         //prev_train_errors = prev_layer->train_errors;
         //this_train_errors = layer_it->train_errors;
+#if (defined FANN_QUIRE_DOT) || (defined FANN_BP_FLOAT_ACC)
+        for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+            if (fann_bp_is_zero(neuron_it->train_error)) {
+                // there is nothing to backpropagate
+                skipped++;
+            }
+        }
+#endif
+#ifdef FANN_QUIRE_DOT
+        // each previous error is one dot product over this layer, rounded once
+        for (n = prev_layer->num_neurons; (skipped < layer_it->num_neurons) && n--;) {
+            fann_quire q = fann_bp_to_quire(prev_layer->neuron[n].train_error);
+
+            for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+                if (fann_bp_is_non_zero(neuron_it->train_error)) {
+                    q = fann_quire_mac(q, neuron_it->train_error, fann_ff_to_bp(neuron_it->weight[n]));
+                }
+            }
+            prev_layer->neuron[n].train_error = fann_quire_to_bp(q);
+        }
+#elif defined FANN_BP_FLOAT_ACC
+        // the previous errors are summed over this layer in fp32, rounded once
+        for (n = 0; (skipped < layer_it->num_neurons) && (n < prev_layer->num_neurons); n += FANN_CONV_CHUNK) {
+            float acc[FANN_CONV_CHUNK];
+            unsigned int k, len = prev_layer->num_neurons - n;
+
+            if (len > FANN_CONV_CHUNK) {
+                len = FANN_CONV_CHUNK;
+            }
+            for (k = 0; k < len; k++) {
+                acc[k] = fann_bp_to_float(prev_layer->neuron[n + k].train_error);
+            }
+            for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+                if (fann_bp_is_non_zero(neuron_it->train_error)) {
+                    fann_bp_axpy_float(acc, neuron_it->train_error, neuron_it->weight + n, len);
+                }
+            }
+            for (k = 0; k < len; k++) {
+                prev_layer->neuron[n + k].train_error = fann_float_to_bp(acc[k]);
+            }
+        }
+#else
+#if (defined SWF16_AP) && (defined FANN_BP_MAC_ARRAY)
+        if (ann->change_bias == FANN_BP_BIAS_LAYER) {
+            skipped = fann_backpropagate_layer(layer_it, prev_layer);
+        } else
+#endif
         for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {//, this_train_errors++) {
 #ifdef DEBUGTRAIN
             fprintf(stderr, "neuron %03ld\n", neuron_it - layer_it->neuron);
@@ -520,6 +630,22 @@ void fann_backpropagate_loss(struct fann *ann)
                 continue;
             }
             weights = neuron_it->weight;
+#if (defined SWF16_AP) || (defined HWF16)
+            if (ann->change_bias == FANN_BP_BIAS_LAYER) {
+                // one format for the whole previous layer: set and converted once
+                fann_type_bp train_error;
+
+                fann_set_bp_bias(prev_layer->neuron->bp_fp16_bias);
+                train_error = fann_bp_to_bp(neuron_it->train_error, neuron_it->bp_fp16_bias);
+                for (n = prev_layer->num_neurons; n--;) {
+                    prev_layer->neuron[n].train_error = fann_bp_mac(train_error, fann_ff_to_bp(weights[n]), prev_layer->neuron[n].train_error);
+                }
+                // overflows are summed per layer
+                prev_layer->neuron->bp_batch_overflows += fann_ap_overflow;
+                prev_layer->neuron->bp_epoch_overflows += fann_ap_overflow;
+                continue;
+            }
+#endif
             // no need to calculate BIAS error...
             for (n = prev_layer->num_neurons; n--;) {
                 fann_type_bp train_error;
@@ -545,6 +671,7 @@ void fann_backpropagate_loss(struct fann *ann)
 #endif
             }
         }
+#endif // FANN_QUIRE_DOT
         if (skipped < layer_it->num_neurons) {
             /* then calculate the actual errors in the previous layer */
             //prev_train_errors = prev_layer->train_errors;
@@ -607,11 +734,13 @@ void fann_update_weights_incremental(struct fann *ann)
         last_neuron = layer_it->neuron + layer_it->num_neurons;
         // but include weights to BIAS 'NEURONS'
         prev_neurons = prev_layer->num_neurons;
+        fann_count_update(ann, layer_it, prev_layer, 3, 0);
         for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
             fann_set_bp_bias(neuron_it->bp_fp16_bias);
 #ifdef DEBUGTRAIN
             fprintf(stderr, "neuron[%ld]\n", neuron_it - layer_it->neuron);
 #endif
+            fann_stat_bp(layer_it->stats, FANN_STAT_ERROR, neuron_it->train_error);
             tmp_error = fann_bp_mul((neuron_it->train_error), fann_ff_to_bp(learning_rate));
             //train_errors++;
             /*if (ann->postpone_bp && *skip_errors++) {
@@ -624,6 +753,7 @@ void fann_update_weights_incremental(struct fann *ann)
             delta_w = fann_bp_mac(fann_ff_to_bp(learning_momentum), weight_slopes[w], tmp_error);
             weights[w] = fann_bp_to_ff(fann_bp_add(delta_w, fann_ff_to_bp(weights[w])));
             weight_slopes[w] = delta_w;
+            fann_stat_bp(layer_it->stats, FANN_STAT_DELTA, delta_w);
 #ifdef DEBUGTRAIN
             fprintf(stderr, "bias_delta = %+le\n", fann_bp_to_float(weight_slopes[w]));
 #endif
@@ -633,6 +763,7 @@ void fann_update_weights_incremental(struct fann *ann)
                         fann_bp_mul(fann_ff_to_bp(learning_momentum), weight_slopes[w]));
                 weights[w] = fann_bp_to_ff(fann_bp_add(delta_w, fann_ff_to_bp(weights[w])));
                 weight_slopes[w] = delta_w;
+                fann_stat_bp(layer_it->stats, FANN_STAT_DELTA, delta_w);
 #ifdef DEBUGTRAIN
                 fprintf(stderr, "delta[%u] = %+le\n", w, fann_bp_to_float(weight_slopes[w]));
 #endif
@@ -653,6 +784,40 @@ void fann_update_weights_incremental(struct fann *ann)
    will update all slopes.
 
 */
+#if (defined SWF16_AP) && (defined FANN_BP_MAC_ARRAY)
+/* INTERNAL FUNCTION
+   fann_update_slopes_batch() of a dense layer with FANN_BP_BIAS_LAYER: each
+   chunk of inputs is converted to the bp format of the layer once, for all
+   its neurons.
+*/
+static void fann_update_slopes_layer(struct fann_layer *layer, const struct fann_layer *prev_layer)
+{
+    struct fann_neuron *neuron_it, *last_neuron = layer->neuron + layer->num_neurons;
+    unsigned int i, k, prev_neurons = prev_layer->num_neurons;
+    fann_type_bp tmp[FANN_CONV_CHUNK];
+
+    fann_set_bp_bias(layer->neuron->bp_fp16_bias);
+    for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+        if (fann_bp_is_non_zero(neuron_it->train_error)) {
+            neuron_it->weight_slopes[prev_neurons] = fann_bp_add((neuron_it->train_error),
+                                                                 neuron_it->weight_slopes[prev_neurons]);
+        }
+    }
+    for (i = 0; i < prev_neurons; i += k) {
+        k = (prev_neurons - i < FANN_CONV_CHUNK) ? prev_neurons - i : FANN_CONV_CHUNK;
+        fann_ff_to_bp_array(tmp, prev_layer->value + i, k, FP_BIAS);
+        for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+            if (fann_bp_is_non_zero(neuron_it->train_error)) {
+                fann_bp_mac_array(neuron_it->weight_slopes + i, neuron_it->train_error, tmp, k);
+            }
+        }
+    }
+    // overflows are summed per layer
+    layer->neuron->bp_batch_overflows += fann_ap_overflow;
+    layer->neuron->bp_epoch_overflows += fann_ap_overflow;
+}
+#endif
+
 void fann_update_slopes_batch(struct fann *ann)
 {
     struct fann_layer *layer_begin, *layer_end;
@@ -680,11 +845,41 @@ void fann_update_slopes_batch(struct fann *ann)
         //train_errors = layer_begin->train_errors;
         // but include weights to BIAS 'NEURONS'
         prev_neurons = prev_layer->num_neurons;
+        fann_count_slopes(ann, layer_begin, prev_layer);
+#if (defined SWF16_AP) && (defined FANN_BP_MAC_ARRAY)
+        if ((ann->change_bias == FANN_BP_BIAS_LAYER) && (prev_layer->value != NULL)) {
+            fann_update_slopes_layer(layer_begin, prev_layer);
+            continue;
+        }
+#endif
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++/*, train_errors++*/) {
             fann_set_bp_bias(neuron_it->bp_fp16_bias);
             if (fann_bp_is_zero(neuron_it->train_error)) {
                 continue;
             }
+#ifdef FANN_QUIRE_DOT
+            if (neuron_it->slope_sums != NULL) {
+                // exact sums over the batch, see fann_round_weight_slopes()
+                fann_quire *slope_sums = neuron_it->slope_sums;
+
+                w = prev_neurons;
+                slope_sums[w] = fann_quire_mac(slope_sums[w], neuron_it->train_error, ff_p100);
+                values = prev_layer->value;
+                if (values == NULL) {
+                    const unsigned int *index = ann->sparse_index;
+                    const fann_type_ff *value = ann->sparse_value;
+                    unsigned int k;
+
+                    for (k = 0; k < ann->sparse_nnz; k++) {
+                        w = index[k];
+                        slope_sums[w] = fann_quire_mac(slope_sums[w], neuron_it->train_error, fann_ff_to_bp(value[k]));
+                    }
+                } else {
+                    fann_quire_mac_ff_array(slope_sums, neuron_it->train_error, values, w);
+                }
+                continue;
+            }
+#endif
             weight_slopes = neuron_it->weight_slopes;
             w = prev_neurons;
             weight_slopes[w] = fann_bp_add((neuron_it->train_error), weight_slopes[w]);
@@ -693,12 +888,28 @@ void fann_update_slopes_batch(struct fann *ann)
                    fann_bp_to_float(neuron_it->train_error), w, fann_bp_to_float(weight_slopes[w]));
 #endif
             values = prev_layer->value;
-            while (w--) {
-                weight_slopes[w] = fann_bp_mac((neuron_it->train_error), fann_ff_to_bp(values[w]), weight_slopes[w]);
+            if (values == NULL) {
+                // sparse input (fann_run_sparse): the slopes of zero inputs do not change
+                const unsigned int *index = ann->sparse_index;
+                const fann_type_ff *value = ann->sparse_value;
+                unsigned int k;
+
+                for (k = 0; k < ann->sparse_nnz; k++) {
+                    w = index[k];
+                    weight_slopes[w] = fann_bp_mac((neuron_it->train_error), fann_ff_to_bp(value[k]), weight_slopes[w]);
+                }
+            } else {
+#ifdef FANN_BP_MAC_ARRAY
+                fann_bp_mac_ff_array(weight_slopes, neuron_it->train_error, values, w);
+#else
+                while (w--) {
+                    weight_slopes[w] = fann_bp_mac((neuron_it->train_error), fann_ff_to_bp(values[w]), weight_slopes[w]);
 #ifdef DEBUGTRAIN
-                fprintf(stderr, "neuron %ld, error=%+le, wslope[%u]=%+le\n", neuron_it - layer_begin->neuron,
-                       fann_bp_to_float(neuron_it->train_error), w, fann_bp_to_float(weight_slopes[w]));
+                    fprintf(stderr, "neuron %ld, error=%+le, wslope[%u]=%+le\n", neuron_it - layer_begin->neuron,
+                           fann_bp_to_float(neuron_it->train_error), w, fann_bp_to_float(weight_slopes[w]));
 #endif
+                }
+#endif // FANN_BP_MAC_ARRAY
             }
 #if (defined SWF16_AP) || (defined HWF16)
             neuron_it->bp_batch_overflows += fann_ap_overflow;
@@ -710,6 +921,35 @@ void fann_update_slopes_batch(struct fann *ann)
     fann_set_ff_bias();
 }
 
+#ifdef FANN_QUIRE_DOT
+/* INTERNAL FUNCTION
+   Round the exact slope sums of the batch into weight_slopes.
+
+   Must be called after the last fann_update_slopes_batch() of a batch,
+   before the weights are updated.
+*/
+void fann_round_weight_slopes(struct fann *ann)
+{
+    struct fann_layer *layer_it, *prev_layer;
+    struct fann_neuron *neuron_it, *last_neuron;
+    unsigned int w, num_connections;
+
+    prev_layer = ann->first_layer;
+    for (layer_it = prev_layer + 1; layer_it != ann->last_layer; layer_it++, prev_layer++) {
+        last_neuron = layer_it->neuron + layer_it->num_neurons;
+        num_connections = prev_layer->num_connections;
+        for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+            if (neuron_it->slope_sums == NULL) {
+                continue;
+            }
+            for (w = 0; w < num_connections; w++) {
+                neuron_it->weight_slopes[w] = fann_quire_to_bp(neuron_it->slope_sums[w]);
+            }
+        }
+    }
+}
+#endif // FANN_QUIRE_DOT
+
 /* INTERNAL FUNCTION
    Update weights for batch training
  */
@@ -753,6 +993,7 @@ void fann_update_weights_batch(struct fann *ann,// unsigned int num_data,
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
         // but include weights to BIAS 'NEURONS'
         num_connections = prev_layer->num_connections;
+        fann_count_update(ann, layer_begin, prev_layer, 3, 1);
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++) {
             fann_set_bp_bias(neuron_it->bp_fp16_bias);
             //epsilon = fann_bp_div(fann_ff_to_bp(ann->learning_rate), fann_int_to_bp(num_data, neuron_it->bp_fp16_bias));
@@ -760,6 +1001,7 @@ void fann_update_weights_batch(struct fann *ann,// unsigned int num_data,
 #ifdef DEBUGTRAIN
             fprintf(stderr, "  neuron %d\n", (int)(neuron_it - layer_begin->neuron));
 #endif
+            fann_stat_bp(layer_begin->stats, FANN_STAT_ERROR, neuron_it->train_error);
             weight_slopes = neuron_it->weight_slopes;
             if ((neuron_it->prev_steps == NULL) && (speed)) {
                 fann_initialize_prev_steps(ann, layer_begin, neuron_it, num_connections);
@@ -792,10 +1034,12 @@ void fann_update_weights_batch(struct fann *ann,// unsigned int num_data,
                 fprintf(stderr, "(%f * %f) = w[%d]\n", fann_bp_to_float(weight_slopes[i]),
                         fann_bp_to_float(epsilon), i);
 #endif
+                fann_stat_bp(layer_begin->stats, FANN_STAT_DELTA, weight_slopes[i]);
                 if (speed) {
                     prev_steps[i] = fann_bp_add(fann_bp_mul(momentum, prev_steps[i]),
                                                     fann_bp_mul(weight_slopes[i], epsilon));
                     weights[i] = fann_bp_to_ff(fann_bp_add(prev_steps[i], fann_ff_to_bp(weights[i])));
+                    fann_stat_bp(layer_begin->stats, FANN_STAT_STEP, prev_steps[i]);
                 } else {
                     weights[i] = fann_bp_to_ff(fann_bp_mac(weight_slopes[i], epsilon, fann_ff_to_bp(weights[i])));
                 }
@@ -854,11 +1098,13 @@ void fann_update_weights_rmsprop(struct fann *ann,// unsigned int num_data,
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
         // but include weights to BIAS 'NEURONS'
         num_connections = prev_layer->num_connections;
+        fann_count_update(ann, layer_begin, prev_layer, 6, 2);
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++) {
             fann_set_bp_bias(neuron_it->bp_fp16_bias);
 #ifdef DEBUGTRAIN
             fprintf(stderr, "  neuron %d\n", (int)(neuron_it - layer_begin->neuron));
 #endif
+            fann_stat_bp(layer_begin->stats, FANN_STAT_ERROR, neuron_it->train_error);
             rmsprop_avg = fann_ff_to_bp(ann->rmsprop_avg);
             rmsprop_1mavg = fann_ff_to_bp(ann->rmsprop_1mavg);
             if (neuron_it->prev_slopes == NULL) {
@@ -935,6 +1181,9 @@ void fann_update_weights_rmsprop(struct fann *ann,// unsigned int num_data,
                     }
                 }
                 weights[i] = fann_bp_to_ff(fann_bp_add(delta_w, fann_ff_to_bp(weights[i])));
+                fann_stat_bp(layer_begin->stats, FANN_STAT_DELTA, weight_slopes[i]);
+                fann_stat_bp(layer_begin->stats, FANN_STAT_STEP, delta_w);
+                fann_stat_bp(layer_begin->stats, FANN_STAT_SLOPE, prev_slopes[i]);
             }
 #if (defined SWF16_AP) || (defined HWF16)
             neuron_it->bp_batch_overflows += fann_ap_overflow;
@@ -991,6 +1240,7 @@ void fann_update_weights_quickprop(struct fann *ann, unsigned int num_data,
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
         // but include weights to BIAS 'NEURONS'
         num_connections = prev_layer->num_connections;
+        fann_count_update(ann, layer_begin, prev_layer, 8, 3);
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++) {
 #ifdef SWF16_AP
             fann_ap_overflow = 0;
@@ -1086,9 +1336,13 @@ void fann_update_weights_quickprop(struct fann *ann, unsigned int num_data,
 /* INTERNAL FUNCTION
    The iRprop- algorithm
 */
-void fann_update_weights_irpropm(struct fann *ann)
+void fann_update_weights_irpropm(struct fann *ann, struct fann *self)
 {
     struct fann_layer *layer_begin, *layer_end;
+#ifdef FANN_PRINT_STATS
+    // a block per thread, the neurons of a layer are updated by several
+    struct fann_stat *stats;
+#endif
     //unsigned int count[4] = {0, 0, 0, 0}; double tot;
     fann_type_bp *weight_slopes, *prev_steps, *prev_slopes;
     fann_type_ff *weights;
@@ -1109,6 +1363,9 @@ void fann_update_weights_irpropm(struct fann *ann)
 #ifdef DEBUGTRAIN
     fprintf(stderr, "### %s @ %s : %d\n", __FUNCTION__, __FILE__, __LINE__);
 #endif
+#ifndef FANN_PRINT_STATS
+    self = self;
+#endif
 
     prev_layer = ann->first_layer;
     layer_begin = prev_layer + 1;
@@ -1121,6 +1378,10 @@ void fann_update_weights_irpropm(struct fann *ann)
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
         // but include weights to BIAS 'NEURONS'
         num_connections = prev_layer->num_connections;
+#ifdef FANN_PRINT_STATS
+        stats = self->first_layer[l].stats;
+#endif
+        fann_count_update(ann, layer_begin, prev_layer, 5, 3);
         for (n = 0, neuron_it = layer_begin->neuron; neuron_it != last_neuron; n++, neuron_it++) {
             fann_set_bp_bias(neuron_it->bp_fp16_bias);
 #ifdef DEBUGTRAIN
@@ -1156,6 +1417,7 @@ void fann_update_weights_irpropm(struct fann *ann)
             }
             prev_slopes = neuron_it->prev_slopes;
             weights = neuron_it->weight;
+            fann_stat_bp(stats, FANN_STAT_ERROR, neuron_it->train_error);
             increase_factor = fann_ff_to_bp(ann->rprop_increase_factor);
             decrease_factor = fann_ff_to_bp(ann->rprop_decrease_factor);
             delta_min = fann_ff_to_bp(ann->rprop_delta_min);
@@ -1165,6 +1427,7 @@ void fann_update_weights_irpropm(struct fann *ann)
                  * it also reduced fluctuations after maximum accuracy is reached */
                 prev_step = prev_steps[w];
                 slope = weight_slopes[w];
+                fann_stat_bp(stats, FANN_STAT_DELTA, slope);
                 same_sign = fann_bp_mul(prev_slopes[w], slope);
 
                 if (fann_bp_is_pos(same_sign)) {
@@ -1213,6 +1476,8 @@ void fann_update_weights_irpropm(struct fann *ann)
                 /* update global data arrays */
                 prev_steps[w] = next_step;
                 prev_slopes[w] = slope;
+                fann_stat_bp(stats, FANN_STAT_STEP, next_step);
+                fann_stat_bp(stats, FANN_STAT_SLOPE, slope);
             }
 #if (defined SWF16_AP) || (defined HWF16)
             neuron_it->bp_batch_overflows += fann_ap_overflow;
@@ -1318,12 +1583,42 @@ void fann_update_weights_sarprop(struct fann *ann, unsigned int epoch, unsigned
 #if (defined SWF16_AP) || (defined HWF16)
 FANN_EXTERNAL void FANN_API fann_set_fixed_bp_bias(struct fann *ann)
 {
-    ann->change_bias = 0;
+    ann->change_bias = FANN_BP_BIAS_FIXED;
 }
 
 FANN_EXTERNAL void FANN_API fann_set_dynamic_bp_bias(struct fann *ann)
 {
-    ann->change_bias = 1;
+    ann->change_bias = FANN_BP_BIAS_NEURON;
+}
+
+FANN_EXTERNAL void FANN_API fann_set_layer_bp_bias(struct fann *ann)
+{
+    struct fann_neuron *last_neuron, *neuron_it;
+    struct fann_layer *layer_it;
+    struct fann_layer *last_layer = ann->last_layer;
+    int_fast8_t bias;
+
+    ann->change_bias = FANN_BP_BIAS_LAYER;
+    for (layer_it = ann->first_layer + 1; layer_it != last_layer; layer_it++) {
+        last_neuron = layer_it->neuron + layer_it->num_neurons; // NOT THE BIAS
+        bias = layer_it->neuron->bp_fp16_bias;
+        for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+            if (neuron_it->bp_fp16_bias < bias) {
+                bias = neuron_it->bp_fp16_bias;
+            }
+        }
+        for (neuron_it = layer_it->neuron; neuron_it != last_neuron; neuron_it++) {
+            neuron_it->bp_fp16_bias = bias;
+        }
+    }
+#ifdef FANN_THREADS
+    if (ann->num_procs > 1) {
+        unsigned int p = ann->num_procs - 1;
+        while (p--) {
+            fann_set_layer_bp_bias(ann->ann[p]);
+        }
+    }
+#endif
 }
 
 FANN_EXTERNAL void FANN_API fann_initialize_bp_bias(struct fann *ann, int bias)
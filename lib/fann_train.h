@@ -58,14 +58,86 @@
 #ifdef FANN_INFERENCE_ONLY
 #define fann_reset_loss(a)
 #else // ! FANN_INFERENCE_ONLY
+/* Enum: fann_data_enc_enum
+   Storage encoding of the inputs or the outputs of a <struct fann_data>.
+
+   FANN_DATA_FF - One fann_type_ff per value (default).
+   FANN_DATA_U8 - One byte per value, expanded as offset + step * byte, with an offset
+                  and a step for each column.
+   FANN_DATA_F16 - IEEE 754 half precision (binary16).
+   FANN_DATA_BF16 - bfloat16, the upper half of a float.
+   FANN_DATA_SPARSE - Inputs only: the indexes and values of the nonzero inputs of each
+                      row (see <struct fann_sparse_row>), run with <fann_run_sparse>.
+
+   See also:
+       <fann_encode_data>
+*/
+enum fann_data_enc_enum
+{
+    FANN_DATA_FF = 0,
+    FANN_DATA_U8,
+    FANN_DATA_F16,
+    FANN_DATA_BF16,
+    FANN_DATA_SPARSE
+};
+
+/* Constant: FANN_DATA_ENC_NAMES
+
+   Constant array consisting of the names for the data encodings, so that the name of an
+   encoding can be received by:
+   (code)
+   char *name = FANN_DATA_ENC_NAMES[data->input_codec.enc];
+   (end)
+*/
+static char const *const FANN_DATA_ENC_NAMES[] = {
+    "FANN_DATA_FF",
+    "FANN_DATA_U8",
+    "FANN_DATA_F16",
+    "FANN_DATA_BF16",
+    "FANN_DATA_SPARSE"
+};
+
+/* row of FANN_DATA_SPARSE inputs: nnz nonzero values, at ascending indexes */
+struct fann_sparse_row
+{
+    unsigned int nnz;
+    unsigned int *index;
+    fann_type_ff *value;
+};
+
+/* encoding of the inputs or the outputs of a data set */
+struct fann_data_codec
+{
+    enum fann_data_enc_enum enc;
+    /* FANN_DATA_U8 only: num_input (or num_output) offsets followed by as many steps */
+    float *scale;
+};
+
+/* Payload of one or more data sets, released with the last data set
+   (or view) referencing it */
+struct fann_data_store
+{
+    unsigned int refs;
+    uint8_t *input;
+    uint8_t *output;
+};
+
 struct fann_data
 {
     unsigned int num_data;
     unsigned int num_input;
     unsigned int num_output;
-    /* pointer vectors of size num_data */
+    /* pointer vectors of size num_data (rows may be in any store). Rows of
+       encoded data sets hold the packed encoding, not fann_type_ff values */
     fann_type_ff **input;
     fann_type_ff **output;
+    struct fann_data_codec input_codec;
+    struct fann_data_codec output_codec;
+    /* original position of each row, allocated by the first shuffle */
+    unsigned int *order;
+    /* stores referenced by the rows */
+    struct fann_data_store **store;
+    unsigned int num_store;
 };
 
 /* Section: FANN Training */
@@ -219,6 +291,10 @@ FANN_EXTERNAL double FANN_API fann_test_max_data(struct fann *ann, struct fann_d
    >
    >inputdata separated by space
    >outputdata separated by space
+
+   Files starting with FANN_DATA_MAGIC are read in the binary format (see
+   <fann_data_format_enum>). Names ending in .gz, .xz or .zst are read
+   through gzip, xz or zstd.
    
    See also:
        <fann_train_on_data>, <fann_destroy_data>, <fann_save_data>
@@ -321,6 +397,9 @@ FANN_EXTERNAL void FANN_API fann_destroy_data(struct fann_data *train_data);
 /* Function: fann_get_data_input
    Gets the training input data at the given position
 
+   Rows of encoded data sets (see <fann_encode_data>) hold the packed encoding, use
+   <fann_expand_data_input> to read them as fann_type_ff.
+
    See also:
      <fann_get_data_output>
 
@@ -343,6 +422,7 @@ FANN_EXTERNAL fann_type_ff * FANN_API fann_get_data_output(struct fann_data * da
    
    Shuffles training data, randomizing the order. 
    This is recommended for incremental training, while it has no influence during batch training.
+   Only the row pointers are rearranged, the values are not moved.
    
    This function appears in FANN >= 1.1.0.
  */ 
@@ -658,6 +738,230 @@ FANN_EXTERNAL struct fann_data *FANN_API fann_subset_data(struct fann_data
 /* temporary hack to return a quick reference to internal data 
 FANN_EXTERNAL struct fann_data *FANN_API fann_getref_data(struct fann_data *data, unsigned int pos); */
 
+/* Group: Training Data Views */
+
+/* Function: fann_subset_data_view
+
+   Same as <fann_subset_data>, but without copying the values: the new <struct fann_data>
+   only holds pointers to the rows of *data*. The values are shared, and kept allocated
+   until the last data set using them is destroyed with <fann_destroy_data>, so *data* may
+   be destroyed before its views.
+
+   Shuffling a view (<fann_shuffle_data>) only rearranges its row pointers, but scaling a
+   view changes the values seen by every view of the same rows. Scale the data before
+   creating views, and do not scale a view that contains the same row twice.
+
+   See also:
+       <fann_rows_data_view>, <fann_merge_data_view>, <fann_fold_data_view>
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_subset_data_view(struct fann_data *data,
+                                                               unsigned int pos,
+                                                               unsigned int length);
+
+/* Function: fann_duplicate_data_view
+
+   Same as <fann_duplicate_data>, but without copying the values (see <fann_subset_data_view>).
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_duplicate_data_view(struct fann_data *data);
+
+/* Function: fann_merge_data_view
+
+   Same as <fann_merge_data>, but without copying the values (see <fann_subset_data_view>).
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_merge_data_view(struct fann_data *data1,
+                                                              struct fann_data *data2);
+
+/* Function: fann_rows_data_view
+
+   Returns a view with *num_rows* rows of *data*, where row i of the view is row rows[i]
+   of *data* (see <fann_subset_data_view>).
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_rows_data_view(struct fann_data *data,
+                                                             const unsigned int *rows,
+                                                             unsigned int num_rows);
+
+/* Function: fann_fold_data_view
+
+   Splits *data* in *num_folds* contiguous folds for cross-validation. Fold number *fold*
+   is returned in *test*, and the remaining rows in *train*, both as views (see
+   <fann_subset_data_view>), so k-fold cross-validation needs no copies of the data.
+
+   Return:
+   The function returns 0 on success and -1 on failure.
+ */
+FANN_EXTERNAL int FANN_API fann_fold_data_view(struct fann_data *data, unsigned int num_folds,
+                                               unsigned int fold, struct fann_data **train,
+                                               struct fann_data **test);
+
+/* Group: Training Data Encoding */
+
+/* Function: fann_encode_data
+
+   Stores the inputs and the outputs of *data* in a compact encoding (see
+   <fann_data_enc_enum>). Training and testing expand one row at a time to fann_type_ff,
+   right before it is loaded in the first layer, so a FANN_DATA_U8 data set needs 1/8 of
+   the memory (and of the memory bandwidth) of the same data set in a double build.
+
+   FANN_DATA_U8 uses step 1 for columns of integers spanning less than 256 values (as
+   one-hot or 8-bit sensor data), which are stored exactly. Other columns are quantized
+   to 256 levels between their minimum and maximum. FANN_DATA_F16 and FANN_DATA_BF16
+   round to nearest even.
+
+   FANN_DATA_SPARSE inputs keep only the nonzero values. Training runs them with
+   <fann_run_sparse>, and the batch algorithms (FANN_TRAIN_RPROP, FANN_TRAIN_BATCH and
+   FANN_TRAIN_RMSPROP) only accumulate the slopes of the weights of nonzero inputs, so
+   the first layer costs scale with the nonzero count instead of the number of inputs.
+   FANN_TRAIN_INCREMENTAL expands the rows, as its momentum updates every weight.
+
+   The values are copied to a new store, so views of *data* keep the previous encoding.
+   Only FANN_DATA_FF data can be encoded, and encoded data can not be scaled.
+
+   Parameters:
+     data - the data set to encode
+     input_enc - encoding of the inputs
+     output_enc - encoding of the outputs
+
+   Return:
+   The function returns 0 on success and -1 on failure.
+
+   See also:
+       <fann_expand_data_input>
+ */
+FANN_EXTERNAL int FANN_API fann_encode_data(struct fann_data *data,
+                                            enum fann_data_enc_enum input_enc,
+                                            enum fann_data_enc_enum output_enc);
+
+/* Function: fann_read_libsvm_data
+
+   Reads a data set in libsvm format, one row per line:
+   (code)
+   <label> <index>:<value> <index>:<value> ...
+   (end)
+   with ascending indexes starting at 1. The inputs are stored as FANN_DATA_SPARSE.
+
+   Parameters:
+     filename - the file to read
+     num_input - number of inputs, 0 for the largest index in the file
+     num_output - 1 for the label as output, or the number of classes for one-hot
+                  outputs, with labels 1 to num_output; for two classes, files with
+                  -1 (or 0) and +1 labels are read as classes 1 and 2
+
+   Return:
+   The data set, or NULL on failure.
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_read_libsvm_data(const char *filename,
+                                                               unsigned int num_input,
+                                                               unsigned int num_output);
+
+/* Enum: fann_data_format_enum
+   File formats of data sets.
+
+   FANN_FORMAT_TEXT - As read by <fann_read_data_from_file>.
+   FANN_FORMAT_BINARY - FANN_DATA_MAGIC, then the number of rows, inputs and outputs
+                        as uint32_t, then the inputs and outputs of each row as float,
+                        in the byte order of the host. Read by <fann_read_data_from_file>.
+   FANN_FORMAT_LIBSVM - As read by <fann_read_libsvm_data>, which can not read
+                        compressed files.
+*/
+enum fann_data_format_enum
+{
+    FANN_FORMAT_TEXT = 0,
+    FANN_FORMAT_BINARY,
+    FANN_FORMAT_LIBSVM
+};
+
+#define FANN_DATA_MAGIC "FANNDAT1"
+
+/* Enum: fann_synth_enum
+   Problems generated by <fann_create_synthetic_data>.
+
+   FANN_SYNTH_CLASSIFICATION - The inputs are normally distributed around a random
+       centroid of their class, with standard deviation *noise*. The outputs are one-hot,
+       or the class (0 or 1) if there is one output.
+   FANN_SYNTH_REGRESSION - The inputs are uniform in [-1, 1] and each output is
+       (1 + tanh(w.x + b)) / 2 of random weights w and bias b, plus normal noise of
+       standard deviation *noise*.
+*/
+enum fann_synth_enum
+{
+    FANN_SYNTH_CLASSIFICATION = 0,
+    FANN_SYNTH_REGRESSION
+};
+
+/* Struct: fann_synth_params
+   Description of a synthetic data set, see <fann_init_synthetic_params>.
+
+   The problem (centroids or weights) depends only on the seed, the task and the
+   sizes, and each row only on them and its number, so a test set is made with
+   the same parameters and *first_row* past the rows of the training set.
+*/
+struct fann_synth_params
+{
+    enum fann_synth_enum task;
+    unsigned int num_data;
+    unsigned int first_row;
+    unsigned int num_input;
+    unsigned int num_output;
+    /* fraction of nonzero inputs, 1 for dense data */
+    float density;
+    /* class c is skew^c times less frequent than class 0, 1 for balanced classes */
+    float skew;
+    float noise;
+    unsigned int seed;
+};
+
+/* Function: fann_init_synthetic_params
+
+   Sets *params* to a dense problem of *task* with balanced classes, noise 1
+   (classification) or 0.05 (regression) and seed 1.
+ */
+FANN_EXTERNAL void FANN_API fann_init_synthetic_params(struct fann_synth_params *params,
+                                                       enum fann_synth_enum task,
+                                                       unsigned int num_data,
+                                                       unsigned int num_input,
+                                                       unsigned int num_output);
+
+/* Function: fann_create_synthetic_data
+
+   Generates the data set of *params* in memory, as FANN_DATA_FF (see
+   <fann_encode_data> for sparse inputs).
+
+   Return:
+   The data set, or NULL on failure.
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_create_synthetic_data(const struct fann_synth_params *params);
+
+/* Function: fann_save_synthetic_data
+
+   Writes the data set of *params* to *filename* in *format*, one row at a
+   time, so it can be much larger than the memory. Names ending in .gz, .xz or
+   .zst are written through gzip, xz or zstd. FANN_FORMAT_LIBSVM writes the
+   class as label (1 to num_output, or 0 and 1 with one output), and only
+   regression with one output.
+
+   Return:
+   0 on success, -1 on failure.
+ */
+FANN_EXTERNAL int FANN_API fann_save_synthetic_data(const struct fann_synth_params *params,
+                                                    const char *filename,
+                                                    enum fann_data_format_enum format);
+
+/* Function: fann_expand_data_input
+
+   Returns the inputs of row *pos* as fann_type_ff. For encoded data sets the row is
+   expanded to *buf*, which must hold <fann_num_input_data> values, otherwise the row
+   itself is returned.
+ */
+FANN_EXTERNAL fann_type_ff *FANN_API fann_expand_data_input(struct fann_data *data,
+                                                            unsigned int pos, fann_type_ff *buf);
+
+/* Function: fann_expand_data_output
+
+   Same as <fann_expand_data_input>, for the outputs.
+ */
+FANN_EXTERNAL fann_type_ff *FANN_API fann_expand_data_output(struct fann_data *data,
+                                                             unsigned int pos, fann_type_ff *buf);
+
 /* Function: fann_length_data
    
    Returns the number of training patterns in the <struct fann_data>.
@@ -691,6 +995,7 @@ FANN_EXTERNAL unsigned int FANN_API fann_num_output_data(struct fann_data *data)
 /* Function: fann_save_data
    
    Save the training structure to a file, with the format as specified in <fann_read_data_from_file>
+   (compressed for names ending in .gz, .xz or .zst)
 
    Return:
    The function returns 0 on success and -1 on failure.
@@ -26,9 +26,236 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 
 #include "fann.h"
 
+/* bytes used by each value of a row */
+static unsigned int fann_data_enc_size(enum fann_data_enc_enum enc)
+{
+    switch (enc) {
+    case FANN_DATA_U8:
+        return 1;
+    case FANN_DATA_F16:
+    case FANN_DATA_BF16:
+        return 2;
+    default:
+        return sizeof(fann_type_ff);
+    }
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Expand an encoded row of n values to dst. Rows of FANN_DATA_FF data sets
+ * are returned as they are.
+ */
+static fann_type_ff *fann_expand_row(const struct fann_data_codec *codec, fann_type_ff *row,
+                                     unsigned int n, fann_type_ff *dst)
+{
+    unsigned int c = 0;
+
+    fann_set_ff_bias();
+    switch (codec->enc) {
+    case FANN_DATA_FF:
+        return row;
+    case FANN_DATA_U8: {
+        const uint8_t *src = (const uint8_t *)row;
+        const float *offset = codec->scale, *step = codec->scale + n;
+        float tmp[FANN_CONV_CHUNK];
+        unsigned int k, len;
+
+        for (; c < n; c += len) {
+            len = ((n - c) < FANN_CONV_CHUNK) ? (n - c) : FANN_CONV_CHUNK;
+            for (k = 0; k < len; k++) {
+                tmp[k] = offset[c + k] + step[c + k] * (float)src[c + k];
+            }
+            fann_float_to_ff_array(dst + c, tmp, len);
+        }
+        break;
+    }
+    case FANN_DATA_F16:
+        fann_half_to_ff_array(dst, (const uint16_t *)row, n);
+        break;
+    case FANN_DATA_BF16:
+        fann_bf16_to_ff_array(dst, (const uint16_t *)row, n);
+        break;
+    case FANN_DATA_SPARSE: {
+        const struct fann_sparse_row *src = (const struct fann_sparse_row *)row;
+
+        for (; c < n; c++) {
+            dst[c] = ff_0000;
+        }
+        for (c = 0; c < src->nnz; c++) {
+            dst[src->index[c]] = src->value[c];
+        }
+        break;
+    }
+    }
+    return dst;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Encode a row of n fann_type_ff values to dst.
+ */
+static void fann_encode_row(const struct fann_data_codec *codec, const fann_type_ff *src,
+                            unsigned int n, void *dst)
+{
+    unsigned int c;
+
+    fann_set_ff_bias();
+    switch (codec->enc) {
+    case FANN_DATA_FF:
+        fann_memcpy((fann_type_ff *)dst, src, n);
+        break;
+    case FANN_DATA_U8: {
+        const float *offset = codec->scale, *step = codec->scale + n;
+        uint8_t *out = dst;
+        float tmp[FANN_CONV_CHUNK], q;
+        unsigned int k, len;
+
+        for (c = 0; c < n; c += len) {
+            len = ((n - c) < FANN_CONV_CHUNK) ? (n - c) : FANN_CONV_CHUNK;
+            fann_ff_to_float_array(tmp, src + c, len);
+            for (k = 0; k < len; k++) {
+                q = floorf((tmp[k] - offset[c + k]) / step[c + k] + 0.5f);
+                out[c + k] = (uint8_t)fann_clip(q, 0.0f, 255.0f);
+            }
+        }
+        break;
+    }
+    case FANN_DATA_F16:
+        fann_ff_to_half_array(dst, src, n);
+        break;
+    case FANN_DATA_BF16:
+        fann_ff_to_bf16_array(dst, src, n);
+        break;
+    case FANN_DATA_SPARSE: {
+        struct fann_sparse_row *out = dst;
+
+        // out->index and out->value must have room for the nonzero values
+        for (out->nnz = c = 0; c < n; c++) {
+            if (!fann_ff_is_zero(src[c])) {
+                out->index[out->nnz] = c;
+                out->value[out->nnz++] = src[c];
+            }
+        }
+        break;
+    }
+    }
+}
+
+/* rows as loaded in the network by the training and testing loops */
+#define fann_data_input_row(ann, row) \
+    fann_expand_row((ann)->data_input_codec, (row), (ann)->num_input, (ann)->data_row)
+#define fann_data_output_row(ann, row) \
+    fann_expand_row((ann)->data_output_codec, (row), (ann)->num_output, \
+                    (ann)->data_row + (ann)->num_input)
+
+/*
+ * INTERNAL FUNCTION
+ * fann_run of a data set row, sparse rows do not need to be expanded.
+ */
+static inline fann_type_ff *fann_run_data_row(struct fann *ann, fann_type_ff *row)
+{
+    if (ann->data_input_codec->enc == FANN_DATA_SPARSE) {
+        const struct fann_sparse_row *sparse = (const struct fann_sparse_row *)row;
+
+        return fann_run_sparse(ann, sparse->nnz, sparse->index, sparse->value);
+    }
+    return fann_run(ann, fann_data_input_row(ann, row));
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Point the network (and its threads) to the encoding of data, with a
+ * row to expand it to.
+ */
+static int fann_prepare_data(struct fann *ann, struct fann_data *data)
+{
+#ifdef FANN_THREADS
+    int p;
+#endif
+
+    ann->data_input_codec = &data->input_codec;
+    ann->data_output_codec = &data->output_codec;
+    if ((ann->data_row == NULL) &&
+        ((data->input_codec.enc != FANN_DATA_FF) || (data->output_codec.enc != FANN_DATA_FF))) {
+        fann_calloc(ann->data_row, ann->num_input + ann->num_output);
+        if (ann->data_row == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            return -1;
+        }
+    }
+#ifdef FANN_THREADS
+    for (p = (int)ann->num_procs - 2; p >= 0; p--) {
+        if (fann_prepare_data(ann->ann[p], data))
+            return -1;
+    }
+#endif
+    return 0;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Opens a data file for reading ("r") or writing ("w"), through the compressor
+ * of its suffix (.gz, .xz or .zst) if it has one; *piped is then set.
+ */
+FILE *fann_open_data_file(const char *filename, const char *mode, int *piped)
+{
+    static const char * const compressors[][2] = {
+        {".gz", "gzip"},
+        {".xz", "xz"},
+        {".zst", "zstd -q"},
+    };
+    size_t len = strlen(filename), n;
+    unsigned int c;
+    char cmd[4096];
+    FILE *file;
+
+    *piped = 0;
+    for (c = 0; c < sizeof(compressors) / sizeof(compressors[0]); c++) {
+        n = strlen(compressors[c][0]);
+        if ((len > n) && (strcmp(filename + len - n, compressors[c][0]) == 0))
+            break;
+    }
+    if (c == sizeof(compressors) / sizeof(compressors[0]))
+        return fopen(filename, mode);
+#ifdef FANN_EMBEDDED
+    return NULL;
+#else
+    // the shell would only report a missing file when reading
+    if (mode[0] == 'r') {
+        file = fopen(filename, "r");
+        if (file == NULL)
+            return NULL;
+        fclose(file);
+    }
+    if ((strchr(filename, '\'') != NULL) ||
+        (snprintf(cmd, sizeof(cmd), (mode[0] == 'r') ? "%s -dc < '%s'" : "%s -c > '%s'",
+                  compressors[c][1], filename) >= (int)sizeof(cmd)))
+        return NULL;
+    file = popen(cmd, (mode[0] == 'r') ? "r" : "w");
+    *piped = (file != NULL);
+    return file;
+#endif
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Closes a file of fann_open_data_file, non-zero on errors (of the compressor too).
+ */
+int fann_close_data_file(FILE *file, int piped)
+{
+#ifndef FANN_EMBEDDED
+    if (piped)
+        return pclose(file);
+#else
+    (void)piped;
+#endif
+    return fclose(file);
+}
+
 /*
  * Reads training data from a file. 
  */
@@ -36,9 +263,10 @@ FANN_EXTERNAL struct fann_data *FANN_API fann_read_data_from_file(const char *co
 {
     struct fann_data *data;
     FILE *file;
+    int piped = 0;
     
     if (configuration_file != NULL) {
-        file = fopen(configuration_file, "r");
+        file = fann_open_data_file(configuration_file, "r", &piped);
         if (!file) {
             fann_error(FANN_E_CANT_OPEN_CONFIG_R, configuration_file);
             return NULL;
@@ -49,7 +277,7 @@ FANN_EXTERNAL struct fann_data *FANN_API fann_read_data_from_file(const char *co
 
     data = fann_read_data_from_fd(file, configuration_file);
     if (configuration_file != NULL) {
-        fclose(file);
+        fann_close_data_file(file, piped);
     }
     return data;
 }
@@ -67,27 +295,106 @@ FANN_EXTERNAL int FANN_API fann_save_data(struct fann_data *data, const char *fi
  */
 FANN_EXTERNAL void FANN_API fann_destroy_data(struct fann_data *data)
 {
+    unsigned int s;
+
     if(data == NULL)
         return;
-    if(data->input != NULL)
-        fann_free(data->input[0]);
-    if(data->output != NULL)
-        fann_free(data->output[0]);
+    /* the payload is released with the last data set (or view) using it */
+    for(s = 0; s < data->num_store; s++)
+    {
+        if(--data->store[s]->refs == 0)
+        {
+            fann_free(data->store[s]->input);
+            fann_free(data->store[s]->output);
+            fann_free(data->store[s]);
+        }
+    }
+    fann_free(data->store);
     fann_free(data->input);
     fann_free(data->output);
+    fann_free(data->order);
+    fann_free(data->input_codec.scale);
+    fann_free(data->output_codec.scale);
     fann_free(data);
 }
 
+#ifdef FANN_THREADS
+static inline uint64_t fann_thread_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Runs th, the network of extra thread t of ann, on its CPU if pinned.
+ */
+static void fann_thread_start(struct fann *ann, int t, void *(*run)(void *), struct fann *th)
+{
+    uint64_t start = fann_thread_ns();
+    pthread_attr_t attr, *pattr = NULL;
+
+    fann_trace_begin(FANN_TRACE_SPAWN);
+
+#ifdef CPU_SET
+    if (th->cpu >= 0) {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(th->cpu, &set);
+        pthread_attr_init(&attr);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set);
+        pattr = &attr;
+    }
+#endif
+    if (pthread_create(&(ann->thread[t]), pattr, run, th)) {
+        fprintf(stderr, "pthread error \n");
+        exit(1);
+    }
+    if (pattr != NULL) {
+        pthread_attr_destroy(pattr);
+    }
+    fann_trace_end();
+    ann->times.spawn_ns += fann_thread_ns() - start;
+}
+
+static void fann_thread_join(struct fann *ann)
+{
+    uint64_t start = fann_thread_ns();
+    int p;
+
+    fann_trace_begin(FANN_TRACE_JOIN);
+    for (p = ann->num_procs - 2; p >= 0; p--) {
+        pthread_join(ann->thread[p], NULL);
+    }
+    fann_trace_end();
+    ann->times.join_ns += fann_thread_ns() - start;
+}
+#endif // FANN_THREADS
+
 #ifdef CALCULATE_ERROR
 static void * fann_batch_test(void * ref)
 {
     struct fann * ann = ref;
     unsigned int data;
+#ifdef FANN_THREADS
+    uint64_t start = fann_thread_ns();
+#endif
 
+    fann_trace_begin(FANN_TRACE_BATCH);
     fann_reset_loss(ann);
     for (data = 0; data < ann->data_batch; data++) {
-        fann_test(ann, ann->data_input[data], ann->data_output[data]);
+        fann_test_output(ann, fann_run_data_row(ann, ann->data_input[data]),
+                         fann_data_output_row(ann, ann->data_output[data]));
     }
+    fann_trace_end();
+#ifdef FANN_THREADS
+    ann->times.batches++;
+    ann->times.rows += ann->data_batch;
+    ann->times.work_ns += fann_thread_ns() - start;
+#endif
 
     return NULL;
 }
@@ -100,9 +407,10 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
     int t;
     unsigned int i, tot, mini_rem, mini_th, done, np;
 
-    if (fann_check_input_output_sizes(ann, data) == -1)
+    if ((fann_check_input_output_sizes(ann, data) == -1) || fann_prepare_data(ann, data))
         return 0;
     
+    fann_trace_begin(FANN_TRACE_TEST);
     mini_rem = data->num_data;
 #ifdef FANN_THREADS
     np = ann->num_procs;
@@ -121,10 +429,7 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
             th->data_batch = mini_th;
             mini_rem -= mini_th;
             done += mini_th;
-            if (pthread_create(&(ann->thread[t]), NULL, fann_batch_test, th)) {
-                fprintf(stderr, "pthread error \n");
-                exit(1);
-            }
+            fann_thread_start(ann, t, fann_batch_test, th);
 #endif
         } else {
             ann->data_input = data->input + done;
@@ -134,10 +439,7 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
             fann_batch_test(ann);
 #ifdef FANN_THREADS
             if (np > 1) {
-                int p;
-                for (p = ann->num_procs - 2; p >= 0; p--) {
-                    pthread_join(ann->thread[p], NULL);
-                }
+                fann_thread_join(ann);
             }
 #endif
             break;
@@ -146,6 +448,7 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
 #ifdef FANN_THREADS
     if (np > 1) {
         int p;
+        fann_trace_begin(FANN_TRACE_REDUCE);
         for (p = ann->num_procs - 2; p >= 0; p--) {
             unsigned int o;
             struct fann *ann_p = ann->ann[p];
@@ -161,9 +464,12 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
                 ann->num_max_ok[o] += ann_p->num_max_ok[o];
             }
         }
+        fann_trace_end();
     }
 #endif
 
+    fann_trace_end();
+    fann_metrics_tested(data->num_data);
     if (ann->num_output > 1) {
         tot = 0;
         for (i = 0; i < ann->num_output; i++) {
@@ -176,46 +482,25 @@ FANN_EXTERNAL float FANN_API fann_test_data(struct fann *ann, struct fann_data *
 #endif // CALCULATE_ERROR
 #endif // FANN_INFERENCE_ONLY
 
-#define TIME_MEAS
-#undef TIME_MEAS
-
-#ifdef TIME_MEAS
-static uint32_t tms = 0;
-
-static uint32_t us_tot;
-static void * ref_tot = NULL;
-
-static uint32_t * ns_fw = NULL;
-static void * ref_fw = NULL;
-
-static uint32_t * ns_er = NULL;
-static void * ref_er = NULL;
-
-static uint32_t * ns_bw = NULL;
-static void * ref_bw = NULL;
-
-static uint32_t * ns_up = NULL;
-static void * ref_up = NULL;
-
-#define START_FW() {ref_fw = fann_start_count(ref_fw);}
-#define STOP_FW() {ns_fw[i] = fann_stop_count_ns(ref_fw);}
-#define START_ER() {ref_er = fann_start_count(ref_er);}
-#define STOP_ER() {ns_er[i] = fann_stop_count_ns(ref_er);}
-#define START_BW() {ref_bw = fann_start_count(ref_bw);}
-#define STOP_BW() {ns_bw[i] = fann_stop_count_ns(ref_bw);}
-#define START_UP() {ref_up = fann_start_count(ref_up);}
-#define STOP_UP() {ns_up[i] = fann_stop_count_ns(ref_up);}
-
-#else
-#define START_FW()
-#define STOP_FW()
-#define START_ER()
-#define STOP_ER()
-#define START_BW()
-#define STOP_BW()
-#define START_UP()
-#define STOP_UP()
-#endif
+// phases of the timed samples, see fann_prof.h, samples and updates for
+// the metrics, see fann_metrics.h, and events of the timeline, see
+// fann_trace.h
+#define START_FW() {fann_metrics_sample(); fann_prof_sample(); fann_prof_start(FANN_PHASE_FORWARD); \
+                    fann_trace_sample_begin(FANN_TRACE_FORWARD);}
+#define STOP_FW() {fann_trace_sample_end(); fann_prof_stop();}
+#define START_ER() {fann_prof_start(FANN_PHASE_LOSS); fann_trace_sample_begin(FANN_TRACE_LOSS);}
+#define STOP_ER() {fann_trace_sample_end(); fann_prof_stop();}
+#define START_BW() {fann_prof_start(FANN_PHASE_BACKWARD); fann_trace_sample_begin(FANN_TRACE_BACKWARD);}
+#define STOP_BW() {fann_trace_sample_end(); fann_prof_stop();}
+// weight slopes, part of the backward phase
+#define START_SL() {fann_prof_start(FANN_PHASE_BACKWARD); fann_trace_sample_begin(FANN_TRACE_SLOPES);}
+#define STOP_SL() {fann_trace_sample_end(); fann_prof_stop();}
+// weight updates after each sample
+#define START_UP() {fann_prof_start(FANN_PHASE_UPDATE); fann_trace_sample_begin(FANN_TRACE_UPDATE);}
+#define STOP_UP() {fann_trace_sample_end(); fann_prof_stop();}
+// weight updates after each (mini) batch
+#define START_WU() {fann_prof_batch_start(); fann_trace_begin(FANN_TRACE_UPDATE);}
+#define STOP_WU() {fann_trace_end(); fann_prof_batch_stop(); fann_metrics_publish(1);}
 
 #if 0
 static void fann_norm_neurons(struct fann *ann)
@@ -276,6 +561,31 @@ static void fann_norm_neurons(struct fann *ann)
 #endif // 0
 
 #ifndef FANN_INFERENCE_ONLY
+#if (defined SWF16_AP) || (defined HWF16)
+/* FANN_BP_BIAS_LAYER: the bias of all the neurons of the layer goes down if
+   any of them overflowed in the batch, up if none did in the epoch */
+static void fann_adjust_layer_bp_bias(struct fann_layer *layer, int epoch)
+{
+    struct fann_neuron *neuron_it, *last_neuron = layer->neuron + layer->num_neurons;
+    int_fast8_t bias = layer->neuron->bp_fp16_bias;
+    unsigned int overflows = 0;
+
+    for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+        overflows += epoch ? neuron_it->bp_epoch_overflows : neuron_it->bp_batch_overflows;
+    }
+    if (epoch && (overflows == 0) && (bias < 31)) {
+        bias++;
+    } else if (!epoch && (overflows != 0) && (bias > 15)) {
+        bias--;
+    } else {
+        return;
+    }
+    for (neuron_it = layer->neuron; neuron_it != last_neuron; neuron_it++) {
+        neuron_it->bp_fp16_bias = bias;
+    }
+}
+#endif
+
 // fann_clear_weight_slopes must be zero at the beginning of each batch
 static void fann_clear_weight_slopes(struct fann *ann,
         struct fann_layer *layer_begin, struct fann_layer *layer_end)
@@ -295,6 +605,11 @@ static void fann_clear_weight_slopes(struct fann *ann,
     for (; layer_begin <= layer_end; layer_begin++) {
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
         num_connections = prev_layer->num_connections;
+#if (defined SWF16_AP) || (defined HWF16)
+        if (ann->change_bias == FANN_BP_BIAS_LAYER) {
+            fann_adjust_layer_bp_bias(layer_begin, 0);
+        }
+#endif
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++) {
             if (neuron_it->weight_slopes == NULL) {
                 fann_malloc(neuron_it->weight_slopes, num_connections);
@@ -303,12 +618,24 @@ static void fann_clear_weight_slopes(struct fann *ann,
                     return;
                 }
             }
+#ifdef FANN_QUIRE_DOT
+            if (neuron_it->slope_sums == NULL) {
+                fann_malloc(neuron_it->slope_sums, num_connections);
+                if (neuron_it->slope_sums == NULL) {
+                    fann_error(FANN_E_CANT_ALLOCATE_MEM);
+                    return;
+                }
+            }
+            for (i = 0; i < num_connections; i++) {
+                fann_quire_clr(neuron_it->slope_sums[i]);
+            }
+#endif
 #ifdef FANN_THREADS
             neuron_it->step_done = 0;
 #endif
 #if (defined SWF16_AP) || (defined HWF16)
             if ((neuron_it->bp_batch_overflows != 0) && (neuron_it->bp_fp16_bias > 15) &&
-                (ann->change_bias)) {
+                (ann->change_bias == FANN_BP_BIAS_NEURON)) {
                 neuron_it->bp_fp16_bias--;
             }
             neuron_it->bp_batch_overflows = 0;
@@ -328,7 +655,7 @@ static void fann_check_no_overflows(struct fann *ann)
 {
     struct fann_neuron *neuron_it, *last_neuron;
     struct fann_layer *layer_begin, *layer_end;
-    unsigned int h;
+    unsigned int h, overflows;
 
     bias_histogram[0] = 0;
     for (h = 15; h < 32; h++) {
@@ -339,15 +666,21 @@ static void fann_check_no_overflows(struct fann *ann)
     layer_end = ann->last_layer - 1;
     for (; layer_begin <= layer_end; layer_begin++) {
         last_neuron = layer_begin->neuron + layer_begin->num_neurons;
+        if (ann->change_bias == FANN_BP_BIAS_LAYER) {
+            fann_adjust_layer_bp_bias(layer_begin, 1);
+        }
+        overflows = 0;
         for (neuron_it = layer_begin->neuron; neuron_it != last_neuron; neuron_it++) {
             if ((neuron_it->bp_epoch_overflows == 0) && (neuron_it->bp_fp16_bias < 31) &&
-                (ann->change_bias)) {
+                (ann->change_bias == FANN_BP_BIAS_NEURON)) {
                 neuron_it->bp_fp16_bias++;
             }
             bias_histogram[neuron_it->bp_fp16_bias]++;
-            bias_histogram[0] += neuron_it->bp_epoch_overflows;
+            overflows += neuron_it->bp_epoch_overflows;
             neuron_it->bp_epoch_overflows = 0;
         }
+        bias_histogram[0] += overflows;
+        fann_metrics_overflows((unsigned int)(layer_begin - ann->first_layer), overflows);
     }
 }
 #else // (defined SWF16_AP) || (defined HWF16)
@@ -379,23 +712,8 @@ static float fann_train_epoch_quickprop(struct fann *ann, struct fann_data *data
     }
 #endif // CALCULATE_ERROR
 
-#ifdef TIME_MEAS
-    if (tms == 0) {
-        fann_malloc(ref_tot, data->num_data);
-        fann_malloc(ns_fw, data->num_data);
-        fann_malloc(ref_fw, data->num_data);
-        fann_malloc(ns_er, data->num_data);
-        fann_malloc(ref_er, data->num_data);
-        fann_malloc(ns_bw, data->num_data);
-        fann_malloc(ref_bw, data->num_data);
-        fann_malloc(ns_up, data->num_data);
-        fann_malloc(ref_up, data->num_data);
-        tms = data->num_data;
-    }
-    ref_tot = fann_start_count(ref_tot);
-#endif
-
     for (done = 0; done < data->num_data; done += mini) {
+        fann_trace_begin(FANN_TRACE_BATCH);
         fann_reset_loss(ann);
         fann_clear_weight_slopes(ann, NULL, NULL);
         stop = done + mini;
@@ -419,14 +737,15 @@ static float fann_train_epoch_quickprop(struct fann *ann, struct fann_data *data
                 STOP_ER()
             }
 
-            START_UP()
+            START_SL()
             fann_update_slopes_batch(ann);
-            STOP_UP()
+            STOP_SL()
         }
+        fann_round_weight_slopes(ann);
+        START_WU()
         fann_update_weights_quickprop(ann, mini, NULL, NULL);
-#ifndef FANN_INFERENCE_ONLY
-        fann_batch_stats(ann);
-#endif // FANN_INFERENCE_ONLY
+        STOP_WU()
+        fann_trace_end();
 #ifdef CALCULATE_LOSS
         tot_mse += ann->loss_count;
         acc_mse += ann->loss_value;
@@ -451,14 +770,7 @@ static float fann_train_epoch_quickprop(struct fann *ann, struct fann_data *data
     ann->num_bit_ok[0] = tot_bits_ok[0];
     ann->num_bit_ok[1] = tot_bits_ok[1];
 #endif // CALCULATE_ERROR
-#ifdef TIME_MEAS
-    us_tot = fann_stop_count_us(ref_tot);
-    printf("tot = %f\n", 1000.0 * (double)us_tot / (double)(data->num_data));
-    fann_print_count(ns_fw, data->num_data);
-    fann_print_count(ns_er, data->num_data);
-    fann_print_count(ns_bw, data->num_data);
-    fann_print_count(ns_up, data->num_data);
-#endif
+    fann_prof_flush();
     return 0.5 * acc_mse / (float)tot_mse; //fann_get_loss(ann);
 }
 #endif // 0
@@ -467,16 +779,21 @@ static void * fann_batch_train(void * ref)
 {
     struct fann * ann = ref;
     unsigned int data;
+#ifdef FANN_THREADS
+    struct fann * self = ann;
+    uint64_t start = fann_thread_ns(), stop;
+#endif
 
+    fann_trace_begin(FANN_TRACE_BATCH);
     fann_reset_loss(ann);
     fann_clear_weight_slopes(ann, NULL, NULL);
     for (data = 0; data < ann->data_batch; data++) {
         START_FW()
-        fann_run(ann, ann->data_input[data]);
+        fann_run_data_row(ann, ann->data_input[data]);
         STOP_FW()
 
         START_ER()
-        if (fann_compute_loss(ann, ann->data_output[data])) {
+        if (fann_compute_loss(ann, fann_data_output_row(ann, ann->data_output[data]))) {
             STOP_ER()
 
             START_BW()
@@ -486,15 +803,22 @@ static void * fann_batch_train(void * ref)
             STOP_ER()
         }
 
-        START_UP()
+        START_SL()
         fann_update_slopes_batch(ann);
-        STOP_UP()
+        STOP_SL()
     }
+    fann_round_weight_slopes(ann);
 #ifdef FANN_THREADS
+    stop = fann_thread_ns();
+    self->times.batches++;
+    self->times.rows += self->data_batch;
+    self->times.work_ns += stop - start;
+    start = stop;
     if (ann->num_procs == 0) {
         ann = ann->ann[0];
     }
     if (ann->num_procs != 1) {
+        fann_trace_begin(FANN_TRACE_BARRIER);
         pthread_mutex_lock(&(ann->mutex));
         ann->wait_procs--;
         while (ann->wait_procs > 0) {
@@ -502,9 +826,23 @@ static void * fann_batch_train(void * ref)
         }
         pthread_mutex_unlock(&(ann->mutex));
         pthread_cond_signal(&(ann->cond));
+        fann_trace_end();
     }
+    stop = fann_thread_ns();
+    self->times.wait_ns += stop - start;
+    start = stop;
+#endif
+    // with the reduction of the weight slopes of the threads
+    START_WU()
+    fann_update_weights_irpropm(ann, ref);
+    // every thread publishes its samples, the caller the update
+    fann_trace_end();
+    fann_prof_batch_stop();
+    fann_metrics_publish(ann == ref);
+    fann_trace_end();
+#ifdef FANN_THREADS
+    self->times.update_ns += fann_thread_ns() - start;
 #endif
-    fann_update_weights_irpropm(ann);
     return NULL;
 }
 
@@ -519,7 +857,6 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
     double tmp;
 #endif // CALCULATE_LOSS
     double x, var, avg;
-    static double last_ratio = 1e3;
     double loss;
     unsigned int mini_rem, mini_th;
     unsigned int done, mini, stop, tot_mse = 0;
@@ -548,22 +885,6 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
     }
 #endif // CALCULATE_ERROR
 
-#ifdef TIME_MEAS
-    if (tms == 0) {
-        fann_malloc(ref_tot, data->num_data);
-        fann_malloc(ns_fw, data->num_data);
-        fann_malloc(ref_fw, data->num_data);
-        fann_malloc(ns_er, data->num_data);
-        fann_malloc(ref_er, data->num_data);
-        fann_malloc(ns_bw, data->num_data);
-        fann_malloc(ref_bw, data->num_data);
-        fann_malloc(ns_up, data->num_data);
-        fann_malloc(ref_up, data->num_data);
-        tms = data->num_data;
-    }
-    ref_tot = fann_start_count(ref_tot);
-#endif
-
     for (done = 0; done < data->num_data; ) {
         stop = done + mini;
         if (stop > data->num_data) {
@@ -585,10 +906,7 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
                 th->data_batch = mini_th;
                 mini_rem -= mini_th;
                 done += mini_th;
-                if (pthread_create(&(ann->thread[t]), NULL, fann_batch_train, th)) {
-                    fprintf(stderr, "pthread error \n");
-                    exit(1);
-                }
+                fann_thread_start(ann, t, fann_batch_train, th);
 #endif
             } else {
                 ann->data_input = data->input + done;
@@ -598,10 +916,7 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
                 fann_batch_train(ann);
 #ifdef FANN_THREADS
                 if (ann->num_procs > 1) {
-                    int p;
-                    for (p = ann->num_procs - 2; p >= 0; p--) {
-                        pthread_join(ann->thread[p], NULL);
-                    }
+                    fann_thread_join(ann);
                 }
 #endif
                 break;
@@ -610,6 +925,7 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
 #ifdef FANN_THREADS
         if (ann->num_procs > 1) {
             int p;
+            fann_trace_begin(FANN_TRACE_REDUCE);
             for (p = ann->num_procs - 2; p >= 0; p--) {
                 unsigned int o;
                 struct fann *ann_p = ann->ann[p];
@@ -625,6 +941,7 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
                     ann->num_max_ok[o] += ann_p->num_max_ok[o];
                 }
             }
+            fann_trace_end();
         }
 #endif
 
@@ -642,9 +959,6 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
         tot_mse += ann->loss_count;
         acc_mse += ann->loss_value;
 #endif // CALCULATE_LOSS
-#ifndef FANN_INFERENCE_ONLY
-        fann_batch_stats(ann);
-#endif // FANN_INFERENCE_ONLY
 #ifdef CALCULATE_ERROR
         tot_bits_fail[0] += ann->num_bit_fail[0];
         tot_bits_fail[1] += ann->num_bit_fail[1];
@@ -665,23 +979,16 @@ static double fann_train_epoch_irpropm(struct fann *ann, struct fann_data *data)
     ann->num_bit_ok[0] = tot_bits_ok[0];
     ann->num_bit_ok[1] = tot_bits_ok[1];
 #endif // CALCULATE_ERROR
-#ifdef TIME_MEAS
-    us_tot = fann_stop_count_us(ref_tot);
-    printf("tot = %f\n", 1000.0 * (double)us_tot / (double)(data->num_data));
-    fann_print_count(ns_fw, data->num_data);
-    fann_print_count(ns_er, data->num_data);
-    fann_print_count(ns_bw, data->num_data);
-    fann_print_count(ns_up, data->num_data);
-#endif
+    fann_prof_flush();
     //fann_norm_neurons(ann);
     loss = 0.5 * acc_mse / (float)tot_mse;
     if (ann->mini_batch != 0) {
         var /= (double)k;
         x = sqrt(var);
-        if ((x / avg) > last_ratio) {
+        if ((x / avg) > ann->mini_batch_ratio) {
             ann->mini_batch = 0;
         }
-        last_ratio = x / avg;
+        ann->mini_batch_ratio = x / avg;
     }
     return loss;
 }
@@ -710,9 +1017,6 @@ float fann_train_epoch_sarprop(struct fann *ann, struct fann_data *data)
         fann_update_slopes_batch(ann, ann->first_layer + 1, ann->last_layer - 1);
     }
     fann_check_no_overflows(ann);
-    if (ann->stats_weigs != NULL) {
-        fann_batch_stats(ann);
-    }
 
     //fann_update_weights_sarprop(ann, ann->sarprop_epoch, 0, ann->total_connections);
 
@@ -745,23 +1049,8 @@ static float fann_train_epoch_batch(struct fann *ann, struct fann_data *data)
     }
 #endif // CALCULATE_ERROR
 
-#ifdef TIME_MEAS
-    if (tms == 0) {
-        fann_malloc(ref_tot, data->num_data);
-        fann_malloc(ns_fw, data->num_data);
-        fann_malloc(ref_fw, data->num_data);
-        fann_malloc(ns_er, data->num_data);
-        fann_malloc(ref_er, data->num_data);
-        fann_malloc(ns_bw, data->num_data);
-        fann_malloc(ref_bw, data->num_data);
-        fann_malloc(ns_up, data->num_data);
-        fann_malloc(ref_up, data->num_data);
-        tms = data->num_data;
-    }
-    ref_tot = fann_start_count(ref_tot);
-#endif
-
     for (done = 0; done < data->num_data; done += mini) {
+        fann_trace_begin(FANN_TRACE_BATCH);
         fann_reset_loss(ann);
         fann_clear_weight_slopes(ann, NULL, NULL);
         stop = done + mini;
@@ -771,11 +1060,11 @@ static float fann_train_epoch_batch(struct fann *ann, struct fann_data *data)
         }
         for (i = done; i < stop; i++) {
             START_FW()
-            fann_run(ann, data->input[i]);
+            fann_run_data_row(ann, data->input[i]);
             STOP_FW()
 
             START_ER()
-            if (fann_compute_loss(ann, data->output[i])) {
+            if (fann_compute_loss(ann, fann_data_output_row(ann, data->output[i]))) {
                 STOP_ER()
 
                 START_BW()
@@ -785,14 +1074,15 @@ static float fann_train_epoch_batch(struct fann *ann, struct fann_data *data)
                 STOP_ER()
             }
 
-            START_UP()
+            START_SL()
             fann_update_slopes_batch(ann);
-            STOP_UP()
+            STOP_SL()
         }
+        fann_round_weight_slopes(ann);
+        START_WU()
         fann_update_weights_batch(ann, /*mini,*/ NULL, NULL);
-#ifndef FANN_INFERENCE_ONLY
-        fann_batch_stats(ann);
-#endif // FANN_INFERENCE_ONLY
+        STOP_WU()
+        fann_trace_end();
 #ifdef CALCULATE_LOSS
         tot_mse += ann->loss_count;
         acc_mse += ann->loss_value;
@@ -817,14 +1107,7 @@ static float fann_train_epoch_batch(struct fann *ann, struct fann_data *data)
     ann->num_bit_ok[0] = tot_bits_ok[0];
     ann->num_bit_ok[1] = tot_bits_ok[1];
 #endif // CALCULATE_ERROR
-#ifdef TIME_MEAS
-    us_tot = fann_stop_count_us(ref_tot);
-    printf("tot = %f\n", 1000.0 * (double)us_tot / (double)(data->num_data));
-    fann_print_count(ns_fw, data->num_data);
-    fann_print_count(ns_er, data->num_data);
-    fann_print_count(ns_bw, data->num_data);
-    fann_print_count(ns_up, data->num_data);
-#endif
+    fann_prof_flush();
     return 0.5 * acc_mse / (float)tot_mse; //fann_get_loss(ann);
 }
 
@@ -852,23 +1135,8 @@ static float fann_train_epoch_rmsprop(struct fann *ann, struct fann_data *data)
     }
 #endif // CALCULATE_ERROR
 
-#ifdef TIME_MEAS
-    if (tms == 0) {
-        fann_malloc(ref_tot, data->num_data);
-        fann_malloc(ns_fw, data->num_data);
-        fann_malloc(ref_fw, data->num_data);
-        fann_malloc(ns_er, data->num_data);
-        fann_malloc(ref_er, data->num_data);
-        fann_malloc(ns_bw, data->num_data);
-        fann_malloc(ref_bw, data->num_data);
-        fann_malloc(ns_up, data->num_data);
-        fann_malloc(ref_up, data->num_data);
-        tms = data->num_data;
-    }
-    ref_tot = fann_start_count(ref_tot);
-#endif
-
     for (done = 0; done < data->num_data; done += mini) {
+        fann_trace_begin(FANN_TRACE_BATCH);
         fann_reset_loss(ann);
         fann_clear_weight_slopes(ann, NULL, NULL);
         stop = done + mini;
@@ -878,11 +1146,11 @@ static float fann_train_epoch_rmsprop(struct fann *ann, struct fann_data *data)
         }
         for (i = done; i < stop; i++) {
             START_FW()
-            fann_run(ann, data->input[i]);
+            fann_run_data_row(ann, data->input[i]);
             STOP_FW()
 
             START_ER()
-            if (fann_compute_loss(ann, data->output[i])) {
+            if (fann_compute_loss(ann, fann_data_output_row(ann, data->output[i]))) {
                 STOP_ER()
 
                 START_BW()
@@ -892,14 +1160,15 @@ static float fann_train_epoch_rmsprop(struct fann *ann, struct fann_data *data)
                 STOP_ER()
             }
 
-            START_UP()
+            START_SL()
             fann_update_slopes_batch(ann);
-            STOP_UP()
+            STOP_SL()
         }
+        fann_round_weight_slopes(ann);
+        START_WU()
         fann_update_weights_rmsprop(ann, /*mini,*/ NULL, NULL);
-#ifndef FANN_INFERENCE_ONLY
-        fann_batch_stats(ann);
-#endif // FANN_INFERENCE_ONLY
+        STOP_WU()
+        fann_trace_end();
 #ifdef CALCULATE_LOSS
         tot_mse += ann->loss_count;
         acc_mse += ann->loss_value;
@@ -924,14 +1193,7 @@ static float fann_train_epoch_rmsprop(struct fann *ann, struct fann_data *data)
     ann->num_bit_ok[0] = tot_bits_ok[0];
     ann->num_bit_ok[1] = tot_bits_ok[1];
 #endif // CALCULATE_ERROR
-#ifdef TIME_MEAS
-    us_tot = fann_stop_count_us(ref_tot);
-    printf("tot = %f\n", 1000.0 * (double)us_tot / (double)(data->num_data));
-    fann_print_count(ns_fw, data->num_data);
-    fann_print_count(ns_er, data->num_data);
-    fann_print_count(ns_bw, data->num_data);
-    fann_print_count(ns_up, data->num_data);
-#endif
+    fann_prof_flush();
     return 0.5 * acc_mse / (float)tot_mse; //fann_get_loss(ann);
 }
 
@@ -947,29 +1209,14 @@ static float fann_train_epoch_incremental(struct fann *ann, struct fann_data *da
     if (ann->first_layer[1].neuron[0].weight_slopes == NULL)
         fann_clear_weight_slopes(ann, NULL, NULL);
 
-#ifdef TIME_MEAS
-    if (tms == 0) {
-        fann_malloc(ref_tot, data->num_data);
-        fann_malloc(ns_fw, data->num_data);
-        fann_malloc(ref_fw, data->num_data);
-        fann_malloc(ns_er, data->num_data);
-        fann_malloc(ref_er, data->num_data);
-        fann_malloc(ns_bw, data->num_data);
-        fann_malloc(ref_bw, data->num_data);
-        fann_malloc(ns_up, data->num_data);
-        fann_malloc(ref_up, data->num_data);
-        tms = data->num_data;
-    }
-    ref_tot = fann_start_count(ref_tot);
-#endif
-
     for (i = 0; i != data->num_data; i++) {
         START_FW()
-        fann_run(ann, data->input[i]);
+        // sparse rows are expanded too, the momentum changes every weight
+        fann_run(ann, fann_data_input_row(ann, data->input[i]));
         STOP_FW()
 
         START_ER()
-        if (fann_compute_loss(ann, data->output[i])) {
+        if (fann_compute_loss(ann, fann_data_output_row(ann, data->output[i]))) {
             STOP_ER()
 
             START_BW()
@@ -983,20 +1230,10 @@ static float fann_train_epoch_incremental(struct fann *ann, struct fann_data *da
         fann_update_weights_incremental(ann);
         STOP_UP()
 
-#ifndef FANN_INFERENCE_ONLY
-        fann_batch_stats(ann);
-#endif // FANN_INFERENCE_ONLY
     }
     fann_check_no_overflows(ann);
 
-#ifdef TIME_MEAS
-    us_tot = fann_stop_count_us(ref_tot);
-    printf("tot = %f\n", 1000.0 * (double)us_tot / (double)(data->num_data));
-    fann_print_count(ns_fw, data->num_data);
-    fann_print_count(ns_er, data->num_data);
-    fann_print_count(ns_bw, data->num_data);
-    fann_print_count(ns_up, data->num_data);
-#endif
+    fann_prof_flush();
 
     //fann_norm_neurons(ann);
     return fann_get_loss(ann);
@@ -1009,8 +1246,15 @@ unsigned int fann_train_shuffle = 10000;
  */
 FANN_EXTERNAL float FANN_API fann_train_epoch(struct fann *ann, struct fann_data *data)
 {
-    if(fann_check_input_output_sizes(ann, data) == -1)
+    float error = 0;
+
+    if(fann_check_weights_writable(ann) || (fann_check_input_output_sizes(ann, data) == -1) ||
+       fann_prepare_data(ann, data))
         return 0;
+#ifdef FIXEDFANN
+    // the int16 copies would no longer match the weights
+    fann_fixed_release(ann);
+#endif
     
     if (fann_train_shuffle > 0) {
         fann_train_shuffle--;
@@ -1018,22 +1262,29 @@ FANN_EXTERNAL float FANN_API fann_train_epoch(struct fann *ann, struct fann_data
     }
    
     ann->train_epoch++;
+    fann_trace_begin(FANN_TRACE_EPOCH);
     switch (ann->training_algorithm)
     {
     //case FANN_TRAIN_QUICKPROP:
     //    return fann_train_epoch_quickprop(ann, data);
     case FANN_TRAIN_RPROP:
-        return fann_train_epoch_irpropm(ann, data);
+        error = fann_train_epoch_irpropm(ann, data);
+        break;
     case FANN_TRAIN_RMSPROP:
-        return fann_train_epoch_rmsprop(ann, data);
+        error = fann_train_epoch_rmsprop(ann, data);
+        break;
     //case FANN_TRAIN_SARPROP:
     //    return fann_train_epoch_sarprop(ann, data);
     case FANN_TRAIN_BATCH:
-        return fann_train_epoch_batch(ann, data);
+        error = fann_train_epoch_batch(ann, data);
+        break;
     case FANN_TRAIN_INCREMENTAL:
-        return fann_train_epoch_incremental(ann, data);
+        error = fann_train_epoch_incremental(ann, data);
+        break;
     }
-    return 0;
+    fann_trace_end();
+    fann_metrics_epoch(ann, error);
+    return error;
 }
 
 FANN_EXTERNAL void FANN_API fann_train_on_data(struct fann *ann, struct fann_data *data,
@@ -1049,12 +1300,16 @@ FANN_EXTERNAL void FANN_API fann_train_on_data(struct fann *ann, struct fann_dat
 #ifdef DEBUG
     printf("Training with %s\n", FANN_TRAIN_NAMES[ann->training_algorithm]);
 #endif
+    if (fann_check_weights_writable(ann))
+        return;
 
     if(epochs_between_reports && ann->callback == NULL)
     {
         printf("Max epochs %8d. Desired error: %.10f.\n", max_epochs, desired_error);
     }
-    ann->train_epoch = 0;
+    /* a network restored by fann_load_checkpoint continues from its epoch */
+    ann->train_epoch = ann->resume_epoch;
+    ann->resume_epoch = 0;
 
     while (ann->train_epoch < max_epochs) {
         /*
@@ -1119,27 +1374,103 @@ FANN_EXTERNAL void FANN_API fann_train_on_file(struct fann *ann, const char *fil
 FANN_EXTERNAL void FANN_API fann_shuffle_data(struct fann_data *train_data)
 {
     unsigned int dat = 0, elem, swap;
-    fann_type_ff temp;
+    fann_type_ff *temp;
+
+    /* keep track of the row order, so that checkpoints can restore it */
+    if(train_data->order == NULL)
+    {
+        fann_malloc(train_data->order, train_data->num_data);
+        if(train_data->order != NULL)
+        {
+            for(elem = 0; elem < train_data->num_data; elem++)
+                train_data->order[elem] = elem;
+        }
+    }
 
+    /* only the row pointers move, the payload may be shared with other views */
     for(; dat < train_data->num_data; dat++)
     {
         swap = (unsigned int) (rand() % train_data->num_data);
         if(swap != dat)
         {
-            for(elem = 0; elem < train_data->num_input; elem++)
-            {
-                temp = train_data->input[dat][elem];
-                train_data->input[dat][elem] = train_data->input[swap][elem];
-                train_data->input[swap][elem] = temp;
-            }
-            for(elem = 0; elem < train_data->num_output; elem++)
+            if(train_data->order != NULL)
             {
-                temp = train_data->output[dat][elem];
-                train_data->output[dat][elem] = train_data->output[swap][elem];
-                train_data->output[swap][elem] = temp;
+                elem = train_data->order[dat];
+                train_data->order[dat] = train_data->order[swap];
+                train_data->order[swap] = elem;
             }
+            temp = train_data->input[dat];
+            train_data->input[dat] = train_data->input[swap];
+            train_data->input[swap] = temp;
+            temp = train_data->output[dat];
+            train_data->output[dat] = train_data->output[swap];
+            train_data->output[swap] = temp;
+        }
+    }
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Rearrange the rows so that row i holds the row originally (before any
+ * shuffle) at position order[i], as recorded by fann_shuffle_data.
+ */
+int fann_reorder_data(struct fann_data *data, const unsigned int *order)
+{
+    fann_type_ff **input, **output;
+    unsigned int *where;
+    unsigned int i, src;
+
+    for(i = 0; i < data->num_data; i++)
+    {
+        if(order[i] >= data->num_data)
+        {
+            fann_error(FANN_E_INDEX_OUT_OF_BOUND, order[i]);
+            return -1;
+        }
+    }
+    if(data->num_data == 0)
+        return 0;
+    fann_calloc(where, data->num_data);
+    fann_calloc(input, data->num_data);
+    fann_calloc(output, data->num_data);
+    if((where == NULL) || (input == NULL) || (output == NULL))
+    {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_free(where);
+        fann_free(input);
+        fann_free(output);
+        return -1;
+    }
+    /* current position of each original row */
+    for(i = 0; i < data->num_data; i++)
+    {
+        where[(data->order == NULL) ? i : data->order[i]] = i;
+    }
+    if(data->order == NULL)
+    {
+        fann_malloc(data->order, data->num_data);
+        if(data->order == NULL)
+        {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            fann_free(where);
+            fann_free(input);
+            fann_free(output);
+            return -1;
         }
     }
+    for(i = 0; i < data->num_data; i++)
+    {
+        src = where[order[i]];
+        input[i] = data->input[src];
+        output[i] = data->output[src];
+    }
+    fann_free(where);
+    fann_memcpy(data->order, order, data->num_data);
+    fann_free(data->input);
+    fann_free(data->output);
+    data->input = input;
+    data->output = output;
+    return 0;
 }
 
 /*
@@ -1171,6 +1502,10 @@ static void fann_get_min_max_data(fann_type_ff ** data, unsigned int num_data, u
 FANN_EXTERNAL float FANN_API fann_get_min_data_input(struct fann_data *train_data)
 {
     struct fann_ff_limits lim;
+    if (train_data->input_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->input_codec.enc]);
+        return 0;
+    }
     fann_get_min_max_data(train_data->input, train_data->num_data, train_data->num_input, &lim);
     fann_set_ff_bias();
     return fann_ff_to_float(lim.min);
@@ -1179,6 +1514,10 @@ FANN_EXTERNAL float FANN_API fann_get_min_data_input(struct fann_data *train_dat
 FANN_EXTERNAL float FANN_API fann_get_max_data_input(struct fann_data *train_data)
 {
     struct fann_ff_limits lim;
+    if (train_data->input_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->input_codec.enc]);
+        return 0;
+    }
     fann_get_min_max_data(train_data->input, train_data->num_data, train_data->num_input, &lim);
     fann_set_ff_bias();
     return fann_ff_to_float(lim.max);
@@ -1187,6 +1526,10 @@ FANN_EXTERNAL float FANN_API fann_get_max_data_input(struct fann_data *train_dat
 FANN_EXTERNAL float FANN_API fann_get_min_data_output(struct fann_data *train_data)
 {
     struct fann_ff_limits lim;
+    if (train_data->output_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->output_codec.enc]);
+        return 0;
+    }
     fann_get_min_max_data(train_data->output, train_data->num_data, train_data->num_output, &lim);
     fann_set_ff_bias();
     return fann_ff_to_float(lim.min);
@@ -1195,6 +1538,10 @@ FANN_EXTERNAL float FANN_API fann_get_min_data_output(struct fann_data *train_da
 FANN_EXTERNAL float FANN_API fann_get_max_data_output(struct fann_data *train_data)
 {
     struct fann_ff_limits lim;
+    if (train_data->output_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->output_codec.enc]);
+        return 0;
+    }
     fann_get_min_max_data(train_data->output, train_data->num_data, train_data->num_output, &lim);
     fann_set_ff_bias();
     return fann_ff_to_float(lim.max);
@@ -1229,29 +1576,33 @@ FANN_EXTERNAL unsigned int fann_count_classes(struct fann_data * data, unsigned
         float threshold_f, unsigned int * max_idx, unsigned int * min_idx)
 {
     unsigned int dat, elem, max_class, min_class, noclass;
-    fann_type_ff ** out = data->output, threshold;
-
-    fann_set_ff_bias();
-    threshold = fann_float_to_ff(threshold_f);
+    fann_type_ff *out, *buf, threshold;
 
     if (*class_count == NULL) {
         fann_malloc(*class_count, data->num_output);
     }
-    if (*class_count == NULL) {
+    fann_malloc(buf, data->num_output);
+    if ((*class_count == NULL) || (buf == NULL)) {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_free(buf);
         return 0;
     }
+    fann_set_ff_bias();
+    threshold = fann_float_to_ff(threshold_f);
+
     for (elem = 0; elem < data->num_output; elem++) {
         (*class_count)[elem] = 0;
     }
     for (noclass = dat = 0; dat < data->num_data; dat++) {
         int match = 0;
 
+        out = fann_expand_data_output(data, dat, buf);
         for (elem = 0; elem < data->num_output; elem++) {
-            if (fann_ff_gt(out[dat][elem], threshold)) {
+            if (fann_ff_gt(out[elem], threshold)) {
                 (*class_count)[elem]++;
                 if (match) {
                     fprintf(stderr, "ERROR: classes not mutually exclusive\n");
+                    fann_free(buf);
                     return 0;
                 }
                 match = 1;
@@ -1261,6 +1612,7 @@ FANN_EXTERNAL unsigned int fann_count_classes(struct fann_data * data, unsigned
             noclass++;
         }
     }
+    fann_free(buf);
     *max_idx = data->num_output;
     if (min_idx != NULL) {
         *min_idx = data->num_output;
@@ -1304,46 +1656,75 @@ FANN_EXTERNAL void FANN_API fann_scale_data_to_range(fann_type_ff ** data, unsig
                      struct fann_ff_limits * old_l, struct fann_ff_limits new_l)
 {
     unsigned int dat, elem;
-    fann_type_nt temp, old_span, new_span, factor;
+    fann_type_nt temp, new_span, *old_min, *factor, *row;
     fann_type_nt new_minf, new_maxf;
+    unsigned char *clip, *flat; // clip: 1 to new_l.min, 2 to new_l.max
 
-    fann_set_ff_bias();
+    fann_malloc(old_min, 3 * num_elem);
+    fann_malloc(clip, 2 * num_elem);
+    if ((old_min == NULL) || (clip == NULL)) {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_free(old_min);
+        fann_free(clip);
+        return;
+    }
+    factor = old_min + num_elem;
+    row = factor + num_elem;
+    flat = clip + num_elem;
+
+    fann_set_ff_bias();
     new_minf = fann_ff_to_nt(new_l.min);
     new_maxf = fann_ff_to_nt(new_l.max);
     new_span = fann_nt_sub(new_maxf, new_minf);
 
     for(elem = 0; elem < num_elem; elem++)
     {
-        old_span = fann_nt_sub(fann_ff_to_nt(old_l[elem].max), fann_ff_to_nt(old_l[elem].min));
-        factor = fann_nt_div(new_span, old_span);
+        fann_type_nt old_span;
+
+        old_min[elem] = fann_ff_to_nt(old_l[elem].min);
+        old_span = fann_nt_sub(fann_ff_to_nt(old_l[elem].max), old_min[elem]);
+        factor[elem] = fann_nt_div(new_span, old_span);
+        flat[elem] = fann_nt_is_zero(old_span);
         //fprintf(stderr, "max %f, min %f, factor %f = %f / %f, #%u\n", fann_ff_to_float(old_max[elem]),
         //        fann_ff_to_float(old_min[elem]), factor, new_span, old_span, elem);
-        if (fann_nt_is_zero(old_span)) {
-            fann_type_ff nil = fann_nt_to_ff(fann_nt_div(new_span, fann_float_to_nt(2.0)));
-            for (dat = 0; dat < num_data; dat++) {
-                data[dat][elem] = nil;
-            }
-            continue;
+        if (flat[elem]) {
+            factor[elem] = fann_nt_div(new_span, fann_float_to_nt(2.0));
         }
-        for (dat = 0; dat < num_data; dat++) {
-            temp = fann_nt_add(fann_nt_mul(fann_nt_sub(fann_ff_to_nt(data[dat][elem]), fann_ff_to_nt(old_l[elem].min)), factor), new_minf);
+    }
+    // row by row, through the array conversions of the back-end
+    for (dat = 0; dat < num_data; dat++) {
+        fann_ff_to_nt_array(row, data[dat], num_elem);
+        for (elem = 0; elem < num_elem; elem++) {
+            clip[elem] = 0;
+            if (flat[elem]) {
+                row[elem] = factor[elem]; // new_span / 2
+                continue;
+            }
+            temp = fann_nt_add(fann_nt_mul(fann_nt_sub(row[elem], old_min[elem]), factor[elem]), new_minf);
             if(fann_nt_lt(temp, new_minf)) {
-                data[dat][elem] = new_l.min;
+                clip[elem] = 1;
 #ifndef FANN_INFERENCE_ONLY
                 printf("%s|%s error %f < %f\n", __FILE__, __FUNCTION__, fann_nt_to_float(temp), fann_nt_to_float(new_minf));
 #endif
             } else if(fann_nt_gt(temp, new_maxf)) {
-                data[dat][elem] = new_l.max;
+                clip[elem] = 2;
 #ifndef FANN_INFERENCE_ONLY
                 printf("%s|%s error %f > %f\n", __FILE__, __FUNCTION__, fann_nt_to_float(temp), fann_nt_to_float(new_maxf));
 #endif
-            } else {
-                //printf(",%f", temp); 
-                data[dat][elem] = fann_nt_to_ff(temp);
+            }
+            row[elem] = temp;
+        }
+        fann_nt_to_ff_array(data[dat], row, num_elem);
+        for (elem = 0; elem < num_elem; elem++) {
+            if (clip[elem] == 1) {
+                data[dat][elem] = new_l.min;
+            } else if (clip[elem] == 2) {
+                data[dat][elem] = new_l.max;
             }
         }
-        //printf("\n");
     }
+    fann_free(old_min);
+    fann_free(clip);
 }
 
 /*
@@ -1352,6 +1733,10 @@ FANN_EXTERNAL void FANN_API fann_scale_data_to_range(fann_type_ff ** data, unsig
 FANN_EXTERNAL void FANN_API fann_scale_input_data_linear(struct fann_data *train_data,
                      struct fann_ff_limits ** old_l, struct fann_ff_limits new_l)
 {
+    if (train_data->input_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->input_codec.enc]);
+        return;
+    }
     fann_scale_data_linear(train_data->input, train_data->num_data, train_data->num_input,
                     old_l, new_l);
 }
@@ -1362,149 +1747,407 @@ FANN_EXTERNAL void FANN_API fann_scale_input_data_linear(struct fann_data *train
 FANN_EXTERNAL void FANN_API fann_scale_output_data_linear(struct fann_data *train_data,
                      struct fann_ff_limits ** old_l, struct fann_ff_limits new_l)
 {
+    if (train_data->output_codec.enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[train_data->output_codec.enc]);
+        return;
+    }
     fann_scale_data_linear(train_data->output, train_data->num_data, train_data->num_output,
                     old_l, new_l);
 }
 #endif // FANN_DATA_SCALE
 
 /*
- * merges training data into a single struct. 
+ * INTERNAL FUNCTION
+ * Allocate a data set with its row pointer vectors, but without payload.
  */
-FANN_EXTERNAL struct fann_data *FANN_API fann_merge_data(struct fann_data *data1,
-                                                                     struct fann_data *data2)
+static struct fann_data *fann_create_data_rows(unsigned int num_data, unsigned int num_input,
+                                               unsigned int num_output)
 {
-    unsigned int i;
-    fann_type_ff *data_input, *data_output;
-    struct fann_data *dest;// =
+    struct fann_data *data;
 
-    fann_malloc(dest, 1);
-    if(dest == NULL)
+    fann_calloc(data, 1);
+    if(data == NULL)
     {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
         return NULL;
     }
-
-    if((data1->num_input != data2->num_input) || (data1->num_output != data2->num_output))
+    data->num_data = num_data;
+    data->num_input = num_input;
+    data->num_output = num_output;
+    fann_calloc(data->input, num_data);
+    fann_calloc(data->output, num_data);
+    if((data->input == NULL) || (data->output == NULL))
     {
-        fann_error(FANN_E_TRAIN_DATA_MISMATCH);
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_destroy_data(data);
         return NULL;
     }
+    return data;
+}
 
-    dest->num_data = data1->num_data+data2->num_data;
-    dest->num_input = data1->num_input;
-    dest->num_output = data1->num_output;
-    fann_calloc(dest->input, dest->num_data);
-    if(dest->input == NULL)
-    {
+/*
+ * INTERNAL FUNCTION
+ * Copy an encoding (with the per column scales of FANN_DATA_U8).
+ */
+static int fann_copy_codec(struct fann_data_codec *dest, const struct fann_data_codec *src,
+                           unsigned int n)
+{
+    fann_free(dest->scale);
+    dest->enc = src->enc;
+    if (src->scale != NULL) {
+        fann_malloc(dest->scale, 2 * n);
+        if (dest->scale == NULL) {
+            fann_error(FANN_E_CANT_ALLOCATE_MEM);
+            return -1;
+        }
+        fann_memcpy(dest->scale, src->scale, 2 * n);
+    }
+    return 0;
+}
+
+static int fann_same_codec(const struct fann_data_codec *a, const struct fann_data_codec *b,
+                           unsigned int n)
+{
+    if (a->enc != b->enc)
+        return 0;
+    if ((a->scale == NULL) || (b->scale == NULL))
+        return a->scale == b->scale;
+    return memcmp(a->scale, b->scale, 2 * n * sizeof(*a->scale)) == 0;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Allocate the payload of a data set without stores, in its encoding, and
+ * point the rows to it. FANN_DATA_SPARSE inputs get room for nnz values,
+ * with all rows empty and pointing to the first value.
+ */
+static int fann_create_store(struct fann_data *data, unsigned int nnz)
+{
+    struct fann_data_store *store;
+    unsigned int i, in_size, out_size, value_size = 0, extra = 0;
+
+    if (data->input_codec.enc == FANN_DATA_SPARSE) {
+        in_size = sizeof(struct fann_sparse_row);
+        /* the indexes stay aligned after 1 or 2 byte values */
+        value_size = (nnz * sizeof(fann_type_ff) + sizeof(unsigned int) - 1) &
+                     ~(unsigned int)(sizeof(unsigned int) - 1);
+        extra = value_size + nnz * sizeof(unsigned int);
+    } else {
+        in_size = data->num_input * fann_data_enc_size(data->input_codec.enc);
+    }
+    out_size = data->num_output * fann_data_enc_size(data->output_codec.enc);
+    fann_calloc(data->store, 1);
+    fann_calloc(store, 1);
+    if ((data->store == NULL) || (store == NULL)) {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+        fann_free(store);
+        return -1;
     }
+    store->refs = 1;
+    data->store[0] = store;
+    data->num_store = 1;
 
-    fann_calloc(dest->output, dest->num_data);
-    if(dest->output == NULL)
-    {
+    fann_calloc(store->input, in_size * data->num_data + extra);
+    fann_calloc(store->output, out_size * data->num_data);
+    if ((store->input == NULL) || (store->output == NULL)) {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+        return -1;
+    }
+    for (i = 0; i != data->num_data; i++) {
+        data->input[i] = (fann_type_ff *)(store->input + (size_t)i * in_size);
+        data->output[i] = (fann_type_ff *)(store->output + (size_t)i * out_size);
+    }
+    if (data->input_codec.enc == FANN_DATA_SPARSE) {
+        /* rows, then the values, then the indexes */
+        struct fann_sparse_row *rows = (struct fann_sparse_row *)store->input;
+        fann_type_ff *value = (fann_type_ff *)(rows + data->num_data);
+        unsigned int *index = (unsigned int *)((unsigned char *)value + value_size);
+
+        for (i = 0; i != data->num_data; i++) {
+            rows[i].index = index;
+            rows[i].value = value;
+        }
+    }
+    return 0;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Append row i to the values of a FANN_DATA_SPARSE store from
+ * fann_create_store, after the values of row i-1.
+ */
+static inline struct fann_sparse_row *fann_sparse_row_next(struct fann_data *data, unsigned int i)
+{
+    struct fann_sparse_row *row = (struct fann_sparse_row *)data->input[i];
+
+    if (i > 0) {
+        const struct fann_sparse_row *prev = (const struct fann_sparse_row *)data->input[i - 1];
+
+        row->index = prev->index + prev->nnz;
+        row->value = prev->value + prev->nnz;
     }
+    return row;
+}
+
+/* number of nonzero inputs of a data set */
+static unsigned int fann_count_nnz(struct fann_data *data)
+{
+    unsigned int i, c, nnz = 0;
 
-    fann_calloc(data_input, (dest->num_input * dest->num_data));
-    if(data_input == NULL)
+    fann_set_ff_bias();
+    for (i = 0; i != data->num_data; i++) {
+        if (data->input_codec.enc == FANN_DATA_SPARSE) {
+            nnz += ((const struct fann_sparse_row *)data->input[i])->nnz;
+            continue;
+        }
+        for (c = 0; c < data->num_input; c++) {
+            nnz += !fann_ff_is_zero(data->input[i][c]);
+        }
+    }
+    return nnz;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Add a reference from dest to every store used by src.
+ */
+static int fann_share_data(struct fann_data *dest, struct fann_data *src)
+{
+    struct fann_data_store **store;
+    unsigned int s, d, num_store = dest->num_store;
+
+    /* all rows of a data set have the same encoding */
+    if (num_store == 0) {
+        if (fann_copy_codec(&dest->input_codec, &src->input_codec, src->num_input) ||
+            fann_copy_codec(&dest->output_codec, &src->output_codec, src->num_output))
+            return -1;
+    } else if (!fann_same_codec(&dest->input_codec, &src->input_codec, src->num_input) ||
+               !fann_same_codec(&dest->output_codec, &src->output_codec, src->num_output)) {
+        fann_error(FANN_E_TRAIN_DATA_MISMATCH);
+        return -1;
+    }
+    fann_calloc(store, dest->num_store + src->num_store);
+    if(store == NULL)
     {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+        return -1;
+    }
+    for(d = 0; d < dest->num_store; d++)
+    {
+        store[d] = dest->store[d];
+    }
+    for(s = 0; s < src->num_store; s++)
+    {
+        for(d = 0; (d < num_store) && (store[d] != src->store[s]); d++);
+        if(d == num_store)
+        {
+            store[num_store++] = src->store[s];
+            src->store[s]->refs++;
+        }
     }
-    fann_memcpy(data_input, data1->input[0], (dest->num_input * data1->num_data));
-    fann_memcpy(data_input + (dest->num_input*data1->num_data), 
-                data2->input[0], (dest->num_input * data2->num_data));
+    fann_free(dest->store);
+    dest->store = store;
+    dest->num_store = num_store;
+    return 0;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Copy the rows of a data set (or view) to a new data set.
+ */
+static struct fann_data *fann_copy_data(struct fann_data *data)
+{
+    struct fann_data *dest;
+    unsigned int i, in_size, out_size;
 
-    fann_calloc(data_output, (dest->num_output * dest->num_data));
-    if(data_output == NULL)
+    if(data == NULL)
+        return NULL;
+    dest = fann_create_data_rows(data->num_data, data->num_input, data->num_output);
+    if(dest == NULL)
+        return NULL;
+    if(fann_copy_codec(&dest->input_codec, &data->input_codec, data->num_input) ||
+       fann_copy_codec(&dest->output_codec, &data->output_codec, data->num_output) ||
+       fann_create_store(dest, (data->input_codec.enc == FANN_DATA_SPARSE) ? fann_count_nnz(data) : 0))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         fann_destroy_data(dest);
         return NULL;
     }
-    fann_memcpy(data_output, data1->output[0], (dest->num_output * data1->num_data));
-    fann_memcpy((data_output + (dest->num_output*data1->num_data)),
-                data2->output[0], (dest->num_output * data2->num_data));
-
+    in_size = data->num_input * fann_data_enc_size(data->input_codec.enc);
+    out_size = data->num_output * fann_data_enc_size(data->output_codec.enc);
     for(i = 0; i != dest->num_data; i++)
     {
-        dest->input[i] = data_input;
-        data_input += dest->num_input;
-        dest->output[i] = data_output;
-        data_output += dest->num_output;
+        if(data->input_codec.enc == FANN_DATA_SPARSE)
+        {
+            const struct fann_sparse_row *src = (const struct fann_sparse_row *)data->input[i];
+            struct fann_sparse_row *row = fann_sparse_row_next(dest, i);
+
+            row->nnz = src->nnz;
+            fann_memcpy(row->index, src->index, src->nnz);
+            fann_memcpy(row->value, src->value, src->nnz);
+        }
+        else
+        {
+            memcpy(dest->input[i], data->input[i], in_size);
+        }
+        memcpy(dest->output[i], data->output[i], out_size);
     }
     return dest;
 }
 
 /*
- * return a copy of a fann_data struct 
+ * view with the given rows of a data set
  */
-FANN_EXTERNAL struct fann_data *FANN_API fann_duplicate_data(struct fann_data
-                                                                         *data)
+FANN_EXTERNAL struct fann_data *FANN_API fann_rows_data_view(struct fann_data *data,
+                                                             const unsigned int *rows,
+                                                             unsigned int num_rows)
 {
-    unsigned int i;
-    fann_type_ff *data_input, *data_output;
     struct fann_data *dest;
+    unsigned int i;
 
-    fann_malloc(dest, 1);
+    dest = fann_create_data_rows(num_rows, data->num_input, data->num_output);
     if(dest == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         return NULL;
+    for(i = 0; i != num_rows; i++)
+    {
+        if(rows[i] >= data->num_data)
+        {
+            fann_error(FANN_E_INDEX_OUT_OF_BOUND, rows[i]);
+            fann_destroy_data(dest);
+            return NULL;
+        }
+        dest->input[i] = data->input[rows[i]];
+        dest->output[i] = data->output[rows[i]];
     }
-
-    dest->num_data = data->num_data;
-    dest->num_input = data->num_input;
-    dest->num_output = data->num_output;
-    fann_calloc(dest->input, dest->num_data);
-    if(dest->input == NULL)
+    if(fann_share_data(dest, data))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         fann_destroy_data(dest);
         return NULL;
     }
+    return dest;
+}
 
-    fann_calloc(dest->output, dest->num_data);
-    if(dest->output == NULL)
+/*
+ * view with both data sets 
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_merge_data_view(struct fann_data *data1,
+                                                              struct fann_data *data2)
+{
+    struct fann_data *dest;
+
+    if((data1->num_input != data2->num_input) || (data1->num_output != data2->num_output))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
+        fann_error(FANN_E_TRAIN_DATA_MISMATCH);
         return NULL;
     }
-
-    fann_calloc(data_input, (dest->num_input * dest->num_data));
-    if(data_input == NULL)
+    dest = fann_create_data_rows(data1->num_data + data2->num_data,
+                                 data1->num_input, data1->num_output);
+    if(dest == NULL)
+        return NULL;
+    fann_memcpy(dest->input, data1->input, data1->num_data);
+    fann_memcpy(dest->input + data1->num_data, data2->input, data2->num_data);
+    fann_memcpy(dest->output, data1->output, data1->num_data);
+    fann_memcpy(dest->output + data1->num_data, data2->output, data2->num_data);
+    if(fann_share_data(dest, data1) || fann_share_data(dest, data2))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         fann_destroy_data(dest);
         return NULL;
     }
-    fann_memcpy(data_input, data->input[0], (dest->num_input * dest->num_data));
+    return dest;
+}
 
-    fann_calloc(data_output, (dest->num_output * dest->num_data));
-    if(data_output == NULL)
+/*
+ * view with a range of rows
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_subset_data_view(struct fann_data *data,
+                                                               unsigned int pos,
+                                                               unsigned int length)
+{
+    struct fann_data *dest;
+
+    if(pos > data->num_data || pos+length > data->num_data)
+    {
+        fann_error(FANN_E_TRAIN_DATA_SUBSET, pos, length, data->num_data);
+        return NULL;
+    }
+    dest = fann_create_data_rows(length, data->num_input, data->num_output);
+    if(dest == NULL)
+        return NULL;
+    fann_memcpy(dest->input, data->input + pos, length);
+    fann_memcpy(dest->output, data->output + pos, length);
+    if(fann_share_data(dest, data))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         fann_destroy_data(dest);
         return NULL;
     }
-    fann_memcpy(data_output, data->output[0], (dest->num_output * dest->num_data));
+    return dest;
+}
 
-    for(i = 0; i != dest->num_data; i++)
+FANN_EXTERNAL struct fann_data *FANN_API fann_duplicate_data_view(struct fann_data *data)
+{
+    return fann_subset_data_view(data, 0, data->num_data);
+}
+
+/*
+ * views for k-fold cross-validation: fold number *fold* is the test set,
+ * the remaining rows are the train set
+ */
+FANN_EXTERNAL int FANN_API fann_fold_data_view(struct fann_data *data, unsigned int num_folds,
+                                               unsigned int fold, struct fann_data **train,
+                                               struct fann_data **test)
+{
+    unsigned int start, stop;
+
+    *train = *test = NULL;
+    if((num_folds == 0) || (fold >= num_folds) || (num_folds > data->num_data))
     {
-        dest->input[i] = data_input;
-        data_input += dest->num_input;
-        dest->output[i] = data_output;
-        data_output += dest->num_output;
+        fann_error(FANN_E_INDEX_OUT_OF_BOUND, fold);
+        return -1;
     }
+    start = (unsigned int)(((uint64_t)data->num_data * fold) / num_folds);
+    stop = (unsigned int)(((uint64_t)data->num_data * (fold + 1)) / num_folds);
+    *test = fann_subset_data_view(data, start, stop - start);
+    *train = fann_create_data_rows(data->num_data - (stop - start),
+                                   data->num_input, data->num_output);
+    if((*test == NULL) || (*train == NULL))
+        goto fold_error;
+    fann_memcpy((*train)->input, data->input, start);
+    fann_memcpy((*train)->input + start, data->input + stop, data->num_data - stop);
+    fann_memcpy((*train)->output, data->output, start);
+    fann_memcpy((*train)->output + start, data->output + stop, data->num_data - stop);
+    if(fann_share_data(*train, data))
+        goto fold_error;
+    return 0;
+
+fold_error:
+    fann_destroy_data(*train);
+    fann_destroy_data(*test);
+    *train = *test = NULL;
+    return -1;
+}
+
+/*
+ * merges training data into a single struct. 
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_merge_data(struct fann_data *data1,
+                                                                     struct fann_data *data2)
+{
+    struct fann_data *view, *dest;
+
+    view = fann_merge_data_view(data1, data2);
+    dest = fann_copy_data(view);
+    fann_destroy_data(view);
     return dest;
 }
 
+/*
+ * return a copy of a fann_data struct 
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_duplicate_data(struct fann_data
+                                                                         *data)
+{
+    return fann_copy_data(data);
+}
+
 /*FANN_EXTERNAL struct fann_data *FANN_API fann_getref_data(struct fann_data *data, unsigned int pos)
 {
     static struct fann_data dataret = {0, 0, 0, NULL, NULL};
@@ -1521,68 +2164,164 @@ FANN_EXTERNAL struct fann_data *FANN_API fann_subset_data(struct fann_data
                                                                          *data, unsigned int pos,
                                                                          unsigned int length)
 {
-    unsigned int i;
-    fann_type_ff *data_input, *data_output;
-    struct fann_data *dest;
+    struct fann_data *view, *dest;
 
-    fann_malloc(dest, 1);
-    if(dest == NULL)
-    {
+    view = fann_subset_data_view(data, pos, length);
+    dest = fann_copy_data(view);
+    fann_destroy_data(view);
+    return dest;
+}
+
+/*
+ * INTERNAL FUNCTION
+ * Per column offset and step of FANN_DATA_U8: exact for integer columns
+ * spanning less than 256 values, 256 levels from min to max otherwise.
+ */
+static int fann_u8_codec(struct fann_data_codec *codec, fann_type_ff **rows,
+                         unsigned int num_data, unsigned int n)
+{
+    float *min, *max, *row, v;
+    unsigned int i, c, *frac;
+
+    fann_free(codec->scale);
+    fann_malloc(codec->scale, 2 * n);
+    fann_calloc(frac, n);
+    fann_malloc(row, n);
+    if ((codec->scale == NULL) || (frac == NULL) || (row == NULL)) {
         fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        return NULL;
+        fann_free(frac);
+        fann_free(row);
+        return -1;
     }
-    
-    if(pos > data->num_data || pos+length > data->num_data)
-    {
-        fann_error(FANN_E_TRAIN_DATA_SUBSET, pos, length, data->num_data);
-        return NULL;
+    min = codec->scale;
+    max = codec->scale + n;
+    fann_set_ff_bias();
+    if (num_data > 0) {
+        fann_ff_to_float_array(min, rows[0], n);
+        fann_memcpy(max, min, n);
+    } else {
+        for (c = 0; c < n; c++) {
+            min[c] = max[c] = 0.0f;
+        }
     }
-
-    dest->num_data = length;
-    dest->num_input = data->num_input;
-    dest->num_output = data->num_output;
-    fann_calloc(dest->input, dest->num_data);
-    if(dest->input == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+    for (i = 0; i < num_data; i++) {
+        fann_ff_to_float_array(row, rows[i], n);
+        for (c = 0; c < n; c++) {
+            v = row[c];
+            if (v < min[c])
+                min[c] = v;
+            if (v > max[c])
+                max[c] = v;
+            frac[c] |= (v != floorf(v));
+        }
     }
+    /* scale holds the offsets (min) followed by the steps */
+    for (c = 0; c < n; c++) {
+        if ((frac[c] == 0) && (max[c] - min[c] <= 255.0f))
+            max[c] = 1.0f;
+        else
+            max[c] = (max[c] - min[c]) / 255.0f;
+        if (max[c] == 0.0f)
+            max[c] = 1.0f;
+    }
+    fann_free(frac);
+    fann_free(row);
+    codec->enc = FANN_DATA_U8;
+    return 0;
+}
 
-    fann_calloc(dest->output, dest->num_data);
-    if(dest->output == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+/*
+ * INTERNAL FUNCTION
+ * Encoding enc of rows, from an existing encoding (only the same
+ * encoding or FANN_DATA_FF).
+ */
+static int fann_set_codec(struct fann_data_codec *codec, const struct fann_data_codec *orig,
+                          enum fann_data_enc_enum enc, fann_type_ff **rows,
+                          unsigned int num_data, unsigned int n)
+{
+    if (enc == orig->enc)
+        return fann_copy_codec(codec, orig, n);
+    if (orig->enc != FANN_DATA_FF) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[orig->enc]);
+        return -1;
     }
+    if (enc == FANN_DATA_U8)
+        return fann_u8_codec(codec, rows, num_data, n);
+    codec->enc = enc;
+    return 0;
+}
 
-    fann_calloc(data_input, (dest->num_input * dest->num_data));
-    if(data_input == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
-    }
-    fann_memcpy(data_input, data->input[pos], (dest->num_input * dest->num_data));
+/*
+ * store the rows of a data set in a compact encoding
+ */
+FANN_EXTERNAL int FANN_API fann_encode_data(struct fann_data *data,
+                                            enum fann_data_enc_enum input_enc,
+                                            enum fann_data_enc_enum output_enc)
+{
+    struct fann_data *enc, tmp;
+    unsigned int i;
 
-    fann_calloc(data_output, (dest->num_output * dest->num_data));
-    if(data_output == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(dest);
-        return NULL;
+    if ((input_enc == data->input_codec.enc) && (output_enc == data->output_codec.enc))
+        return 0;
+    if (output_enc == FANN_DATA_SPARSE) {
+        fann_error(FANN_E_DATA_ENCODED, FANN_DATA_ENC_NAMES[output_enc]);
+        return -1;
     }
-    fann_memcpy(data_output, data->output[pos], (dest->num_output * dest->num_data));
-
-    for(i = 0; i != dest->num_data; i++)
-    {
-        dest->input[i] = data_input;
-        data_input += dest->num_input;
-        dest->output[i] = data_output;
-        data_output += dest->num_output;
+    enc = fann_create_data_rows(data->num_data, data->num_input, data->num_output);
+    if (enc == NULL)
+        return -1;
+    if (fann_set_codec(&enc->input_codec, &data->input_codec, input_enc,
+                       data->input, data->num_data, data->num_input) ||
+        fann_set_codec(&enc->output_codec, &data->output_codec, output_enc,
+                       data->output, data->num_data, data->num_output) ||
+        fann_create_store(enc, (input_enc == FANN_DATA_SPARSE) ? fann_count_nnz(data) : 0)) {
+        fann_destroy_data(enc);
+        return -1;
     }
-    return dest;
+    for (i = 0; i != data->num_data; i++) {
+        if (input_enc == FANN_DATA_SPARSE) {
+            struct fann_sparse_row *row = fann_sparse_row_next(enc, i);
+
+            if (data->input_codec.enc == FANN_DATA_SPARSE) {
+                const struct fann_sparse_row *src = (const struct fann_sparse_row *)data->input[i];
+
+                row->nnz = src->nnz;
+                fann_memcpy(row->index, src->index, src->nnz);
+                fann_memcpy(row->value, src->value, src->nnz);
+            } else {
+                fann_encode_row(&enc->input_codec, data->input[i], data->num_input, row);
+            }
+        } else if (input_enc == data->input_codec.enc)
+            memcpy(enc->input[i], data->input[i],
+                   data->num_input * fann_data_enc_size(input_enc));
+        else
+            fann_encode_row(&enc->input_codec, data->input[i], data->num_input, enc->input[i]);
+        if (output_enc == data->output_codec.enc)
+            memcpy(enc->output[i], data->output[i],
+                   data->num_output * fann_data_enc_size(output_enc));
+        else
+            fann_encode_row(&enc->output_codec, data->output[i], data->num_output, enc->output[i]);
+    }
+    /* swap the contents, the rows keep their positions (and order) */
+    tmp = *data;
+    *data = *enc;
+    *enc = tmp;
+    data->order = enc->order;
+    enc->order = NULL;
+    fann_destroy_data(enc);
+    return 0;
+}
+
+FANN_EXTERNAL fann_type_ff *FANN_API fann_expand_data_input(struct fann_data *data,
+                                                            unsigned int pos, fann_type_ff *buf)
+{
+    return fann_expand_row(&data->input_codec, data->input[pos], data->num_input, buf);
+}
+
+FANN_EXTERNAL fann_type_ff *FANN_API fann_expand_data_output(struct fann_data *data,
+                                                             unsigned int pos, fann_type_ff *buf)
+{
+    return fann_expand_row(&data->output_codec, data->output[pos], data->num_output, buf);
 }
 
 FANN_EXTERNAL unsigned int FANN_API fann_length_data(struct fann_data *data)
@@ -1607,8 +2346,8 @@ FANN_EXTERNAL unsigned int FANN_API fann_num_output_data(struct fann_data *data)
  */
 int fann_save_data_internal(struct fann_data *data, const char *filename)
 {
-    int retval = 0;
-    FILE *file = fopen(filename, "w");
+    int retval = 0, piped;
+    FILE *file = fann_open_data_file(filename, "w", &piped);
 
     if(!file)
     {
@@ -1616,7 +2355,11 @@ int fann_save_data_internal(struct fann_data *data, const char *filename)
         return -1;
     }
     retval = fann_save_data_internal_fd(data, file);//, filename);
-    fclose(file);
+    if (fann_close_data_file(file, piped) && (retval == 0))
+    {
+        fann_error(FANN_E_CANT_OPEN_TD_W, filename);
+        retval = -1;
+    }
     
     return retval;
 }
@@ -1636,41 +2379,56 @@ int fann_save_data_internal_fd(struct fann_data *data, FILE * file)//, const cha
     unsigned int num_input = data->num_input;
     unsigned int num_output = data->num_output;
     unsigned int i, j;
+    fann_type_ff *buf;
+    float *input, *output;
     int retval = 0;
 
+    fann_malloc(buf, num_input + num_output);
+    fann_malloc(input, num_input + num_output);
+    if((buf == NULL) || (input == NULL))
+    {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_free(buf);
+        fann_free(input);
+        return -1;
+    }
+    output = input + num_input;
     fprintf(file, "%u %u %u\n", data->num_data, data->num_input, data->num_output);
-    fann_set_ff_bias();
 
     for(i = 0; i < num_data; i++)
     {
+        fann_ff_to_float_array(input, fann_expand_data_input(data, i, buf), num_input);
+        fann_ff_to_float_array(output, fann_expand_data_output(data, i, buf + num_input), num_output);
         for(j = 0; j < num_input; j++)
         {
-            if(((int) floor(fann_ff_to_float(data->input[i][j]) + 0.5) * 1000000) ==
-               ((int) floor(fann_ff_to_float(data->input[i][j]) * 1000000.0 + 0.5)))
+            if(((int) floor(input[j] + 0.5) * 1000000) ==
+               ((int) floor(input[j] * 1000000.0 + 0.5)))
             {
-                fprintf(file, "%d ", (int) fann_ff_to_float(data->input[i][j]));
+                fprintf(file, "%d ", (int) input[j]);
             }
             else
             {
-                fprintf(file, "%.16f ", fann_ff_to_float(data->input[i][j]));
+                fprintf(file, "%.16f ", input[j]);
             }
         }
         fprintf(file, "\n");
 
         for(j = 0; j < num_output; j++)
         {
-            if(((int) floor(fann_ff_to_float(data->output[i][j]) + 0.5) * 1000000) ==
-               ((int) floor(fann_ff_to_float(data->output[i][j]) * 1000000.0 + 0.5)))
+            if(((int) floor(output[j] + 0.5) * 1000000) ==
+               ((int) floor(output[j] * 1000000.0 + 0.5)))
             {
-                fprintf(file, "%d ", (int) fann_ff_to_float(data->output[i][j]));
+                fprintf(file, "%d ", (int) output[j]);
             }
             else
             {
-                fprintf(file, "%.16f ", fann_ff_to_float(data->output[i][j]));
+                fprintf(file, "%.16f ", output[j]);
             }
         }
         fprintf(file, "\n");
     }
+    fann_free(buf);
+    fann_free(input);
     
     return retval;
 }
@@ -1682,60 +2440,16 @@ int fann_save_data_internal_fd(struct fann_data *data, FILE * file)//, const cha
 #ifndef FANN_INFERENCE_ONLY
 FANN_EXTERNAL struct fann_data * FANN_API fann_create_data(unsigned int num_data, unsigned int num_input, unsigned int num_output)
 {
-    fann_type_ff *data_input, *data_output;
-    unsigned int i;
     struct fann_data *data;
 
-    fann_malloc(data, 1);
+    data = fann_create_data_rows(num_data, num_input, num_output);
     if(data == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        return NULL;
-    }
-    
-    data->num_data = num_data;
-    data->num_input = num_input;
-    data->num_output = num_output;
-
-    fann_calloc(data->input, num_data);
-    if(data->input == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(data);
-        return NULL;
-    }
-
-    fann_calloc(data->output, num_data);
-    if(data->output == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(data);
         return NULL;
-    }
-
-    fann_calloc(data_input, (num_input * num_data));
-    if(data_input == NULL)
+    if(fann_create_store(data, 0))
     {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
         fann_destroy_data(data);
         return NULL;
     }
-
-    fann_calloc(data_output, (num_output * num_data));
-    if(data_output == NULL)
-    {
-        fann_error(FANN_E_CANT_ALLOCATE_MEM);
-        fann_destroy_data(data);
-        return NULL;
-    }
-
-    for(i = 0; i != num_data; i++)
-    {
-        data->input[i] = data_input;
-        data_input += num_input;
-        data->output[i] = data_output;
-        data_output += num_output;
-    }
     return data;
 }
 
@@ -1806,6 +2520,183 @@ FANN_EXTERNAL fann_type_ff * FANN_API fann_get_data_output(struct fann_data * da
 }
 
 
+/*
+ * Reads a libsvm data set, with sparse inputs.
+ * The file is read twice: to size the store, then to fill it.
+ */
+FANN_EXTERNAL struct fann_data *FANN_API fann_read_libsvm_data(const char *filename,
+                                                               unsigned int num_input,
+                                                               unsigned int num_output)
+{
+    FILE *file;
+    char *buf = NULL, *pos, *end;
+    size_t len = 0;
+    unsigned int pass, line = 0, i, j, nnz = 0, max_index = 0, index, last, cls;
+    float label, value;
+    int signed_labels = 0;
+    fann_type_ff one, zero;
+    struct fann_data *data = NULL;
+    struct fann_sparse_row *row = NULL;
+
+    file = fopen(filename, "r");
+    if(file == NULL)
+    {
+        fann_error(FANN_E_CANT_OPEN_TD_R, filename);
+        return NULL;
+    }
+    fann_set_ff_bias();
+    one = fann_float_to_ff(1.0f);
+    zero = fann_float_to_ff(0.0f);
+    for(pass = 0; pass < 2; pass++)
+    {
+        rewind(file);
+        for(i = line = 0; getline(&buf, &len, file) != -1; i++)
+        {
+            line++;
+            label = strtof(buf, &pos);
+            if(pos == buf)
+            {
+                if(buf[strspn(buf, " \t\r\n")] != '\0')
+                    goto read_error;
+                i--; // empty line
+                continue;
+            }
+            if(pass == 0)
+            {
+                // -1 (or 0) and +1 labels of two classes
+                if(label <= 0.0f)
+                    signed_labels = 1;
+            }
+            else
+            {
+                row = fann_sparse_row_next(data, i);
+                if(num_output == 1)
+                {
+                    data->output[i][0] = fann_float_to_ff(label);
+                }
+                else
+                {
+                    if((num_output == 2) && signed_labels)
+                    {
+                        if((label != -1.0f) && (label != 0.0f) && (label != 1.0f))
+                            goto read_error;
+                        label = (label > 0.0f) ? 2.0f : 1.0f;
+                    }
+                    // checked before the cast, negative floats do not convert
+                    if((label < 1.0f) || (label > (float)num_output))
+                        goto read_error;
+                    cls = (unsigned int)label;
+                    if(label != (float)cls)
+                        goto read_error;
+                    for(j = 0; j < num_output; j++)
+                        data->output[i][j] = (j == cls - 1) ? one : zero;
+                }
+            }
+            for(last = 0;; last = index)
+            {
+                index = (unsigned int)strtoul(pos, &end, 10);
+                if(end == pos)
+                    break;
+                if((*end != ':') || (index <= last))
+                    goto read_error;
+                pos = end + 1;
+                value = strtof(pos, &end);
+                if(end == pos)
+                    goto read_error;
+                pos = end;
+                if(pass == 0)
+                {
+                    nnz++;
+                    if(max_index < index)
+                        max_index = index;
+                }
+                else if(value != 0.0f)
+                {
+                    row->index[row->nnz] = index - 1;
+                    row->value[row->nnz++] = fann_float_to_ff(value);
+                }
+            }
+            if(pos[strspn(pos, " \t\r\n")] != '\0')
+                goto read_error;
+        }
+        if(pass == 0)
+        {
+            if(num_input == 0)
+            {
+                num_input = max_index;
+            }
+            else if(max_index > num_input)
+            {
+                fann_error(FANN_E_INDEX_OUT_OF_BOUND, max_index);
+                goto libsvm_error;
+            }
+            data = fann_create_data_rows(i, num_input, num_output);
+            if(data == NULL)
+                goto libsvm_error;
+            data->input_codec.enc = FANN_DATA_SPARSE;
+            if(fann_create_store(data, nnz))
+                goto libsvm_error;
+        }
+    }
+    free(buf);
+    fclose(file);
+    return data;
+
+read_error:
+    fann_error(FANN_E_CANT_READ_TD, filename, line);
+libsvm_error:
+    free(buf);
+    fclose(file);
+    fann_destroy_data(data);
+    return NULL;
+}
+
+/* INTERNAL FUNCTION
+   Reads a data set in FANN_FORMAT_BINARY, after its magic.
+ */
+static struct fann_data *fann_read_binary_data(FILE * file, const char *filename)
+{
+    uint32_t head[3];
+    unsigned int i, n;
+    struct fann_data *data;
+    float *row;
+
+    if(fread(head, sizeof(uint32_t), 3, file) != 3)
+    {
+        fann_error(FANN_E_CANT_READ_TD, filename, 1);
+        return NULL;
+    }
+    data = fann_create_data(head[0], head[1], head[2]);
+    if(data == NULL)
+    {
+        return NULL;
+    }
+    n = head[1] + head[2];
+    fann_malloc(row, n);
+    if(row == NULL)
+    {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_destroy_data(data);
+        return NULL;
+    }
+    fann_set_ff_bias();
+    for(i = 0; i != head[0]; i++)
+    {
+        if(fread(row, sizeof(float), n, file) != n)
+        {
+            // rows numbered as the lines of the text format
+            fann_error(FANN_E_CANT_READ_TD, filename, 2 * i + 2);
+            fann_free(row);
+            fann_destroy_data(data);
+            return NULL;
+        }
+        fann_float_to_ff_array(data->input[i], row, head[1]);
+        fann_float_to_ff_array(data->output[i], row + head[1], head[2]);
+    }
+    fann_free(row);
+    return data;
+}
+
 /*
  * INTERNAL FUNCTION Reads training data from a file descriptor. 
  */
@@ -1814,6 +2705,26 @@ struct fann_data *fann_read_data_from_fd(FILE * file, const char *filename)
     unsigned int num_input, num_output, num_data, i, j;
     unsigned int line = 1;
     struct fann_data *data;
+    DATATYPE *row;
+    char magic[sizeof(FANN_DATA_MAGIC) - 1];
+    int c;
+
+    c = getc(file);
+    if(c == FANN_DATA_MAGIC[0])
+    {
+        magic[0] = (char)c;
+        if((fread(magic + 1, 1, sizeof(magic) - 1, file) != sizeof(magic) - 1) ||
+           (memcmp(magic, FANN_DATA_MAGIC, sizeof(magic)) != 0))
+        {
+            fann_error(FANN_E_CANT_READ_TD, filename, line);
+            return NULL;
+        }
+        return fann_read_binary_data(file, filename);
+    }
+    if(c != EOF)
+    {
+        ungetc(c, file);
+    }
 
     if(fscanf(file, "%u %u %u\n", &num_data, &num_input, &num_output) != 3)
     {
@@ -1828,43 +2739,48 @@ struct fann_data *fann_read_data_from_fd(FILE * file, const char *filename)
         return NULL;
     }
 
+    fann_malloc(row, (num_input > num_output) ? num_input : num_output);
+    if(row == NULL)
+    {
+        fann_error(FANN_E_CANT_ALLOCATE_MEM);
+        fann_destroy_data(data);
+        return NULL;
+    }
 #if (defined SWF16_AP) || (defined HWF16)
     FP_BIAS = FP_BIAS_DEFAULT;
 #endif
 
     for(i = 0; i != num_data; i++)
     {
-        DATATYPE tmpf;
-
         for(j = 0; j != num_input; j++)
         {
-            if(fscanf(file, DATASCANF " ", &tmpf) != 1)
+            if(fscanf(file, DATASCANF " ", &row[j]) != 1)
             {
                 fann_error(FANN_E_CANT_READ_TD, filename, line);
-                fann_destroy_data(data);
-                return NULL;
+                goto read_error;
             }
-            //fprintf(stderr, "%u %u " DATAPRINTF " ", i, j, tmpf); 
-            data->input[i][j] = fann_float_to_ff(tmpf);
         }
-        //fprintf(stderr, "l=%u\n", line);
+        fann_float_to_ff_array(data->input[i], row, num_input);
         line++;
 
         for(j = 0; j != num_output; j++)
         {
-            if(fscanf(file, DATASCANF " ", &tmpf) != 1)
+            if(fscanf(file, DATASCANF " ", &row[j]) != 1)
             {
                 fann_error(FANN_E_CANT_READ_TD, filename, line);
-                fann_destroy_data(data);
-                return NULL;
+                goto read_error;
             }
-            data->output[i][j] = fann_float_to_ff(tmpf);
-            //fprintf(stderr, "%u %u " DATAPRINTF " ", i, j, tmpf); 
         }
-        //fprintf(stderr, "l=%u\n", line);
+        fann_float_to_ff_array(data->output[i], row, num_output);
         line++;
     }
+    fann_free(row);
     return data;
+
+read_error:
+    fann_free(row);
+    fann_destroy_data(data);
+    return NULL;
 }
 #endif // FANN_INFERENCE_ONLY
 
@@ -1896,31 +2812,54 @@ int fann_desired_error_reached(struct fann *ann, float desired_error)
 
 #endif // FANN_INFERENCE_ONLY
 
+#ifndef FANN_INFERENCE_ONLY
+#ifdef FANN_DATA_SCALE
+/* INTERNAL FUNCTION
+   Scales (or descales) the n values of vector with the parameters of their
+   neurons, converting them in FANN_CONV_CHUNK blocks. The results are
+   converted one by one from the precision of the expression (-1.0 is a
+   double), so the fixed point back-end truncates them as before.
+ */
+static void fann_scale_vector(fann_type_ff *vector, unsigned int n, const fann_type_nt *mean,
+                              const fann_type_nt *deviation, const fann_type_nt *new_min,
+                              const fann_type_nt *factor, int descale)
+{
+    fann_type_nt tmp[FANN_CONV_CHUNK];
+    unsigned int i, j, k;
+
+    for (i = 0; i < n; i += k) {
+        k = ((n - i) < FANN_CONV_CHUNK) ? (n - i) : FANN_CONV_CHUNK;
+        fann_ff_to_nt_array(tmp, vector + i, k);
+        if (descale) {
+            for (j = 0; j < k; j++)
+                vector[i + j] = fann_nt_to_ff(fann_nt_add(fann_nt_mul(
+                    fann_nt_add(fann_nt_div(fann_nt_sub(tmp[j], new_min[i + j]), factor[i + j]),
+                                fann_float_to_nt(-1.0)) /* This is old_min */,
+                    deviation[i + j]), mean[i + j]));
+        } else {
+            for (j = 0; j < k; j++)
+                vector[i + j] = fann_nt_to_ff(fann_nt_add(fann_nt_mul(
+                    fann_nt_sub(fann_nt_div(fann_nt_sub(tmp[j], mean[i + j]), deviation[i + j]),
+                                fann_float_to_nt(-1.0)) /* This is old_min */,
+                    factor[i + j]), new_min[i + j]));
+        }
+    }
+}
+
 /*
  * Scale data in input vector before feed it to ann based on previously calculated parameters.
  */
-#ifndef FANN_INFERENCE_ONLY
-#ifdef FANN_DATA_SCALE
 FANN_EXTERNAL void FANN_API fann_scale_input( struct fann *ann, fann_type_ff *input_vector )
 {
-    unsigned cur_neuron;
     if(ann->scale_mean_in == NULL)
     {
         fann_error( FANN_E_SCALE_NOT_PRESENT );
         return;
     }
-    
+
     fann_set_ff_bias();
-    for( cur_neuron = 0; cur_neuron < ann->num_input; cur_neuron++ )
-        input_vector[ cur_neuron ] = fann_nt_to_ff(
-            fann_nt_add(fann_nt_mul(
-            (fann_nt_sub(
-                fann_nt_div(( fann_nt_sub(fann_ff_to_nt(input_vector[ cur_neuron ]), ann->scale_mean_in[ cur_neuron ]) ),
-                            ann->scale_deviation_in[ cur_neuron ]), 
-                fann_float_to_nt(-1.0 ))) /* This is old_min */,
-            ann->scale_factor_in[ cur_neuron ]), 
-            ann->scale_new_min_in[ cur_neuron ])
-            );
+    fann_scale_vector(input_vector, ann->num_input, ann->scale_mean_in, ann->scale_deviation_in,
+                      ann->scale_new_min_in, ann->scale_factor_in, 0);
 }
 
 /*
@@ -1928,7 +2867,6 @@ FANN_EXTERNAL void FANN_API fann_scale_input( struct fann *ann, fann_type_ff *in
  */
 FANN_EXTERNAL void FANN_API fann_scale_output( struct fann *ann, fann_type_ff *output_vector )
 {
-    unsigned cur_neuron;
     if(ann->scale_mean_in == NULL)
     {
         fann_error( FANN_E_SCALE_NOT_PRESENT );
@@ -1936,16 +2874,8 @@ FANN_EXTERNAL void FANN_API fann_scale_output( struct fann *ann, fann_type_ff *o
     }
 
     fann_set_ff_bias();
-    for( cur_neuron = 0; cur_neuron < ann->num_output; cur_neuron++ )
-        output_vector[ cur_neuron ] = fann_nt_to_ff(
-            fann_nt_add(fann_nt_mul(
-            fann_nt_sub(
-                fann_nt_div(( fann_nt_sub(fann_ff_to_nt(output_vector[ cur_neuron ]), ann->scale_mean_out[ cur_neuron ]) ),
-                ann->scale_deviation_out[ cur_neuron ]),
-                ( fann_float_to_nt(-1.0) ) /* This is old_min */),
-            ann->scale_factor_out[ cur_neuron ]),
-            ann->scale_new_min_out[ cur_neuron ]
-            ));
+    fann_scale_vector(output_vector, ann->num_output, ann->scale_mean_out, ann->scale_deviation_out,
+                      ann->scale_new_min_out, ann->scale_factor_out, 0);
 }
 
 /*
@@ -1953,7 +2883,6 @@ FANN_EXTERNAL void FANN_API fann_scale_output( struct fann *ann, fann_type_ff *o
  */
 FANN_EXTERNAL void FANN_API fann_descale_input( struct fann *ann, fann_type_ff *input_vector )
 {
-    unsigned cur_neuron;
     if(ann->scale_mean_in == NULL)
     {
         fann_error( FANN_E_SCALE_NOT_PRESENT );
@@ -1961,17 +2890,8 @@ FANN_EXTERNAL void FANN_API fann_descale_input( struct fann *ann, fann_type_ff *
     }
 
     fann_set_ff_bias();
-    for( cur_neuron = 0; cur_neuron < ann->num_input; cur_neuron++ )
-        input_vector[ cur_neuron ] = fann_nt_to_ff(
-            fann_nt_add(fann_nt_mul(
-                fann_nt_add(fann_nt_div(
-                    fann_nt_sub(fann_ff_to_nt(input_vector[ cur_neuron ]),
-                    ann->scale_new_min_in[ cur_neuron ]),
-                ann->scale_factor_in[ cur_neuron ]),
-                fann_float_to_nt(-1.0)) /* This is old_min */,
-            ann->scale_deviation_in[ cur_neuron ]),
-            ann->scale_mean_in[ cur_neuron ])
-            );
+    fann_scale_vector(input_vector, ann->num_input, ann->scale_mean_in, ann->scale_deviation_in,
+                      ann->scale_new_min_in, ann->scale_factor_in, 1);
 }
 
 /*
@@ -1979,7 +2899,6 @@ FANN_EXTERNAL void FANN_API fann_descale_input( struct fann *ann, fann_type_ff *
  */
 FANN_EXTERNAL void FANN_API fann_descale_output( struct fann *ann, fann_type_ff *output_vector )
 {
-    unsigned cur_neuron;
     if(ann->scale_mean_in == NULL)
     {
         fann_error( FANN_E_SCALE_NOT_PRESENT );
@@ -1987,17 +2906,8 @@ FANN_EXTERNAL void FANN_API fann_descale_output( struct fann *ann, fann_type_ff
     }
 
     fann_set_ff_bias();
-    for( cur_neuron = 0; cur_neuron < ann->num_output; cur_neuron++ )
-        output_vector[ cur_neuron ] = fann_nt_to_ff(
-            fann_nt_add(fann_nt_mul(
-                fann_nt_add(fann_nt_div(
-                    fann_nt_sub(fann_ff_to_nt(output_vector[ cur_neuron ]),
-                    ann->scale_new_min_out[ cur_neuron ]),
-                ann->scale_factor_out[ cur_neuron ]),
-                fann_float_to_nt(-1.0) /* This is old_min */),
-            ann->scale_deviation_out[ cur_neuron ]),
-            ann->scale_mean_out[ cur_neuron ])
-            );
+    fann_scale_vector(output_vector, ann->num_output, ann->scale_mean_out, ann->scale_deviation_out,
+                      ann->scale_new_min_out, ann->scale_factor_out, 1);
 }
 
 /*
@@ -0,0 +1,303 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Front end of libfann_typed: dispatch to the back-end vtables */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <strings.h>
+
+#include "fann_typed.h"
+
+// defined by typed-<name>.o, see lib/Makefile
+extern const struct fann_typed_ops fann_typed_double;
+extern const struct fann_typed_ops fann_typed_float;
+extern const struct fann_typed_ops fann_typed_fixed;
+extern const struct fann_typed_ops fann_typed_float_union;
+extern const struct fann_typed_ops fann_typed_bf16;
+extern const struct fann_typed_ops fann_typed_f16_ff;
+extern const struct fann_typed_ops fann_typed_f16;
+extern const struct fann_typed_ops fann_typed_swf16_ap;
+extern const struct fann_typed_ops fann_typed_swf16_ieee;
+extern const struct fann_typed_ops fann_typed_hwf16;
+extern const struct fann_typed_ops fann_typed_posit16;
+extern const struct fann_typed_ops fann_typed_fp8_e4m3;
+extern const struct fann_typed_ops fann_typed_fp8_e5m2;
+extern const struct fann_typed_ops fann_typed_posit8;
+
+static const struct fann_typed_ops * const fann_typed_table[FANN_TYPE_COUNT] = {
+    &fann_typed_double,
+    &fann_typed_float,
+    &fann_typed_fixed,
+    &fann_typed_float_union,
+    &fann_typed_bf16,
+    &fann_typed_f16_ff,
+    &fann_typed_f16,
+    &fann_typed_swf16_ap,
+    &fann_typed_swf16_ieee,
+    &fann_typed_hwf16,
+    &fann_typed_posit16,
+    &fann_typed_fp8_e4m3,
+    &fann_typed_fp8_e5m2,
+    &fann_typed_posit8,
+};
+
+const char * const FANN_NUMERIC_TYPE_NAMES[FANN_TYPE_COUNT] = {
+    "double",
+    "float",
+    "fixed",
+    "float_union",
+    "bf16",
+    "f16_ff",
+    "f16",
+    "swf16_ap",
+    "swf16_ieee",
+    "hwf16",
+    "posit16",
+    "fp8_e4m3",
+    "fp8_e5m2",
+    "posit8",
+};
+
+FANN_EXTERNAL const struct fann_typed_ops *FANN_API fann_typed_get_ops(enum fann_numeric_type type)
+{
+    if ((unsigned int)type >= FANN_TYPE_COUNT) {
+        fprintf(stderr, "Unknown numeric type %d.\n", (int)type);
+        return NULL;
+    }
+    return fann_typed_table[type];
+}
+
+FANN_EXTERNAL int FANN_API fann_typed_parse(const char *name)
+{
+    int i;
+
+    for (i = 0; i < FANN_TYPE_COUNT; i++) {
+        if (strcasecmp(name, FANN_NUMERIC_TYPE_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+FANN_EXTERNAL void FANN_API fann_typed_enable_seed_fixed(unsigned int seed)
+{
+    int i;
+
+    for (i = 0; i < FANN_TYPE_COUNT; i++) {
+        fann_typed_table[i]->enable_seed_fixed(seed);
+    }
+}
+
+/* INTERNAL FUNCTION
+   Wrap a network of the back-end ops, NULL (after destroying it) on failure.
+ */
+static struct fann_typed *fann_typed_wrap(enum fann_numeric_type type,
+                                          const struct fann_typed_ops *ops, void *net)
+{
+    struct fann_typed *ann;
+
+    if (net == NULL) {
+        return NULL;
+    }
+    ann = (struct fann_typed *)calloc(1, sizeof(struct fann_typed));
+    if (ann != NULL) {
+        ann->ops = ops;
+        ann->type = type;
+        ann->ann = net;
+        ann->ff = malloc(ops->ff_size * ops->get_num_input(net));
+        ann->output = (float *)malloc(sizeof(float) * ops->get_num_output(net));
+    }
+    if ((ann == NULL) || (ann->ff == NULL) || (ann->output == NULL)) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        if (ann != NULL) {
+            free(ann->ff);
+            free(ann->output);
+            free(ann);
+        }
+        ops->destroy(net);
+        return NULL;
+    }
+    return ann;
+}
+
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed_vector(enum fann_numeric_type type,
+                                                                  unsigned int extra_threads,
+                                                                  unsigned int num_layers,
+                                                                  const unsigned int *layers)
+{
+    const struct fann_typed_ops *ops = fann_typed_get_ops(type);
+
+    if (ops == NULL) {
+        return NULL;
+    }
+    return fann_typed_wrap(type, ops, ops->create(extra_threads, num_layers, layers));
+}
+
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed(enum fann_numeric_type type,
+                                                           unsigned int num_layers, ...)
+{
+    struct fann_typed *ann;
+    unsigned int *layers, i;
+    va_list layer_sizes;
+
+    layers = (unsigned int *)calloc(num_layers, sizeof(unsigned int));
+    if (layers == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return NULL;
+    }
+    va_start(layer_sizes, num_layers);
+    for (i = 0; i < num_layers; i++) {
+        layers[i] = va_arg(layer_sizes, unsigned int);
+    }
+    va_end(layer_sizes);
+    ann = fann_create_typed_vector(type, 0, num_layers, layers);
+    free(layers);
+    return ann;
+}
+
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed_from_file(enum fann_numeric_type type,
+                                                                     const char *file)
+{
+    const struct fann_typed_ops *ops = fann_typed_get_ops(type);
+
+    if (ops == NULL) {
+        return NULL;
+    }
+    return fann_typed_wrap(type, ops, ops->create_from_file(file));
+}
+
+FANN_EXTERNAL void FANN_API fann_typed_destroy(struct fann_typed *ann)
+{
+    if (ann == NULL) {
+        return;
+    }
+    ann->ops->destroy(ann->ann);
+    free(ann->ff);
+    free(ann->output);
+    free(ann);
+}
+
+FANN_EXTERNAL int FANN_API fann_typed_save(struct fann_typed *ann, const char *file)
+{
+    return ann->ops->save(ann->ann, file);
+}
+
+FANN_EXTERNAL float *FANN_API fann_typed_run(struct fann_typed *ann, const float *input)
+{
+    ann->ops->run(ann->ann, ann->ff, input, ann->output);
+    return ann->output;
+}
+
+FANN_EXTERNAL struct fann_typed_data *FANN_API fann_typed_read_data(enum fann_numeric_type type,
+                                                                   const char *file)
+{
+    const struct fann_typed_ops *ops = fann_typed_get_ops(type);
+    struct fann_typed_data *data;
+    void *raw;
+
+    if ((ops == NULL) || ((raw = ops->read_data(file)) == NULL)) {
+        return NULL;
+    }
+    data = (struct fann_typed_data *)malloc(sizeof(struct fann_typed_data));
+    if (data == NULL) {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        ops->destroy_data(raw);
+        return NULL;
+    }
+    data->ops = ops;
+    data->type = type;
+    data->data = raw;
+    return data;
+}
+
+FANN_EXTERNAL void FANN_API fann_typed_destroy_data(struct fann_typed_data *data)
+{
+    if (data == NULL) {
+        return;
+    }
+    data->ops->destroy_data(data->data);
+    free(data);
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_length_data(struct fann_typed_data *data)
+{
+    return data->ops->length_data(data->data);
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_num_input_data(struct fann_typed_data *data)
+{
+    return data->ops->num_input_data(data->data);
+}
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_num_output_data(struct fann_typed_data *data)
+{
+    return data->ops->num_output_data(data->data);
+}
+
+/* INTERNAL FUNCTION
+   Data read by another back-end has another layout.
+ */
+static int fann_typed_check_data(struct fann_typed *ann, struct fann_typed_data *data)
+{
+    if (data->ops != ann->ops) {
+        fprintf(stderr, "Data of type %s used with a network of type %s.\n",
+                FANN_NUMERIC_TYPE_NAMES[data->type], FANN_NUMERIC_TYPE_NAMES[ann->type]);
+        return -1;
+    }
+    return 0;
+}
+
+FANN_EXTERNAL int FANN_API fann_typed_train_on_data(struct fann_typed *ann,
+                                                    struct fann_typed_data *data,
+                                                    unsigned int max_epochs,
+                                                    unsigned int epochs_between_reports,
+                                                    float desired_error)
+{
+    if (fann_typed_check_data(ann, data)) {
+        return -1;
+    }
+    ann->ops->train_on_data(ann->ann, data->data, max_epochs, epochs_between_reports, desired_error);
+    return 0;
+}
+
+FANN_EXTERNAL float FANN_API fann_typed_train_epoch(struct fann_typed *ann,
+                                                    struct fann_typed_data *data)
+{
+    if (fann_typed_check_data(ann, data)) {
+        return -1;
+    }
+    return ann->ops->train_epoch(ann->ann, data->data);
+}
+
+FANN_EXTERNAL float FANN_API fann_typed_test_data(struct fann_typed *ann,
+                                                  struct fann_typed_data *data)
+{
+    if (fann_typed_check_data(ann, data)) {
+        return -1;
+    }
+    return ann->ops->test_data(ann->ann, data->data);
+}
+
+FANN_EXTERNAL float FANN_API fann_typed_get_loss(struct fann_typed *ann)
+{
+    return ann->ops->get_loss(ann->ann);
+}
@@ -0,0 +1,256 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+#ifndef __fann_typed_h__
+#define __fann_typed_h__
+
+/* Numeric back-end selected at runtime.
+ *
+ * libfann_typed (lib/Makefile) holds every back-end, each one compiled
+ * from the same sources as its own object with all symbols but its
+ * vtable (fann_typed_<name>) made local. Networks and data sets of
+ * different types live side by side in one process, each handle carrying
+ * the vtable of its back-end. Values cross this interface as float.
+ *
+ * Do not include together with floatfann.h, softfann.h and the others:
+ * this header depends on none of the fann_type_* definitions.
+ */
+
+#include <stddef.h>
+
+#ifndef FANN_EXTERNAL
+#define FANN_EXTERNAL
+#define FANN_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Enum: fann_numeric_type
+
+   FANN_TYPE_DOUBLE      - doublefann
+   FANN_TYPE_FLOAT       - floatfann
+   FANN_TYPE_FIXED       - fixedfann
+   FANN_TYPE_FLOAT_UNION - floatfann with _FLOAT_UNION
+   FANN_TYPE_BF16        - floatfann with _BFLOAT16
+   FANN_TYPE_F16_FF      - floatfann with _GCC_ARM_F16_FF (F16C on x86)
+   FANN_TYPE_F16         - floatfann with _GCC_ARM_F16_BP (F16C on x86)
+   FANN_TYPE_SWF16_AP    - softfann with SWF16_AP
+   FANN_TYPE_SWF16_IEEE  - softfann with SWF16_IEEE
+   FANN_TYPE_HWF16       - softfann with HWF16
+   FANN_TYPE_POSIT16     - softfann with POSIT16
+   FANN_TYPE_FP8_E4M3    - softfann with SWF8_E4M3
+   FANN_TYPE_FP8_E5M2    - softfann with SWF8_E5M2
+   FANN_TYPE_POSIT8      - softfann with POSIT8
+ */
+enum fann_numeric_type
+{
+    FANN_TYPE_DOUBLE = 0,
+    FANN_TYPE_FLOAT,
+    FANN_TYPE_FIXED,
+    FANN_TYPE_FLOAT_UNION,
+    FANN_TYPE_BF16,
+    FANN_TYPE_F16_FF,
+    FANN_TYPE_F16,
+    FANN_TYPE_SWF16_AP,
+    FANN_TYPE_SWF16_IEEE,
+    FANN_TYPE_HWF16,
+    FANN_TYPE_POSIT16,
+    FANN_TYPE_FP8_E4M3,
+    FANN_TYPE_FP8_E5M2,
+    FANN_TYPE_POSIT8,
+    FANN_TYPE_COUNT
+};
+
+/* names of the types, as accepted by <fann_typed_parse> */
+extern const char * const FANN_NUMERIC_TYPE_NAMES[FANN_TYPE_COUNT];
+
+/* Struct: fann_typed_ops
+
+   Entry points of one back-end. *ann* and *data* are the back-end's
+   struct fann and struct fann_data, the enums are passed as int.
+ */
+struct fann_typed_ops
+{
+    const char *(*get_name)(void);  // fann_float_type of the back-end
+    size_t ff_size;                 // sizeof(fann_type_ff)
+
+    void *(*create)(unsigned int extra_threads, unsigned int num_layers, const unsigned int *layers);
+    void *(*create_from_file)(const char *file);
+    int (*save)(void *ann, const char *file);
+    void (*destroy)(void *ann);
+    void (*enable_seed_fixed)(unsigned int seed);
+
+    unsigned int (*get_num_input)(void *ann);
+    unsigned int (*get_num_output)(void *ann);
+    // input is staged in ff (ff_size * num_input bytes)
+    void (*run)(void *ann, void *ff, const float *input, float *output);
+
+    void (*set_training_algorithm)(void *ann, int algorithm);
+    void (*set_activation_function_hidden)(void *ann, int activation);
+    void (*set_activation_function_output)(void *ann, int activation);
+    void (*set_learning_rate)(void *ann, float learning_rate);
+    void (*set_mini_batch)(void *ann, unsigned int mini_batch);
+
+    void *(*read_data)(const char *file);
+    void (*destroy_data)(void *data);
+    unsigned int (*length_data)(void *data);
+    unsigned int (*num_input_data)(void *data);
+    unsigned int (*num_output_data)(void *data);
+    void (*train_on_data)(void *ann, void *data, unsigned int max_epochs,
+                          unsigned int epochs_between_reports, float desired_error);
+    float (*train_epoch)(void *ann, void *data);
+    float (*test_data)(void *ann, void *data);
+    float (*get_loss)(void *ann);
+};
+
+/* Struct: fann_typed
+
+   A network of a back-end chosen at runtime.
+ */
+struct fann_typed
+{
+    const struct fann_typed_ops *ops;
+    enum fann_numeric_type type;
+    void *ann;
+    void *ff;                       // staged input of <fann_typed_run>
+    float *output;                  // output of <fann_typed_run>
+};
+
+/* Struct: fann_typed_data
+
+   A data set read by a back-end, usable by the networks of its type.
+ */
+struct fann_typed_data
+{
+    const struct fann_typed_ops *ops;
+    enum fann_numeric_type type;
+    void *data;
+};
+
+/* Function: fann_typed_get_ops
+
+   The vtable of *type*, NULL if out of range.
+ */
+FANN_EXTERNAL const struct fann_typed_ops *FANN_API fann_typed_get_ops(enum fann_numeric_type type);
+
+/* Function: fann_typed_parse
+
+   The type named *name* (see <FANN_NUMERIC_TYPE_NAMES>, case insensitive),
+   -1 if unknown.
+ */
+FANN_EXTERNAL int FANN_API fann_typed_parse(const char *name);
+
+/* Function: fann_typed_enable_seed_fixed
+
+   <fann_enable_seed_fixed> in every back-end, so that networks of
+   different types created in the same order get the same initial weights
+   (before rounding). 0 goes back to random seeds.
+ */
+FANN_EXTERNAL void FANN_API fann_typed_enable_seed_fixed(unsigned int seed);
+
+/* Function: fann_create_typed
+
+   Like <fann_create_standard>, with the numeric back-end as first
+   argument.
+
+   Example:
+   > struct fann_typed *ann = fann_create_typed(FANN_TYPE_BF16, 3, 2, 8, 1);
+ */
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed(enum fann_numeric_type type,
+                                                           unsigned int num_layers, ...);
+
+/* Function: fann_create_typed_vector
+
+   Like <fann_create_standard_vector>, with the numeric back-end as first
+   argument.
+ */
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed_vector(enum fann_numeric_type type,
+                                                                  unsigned int extra_threads,
+                                                                  unsigned int num_layers,
+                                                                  const unsigned int *layers);
+
+/* Function: fann_create_typed_from_file
+
+   Loads a network saved by the back-end of the same *type*.
+ */
+FANN_EXTERNAL struct fann_typed *FANN_API fann_create_typed_from_file(enum fann_numeric_type type,
+                                                                     const char *file);
+
+FANN_EXTERNAL void FANN_API fann_typed_destroy(struct fann_typed *ann);
+
+FANN_EXTERNAL int FANN_API fann_typed_save(struct fann_typed *ann, const char *file);
+
+/* Function: fann_typed_run
+
+   Runs *input* (num_input floats) through the network. The outputs are
+   converted to float in a buffer owned by *ann*, valid until the next run.
+ */
+FANN_EXTERNAL float *FANN_API fann_typed_run(struct fann_typed *ann, const float *input);
+
+/* Function: fann_typed_read_data
+
+   Reads a data file with the back-end of *type*.
+ */
+FANN_EXTERNAL struct fann_typed_data *FANN_API fann_typed_read_data(enum fann_numeric_type type,
+                                                                   const char *file);
+
+FANN_EXTERNAL void FANN_API fann_typed_destroy_data(struct fann_typed_data *data);
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_length_data(struct fann_typed_data *data);
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_num_input_data(struct fann_typed_data *data);
+
+FANN_EXTERNAL unsigned int FANN_API fann_typed_num_output_data(struct fann_typed_data *data);
+
+/* Function: fann_typed_train_on_data
+
+   <fann_train_on_data>, *data* must be of the type of *ann*.
+ */
+FANN_EXTERNAL int FANN_API fann_typed_train_on_data(struct fann_typed *ann,
+                                                    struct fann_typed_data *data,
+                                                    unsigned int max_epochs,
+                                                    unsigned int epochs_between_reports,
+                                                    float desired_error);
+
+/* Function: fann_typed_train_epoch
+
+   <fann_train_epoch>, -1 if *data* is not of the type of *ann*.
+ */
+FANN_EXTERNAL float FANN_API fann_typed_train_epoch(struct fann_typed *ann,
+                                                    struct fann_typed_data *data);
+
+/* Function: fann_typed_test_data
+
+   <fann_test_data>, -1 if *data* is not of the type of *ann*. The loss is
+   then available from <fann_typed_get_loss>.
+ */
+FANN_EXTERNAL float FANN_API fann_typed_test_data(struct fann_typed *ann,
+                                                  struct fann_typed_data *data);
+
+FANN_EXTERNAL float FANN_API fann_typed_get_loss(struct fann_typed *ann);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __fann_typed_h__
@@ -0,0 +1,191 @@
+/*
+
+  Fast Artificial Neural Network Library - Floating Point Tests Version
+  Copyright (C) 2017-2019 Vitor Angelo (vitorangelo@gmail.com)
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License v2.1 as published by the Free Software Foundation.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/* Vtable of the back-end being compiled, named by FANN_TYPED_OPS
+   (included by doublefann.c, floatfann.c, fixedfann.c and softfann.c) */
+
+#include "fann_typed.h"
+
+static const char *fann_typed_ops_name(void)
+{
+    return fann_float_type;
+}
+
+static void *fann_typed_ops_create(unsigned int extra_threads, unsigned int num_layers,
+                               const unsigned int *layers)
+{
+    struct fann *ann = fann_create_standard_vector(extra_threads, num_layers, layers);
+
+    // as argopts does by default
+    if (ann != NULL) {
+#ifdef FP_BIAS_DEFAULT
+        fann_initialize_bp_bias(ann, FP_BIAS_DEFAULT);
+#endif
+        fann_init_weights(ann);
+    }
+    return ann;
+}
+
+static void *fann_typed_ops_create_from_file(const char *file)
+{
+    return fann_create_from_file(file);
+}
+
+static int fann_typed_ops_save(void *ann, const char *file)
+{
+    return fann_save((struct fann *)ann, file);
+}
+
+static void fann_typed_ops_destroy(void *ann)
+{
+    fann_destroy((struct fann *)ann);
+}
+
+static void fann_typed_ops_seed(unsigned int seed)
+{
+    if (seed) {
+        fann_enable_seed_fixed(seed);
+    } else {
+        fann_enable_seed_rand();
+    }
+}
+
+static unsigned int fann_typed_ops_num_input(void *ann)
+{
+    return fann_get_num_input((struct fann *)ann);
+}
+
+static unsigned int fann_typed_ops_num_output(void *ann)
+{
+    return fann_get_num_output((struct fann *)ann);
+}
+
+static void fann_typed_ops_run(void *ann, void *ff, const float *input, float *output)
+{
+    struct fann *net = (struct fann *)ann;
+
+    fann_float_to_ff_array((fann_type_ff *)ff, input, net->num_input);
+    fann_ff_to_float_array(output, fann_run(net, (fann_type_ff *)ff), net->num_output);
+}
+
+static void fann_typed_ops_training_algorithm(void *ann, int algorithm)
+{
+    struct fann *net = (struct fann *)ann;
+
+    fann_set_training_algorithm(net, (enum fann_train_enum)algorithm);
+}
+
+static void fann_typed_ops_activation_hidden(void *ann, int activation)
+{
+    fann_set_activation_function_hidden((struct fann *)ann, (enum fann_activationfunc_enum)activation);
+}
+
+static void fann_typed_ops_activation_output(void *ann, int activation)
+{
+    fann_set_activation_function_output((struct fann *)ann, (enum fann_activationfunc_enum)activation);
+}
+
+static void fann_typed_ops_learning_rate(void *ann, float learning_rate)
+{
+    fann_set_learning_rate((struct fann *)ann, learning_rate);
+}
+
+static void fann_typed_ops_mini_batch(void *ann, unsigned int mini_batch)
+{
+    struct fann *net = (struct fann *)ann;
+
+    fann_set_mini_batch(net, mini_batch);
+}
+
+static void *fann_typed_ops_read_data(const char *file)
+{
+    return fann_read_data_from_file(file);
+}
+
+static void fann_typed_ops_destroy_data(void *data)
+{
+    fann_destroy_data((struct fann_data *)data);
+}
+
+static unsigned int fann_typed_ops_length_data(void *data)
+{
+    return fann_length_data((struct fann_data *)data);
+}
+
+static unsigned int fann_typed_ops_num_input_data(void *data)
+{
+    return fann_num_input_data((struct fann_data *)data);
+}
+
+static unsigned int fann_typed_ops_num_output_data(void *data)
+{
+    return fann_num_output_data((struct fann_data *)data);
+}
+
+static void fann_typed_ops_train_on_data(void *ann, void *data, unsigned int max_epochs,
+                                         unsigned int epochs_between_reports, float desired_error)
+{
+    fann_train_on_data((struct fann *)ann, (struct fann_data *)data, max_epochs,
+                       epochs_between_reports, desired_error);
+}
+
+static float fann_typed_ops_train_epoch(void *ann, void *data)
+{
+    return fann_train_epoch((struct fann *)ann, (struct fann_data *)data);
+}
+
+static float fann_typed_ops_test_data(void *ann, void *data)
+{
+    return fann_test_data((struct fann *)ann, (struct fann_data *)data);
+}
+
+static float fann_typed_ops_get_loss(void *ann)
+{
+    return fann_get_loss((struct fann *)ann);
+}
+
+const struct fann_typed_ops FANN_TYPED_OPS;
+
+const struct fann_typed_ops FANN_TYPED_OPS = {
+    .get_name = fann_typed_ops_name,
+    .ff_size = sizeof(fann_type_ff),
+    .create = fann_typed_ops_create,
+    .create_from_file = fann_typed_ops_create_from_file,
+    .save = fann_typed_ops_save,
+    .destroy = fann_typed_ops_destroy,
+    .enable_seed_fixed = fann_typed_ops_seed,
+    .get_num_input = fann_typed_ops_num_input,
+    .get_num_output = fann_typed_ops_num_output,
+    .run = fann_typed_ops_run,
+    .set_training_algorithm = fann_typed_ops_training_algorithm,
+    .set_activation_function_hidden = fann_typed_ops_activation_hidden,
+    .set_activation_function_output = fann_typed_ops_activation_output,
+    .set_learning_rate = fann_typed_ops_learning_rate,
+    .set_mini_batch = fann_typed_ops_mini_batch,
+    .read_data = fann_typed_ops_read_data,
+    .destroy_data = fann_typed_ops_destroy_data,
+    .length_data = fann_typed_ops_length_data,
+    .num_input_data = fann_typed_ops_num_input_data,
+    .num_output_data = fann_typed_ops_num_output_data,
+    .train_on_data = fann_typed_ops_train_on_data,
+    .train_epoch = fann_typed_ops_train_epoch,
+    .test_data = fann_typed_ops_test_data,
+    .get_loss = fann_typed_ops_get_loss,
+};
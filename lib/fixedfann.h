@@ -40,4 +40,30 @@ typedef int32_t fann_type_ff;
 #define FANN_INCLUDE
 #include "fann.h"
 
+/* Function: fann_fixed_quantize
+
+   Runs the neuron sums of the hidden and output layers on int16 copies of
+   the weights and of the layer inputs, with the fraction bits of each
+   layer chosen from the largest weight and the largest input observed
+   while running *data*. Sums are rescaled to Q.FIX_FRAC and saturated.
+   Layers with sparse inputs keep the int32 sums.
+
+   The copies are dropped by everything in the library that changes the
+   weights (<fann_train_epoch>, <fann_train_on_data>, <fann_randomize_weights>,
+   <fann_init_weights>, <fann_load_checkpoint>) and by <fann_fixed_release>;
+   call the latter after writing the weights directly.
+
+   Returns:
+   0 on success, -1 on failure.
+ */
+#ifndef FANN_INFERENCE_ONLY
+FANN_EXTERNAL int FANN_API fann_fixed_quantize(struct fann *ann, struct fann_data *data);
+#endif
+
+/* Function: fann_fixed_release
+
+   Back to the int32 neuron sums.
+ */
+FANN_EXTERNAL void FANN_API fann_fixed_release(struct fann *ann);
+
 #endif
@@ -40,8 +40,22 @@
 #include "fann_mem.c"
 #include "fann_activation.c"
 #include "fann_const.c"
+#include "fann_conv.c"
+#include "fann_count.c"
+#include "fann_prof.c"
+#include "fann_synth.c"
+#include "fann_metrics.c"
+#include "fann_trace.c"
+#include "fann_model.c"
+#ifdef FANN_TYPED_OPS
+#include "fann_typed_ops.c"
+#endif
 
-#ifdef _GCC_ARM_F16_FF
+#if (defined _GCC_ARM_F16_FF) && !((defined __arm__) || (defined __aarch64__))
+const char * fann_float_type = "FF_F16C BP_FLOAT";
+#elif (defined _GCC_ARM_F16_BP) && !((defined __arm__) || (defined __aarch64__))
+const char * fann_float_type = "FF AND BP F16C";
+#elif (defined _GCC_ARM_F16_FF)
 const char * fann_float_type = "FF_ARMFP16 BP_FLOAT";
 #elif (defined _GCC_ARM_F16_BP)
 const char * fann_float_type = "FF AND BP ARMFP16";
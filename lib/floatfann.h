@@ -34,11 +34,20 @@ typedef float fann_type_nt;
 #include <stdint.h>
 #endif
 
+#if (defined _GCC_ARM_F16_FF) || (defined _GCC_ARM_F16_BP)
+#if (defined __arm__) || (defined __aarch64__)
+typedef __fp16 fann_half;
+#else
+// x86: IEEE binary16 storage, computed in fp32 (converted by F16C with -mf16c)
+typedef _Float16 fann_half;
+#endif
+#endif
+
 #ifndef FANN_INFERENCE_ONLY
 #if (defined _GCC_ARM_F16_FF) || (defined _FLOAT_UNION)
 typedef union { float f; uint32_t u; } fann_type_bp;
 #elif defined _GCC_ARM_F16_BP
-typedef union { __fp16 f; uint16_t u; } fann_type_bp;
+typedef union { fann_half f; uint16_t u; } fann_type_bp;
 #elif (defined _BFLOAT16)
 typedef union { int16_t i; uint16_t u; } fann_type_bp;
 #else // native FP32
@@ -47,7 +56,7 @@ typedef float fann_type_bp;
 #endif // FANN_INFERENCE_ONLY
 
 #if (defined _GCC_ARM_F16_FF) || (defined _GCC_ARM_F16_BP)
-typedef union { __fp16 f; uint16_t u; } fann_type_ff;
+typedef union { fann_half f; uint16_t u; } fann_type_ff;
 #elif (defined _FLOAT_UNION)
 typedef union { float f; uint32_t u; } fann_type_ff;
 #elif (defined _BFLOAT16)
@@ -36,6 +36,16 @@
 #include "fann_mem.c"
 #include "fann_activation.c"
 #include "fann_const.c"
+#include "fann_conv.c"
+#include "fann_count.c"
+#include "fann_prof.c"
+#include "fann_synth.c"
+#include "fann_metrics.c"
+#include "fann_trace.c"
+#include "fann_model.c"
+#ifdef FANN_TYPED_OPS
+#include "fann_typed_ops.c"
+#endif
 
 #ifdef SWF32_IEEE
 const char * fann_float_type = "SOFT-SWF32_IEEE";
@@ -53,6 +63,15 @@ const char * fann_float_type = "SOFT-ARMF16";
 #elif defined POSIT16
 const char * fann_float_type = "SOFT-POSIT16";
 #include "softposit.c"
+#elif defined SWF8_E4M3
+const char * fann_float_type = "SOFT-SWF8-E4M3";
+#include "fann_f8.c"
+#elif defined SWF8_E5M2
+const char * fann_float_type = "SOFT-SWF8-E5M2";
+#include "fann_f8.c"
+#elif defined POSIT8
+const char * fann_float_type = "SOFT-POSIT8";
+#include "fann_f8.c"
 #else
 #error "Choose floating point type"
 #endif
@@ -96,6 +115,18 @@ unsigned int fann_ff_fpu_limits(double *min_neg, double *max_neg, double *min_po
     ff.v = 0xFFFF;
     *max_neg = fann_ff_to_float(ff);
     return 16;
+#elif defined SWF8
+    fann_type_ff ff;
+    ff.u = 0x01;
+    *min_pos = fann_ff_to_float(ff);
+    ff.u = F8_MAX_UI;
+    *max_pos = fann_ff_to_float(ff);
+    ff = f8_neg(ff);
+    *min_neg = fann_ff_to_float(ff);
+    ff.u = 0x01;
+    ff = f8_neg(ff);
+    *max_neg = fann_ff_to_float(ff);
+    return 8;
 #else
 #error "Choose floating point type"
 #endif
@@ -139,41 +170,46 @@ unsigned int fann_bp_fpu_limits(double *min_neg, double *max_neg, double *min_po
     bp.v = 0xFFFF;
     *max_neg = fann_bp_to_float(bp);
     return 16;
+#elif defined SWF8
+    fann_type_bp bp;
+    bp.u = 0x01;
+    *min_pos = fann_bp_to_float(bp);
+    bp.u = F8_MAX_UI;
+    *max_pos = fann_bp_to_float(bp);
+    bp = f8_neg(bp);
+    *min_neg = fann_bp_to_float(bp);
+    bp.u = 0x01;
+    bp = f8_neg(bp);
+    *max_neg = fann_bp_to_float(bp);
+    return 8;
 #else
 #error "Choose floating point type"
 #endif
     return 0;
 }
 #ifndef FANN_INFERENCE_ONLY
-unsigned long int fann_mac_ops_count;
-unsigned long int fann_add_ops_count;
-unsigned long int fann_mult_ops_count;
-unsigned long int fann_div_ops_count;
-
 void fann_reset_counters(void)
 {
-    fann_mac_ops_count = 0;
-    fann_add_ops_count = 0;
-    fann_mult_ops_count = 0;
-    fann_div_ops_count = 0;
+    fann_clear_counters();
 #ifdef SWF16_IEEE 
     printf("float exceptions: 0x%02X\n", (unsigned int)softfloat_exceptionFlags);
 #endif
 }
 
-#define COUNT_MAC_OP()
-#define COUNT_ADD_OP()
-#define COUNT_MULT_OP()
-#define COUNT_DIV_OP()
-
-#else // FANN_INFERENCE_ONLY
+#endif // FANN_INFERENCE_ONLY
 
+// count every scalar operation (FANN_COUNT_OPS in fann_count.h)
+#ifdef FANN_COUNT_OPS
+#define COUNT_MAC_OP() fann_count_ops(mac, 1)
+#define COUNT_ADD_OP() fann_count_ops(add, 1)
+#define COUNT_MULT_OP() fann_count_ops(mul, 1)
+#define COUNT_DIV_OP() fann_count_ops(div, 1)
+#else
 #define COUNT_MAC_OP()
 #define COUNT_ADD_OP()
 #define COUNT_MULT_OP()
 #define COUNT_DIV_OP()
-
-#endif // FANN_INFERENCE_ONLY
+#endif // FANN_COUNT_OPS
 
 #define DEBUG_NAN 400
 #undef DEBUG_NAN
@@ -255,7 +291,7 @@ fann_type_ff fann_bp_to_ff(fann_type_bp bp)
 }
 
 #ifndef SWF16_IEEE
-#ifndef POSIT16 
+#if !((defined POSIT16) || (defined SWF8))
 fann_type_bp fann_bp_to_bp(fann_type_bp src, int_fast8_t src_bias)
 {
 #if (defined SWF16_AP) || (defined HWF16)
@@ -291,7 +327,7 @@ fann_type_bp fann_bp_to_bp(fann_type_bp src, int_fast8_t src_bias)
     return src;
 #endif
 }
-#endif // POSIT16 
+#endif // POSIT16 || SWF8
 #endif // SWF16_IEEE
 
 // APPROX FUNCTIONS
@@ -313,6 +349,8 @@ fann_type_bp fann_int_to_bp(int i)//, int_fast8_t bias)
     //return ret;
 #elif defined SWF16_IEEE
     return i32_to_f16(i);
+#elif defined SWF8
+    return i32_to_f8(i);
 #elif defined POSIT16
     return i32_to_p16(i);
 #else // ARMF16
@@ -343,6 +381,8 @@ fann_type_ff fann_int_to_ff(int i)
 #endif
 #elif defined SWF16_IEEE
     return i32_to_f16(i);
+#elif defined SWF8
+    return i32_to_f8(i);
 #elif defined POSIT16
     return i32_to_p16(i);
 #else // ARMF16
@@ -363,6 +403,8 @@ fann_type_bp fann_float_to_bp(float f)//, int_fast8_t bias)
     float hwf; } un;
     un.hwf = (float)f;
     return un.swf;
+#elif defined SWF8
+    return f32_to_f8(f);
 #elif defined POSIT16
     return convertDoubleToP16(f);
 #elif defined SWF16 
@@ -396,6 +438,8 @@ inline fann_type_ff fann_float_to_ff(float f)
     float hwf; } un;
     un.hwf = (float)f;
     return un.swf;
+#elif defined SWF8
+    return f32_to_f8(f);
 #elif defined POSIT16
     return convertDoubleToP16(f);
 #elif defined SWF16 
@@ -480,6 +524,8 @@ inline float fann_bp_to_float(fann_type_bp f)//, int_fast8_t bias)
     float32_t swf;
     swf = f16_to_f32(f);
     return (float)swf.f;
+#elif defined SWF8
+    return f8_to_f32(f);
 #elif defined POSIT16
     return convertP16ToDouble(f);
 #else  // ARMF16
@@ -501,6 +547,8 @@ inline float fann_ff_to_float(fann_type_ff f)
     float32_t swf;
     swf = f16_to_f32(f);
     return (float)swf.f;
+#elif defined SWF8
+    return f8_to_f32(f);
 #elif defined POSIT16
     return convertP16ToDouble(f);
 #else  // ARMF16
@@ -518,6 +566,8 @@ fann_type_bp fann_bp_neg(fann_type_bp f)
     f.u ^= 0x80000000;
 #elif defined SWF16
     f.u ^= 0x8000;
+#elif defined SWF8
+    f = f8_neg(f);
 #elif defined POSIT16
     if (f.v != 0x8000)
         f.v = (~f.v) + 1;
@@ -537,6 +587,8 @@ fann_type_ff fann_ff_neg(fann_type_ff f)
     f.u ^= 0x80000000;
 #elif defined SWF16
     f.u ^= 0x8000;
+#elif defined SWF8
+    f = f8_neg(f);
 #elif defined POSIT16
     if (f.v != 0x8000)
         f.v = (~f.v) + 1;
@@ -555,6 +607,8 @@ fann_type_bp fann_bp_mac(fann_type_bp x, fann_type_bp y, fann_type_bp c)
     COUNT_MAC_OP();
 #ifdef SWF32_IEEE
     return f32_mulAdd(x, y, c);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_mulAdd_fast(x, y, c);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_mulAdd(x, y, c);
 #elif (defined HWF16)
@@ -564,6 +618,8 @@ fann_type_bp fann_bp_mac(fann_type_bp x, fann_type_bp y, fann_type_bp c)
     cf = fann_bp_to_float(c);
     cf += xf * yf;
     return fann_float_to_bp(cf);
+#elif defined SWF8
+    return f8_mulAdd(x, y, c);
 #elif defined POSIT16
     return p16_mulAdd(x, y, c);
 #else  // ARMF16 
@@ -581,6 +637,8 @@ fann_type_ff fann_ff_mac(fann_type_ff x, fann_type_ff y, fann_type_ff c)
     COUNT_MAC_OP();
 #ifdef SWF32_IEEE
     return f32_mulAdd(x, y, c);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_mulAdd_fast(x, y, c);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_mulAdd(x, y, c);
 #elif (defined HWF16)
@@ -590,6 +648,8 @@ fann_type_ff fann_ff_mac(fann_type_ff x, fann_type_ff y, fann_type_ff c)
     cf = fann_ff_to_float(c);
     cf += xf * yf;
     return fann_float_to_ff(cf);
+#elif defined SWF8
+    return f8_mulAdd(x, y, c);
 #elif defined POSIT16
     return p16_mulAdd(x, y, c);
 #else  // ARMF16 
@@ -607,6 +667,8 @@ fann_type_bp fann_bp_mul(fann_type_bp x, fann_type_bp y)
     COUNT_MULT_OP();
 #ifdef SWF32_IEEE
     return f32_mul(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_mul_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_mul(x, y);
 #elif (defined HWF16)
@@ -614,6 +676,8 @@ fann_type_bp fann_bp_mul(fann_type_bp x, fann_type_bp y)
     xf = fann_bp_to_float(x);
     yf = fann_bp_to_float(y);
     return fann_float_to_bp(xf * yf);
+#elif defined SWF8
+    return f8_mul(x, y);
 #elif defined POSIT16
     return p16_mul(x, y);
 #else // ARMF16
@@ -630,6 +694,8 @@ fann_type_ff fann_ff_mul(fann_type_ff x, fann_type_ff y)
     COUNT_MULT_OP();
 #ifdef SWF32_IEEE
     return f32_mul(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_mul_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_mul(x, y);
 #elif (defined HWF16)
@@ -637,6 +703,8 @@ fann_type_ff fann_ff_mul(fann_type_ff x, fann_type_ff y)
     xf = fann_ff_to_float(x);
     yf = fann_ff_to_float(y);
     return fann_float_to_ff(xf * yf);
+#elif defined SWF8
+    return f8_mul(x, y);
 #elif defined POSIT16
     return p16_mul(x, y);
 #else // ARMF16
@@ -676,6 +744,8 @@ fann_type_ff fann_ff_div(fann_type_ff x, fann_type_ff y)
     COUNT_DIV_OP();
 #ifdef SWF32_IEEE
     return f32_div(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_div_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_div(x, y);
 #elif (defined HWF16)
@@ -683,6 +753,8 @@ fann_type_ff fann_ff_div(fann_type_ff x, fann_type_ff y)
     xf = fann_ff_to_float(x);
     yf = fann_ff_to_float(y);
     return fann_float_to_ff(xf / yf);
+#elif defined SWF8
+    return f8_div(x, y);
 #elif defined POSIT16
     return p16_div(x, y);
 #else // ARMF16
@@ -699,6 +771,8 @@ fann_type_bp fann_bp_add(fann_type_bp x, fann_type_bp y)
     COUNT_ADD_OP();
 #ifdef SWF32_IEEE
     return f32_add(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_add_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_add(x, y);
 #elif (defined HWF16)
@@ -706,6 +780,8 @@ fann_type_bp fann_bp_add(fann_type_bp x, fann_type_bp y)
     xf = fann_bp_to_float(x);
     yf = fann_bp_to_float(y);
     return fann_float_to_bp(xf + yf);
+#elif defined SWF8
+    return f8_add(x, y);
 #elif defined POSIT16
     return p16_add(x, y);
 #else // ARMF16
@@ -722,6 +798,8 @@ fann_type_ff fann_ff_add(fann_type_ff x, fann_type_ff y)
     COUNT_ADD_OP();
 #ifdef SWF32_IEEE
     return f32_add(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_add_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_add(x, y);
 #elif (defined HWF16)
@@ -729,6 +807,8 @@ fann_type_ff fann_ff_add(fann_type_ff x, fann_type_ff y)
     xf = fann_ff_to_float(x);
     yf = fann_ff_to_float(y);
     return fann_float_to_ff(xf + yf);
+#elif defined SWF8
+    return f8_add(x, y);
 #elif defined POSIT16
     return p16_add(x, y);
 #else // ARMF16
@@ -745,6 +825,8 @@ fann_type_bp fann_bp_sub(fann_type_bp x, fann_type_bp y)
     COUNT_ADD_OP();
 #ifdef SWF32_IEEE
     return f32_sub(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_sub_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_sub(x, y);
 #elif (defined HWF16)
@@ -752,6 +834,8 @@ fann_type_bp fann_bp_sub(fann_type_bp x, fann_type_bp y)
     xf = fann_bp_to_float(x);
     yf = fann_bp_to_float(y);
     return fann_float_to_bp(xf - yf);
+#elif defined SWF8
+    return f8_sub(x, y);
 #elif defined POSIT16
     return p16_sub(x, y);
 #else // ARMF16
@@ -768,6 +852,8 @@ fann_type_ff fann_ff_sub(fann_type_ff x, fann_type_ff y)
     COUNT_ADD_OP();
 #ifdef SWF32_IEEE
     return f32_sub(x, y);
+#elif (defined SWF16_IEEE) && (defined FANN_F16_FAST)
+    return f16_sub_fast(x, y);
 #elif (defined SWF16_AP) || (defined SWF16_IEEE)
     return f16_sub(x, y);
 #elif (defined HWF16)
@@ -775,6 +861,8 @@ fann_type_ff fann_ff_sub(fann_type_ff x, fann_type_ff y)
     xf = fann_ff_to_float(x);
     yf = fann_ff_to_float(y);
     return fann_float_to_ff(xf - yf);
+#elif defined SWF8
+    return f8_sub(x, y);
 #elif defined POSIT16
     return p16_sub(x, y);
 #else // ARMF16
@@ -782,6 +870,128 @@ fann_type_ff fann_ff_sub(fann_type_ff x, fann_type_ff y)
 #endif
 }
 
+#ifdef FANN_MAC_LANES
+void fann_ff_mac_rows(fann_type_ff *sum, fann_type_ff * const *rows, const fann_type_ff *x,
+                      unsigned int num_rows, unsigned int n)
+{
+    f16_mulAdd_rows(sum, rows, x, num_rows, n);
+}
+
+#ifndef FANN_INFERENCE_ONLY
+void fann_bp_mac_ff_array(fann_type_bp *y, fann_type_bp a, const fann_type_ff *x, unsigned int n)
+{
+#ifdef SWF16_AP
+    fann_type_bp tmp[FANN_CONV_CHUNK];
+    unsigned int i, k;
+
+    // x to the current bp bias first, as fann_ff_to_bp() does
+    for (i = 0; i < n; i += k) {
+        k = (n - i < FANN_CONV_CHUNK) ? n - i : FANN_CONV_CHUNK;
+        fann_ff_to_bp_array(tmp, x + i, k, FP_BIAS);
+        f16_mulAdd_array(y + i, a, tmp, k);
+    }
+#else // SWF16_IEEE: ff and bp are the same
+    f16_mulAdd_array(y, a, x, n);
+#endif
+}
+
+void fann_bp_mac_array(fann_type_bp *y, fann_type_bp a, const fann_type_bp *x, unsigned int n)
+{
+    f16_mulAdd_array(y, a, x, n);
+}
+#endif // FANN_INFERENCE_ONLY
+#endif // FANN_MAC_LANES
+
+#ifdef FANN_QUIRE_DOT
+fann_type_ff fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *x,
+                         unsigned int n)
+{
+    fann_quire q;
+    unsigned int i;
+
+    q16_clr(q);
+    q = q16_fdp_add(q, c, ff_p100);
+    for (i = 0; i < n; i++) {
+        q = q16_fdp_add(q, a[i], x[i]);
+    }
+    return q16_to_p16(q);
+}
+
+fann_type_ff fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                               const fann_type_ff *x, unsigned int n)
+{
+    fann_quire q;
+    unsigned int i;
+
+    q16_clr(q);
+    q = q16_fdp_add(q, c, ff_p100);
+    for (i = 0; i < n; i++) {
+        q = q16_fdp_add(q, a[index[i]], x[i]);
+    }
+    return q16_to_p16(q);
+}
+
+#ifndef FANN_INFERENCE_ONLY
+fann_quire fann_bp_to_quire(fann_type_bp c)
+{
+    fann_quire q;
+
+    q16_clr(q);
+    return q16_fdp_add(q, c, ff_p100);
+}
+
+fann_quire fann_quire_mac(fann_quire q, fann_type_bp x, fann_type_bp y)
+{
+    return q16_fdp_add(q, x, y);
+}
+
+fann_type_bp fann_quire_to_bp(fann_quire q)
+{
+    return q16_to_p16(q);
+}
+
+void fann_quire_mac_ff_array(fann_quire *q, fann_type_bp a, const fann_type_ff *x, unsigned int n)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        q[i] = q16_fdp_add(q[i], a, x[i]);
+    }
+}
+#endif // FANN_INFERENCE_ONLY
+#endif // FANN_QUIRE_DOT
+
+#ifdef SWF8
+/* fp32 sums of the exact products, as 8-bit hardware accumulates */
+fann_type_ff fann_ff_dot(fann_type_ff c, const fann_type_ff *a, const fann_type_ff *x,
+                         unsigned int n)
+{
+    float sum0 = f8_to_f32_lut[c.u], sum1 = 0.0f;
+    unsigned int i;
+
+    for (i = 0; i + 2 <= n; i += 2) {
+        sum0 += f8_to_f32_lut[a[i].u] * f8_to_f32_lut[x[i].u];
+        sum1 += f8_to_f32_lut[a[i + 1].u] * f8_to_f32_lut[x[i + 1].u];
+    }
+    if (i < n) {
+        sum0 += f8_to_f32_lut[a[i].u] * f8_to_f32_lut[x[i].u];
+    }
+    return f32_to_f8(sum0 + sum1);
+}
+
+fann_type_ff fann_ff_dot_index(fann_type_ff c, const fann_type_ff *a, const unsigned int *index,
+                               const fann_type_ff *x, unsigned int n)
+{
+    float sum = f8_to_f32_lut[c.u];
+    unsigned int i;
+
+    for (i = 0; i < n; i++) {
+        sum += f8_to_f32_lut[a[index[i]].u] * f8_to_f32_lut[x[i].u];
+    }
+    return f32_to_f8(sum);
+}
+#endif // SWF8
+
 fann_type_bp fann_bp_abs(fann_type_bp x)
 {
 #ifdef DEBUG_NAN
@@ -794,6 +1004,11 @@ fann_type_bp fann_bp_abs(fann_type_bp x)
     x.u &= 0x7FFF;
 #elif defined ARMF16 
     x.u &= 0x7FFF;
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    x.u &= 0x7F;
+#elif defined SWF8
+    if (x.u > F8_NAR_UI)
+        x = f8_neg(x);
 #elif defined POSIT16
     if (x.v > 0x8000)
         x = fann_bp_neg(x);
@@ -813,6 +1028,11 @@ fann_type_ff fann_ff_abs(fann_type_ff x)
     x.u &= 0x7FFF;
 #elif defined ARMF16 
     x.u &= 0x7FFF;
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    x.u &= 0x7F;
+#elif defined SWF8
+    if (x.u > F8_NAR_UI)
+        x = f8_neg(x);
 #elif defined POSIT16
     if (x.v > 0x8000)
         x = fann_bp_neg(x);
@@ -829,6 +1049,8 @@ int fann_bp_gt(fann_type_bp x, fann_type_bp y)
     return ! f32_le(x, y);
 #elif defined SWF16 
     return ! f16_le(x, y);
+#elif defined SWF8
+    return ! f8_le(x, y);
 #elif defined POSIT16
     return ! p16_le(x, y);
 #else
@@ -843,6 +1065,8 @@ int fann_ff_gt(fann_type_ff x, fann_type_ff y)
     return ! f32_le(x, y);
 #elif defined SWF16 
     return ! f16_le(x, y);
+#elif defined SWF8
+    return ! f8_le(x, y);
 #elif defined POSIT16
     return ! p16_le(x, y);
 #else
@@ -857,6 +1081,8 @@ int fann_bp_lt(fann_type_bp x, fann_type_bp y)
     return f32_lt(x, y);
 #elif defined SWF16 
     return f16_lt(x, y);
+#elif defined SWF8
+    return f8_lt(x, y);
 #elif defined POSIT16
     return p16_lt(x, y);
 #endif
@@ -869,6 +1095,8 @@ int fann_ff_lt(fann_type_ff x, fann_type_ff y)
     return f32_lt(x, y);
 #elif defined SWF16 
     return f16_lt(x, y);
+#elif defined SWF8
+    return f8_lt(x, y);
 #elif defined POSIT16
     return p16_lt(x, y);
 #endif
@@ -881,6 +1109,8 @@ int fann_bp_ne(fann_type_bp x, fann_type_bp y)
     return ! f32_eq(x, y);
 #elif defined SWF16 
     return ! f16_eq(x, y);
+#elif defined SWF8
+    return ! f8_eq(x, y);
 #elif defined POSIT16
     return ! p16_eq(x, y);
 #endif
@@ -893,6 +1123,8 @@ int fann_ff_ne(fann_type_ff x, fann_type_ff y)
     return ! f32_eq(x, y);
 #elif defined SWF16 
     return ! f16_eq(x, y);
+#elif defined SWF8
+    return ! f8_eq(x, y);
 #elif defined POSIT16
     return ! p16_eq(x, y);
 #endif
@@ -950,6 +1182,10 @@ int fann_bp_is_neg(fann_type_bp x)
     return ((x.u & 0x80000000) == 0x80000000) && ((x.u & 0x7FFFFFFF) != 0);
 #elif defined SWF16 
     return ((x.u & 0x8000) == 0x8000) && ((x.u & 0x7FFF) != 0);
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    return ((x.u & 0x80) == 0x80) && ((x.u & 0x7F) != 0);
+#elif defined SWF8
+    return ((x.u & 0x80) == 0x80) && (x.u != F8_NAR_UI);
 #elif defined POSIT16
     return ((x.v & 0x8000) == 0x8000) && (x.v != 0x8000);
 #endif
@@ -961,6 +1197,10 @@ int fann_ff_is_neg(fann_type_ff x)
     return ((x.u & 0x80000000) == 0x80000000) && ((x.u & 0x7FFFFFFF) != 0);
 #elif defined SWF16 
     return ((x.u & 0x8000) == 0x8000) && ((x.u & 0x7FFF) != 0);
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    return ((x.u & 0x80) == 0x80) && ((x.u & 0x7F) != 0);
+#elif defined SWF8
+    return ((x.u & 0x80) == 0x80) && (x.u != F8_NAR_UI);
 #elif defined POSIT16
     return ((x.v & 0x8000) == 0x8000) && (x.v != 0x8000);
 #endif
@@ -972,6 +1212,8 @@ int fann_bp_is_pos(fann_type_bp x)
     return ((x.u & 0x80000000) == 0) && (x.u != 0);
 #elif defined SWF16 
     return ((x.u & 0x8000) == 0) && (x.u != 0);
+#elif defined SWF8
+    return ((x.u & 0x80) == 0) && (x.u != 0);
 #elif defined POSIT16
     return ((x.v & 0x8000) == 0);
 #endif
@@ -983,6 +1225,8 @@ int fann_ff_is_pos(fann_type_ff x)
     return ((x.u & 0x80000000) == 0) && (x.u != 0);
 #elif defined SWF16 
     return ((x.u & 0x8000) == 0) && (x.u != 0);
+#elif defined SWF8
+    return ((x.u & 0x80) == 0) && (x.u != 0);
 #elif defined POSIT16
     return ((x.v & 0x8000) == 0);
 #endif
@@ -994,6 +1238,10 @@ int fann_bp_is_zero(fann_type_bp x)
     return ((x.u & 0x7FFFFFFF) == 0);
 #elif defined SWF16 
     return ((x.u & 0x7FFF) == 0);
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    return ((x.u & 0x7F) == 0);
+#elif defined SWF8
+    return x.u == 0;
 #elif defined POSIT16
     return x.v == 0;
 #endif
@@ -1005,6 +1253,10 @@ int fann_ff_is_zero(fann_type_ff x)
     return ((x.u & 0x7FFFFFFF) == 0);
 #elif defined SWF16 
     return ((x.u & 0x7FFF) == 0);
+#elif (defined SWF8) && (defined F8_SIGN_MAGNITUDE)
+    return ((x.u & 0x7F) == 0);
+#elif defined SWF8
+    return x.u == 0;
 #elif defined POSIT16
     return x.v == 0;
 #endif
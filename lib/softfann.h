@@ -27,10 +27,6 @@
 
 #ifndef FANN_INFERENCE_ONLY
 void fann_reset_counters(void);
-extern unsigned long int fann_mac_ops_count;
-extern unsigned long int fann_add_ops_count;
-extern unsigned long int fann_mult_ops_count;
-extern unsigned long int fann_div_ops_count;
 #endif // FANN_INFERENCE_ONLY
 
 // One of these must be defined at compilation time:
@@ -40,6 +36,9 @@ extern unsigned long int fann_div_ops_count;
 //#define SWF16_AP
 //#define HWF16
 //#define POSIT16
+//#define SWF8_E4M3
+//#define SWF8_E5M2
+//#define POSIT8
 
 #ifdef SWF16_IEEE
 #include "fann_ieee_f16.h"
@@ -59,6 +58,12 @@ extern unsigned long int fann_div_ops_count;
 #elif defined POSIT16
 #include "softposit.h"
 #define EMUL_FLOAT
+
+#elif (defined SWF8_E4M3) || (defined SWF8_E5M2) || (defined POSIT8)
+#include "fann_f8.h"
+#define SWF8
+#define EMUL_FLOAT
+
 #elif defined ARMF16
 #include <stdint.h>
 // use diff. types to force errors
@@ -94,13 +99,37 @@ typedef float16_t fann_type_ff;
 typedef posit16_t fann_type_bp;
 #endif // FANN_INFERENCE_ONLY
 typedef posit16_t fann_type_ff;
-#endif // POSIT16
+#elif defined SWF8
+
+#ifndef FANN_INFERENCE_ONLY
+typedef float8_t fann_type_bp;
+#endif // FANN_INFERENCE_ONLY
+typedef float8_t fann_type_ff;
+#endif // SWF8
 
 #ifndef FANN_INFERENCE_ONLY
 //typedef float fann_type_nt;
 typedef fann_type_ff fann_type_nt;
 #endif // FANN_INFERENCE_ONLY
 
+// multiply-add lanes of the format (fann_ff_mac_rows(), fann_bp_mac_ff_array())
+#if (defined FANN_F16_FAST) && ((defined SWF16_IEEE) || (defined SWF16_AP))
+#define FANN_MAC_LANES F16_LANES
+#define FANN_BP_MAC_ARRAY
+#endif
+
+// exact accumulator of the format (fann_ff_dot(), fann_quire_*())
+#ifdef POSIT16
+#define FANN_QUIRE_DOT
+#define FANN_FF_DOT
+typedef quire16_t fann_quire;
+#endif
+
+// 8-bit neuron sums in fp32 (fann_ff_dot())
+#ifdef SWF8
+#define FANN_FF_DOT
+#endif
+
 #undef SOFTFANN
 #define SOFTFANN
 
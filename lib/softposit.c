@@ -2512,3 +2512,180 @@ posit16_t p16_sub( posit16_t a, posit16_t b ){
 
 }
 
+
+/*============================================================================
+
+Quire16 fused dot products.
+
+The quire is a 128-bit two's complement fixed point accumulator with its
+binary point between bits 55 and 56 (v[0] holds the upper half), which
+holds every product of two posit16 values exactly. The accumulation uses
+the native 128-bit integer arithmetic of the compiler and a single
+rounding is done by q16_to_p16().
+
+=============================================================================*/
+
+#include "platform.h"
+#include "internals.h"
+
+#define castU128Q16( q ) ( ((unsigned __int128) (q).v[0] << 64) | (q).v[1] )
+
+//Significand (hidden bit at 2^12) and scale of a positive non-zero posit16
+static inline int_fast8_t softposit_decodeP16UI( uint_fast16_t uiA, uint_fast32_t *sig ){
+
+	uint32_t tmp = (uint32_t) uiA << 17;
+	int_fast8_t k;
+	int n;
+
+	if (tmp>>31){
+		n = __builtin_clz( ~tmp );
+		k = n - 1;
+	}
+	else{
+		n = __builtin_clz( tmp );
+		k = -n;
+	}
+	//skip the regime and its terminating bit (missing on maxpos)
+	tmp = (n < 15) ? tmp << (n + 1) : 0;
+	*sig = 0x1000 | ((tmp<<1)>>20);
+	return 2*k + (tmp>>31);
+
+}
+
+//Exact product of two posit16 values aligned to the quire
+static inline unsigned __int128 softposit_productQ16( uint_fast16_t uiA, uint_fast16_t uiB ){
+
+	uint_fast32_t sigA, sigB;
+	unsigned __int128 uZ;
+	uint_fast64_t frac;
+	bool signZ;
+	int_fast8_t shift;
+
+	signZ = signP16UI( uiA ) ^ signP16UI( uiB );
+	if (signP16UI( uiA )) uiA = (-uiA & 0xFFFF);
+	if (signP16UI( uiB )) uiB = (-uiB & 0xFFFF);
+	shift = softposit_decodeP16UI( uiA, &sigA );
+	shift += softposit_decodeP16UI( uiB, &sigB );
+	frac = (uint_fast64_t) sigA * sigB;
+	//the product is sigA*sigB * 2^(scaleA+scaleB-24), the quire LSB is 2^-56
+	shift += 32;
+	//no bits are lost shifting right: products below 2^-32 have short fractions
+	if (shift<0) uZ = frac >> -shift;
+	else uZ = (unsigned __int128) frac << shift;
+	return signZ ? -uZ : uZ;
+
+}
+
+static inline quire16_t softposit_fdpQ16( quire16_t q, posit16_t pA, posit16_t pB, bool sub ){
+
+	union ui16_p16 uA, uB;
+	uint_fast16_t uiA, uiB;
+	unsigned __int128 uZ;
+
+	uA.p = pA;
+	uiA = uA.ui;
+	uB.p = pB;
+	uiB = uB.ui;
+
+	//NaR
+	if (isNaRQ16( q ) || isNaRP16UI( uiA ) || isNaRP16UI( uiB )){
+		q.v[0] = 0x8000000000000000ULL;
+		q.v[1] = 0;
+		return q;
+	}
+	else if (uiA==0 || uiB==0)
+		return q;
+
+	uZ = softposit_productQ16( uiA, uiB );
+	if (sub)
+		uZ = castU128Q16( q ) - uZ;
+	else
+		uZ = castU128Q16( q ) + uZ;
+	q.v[0] = (uint64_t) (uZ>>64);
+	q.v[1] = (uint64_t) uZ;
+	//a sum that lands on the NaR pattern is too large anyway
+	return q;
+
+}
+
+quire16_t q16_fdp_add( quire16_t q, posit16_t pA, posit16_t pB ){
+
+	return softposit_fdpQ16( q, pA, pB, 0 );
+
+}
+
+quire16_t q16_fdp_sub( quire16_t q, posit16_t pA, posit16_t pB ){
+
+	return softposit_fdpQ16( q, pA, pB, 1 );
+
+}
+
+posit16_t q16_to_p16( quire16_t q ){
+
+	union ui16_p16 uZ;
+	unsigned __int128 uQ;
+	uint_fast64_t frac, body, lost;
+	bool signQ, bitNPlusOne, bitsMore;
+	int_fast8_t scale, k, regLen;
+	int msb;
+
+	if (isNaRQ16( q )){
+		uZ.ui = 0x8000;
+		return uZ.p;
+	}
+	else if (isQ16Zero( q )){
+		uZ.ui = 0;
+		return uZ.p;
+	}
+
+	uQ = castU128Q16( q );
+	signQ = uQ>>127;
+	if (signQ) uQ = -uQ;
+
+	if (uQ>>64)
+		msb = 127 - __builtin_clzll( (uint64_t) (uQ>>64) );
+	else
+		msb = 63 - __builtin_clzll( (uint64_t) uQ );
+	scale = msb - 56;
+
+	if (scale>27)
+		uZ.ui = 0x7FFF;
+	else if (scale<-28)
+		uZ.ui = 0x1;
+	else{
+		//fraction bits below the hidden bit, left aligned
+		uQ <<= 127 - msb;
+		frac = (uint64_t) (uQ>>63);
+		bitsMore = ((uint64_t) uQ << 1) != 0;
+
+		k = (scale<0) ? -((1 - scale)>>1) : scale>>1;
+		if (k<0){
+			regLen = 1 - k;
+			body = 1;
+		}
+		else{
+			regLen = k + 2;
+			body = ((1ULL << (k + 1)) - 1) << 1;
+		}
+		body <<= 64 - regLen;
+		body |= (uint64_t) (scale - 2*k) << (63 - regLen);
+		body |= frac >> (regLen + 1);
+		lost = frac & ((1ULL << (regLen + 1)) - 1);
+
+		//15 bits of regime, exponent and fraction, then round to nearest even
+		uZ.ui = body>>49;
+		bitNPlusOne = (body>>48) & 0x1;
+		bitsMore |= ((body & 0xFFFFFFFFFFFFULL) | lost) != 0;
+		if (bitNPlusOne && (bitsMore || (uZ.ui & 0x1)))
+			uZ.ui++;
+	}
+	if (signQ) uZ.ui = -uZ.ui & 0xFFFF;
+	return uZ.p;
+
+}
+
+posit16_t convertQ16ToP16( quire16_t q ){
+
+	return q16_to_p16( q );
+
+}